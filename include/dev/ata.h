@@ -31,4 +31,9 @@
 	 */
 	extern void ata_init(void);
 
+	/**
+	 * @brief Gets the number of pending requests of an ATA device.
+	 */
+	extern int ata_queue_depth(unsigned);
+
 #endif /* ATA_H_ */
@@ -0,0 +1,52 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+	#include <nanvix/const.h>
+	#include <sys/trace.h>
+	#include <stdint.h>
+
+	/**
+	 * @brief Is tracing enabled?
+	 */
+	EXTERN volatile int trace_enabled;
+
+	/* Forward definitions. */
+	EXTERN void trace_init(void);
+	EXTERN void test_trace(void);
+	EXTERN void trace_event(unsigned, uint32_t, uint32_t, uint32_t);
+	EXTERN void trace_syscall_enter(unsigned, uint32_t, uint32_t);
+	EXTERN void trace_syscall_exit(int);
+
+	/**
+	 * @brief Static tracepoint.
+	 *
+	 * @details Costs a single test when tracing is disabled.
+	 */
+	#define TRACE(event, a0, a1, a2)                                    \
+	do                                                                  \
+	{                                                                   \
+		if (trace_enabled)                                              \
+			trace_event(event, (uint32_t)(a0), (uint32_t)(a1),          \
+				(uint32_t)(a2));                                        \
+	} while (0)
+
+#endif /* TRACE_H_ */
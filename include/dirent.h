@@ -67,7 +67,7 @@
 	#include <limits.h>
 	
  	#ifndef MAXNAMLEN
-	#define MAXNAMLEN 30
+	#define MAXNAMLEN 60
  	#endif
 
 	/*
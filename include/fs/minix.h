@@ -46,7 +46,7 @@
 	/**
 	 * @brief User for block number.
 	 */
-	typedef uint16_t block_t;
+	typedef uint32_t block_t;
 #endif
 	
 	/**
@@ -128,10 +128,10 @@
 	#define NR_DIRECT 1
 
 	/** Number of zones in a single indirect zone. */
-	#define NR_SINGLE (BLOCK_SIZE/sizeof(block_t))
+	#define NR_SINGLE (BLOCK_SIZE/sizeof(uint16_t))
 	
 	/** Number of zones in a double indirect zone. */
-	#define NR_DOUBLE ((BLOCK_SIZE/sizeof(block_t))*NR_SINGLE)
+	#define NR_DOUBLE ((BLOCK_SIZE/sizeof(uint16_t))*NR_SINGLE)
 
 	/** Offset remaining to use in double indirect zone. */
 	#define REMAINING_OFFSET ((NR_ZONES_DIRECT+NR_SINGLE)*BLOCK_SIZE)
@@ -174,4 +174,96 @@
 	} __attribute__((packed));
 #endif
 
+/*============================================================================*
+ *                                 Minix v3                                   *
+ *============================================================================*/
+
+	/**
+	 * @brief Log 2 of block size in a Minix v3 file system.
+	 */
+	#define BLOCK_SIZE_V3_LOG2 12
+	
+	/**
+	 * @brief Block size in a Minix v3 file system (in bytes).
+	 */
+	#define BLOCK_SIZE_V3 (1 << BLOCK_SIZE_V3_LOG2)
+
+	/**
+	 * @brief Minix v3 superblock magic number.
+	 */
+	#define SUPER_MAGIC_V3 0x4d5a
+
+	/**
+	 * @name Number of Zones in a Minix v3 Inode
+	 */
+	/**@{*/
+	#define NR_ZONES_TRIPLE  1 /**< Number of triple indirect zones. */
+	#define NR_ZONES_V3     10 /**< Total of zones.                  */
+	/**@}*/
+
+	/**
+	 * @brief Triple indirect zone index.
+	 */
+	#define ZONE_TRIPLE (ZONE_DOUBLE + NR_ZONES_DOUBLE)
+
+	/**
+	 * @brief Number of zones in a Minix v3 single indirect zone.
+	 */
+	#define NR_SINGLE_V3 (BLOCK_SIZE_V3/sizeof(uint32_t))
+
+	/**
+	 * @brief Maximum name on a Minix v3 file system.
+	 */
+	#define MINIX3_NAME_MAX 60
+
+#ifndef _ASM_FILE_
+	/**
+	 * @brief Minix v3 in-disk superblock.
+	 * 
+	 * @details The superblock lives at byte offset 1024, no matter the
+	 *          block size. The inode map starts at block 2.
+	 */
+	struct d_superblock_v3
+	{
+		uint32_t s_ninodes;          /**< Number of inodes.           */
+		uint16_t unused1;            /**< Unused.                     */
+		uint16_t s_imap_nblocks;     /**< Number of inode map blocks. */
+		uint16_t s_bmap_nblocks;     /**< Number of block map blocks. */
+		uint16_t s_first_data_block; /**< First data block.           */
+		uint16_t s_log_zone_size;    /**< Log 2 of blocks per zone.   */
+		uint16_t unused2;            /**< Unused.                     */
+		uint32_t s_max_size;         /**< Maximum file size.          */
+		uint32_t s_nblocks;          /**< Number of blocks.           */
+		uint16_t s_magic;            /**< Magic number.               */
+		uint16_t unused3;            /**< Unused.                     */
+		uint16_t s_block_size;       /**< Block size (in bytes).      */
+		uint8_t s_disk_version;      /**< File system sub-version.    */
+	} __attribute__((packed));
+
+	/**
+	 * @brief Minix v3 disk inode.
+	 */
+	struct d_inode_v3
+	{
+		uint16_t i_mode;               /**< Access permissions.           */
+		uint16_t i_nlinks;             /**< Number of links to the file.  */
+		uint16_t i_uid;                /**< User id of the file's owner.  */
+		uint16_t i_gid;                /**< Group number of owner user.   */
+		uint32_t i_size;               /**< File size (in bytes).         */
+		uint32_t i_atime;              /**< Time of last access.          */
+		uint32_t i_mtime;              /**< Time of last modification.    */
+		uint32_t i_ctime;              /**< Time of last status change.   */
+		uint32_t i_zones[NR_ZONES_V3]; /**< Zone numbers.                 */
+	} __attribute__((packed));
+
+	/**
+	 * @brief Minix v3 directory entry.
+	 */
+	struct d_dirent_v3
+	{
+		uint32_t d_ino;               /**< File serial number. */
+		char d_name[MINIX3_NAME_MAX]; /**< Name of entry.      */
+	} __attribute__((packed));
+#endif
+
 #endif /* MINIX_H_ */
@@ -0,0 +1,136 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file i386/apic.h
+ *
+ * @brief Local and I/O Advanced Programmable Interrupt Controllers
+ */
+
+#ifndef I386_APIC_H_
+#define I386_APIC_H_
+
+	/**
+	 * @name Memory-mapped APIC windows
+	 *
+	 * @details Both controllers are identity mapped by a dedicated kernel
+	 * page table, with caching disabled.
+	 */
+	/**@{*/
+	#define APIC_VIRT   0xfec00000 /**< APIC window (virtual).      */
+	#define IOAPIC_PHYS 0xfec00000 /**< Default I/O APIC address.   */
+	#define LAPIC_PHYS  0xfee00000 /**< Default local APIC address. */
+	/**@}*/
+
+	/**
+	 * @name Local APIC registers (offsets)
+	 */
+	/**@{*/
+	#define LAPIC_ID        0x020 /**< ID.                          */
+	#define LAPIC_VER       0x030 /**< Version.                     */
+	#define LAPIC_TPR       0x080 /**< Task priority.               */
+	#define LAPIC_EOI       0x0b0 /**< End of interrupt.            */
+	#define LAPIC_SVR       0x0f0 /**< Spurious interrupt vector.   */
+	#define LAPIC_ESR       0x280 /**< Error status.                */
+	#define LAPIC_ICRLO     0x300 /**< Interrupt command (low).     */
+	#define LAPIC_ICRHI     0x310 /**< Interrupt command (high).    */
+	#define LAPIC_TIMER     0x320 /**< LVT timer.                   */
+	#define LAPIC_PCINT     0x340 /**< LVT performance counter.     */
+	#define LAPIC_LINT0     0x350 /**< LVT local interrupt 0.       */
+	#define LAPIC_LINT1     0x360 /**< LVT local interrupt 1.       */
+	#define LAPIC_ERROR     0x370 /**< LVT error.                   */
+	#define LAPIC_TICR      0x380 /**< Timer initial count.         */
+	#define LAPIC_TCCR      0x390 /**< Timer current count.         */
+	#define LAPIC_TDCR      0x3e0 /**< Timer divide configuration.  */
+	/**@}*/
+
+	/**
+	 * @name Local APIC register bits
+	 */
+	/**@{*/
+	#define LAPIC_SVR_ENABLE  0x00000100 /**< Software enable.          */
+	#define LAPIC_ICR_INIT    0x00000500 /**< INIT delivery mode.       */
+	#define LAPIC_ICR_STARTUP 0x00000600 /**< Start-up delivery mode.   */
+	#define LAPIC_ICR_DELIVS  0x00001000 /**< Delivery status.          */
+	#define LAPIC_ICR_ASSERT  0x00004000 /**< Assert interrupt.         */
+	#define LAPIC_ICR_LEVEL   0x00008000 /**< Level triggered.          */
+	#define LAPIC_ICR_BCAST   0x00080000 /**< All including self.       */
+	#define LAPIC_LVT_MASKED  0x00010000 /**< Interrupt masked.         */
+	#define LAPIC_LVT_NMI     0x00000400 /**< NMI delivery mode.        */
+	#define LAPIC_LVT_EXTINT  0x00000700 /**< ExtINT delivery mode.     */
+	#define LAPIC_TIMER_ONESHOT  0x00000000 /**< One-shot timer mode.   */
+	#define LAPIC_TIMER_PERIODIC 0x00020000 /**< Periodic timer mode.   */
+	#define LAPIC_TDCR_16     0x00000003 /**< Divide timer clock by 16. */
+	/**@}*/
+
+	/**
+	 * @name I/O APIC registers
+	 */
+	/**@{*/
+	#define IOAPIC_REGSEL  0x00 /**< Register select (offset).     */
+	#define IOAPIC_WIN     0x10 /**< Register window (offset).     */
+	#define IOAPIC_REG_ID  0x00 /**< ID register.                  */
+	#define IOAPIC_REG_VER 0x01 /**< Version register.             */
+	#define IOAPIC_REG_TBL 0x10 /**< First redirection table entry. */
+	#define IOAPIC_MASKED  0x00010000 /**< Redirection entry masked. */
+	/**@}*/
+
+	/**
+	 * @name Interrupt vectors
+	 */
+	/**@{*/
+	#define APIC_VEC_TIMER    48 /**< Local APIC timer.   */
+	#define APIC_VEC_RESCHED  49 /**< Reschedule.         */
+	#define APIC_VEC_SPURIOUS 255 /**< Spurious interrupt. */
+	/**@}*/
+
+	/**
+	 * @brief Physical address where application processors start.
+	 */
+	#define TRAMPOLINE_PHYS 0x7000
+
+#ifndef _ASM_FILE_
+
+	#include <nanvix/const.h>
+	#include <stdint.h>
+
+	/* Forward definitions. */
+	EXTERN int lapic_present;
+	EXTERN void lapic_init(int);
+	EXTERN unsigned lapic_id(void);
+	EXTERN void lapic_eoi(void);
+	EXTERN void lapic_sendipi(unsigned, unsigned);
+	EXTERN void lapic_startap(unsigned, uint32_t);
+	EXTERN void lapic_timer_calibrate(void);
+	EXTERN void lapic_timer_start(void);
+	EXTERN int lapic_timer_stop(void);
+	EXTERN void do_lapic_timer(void);
+	EXTERN void do_lapic_resched(void);
+	EXTERN void ioapic_init(uint32_t, unsigned);
+	EXTERN void ioapic_route(unsigned, unsigned, unsigned);
+	EXTERN void ioapic_mask(unsigned);
+
+	/* Interrupt hooks. */
+	EXTERN void lapic_timer(void);
+	EXTERN void lapic_resched(void);
+	EXTERN void lapic_spurious(void);
+
+#endif /* _ASM_FILE_ */
+
+#endif /* I386_APIC_H_ */
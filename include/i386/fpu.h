@@ -35,6 +35,11 @@
 		char dummy[512];
 	} __attribute__((packed));
 
+	/**
+	 * @brief Are SSE2 instructions available?
+	 */
+	EXTERN int fpu_sse2;
+
 	EXTERN void fpu_init(void);
 	EXTERN void fpu_save(struct process *);
 	EXTERN void fpu_restore(struct process *);
@@ -27,7 +27,7 @@
 	#define GDTPTR_SIZE 6
 	
 	/* GDT size (number of entries). */
-	#define GDT_SIZE 6
+	#define GDT_SIZE 7
 
 	/* GDT entries. */
 	#define GDT_NULL       0 /* Null.       */
@@ -36,6 +36,7 @@
 	#define GDT_CODE_DPL3  3 /* Code DPL 3. */
 	#define GDT_DATA_DPL3  4 /* Data DPL 3. */
 	#define GDT_TSS        5 /* TSS.        */
+	#define GDT_PERCPU     6 /* Per-CPU.    */
 	
 	/* GDT segment selectors. */
 	#define KERNEL_CS (GDTE_SIZE*GDT_CODE_DPL0)     /* Kernel code. */
@@ -43,6 +44,7 @@
 	#define USER_CS   (GDTE_SIZE*GDT_CODE_DPL3 + 3) /* User code.   */
 	#define USER_DS   (GDTE_SIZE*GDT_DATA_DPL3 + 3) /* User data.   */
 	#define TSS       (GDTE_SIZE*GDT_TSS + 3)       /* TSS.         */
+	#define KERNEL_GS (GDTE_SIZE*GDT_PERCPU)        /* Per-CPU.     */
 
 #ifndef _ASM_FILE_
 
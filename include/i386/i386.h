@@ -51,6 +51,9 @@
 	#define JMP_BUF_KESP   28
 	#define JMP_BUF_INTLVL 32
 	
+	/* EFLAGS bits. */
+	#define EFLAGS_IF 0x200 /* Interrupt enable. */
+	
 #ifndef _ASM_FILE_
 
 	/* Machine types. */
@@ -86,6 +89,16 @@
 	 */
 	EXTERN void idt_flush(struct idtptr *idtptr);
 	
+	/*
+	 * Enables interrupts and halts. An interrupt is only taken after
+	 * the instruction that follows sti, so none can get in between
+	 * and be lost before the processor halts.
+	 */
+	static inline void idle_halt(void)
+	{
+		__asm__ __volatile__ ("sti; hlt" : : : "memory");
+	}
+	
 
 #endif /* _ASM_FILE_ */
 
@@ -33,6 +33,11 @@
 	#define PTE_SIZE   4                 /* Page table entry size.     */
 	#define PDE_SIZE   4                 /* Page directory entry size. */
 
+	/* Large pages (PSE). */
+	#define LPAGE_SIZE PGTAB_SIZE /* Large page size.                    */
+	#define PDE_LARGE  0x80       /* Large page bit of a directory entry. */
+	#define CR4_PSE    0x10       /* Page size extensions enable.         */
+
 #ifndef _ASM_FILE_
 
 	/*
@@ -46,7 +51,8 @@
 		unsigned          :  2; /* Reserved.          */
 		unsigned accessed :  1; /* Accessed?          */
 		unsigned dirty    :  1; /* Dirty?             */
-		unsigned          :  2; /* Reserved.          */
+		unsigned large    :  1; /* Large page?        */
+		unsigned          :  1; /* Reserved.          */
 		unsigned          :  3; /* Unused.            */
 		unsigned frame    : 20; /* Frame number.      */
 	};
@@ -142,6 +148,31 @@
 		return (pde->user);
 	}
 
+	/**
+	 * @brief Sets/clears the large page bit of a page table directory entry.
+	 *
+	 * @param pde Target page table directory entry.
+	 * @param set Set bit?
+	 */
+	static inline void pde_large_set(struct pde *pde, int set)
+	{
+		pde->large = (set) ? 1 : 0;
+	}
+
+	/**
+	 * @brief Asserts if the large page bit of a page table directory entry
+	 * is set.
+	 *
+	 * @param pde Target page table directory entry.
+	 *
+	 * @returns Non zero if the target page table directory entry maps a
+	 * large page, and false otherwise.
+	 */
+	static inline int pde_is_large(struct pde *pde)
+	{
+		return (pde->large);
+	}
+
 	/**
 	 * @brief Sets/clears the present bit of a page table entry.
 	 *
@@ -24,7 +24,9 @@
 	#define PIT_FREQUENCY 1193180
 	
 	/* Registers. */
-	#define PIT_CTRL 0x43 /* Control. */
-	#define PIT_DATA 0x40 /* Data.    */
+	#define PIT_CTRL 0x43 /* Control.           */
+	#define PIT_DATA 0x40 /* Data.              */
+	#define PIT_CH2  0x42 /* Channel 2 data.    */
+	#define PIT_GATE 0x61 /* Channel 2 gate.    */
 
 #endif /* I386_PIT_H_ */
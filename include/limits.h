@@ -216,11 +216,14 @@
 /**
  * @brief Maximum number of bytes in a filename.
  */
-#define NAME_MAX 30
+#define NAME_MAX 60
 
 /* Files that one process can have open simultaneously. */
 #define OPEN_MAX 20
 
+/* Maximum number of elements in an I/O vector. */
+#define IOV_MAX 1024
+
 /* Number of semaphores that can be opened simultaneously. */
 #define SEM_OPEN_MAX 100
 
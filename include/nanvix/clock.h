@@ -22,6 +22,7 @@
 #define TIMER_H_
 
 	#include <nanvix/const.h>
+	#include <sys/timepage.h>
 	
 	/**
 	 * @brief Clock interrupt frequency (in Hz)
@@ -36,9 +37,16 @@
 
  	/* Forward declarations. */
 	EXTERN void clock_init(unsigned);
+	EXTERN void clock_account(void);
+	EXTERN int clock_stop(unsigned);
+	EXTERN void clock_resume(void);
+	EXTERN void timepage_init(unsigned, unsigned);
+	EXTERN void timepage_update(void);
+	EXTERN int timepage_attach(void);
 
 	/* Forward definitions. */
 	EXTERN unsigned ticks;
-	EXTERN signed startup_time;
+	EXTERN unsigned startup_time;
+	EXTERN struct timepage *timepage;
 	
 #endif /* TIMER_H_ */
@@ -40,13 +40,14 @@
 	#define MULTIUSER                    0 /**< Multiuser support?                 */
 	#define KERNEL_VERSION           "2.0" /**< Kernel version.                    */
 	#define PROC_MAX                    64 /**< Maximum number of process.         */
+	#define CPU_MAX                      8 /**< Maximum number of processors.      */
 	#define PROC_SIZE_MAX  (MEMORY_SIZE/8) /**< Maximum process size.              */
 	#define RAMDISK_SIZE         0x4000000 /**< RAM disks size.                    */
 	#define INITRD_SIZE          0x4000000 /**< Init RAM disk size.                */
+	#define TMPFS_SIZE            0x800000 /**< tmpfs data, for all instances.    */
 	#define NR_INODES                 1024 /**< Number of in-core inodes.          */
 	#define NR_SUPERBLOCKS               4 /**< Number of in-core super blocks.    */
 	#define ROOT_DEV                0x0001 /**< Root device number.                */
-	#define NR_FILES                   256 /**< Number of opened files.            */
 	#define NR_REGIONS                 128 /**< Number of memory regions.          */
 	#define NR_BUFFERS                 256 /**< Number of block buffers.           */
 	#define NR_MOUNTING_POINT           64 /**< Maximum nunber of mounting points. */
@@ -62,9 +62,12 @@
 	 * @brief Major numbers for character devices.
 	 */
 	/**@{*/
-	#define NULL_MAJOR 0x0 /**< Null device.       */
-	#define TTY_MAJOR  0x1 /**< TTY device.        */
-	#define KLOG_MAJOR 0x2 /**< kernel log device. */
+	#define NULL_MAJOR  0x0 /**< Null device.         */
+	#define TTY_MAJOR   0x1 /**< TTY device.          */
+	#define KLOG_MAJOR  0x2 /**< kernel log device.   */
+	#define TRACE_MAJOR 0x3 /**< kernel trace device. */
+	#define TMPFS_MAJOR 0x4 /**< tmpfs (no driver).   */
+	#define PROC_MAJOR  0x5 /**< procfs (no driver).  */
 	/**@}*/
 	
 	/**
@@ -82,6 +85,7 @@
 		ssize_t (*write)(unsigned, const char *, size_t); /**< Write.   */
 		int (*ioctl)(unsigned, unsigned, unsigned);       /**< Control. */
 		int (*close)(dev_t);                              /**< Close.   */
+		int (*poll)(unsigned, int);                       /**< Poll.    */
 	};
 	
 	/* Forward definitions. */
@@ -91,6 +95,7 @@
 	EXTERN int cdev_open(dev_t);
 	EXTERN int cdev_close(dev_t);
 	EXTERN int cdev_ioctl(dev_t, unsigned, unsigned);
+	EXTERN int cdev_poll(dev_t, int);
 	EXTERN void cdev_test(void);
 	
 	/*========================================================================*
@@ -114,6 +119,7 @@
 		ssize_t (*write)(dev_t, const char *, size_t, off_t); /**< Write.       */
 		int (*readblk)(unsigned, struct buffer *);            /**< Read block.  */
 		int (*writeblk)(unsigned, struct buffer *);           /**< Write block. */
+		void *(*mapblk)(unsigned, block_t);                   /**< Map block.   */
 	};
 	
 	/* Forward definitions. */
@@ -122,5 +128,6 @@
 	EXTERN ssize_t bdev_read(dev_t, char *, size_t, off_t);
 	EXTERN void bdev_writeblk(struct buffer *);
 	EXTERN void bdev_readblk(struct buffer *);
+	EXTERN void *bdev_mapblk(dev_t, block_t);
 	EXTERN void bdev_test(void);
 #endif /* DEV_H_ */
@@ -34,6 +34,7 @@
 	#include <nanvix/pm.h>
 	#include <sys/stat.h>
 	#include <sys/types.h>
+	#include <sys/uio.h>
 	#include <stdint.h>
 	#include <ustat.h>
 	#include <sys/sem.h>
@@ -62,13 +63,21 @@
 	EXTERN void blklock(buffer_t);
 	EXTERN void blkunlock(buffer_t);
 	EXTERN void brelse(buffer_t);
+	EXTERN unsigned buffer_hits;
+	EXTERN unsigned buffer_misses;
 	EXTERN buffer_t bread(dev_t, block_t);
+	EXTERN buffer_t breada(dev_t, block_t);
+	EXTERN void bdone(buffer_t);
+	EXTERN void bwait(buffer_t);
 	EXTERN void bwrite(buffer_t);
+	EXTERN int bcached(dev_t, block_t);
 	EXTERN void buffer_dirty(buffer_t, int);
 	EXTERN void *buffer_data(const_buffer_t);
 	EXTERN dev_t buffer_dev(const_buffer_t);
 	EXTERN block_t buffer_num(const_buffer_t);
 	EXTERN int buffer_is_sync(const_buffer_t);
+	EXTERN int buffer_is_async(const_buffer_t);
+	EXTERN int buffer_is_valid(const_buffer_t);
 	
 	/**@}*/
 	
@@ -90,7 +99,10 @@
 		int (*dir_remove)(struct inode *, const char *);
 		ssize_t (*file_read)(struct inode *, void *, size_t , off_t );
 		ssize_t (*file_write)(struct inode *, const void *, size_t , off_t);
-		struct d_dirent *(*dirent_search) (struct inode *, const char *, struct buffer **, int);
+		ino_t (*dir_search)(struct inode *, const char *);
+		void *(*file_map)(struct inode *, off_t);
+		struct buffer *(*file_bread)(struct inode *, off_t);
+		struct buffer *(*file_breada)(struct inode *, off_t);
 	};
 
 	/**
@@ -105,6 +117,18 @@
 		INODE_PIPE   = (1 << 4)  /**< Pipe inode?  */
 	};
 
+	/**
+	 * @brief Selection record.
+	 *
+	 * @details Remembers which process polls an object, so that
+	 *          selwakeup() may wake it up alone.
+	 */
+	struct selinfo
+	{
+		struct process *proc; /**< Polling process.             */
+		int collision;        /**< Many processes polling?      */
+	};
+
 	/** 
  	 * @brief In-core inode. 
 	 */ 
@@ -116,7 +140,7 @@
 		gid_t gid;                /**< Group number of owner user.           */ 
 		off_t size;               /**< File size (in bytes).                 */ 
 		time_t time;              /**< Time when the file was last accessed. */ 
-		block_t blocks[NR_ZONES]; /**< Zone numbers.                         */ 
+		block_t blocks[NR_ZONES_V3]; /**< Zone numbers.                      */ 
 		dev_t dev;                /**< Underlying device.                    */ 
 		ino_t num;                /**< Inode number.                         */ 
 		struct superblock *sb;    /**< Superblock.                           */ 
@@ -129,6 +153,7 @@
 		struct inode *hash_next;  /**< Next inode in the hash table.         */ 
 		struct inode *hash_prev;  /**< Previous inode in the hash table.     */ 
 		struct process *chain;    /**< Sleeping chain.                       */ 
+		struct selinfo sel;       /**< Pipe polling.                         */ 
 		struct inode_operations * i_op;
 		union {
 			struct d_inode minix;
@@ -138,6 +163,8 @@
   /**@}*/ 
    
   /* Forward definitions. */ 
+  EXTERN unsigned inode_hits;
+  EXTERN unsigned inode_misses;
   EXTERN void inode_touch(struct inode *); 
   EXTERN void inode_lock(struct inode *); 
   EXTERN void inode_unlock(struct inode *); 
@@ -207,6 +234,7 @@
   EXTERN void putname(char *); 
   EXTERN int getfildes(void); 
   EXTERN struct file *getfile(void); 
+  EXTERN void putfile(struct file *);
   EXTERN void do_close(int); 
   EXTERN int dir_add(struct inode *, struct inode *, const char *); 
   EXTERN ino_t dir_search(struct inode *, const char *); 
@@ -214,15 +242,31 @@
   EXTERN ssize_t file_read(struct inode *, void *, size_t, off_t); 
   EXTERN ssize_t dir_read(struct inode *, void *, size_t, off_t); 
   EXTERN ssize_t file_write(struct inode *, const void *, size_t, off_t); 
+  EXTERN ssize_t file_readv(struct inode *, const struct iovec *, int, off_t);
+  EXTERN ssize_t file_writev(struct inode *, const struct iovec *, int, off_t);
+  EXTERN void *file_map(struct inode *, off_t);
+  EXTERN int file_sized(struct inode *);
+  EXTERN struct buffer *file_bread(struct inode *, off_t);
+  EXTERN struct buffer *file_breada(struct inode *, off_t);
+  EXTERN ssize_t chkiov(const struct iovec *, int);
+  EXTERN ssize_t do_read(struct file *, const struct iovec *, int, off_t);
+  EXTERN ssize_t do_write(struct file *, const struct iovec *, int, off_t);
   EXTERN ssize_t pipe_read(struct inode *, char *, size_t); 
   EXTERN ssize_t pipe_write(struct inode *, const char *, size_t); 
+  EXTERN int pipe_poll(struct inode *, int);
+  EXTERN void selrecord(struct selinfo *);
+  EXTERN void selwakeup(struct selinfo *);
   EXTERN struct inode *do_creat(struct inode *, const char *wame, mode_t, int);
   EXTERN const char *break_path(const char *, char *);
+  EXTERN int ioring_attach(void);
+  EXTERN void ioring_detach(void);
+  EXTERN unsigned ioring_submit(unsigned);
+  EXTERN void ioring_reap(void);
+  EXTERN void ioring_wait(unsigned);
    
   /* Forward definitions. */ 
   EXTERN struct inode *root; 
   EXTERN struct superblock *rootdev; 
-  EXTERN struct file filetab[NR_FILES]; 
  
 #endif /* _ASM_FILE */ 
  
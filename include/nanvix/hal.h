@@ -40,6 +40,7 @@
 	#include <nanvix/const.h>
 	#include <nanvix/pm.h>
 	#include <stdlib.h>
+	#include <sys/types.h>
 	
 	/* Forward definitions. */
 	struct process;
@@ -56,10 +57,16 @@
 	#define INT_LVL_5 5 /**< Level 5: all hardware interrupts enabled.  */
 	/**@}*/
 	
+	/**
+	 * @brief Number of hardware interrupt lines.
+	 */
+	#define NR_HWINT 16
+
 	/**
 	 * @name Processor Control Functions
 	 */
 	/**@{*/
+	EXTERN unsigned hwint_count[NR_HWINT];
 	EXTERN int set_hwint(int, void (*)(void));
 	EXTERN void enable_interrupts(void);
 	EXTERN void disable_interrupts(void);
@@ -68,6 +75,7 @@
 	EXTERN unsigned processor_raise(unsigned);
 	EXTERN void processor_reload(void);
 	EXTERN void setup(void);
+	EXTERN void setup_ap(int);
 	EXTERN void user_mode(addr_t, addr_t);
 	EXTERN void switch_to(struct process *);
 	EXTERN unsigned irq_lvl(unsigned);
@@ -89,6 +97,8 @@
 	 */
 	/**@{*/
 	EXTERN void physcpy(addr_t, addr_t, size_t);
+	EXTERN int ucopy(void *, const void *, size_t);
+	EXTERN ssize_t ustrncpy(char *, const char *, size_t);
 	/**@}*/	
 
 	/**
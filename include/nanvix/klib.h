@@ -220,6 +220,16 @@
 	#define ALIGNED(a, s) \
 		(!(((addr_t)(a)) & ((s) - 1)))
 
+	/**
+	 * @brief Checks if a 32-bit word @p w has a zero byte.
+	 *
+	 * @param w Word to be checked.
+	 *
+	 * @returns Non-zero if the word has a zero byte, and zero otherwise.
+	 */
+	#define HAS_ZERO_BYTE(w) \
+		(((w) - 0x01010101) & ~(w) & 0x80808080)
+
 	/**
 	 * @brief Checks if 'a' agrees on size if 'b'
 	 * 
@@ -292,6 +302,8 @@
 	EXTERN void kmemdump(const void *s, size_t);
 	EXTERN const char *skip_code(const char *buffer, int *);
 	EXTERN char get_code(const char *);
+	EXTERN void klib_init(void);
+	EXTERN void test_klib(void);
 	/**@}*/
 
 	/*========================================================================*
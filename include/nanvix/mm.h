@@ -104,22 +104,47 @@
 		(((addr_t)(addr) < UBASE_VIRT) || \
 		 ((addr_t)(addr) >= KBASE_VIRT))
 
+	/* Cache line size. */
+	#define CACHE_LINE_SIZE 64
+
+	/* Object cache flags. */
+	#define KCACHE_HWALIGN 1 /* Align objects on cache lines. */
+
 #ifndef _ASM_FILE_
 	
+	/* Object cache. */
+	struct kcache;
+
 	/* Buffers virt. */
 	EXTERN unsigned const BUFFERS_VIRT;
 
 	/* Forward definitions. */
 	EXTERN int chkmem(const void *, size_t, mode_t);
+	EXTERN int chkuser(const void *, size_t);
+	EXTERN int pin_user(const void *, size_t, int);
+	EXTERN int copy_from_user(void *, const void *, size_t);
+	EXTERN int copy_to_user(void *, const void *, size_t);
+	EXTERN ssize_t strncpy_from_user(char *, const char *, size_t);
 	EXTERN int fubyte(const void *);
 	EXTERN int fudword(const void *);
 	EXTERN int crtpgdir(struct process *);
 	EXTERN int pfault(addr_t);
+	EXTERN int pinupg(addr_t, size_t, int);
 	EXTERN int vfault(addr_t);
 	EXTERN void dstrypgdir(struct process *);
 	EXTERN void putkpg(void *);
 	EXTERN void mm_init(void);
 	EXTERN void *getkpg(int);
+	EXTERN unsigned kpg_nfree(void);
+	EXTERN unsigned frame_nfree(void);
+	EXTERN struct kcache *kcache_create(const char *, size_t, int, void (*)(void *));
+	EXTERN void kcache_destroy(struct kcache *);
+	EXTERN void *kcache_alloc(struct kcache *);
+	EXTERN void kcache_free(struct kcache *, void *);
+	EXTERN void kcache_reap(void);
+	EXTERN void kcache_init(void);
+	EXTERN void *kmalloc(size_t);
+	EXTERN void kfree(void *);
 
 #endif /* _ASM_FILE_ */
 	
@@ -32,6 +32,8 @@
 	#include <nanvix/fs.h>
 	#include <nanvix/hal.h>
 	#include <nanvix/region.h>
+	#include <nanvix/smp.h>
+	#include <nanvix/spinlock.h>
 	#include <i386/fpu.h>
 	#include <i386/pmc.h>
 	#include <sys/types.h>
@@ -68,6 +70,7 @@
 	/**@{*/
 	#define PROC_NEW 0 /**< Is the process new?     */
 	#define PROC_SYS 1 /**< Handling a system call? */
+	#define PROC_AIO 2 /**< Completions pending?    */
 	/**@}*/
 	
 	/**
@@ -155,7 +158,10 @@
 		/**@{*/
 		struct pde *pgdir;                 /**< Page directory.         */
 		struct pregion pregs[NR_PREGIONS]; /**< Process memory regions. */
+		struct pregion *lastreg;           /**< Last region looked up.  */
 		size_t size;                       /**< Process size.           */
+		unsigned minflt;                   /**< Page faults served.     */
+		unsigned majflt;                   /**< Page faults with I/O.   */
 		/**@}*/
 
 		/**
@@ -168,6 +174,7 @@
 		int close;                     /**< Close on exec()?           */
 		mode_t umask;                  /**< User file's creation mask. */
 		dev_t tty;                     /**< Associated tty device.     */
+		struct ioring *ioring;         /**< Asynchronous I/O ring.     */
 		/**@}*/
 		
 		/**
@@ -207,8 +214,12 @@
     	int priority;            /**< Process priorities.     */
     	int nice;                /**< Nice for scheduling.    */
     	unsigned alarm;          /**< Alarm.                  */
+    	unsigned timeout;        /**< Sleep timeout.          */
 		struct process *next;    /**< Next process in a list. */
 		struct process **chain;  /**< Sleeping chain.         */
+		struct process *rqnext;  /**< Next in a ready queue.  */
+		unsigned cpu;            /**< Last processor.         */
+		unsigned affinity;       /**< Allowed processors.     */
 		/**@}*/
 	};
 	
@@ -220,10 +231,16 @@
 	EXTERN void sched(struct process *);
 #ifdef BUILDING_KERNEL
 	EXTERN void sleep(struct process **, int);
+	EXTERN void sleep_locked(struct process **, int, struct spinlock *);
+	EXTERN int futex_sleep(const void *, addr_t);
+	EXTERN int futex_wakeup(const void *, addr_t, int);
 #endif
 	EXTERN void sndsig(struct process *, int);
+	EXTERN void unsleep(struct process *);
 	EXTERN void wakeup(struct process **);
 	EXTERN void yield(void);
+	EXTERN int sched_idle(unsigned *);
+	EXTERN void sched_timer(unsigned);
 	
 	/**
 	 * @name Process memory regions
@@ -282,7 +299,9 @@
 	/* Forward definitions. */
 	EXTERN int shutting_down;
 	EXTERN struct process proctab[PROC_MAX];
+#ifndef i386
 	EXTERN struct process *curr_proc;
+#endif
 	EXTERN struct process *last_proc;
 	EXTERN pid_t next_pid;
 	EXTERN unsigned nprocs;
@@ -35,6 +35,8 @@
 	#define REGION_STICKY    0x08 /* Stick region.           */
 	#define REGION_DOWNWARDS 0x10 /* Region grows downwards. */
 	#define REGION_UPWARDS   0x20 /* Region grows upwards.   */
+	#define REGION_PRIVATE   0x40 /* Not inherited on fork.  */
+	#define REGION_DAX       0x80 /* Maps file in place.     */
 	
 	/* Memory region dimensions. */
 	#define REGION_PGTABS (16) /* # Page tables.     */
@@ -171,10 +173,12 @@
 	EXTERN int attachreg(struct process*,struct pregion*,addr_t,struct region*);
 	EXTERN int editreg(struct region *, uid_t, gid_t, mode_t);
 	EXTERN int growreg(struct process *, struct pregion *, ssize_t);
+	EXTERN int ismapped(const struct inode *);
 	EXTERN int loadreg(struct inode *, struct region *, off_t, size_t);
 	EXTERN void detachreg(struct process *, struct pregion *);
 	EXTERN void freereg(struct region *);
 	EXTERN void initreg(void);
+	EXTERN struct region *kpgreg(void *, mode_t, int);
 	EXTERN void lockreg(struct region *);
 	EXTERN void unlockreg(struct region *);
 	EXTERN void test_mm(void);
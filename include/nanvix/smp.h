@@ -0,0 +1,131 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file nanvix/smp.h
+ *
+ * @brief Symmetric multiprocessing
+ */
+
+#ifndef NANVIX_SMP_H_
+#define NANVIX_SMP_H_
+
+	#include <nanvix/config.h>
+
+	/**
+	 * @name Offsets to hard-coded fields of a processor
+	 */
+	/**@{*/
+	#define CPU_SELF 0 /**< Self pointer offset.        */
+	#define CPU_CURR 4 /**< Running process offset.     */
+	#define CPU_TSS  8 /**< Task state segment offset.  */
+	/**@}*/
+
+#ifndef _ASM_FILE_
+
+	#include <nanvix/const.h>
+	#include <nanvix/spinlock.h>
+
+	/* Forward definitions. */
+	struct process;
+
+	/**
+	 * @brief Processor affinity mask that allows all processors.
+	 */
+	#define CPU_ALL (~0U)
+
+	/**
+	 * @brief Ready queue of a processor.
+	 */
+	struct runqueue
+	{
+		struct spinlock lock;  /**< Protects this structure. */
+		struct process *head;  /**< Ready processes.         */
+		unsigned nready;       /**< Number of processes.     */
+	};
+
+	/**
+	 * @brief Processor.
+	 */
+	struct cpu
+	{
+		/**
+		 * @name Hard-coded Fields
+		 */
+		/**@{*/
+		struct cpu *self;      /**< This structure.     */
+		struct process *curr;  /**< Running process.    */
+		void *tss;             /**< Task state segment. */
+		/**@}*/
+
+		unsigned id;           /**< Logical ID.         */
+		unsigned apicid;       /**< Local APIC ID.      */
+		volatile int online;   /**< Is it running?      */
+		struct process *idle;  /**< Idle process.       */
+		void *kstack;          /**< Idle kernel stack.  */
+		struct runqueue rq;    /**< Ready queue.        */
+		unsigned nswitches;    /**< Context switches.   */
+		unsigned nskipped;     /**< Idle ticks skipped. */
+	};
+
+	/* Forward definitions. */
+	EXTERN struct cpu cpus[CPU_MAX];
+	EXTERN unsigned ncpus;
+	EXTERN void smp_init(void);
+	EXTERN void smp_boot(void);
+	EXTERN void cpu_idle(void);
+	EXTERN void cpu_kick(struct cpu *);
+	EXTERN void kernel_lock(void);
+	EXTERN void kernel_unlock(void);
+
+#ifdef i386
+
+	/**
+	 * @brief Returns the processor that is running the caller.
+	 *
+	 * @details The per-processor segment is loaded in the %gs register
+	 * at every kernel entry, so the first field of the structure is
+	 * reachable without touching shared memory.
+	 */
+	static inline struct cpu *cpu_self(void)
+	{
+		struct cpu *cpu;
+
+		__asm__ __volatile__ ("movl %%gs:0, %0" : "=r" (cpu));
+
+		return (cpu);
+	}
+
+	/**
+	 * @brief Current running process.
+	 */
+	#define curr_proc (cpu_self()->curr)
+
+#else
+
+	/**
+	 * @brief Returns the processor that is running the caller.
+	 */
+	#define cpu_self() (&cpus[0])
+
+#endif
+
+#endif /* _ASM_FILE_ */
+
+#endif /* NANVIX_SMP_H_ */
@@ -0,0 +1,62 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file nanvix/spinlock.h
+ *
+ * @brief Spinlocks
+ */
+
+#ifndef NANVIX_SPINLOCK_H_
+#define NANVIX_SPINLOCK_H_
+
+#ifndef _ASM_FILE_
+
+	#include <nanvix/const.h>
+
+	/**
+	 * @brief Spinlock.
+	 *
+	 * @details A spinlock disables interrupts on the local processor
+	 * while it is held, so it may be shared with interrupt handlers.
+	 */
+	struct spinlock
+	{
+		volatile unsigned locked; /**< Is the lock held?             */
+		unsigned flags;           /**< Interrupt state of the owner. */
+	};
+
+	/**
+	 * @brief Static initializer for a spinlock.
+	 */
+	#define SPINLOCK_INITIALIZER { 0, 0 }
+
+	/* Forward definitions. */
+	EXTERN void spinlock_init(struct spinlock *);
+	EXTERN void spinlock_lock(struct spinlock *);
+	EXTERN int spinlock_trylock(struct spinlock *);
+	EXTERN void spinlock_unlock(struct spinlock *);
+	
+	/* Architecture hooks. */
+	EXTERN unsigned irq_save(void);
+	EXTERN unsigned test_and_set(volatile unsigned *);
+
+#endif /* _ASM_FILE_ */
+
+#endif /* NANVIX_SPINLOCK_H_ */
@@ -27,15 +27,17 @@
 	#include <sys/stat.h>
 	#include <sys/times.h>
 	#include <sys/types.h>
+	#include <sys/uio.h>
 	#include <sys/utsname.h>
 	#include <i386/pmc.h>
 	#include <signal.h>
 	#include <ustat.h>
+	#include <poll.h>
 	#include <utime.h>
 	#include <semaphore.h>
 
 	/* Number of system calls. */
-	#define NR_SYSCALLS 59
+	#define NR_SYSCALLS 70
 	
 	/* System call numbers. */
 	#define NR_alarm     0
@@ -97,9 +99,17 @@
 	#define NR_sempost  56
 	#define NR_acct     57
 	#define NR_rmdir    58
- 	#define NR_semget   59
- 	#define NR_semctl   60
- 	#define NR_semop    61
+	#define NR_sched_yield 59
+	#define NR_futex    60
+	#define NR_readv    61
+	#define NR_writev   62
+	#define NR_pread    63
+	#define NR_pwrite   64
+	#define NR_sendfile 65
+	#define NR_ioring_setup 66
+	#define NR_ioring_enter 67
+	#define NR_clock_gettime 68
+	#define NR_poll 69
 
 #ifndef _ASM_FILE_
 
@@ -310,6 +320,39 @@
 	/* Removes an empty directory. */
 	EXTERN int sys_rmdir(const char *path);
 
+	/* Yields the processor. */
+	EXTERN int sys_sched_yield(void);
+
+	/* Waits on/wakes up processes waiting on a user word. */
+	EXTERN int sys_futex(int *uaddr, int op, int val);
+
+	/* Reads from a file into a vector of buffers. */
+	EXTERN ssize_t sys_readv(int fd, const struct iovec *iov, int iovcnt);
+
+	/* Writes to a file from a vector of buffers. */
+	EXTERN ssize_t sys_writev(int fd, const struct iovec *iov, int iovcnt);
+
+	/* Reads from a file at a given offset. */
+	EXTERN ssize_t sys_pread(int fd, void *buf, size_t n, off_t off);
+
+	/* Writes to a file at a given offset. */
+	EXTERN ssize_t sys_pwrite(int fd, const void *buf, size_t n, off_t off);
+
+	/* Copies data from a regular file to another file. */
+	EXTERN ssize_t sys_sendfile(int out_fd, int in_fd, off_t *offset, size_t count);
+
+	/* Sets up an asynchronous I/O ring. */
+	EXTERN int sys_ioring_setup(void);
+
+	/* Submits and waits for asynchronous I/O operations. */
+	EXTERN int sys_ioring_enter(unsigned to_submit, unsigned min_complete);
+
+	/* Gets the time of a clock. */
+	EXTERN int sys_clock_gettime(clockid_t clock_id, struct timespec *tp);
+
+	/* Waits for events on file descriptors. */
+	EXTERN int sys_poll(struct pollfd *fds, nfds_t nfds, int timeout);
+
 #endif /* _ASM_FILE_ */
 
 #endif /* NANVIX_SYSCALL_H_ */
@@ -33,7 +33,7 @@
 		int semid; 	/**< Semaphore ID.  */
 	} sem_t;
 
-	extern sem_t *usem[OPEN_MAX];
+	extern sem_t *usem[SEM_OPEN_MAX];
 
 	/* Forward definitions. */
 	extern sem_t *sem_open(const char *, int, ...);
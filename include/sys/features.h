@@ -109,6 +109,11 @@ extern "C" {
 # define _POSIX_VERSION 199009L
 #endif
 
+/* Nanvix has a monotonic clock, but no per-process timers. */
+#if !defined(__rtems__) && !defined(__CYGWIN__)
+#define _POSIX_MONOTONIC_CLOCK		200112L
+#endif
+
 #ifdef __CYGWIN__
 
 #if !defined(__STRICT_ANSI__) || defined(__cplusplus) || __STDC_VERSION__ >= 199901L
@@ -0,0 +1,46 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file sys/futex.h
+ *
+ * @brief Fast user-space locking.
+ */
+
+#ifndef SYS_FUTEX_H_
+#define SYS_FUTEX_H_
+
+	/**
+	 * @name Futex operations
+	 */
+	/**@{*/
+	#define FUTEX_WAIT 0 /**< Sleep if the word holds a given value. */
+	#define FUTEX_WAKE 1 /**< Wake up processes sleeping on a word.  */
+	/**@}*/
+
+#ifndef _ASM_FILE_
+#ifndef BUILDING_KERNEL
+
+	/* Forward definitions. */
+	extern int futex(int *, int, int);
+
+#endif /* BUILDING_KERNEL */
+#endif /* _ASM_FILE_ */
+
+#endif /* SYS_FUTEX_H_ */
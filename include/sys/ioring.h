@@ -0,0 +1,112 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file sys/ioring.h
+ *
+ * @brief Asynchronous I/O rings.
+ *
+ * @details A process submits I/O operations by filling entries of the
+ * submission queue and advancing its tail, and then calling
+ * ioring_enter(). The kernel posts the results in the completion
+ * queue, which the process may poll without entering the kernel.
+ * Completions of asynchronous reads are posted at the end of system
+ * calls, so a process that makes none has to call ioring_enter() to
+ * collect them.
+ * Both queues live in a page that is shared between the process and
+ * the kernel, and their heads and tails are free running counters.
+ */
+
+#ifndef SYS_IORING_H_
+#define SYS_IORING_H_
+
+	/**
+	 * @brief Where the ring is mapped in user space.
+	 */
+	#define IORING_ADDR 0x94000000
+
+	/**
+	 * @name Queue sizes
+	 */
+	/**@{*/
+	#define IORING_NR_SQES  64 /**< Submission queue entries. */
+	#define IORING_NR_CQES 128 /**< Completion queue entries. */
+	/**@}*/
+
+	/**
+	 * @name Operations
+	 */
+	/**@{*/
+	#define IORING_OP_NOP   0 /**< No operation. */
+	#define IORING_OP_READ  1 /**< Read.         */
+	#define IORING_OP_WRITE 2 /**< Write.        */
+	/**@}*/
+
+#ifndef _ASM_FILE_
+
+	#include <sys/types.h>
+
+	/**
+	 * @brief Submission queue entry.
+	 *
+	 * @details An offset of -1 stands for the current file offset,
+	 * which is then advanced as read() and write() do.
+	 */
+	struct io_sqe
+	{
+		int opcode;              /**< Operation.                 */
+		int fd;                  /**< File descriptor.           */
+		void *buf;               /**< Buffer.                    */
+		size_t len;              /**< Number of bytes.           */
+		off_t off;               /**< File offset.               */
+		unsigned long user_data; /**< Passed back on completion. */
+	};
+
+	/**
+	 * @brief Completion queue entry.
+	 */
+	struct io_cqe
+	{
+		unsigned long user_data; /**< As submitted.                */
+		ssize_t res;             /**< Bytes moved or error number. */
+	};
+
+	/**
+	 * @brief Asynchronous I/O ring.
+	 */
+	struct io_ring
+	{
+		volatile unsigned sq_head;          /**< Advanced by the kernel.  */
+		volatile unsigned sq_tail;          /**< Advanced by the process. */
+		volatile unsigned cq_head;          /**< Advanced by the process. */
+		volatile unsigned cq_tail;          /**< Advanced by the kernel.  */
+		struct io_sqe sqes[IORING_NR_SQES]; /**< Submission queue.        */
+		struct io_cqe cqes[IORING_NR_CQES]; /**< Completion queue.        */
+	};
+
+#ifndef BUILDING_KERNEL
+
+	/* Forward definitions. */
+	extern struct io_ring *ioring_setup(void);
+	extern int ioring_enter(unsigned, unsigned);
+
+#endif /* BUILDING_KERNEL */
+#endif /* _ASM_FILE_ */
+
+#endif /* SYS_IORING_H_ */
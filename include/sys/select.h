@@ -0,0 +1,35 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file sys/select.h
+ *
+ * @brief Synchronous input/output multiplexing.
+ */
+
+#ifndef SYS_SELECT_H_
+#define SYS_SELECT_H_
+
+	#include <sys/types.h>
+	#include <sys/time.h>
+
+	/* Forward definitions. */
+	extern int select(int, fd_set *, fd_set *, fd_set *, struct timeval *);
+
+#endif /* SYS_SELECT_H_ */
@@ -18,14 +18,29 @@
 #define SEM_VALID_VALUE(val) \
 		(val<=SEM_VALUE_MAX)
 
+/* Where semaphore values are mapped in user space. */
+#define SEM_ADDR 0x90000000
+
+/* User-visible part of a semaphore. */
+#define SEM_USEM(idx) \
+		(&((struct usem *)SEM_ADDR)[idx])
+
 #ifndef _ASM_FILE_
 
+	/*
+	 * User-visible part of a semaphore. Semaphore values live in
+	 * a page that is shared by all processes, so that semaphores
+	 * may be operated without entering the kernel.
+	 */
+	struct usem {
+		volatile int value;						/* Value of the semaphore								*/
+		volatile int waiters;					/* Number of processes sleeping on the semaphore		*/
+	};
+
 	/* Kernel semaphores */
 	struct ksem {
 		char name[MAX_SEM_NAME];				/* Semaphore name 										*/
-		short value;              				/* Value of the semaphore                    			*/
 		pid_t currprocs[PROC_MAX];				/* Processes using the semaphores						*/
-		struct process* semwaiters[PROC_MAX];	/* The size should be higher if threads are implemented */
 		dev_t dev;								/* Semaphore descriptor device							*/
 		ino_t num;								/* Semaphore descriptor inode number					*/
 	};
@@ -33,6 +48,21 @@
 	/* Semaphores table */
 	extern struct ksem semtable[SEM_OPEN_MAX];
 
+	/* Semaphore values, as seen by the kernel */
+	extern struct usem *semvals;
+
+	/* Maps semaphore values in the current process */
+	int sem_attach(void);
+
+	/* Checks if semaphore values are mapped in the current process */
+	int sem_attached(void);
+
+	/* Consumes a resource, sleeping if needed */
+	int sem_down(int idx);
+
+	/* Releases a resource */
+	void sem_up(int idx);
+
 	/* Inode corresponding to the semaphore directory */
 	extern struct inode *semdirectory;
 
@@ -0,0 +1,158 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file sys/timepage.h
+ *
+ * @brief Time page.
+ *
+ * @details The kernel keeps the monotonic clock in a page that is
+ * mapped read-only in every process, so that processes may read the
+ * time without entering the kernel. The page holds the time at the
+ * last clock interrupt, and the value of the cycle counter at that
+ * time. Readers add the cycles elapsed since then, scaled to
+ * nanoseconds. Where there is no usable cycle counter, the scale is
+ * zero and the clock advances at clock interrupts only.
+ *
+ * The kernel bumps the sequence number before and after updating the
+ * page, so readers retry when they see it odd or changed.
+ */
+
+#ifndef SYS_TIMEPAGE_H_
+#define SYS_TIMEPAGE_H_
+
+	/**
+	 * @brief Where the time page is mapped in user space.
+	 */
+	#define TIMEPAGE_ADDR 0x98000000
+
+	/**
+	 * @brief Nanoseconds per second.
+	 */
+	#define NSEC_PER_SEC 1000000000
+
+#ifndef _ASM_FILE_
+
+	#include <stddef.h>
+	#include <stdint.h>
+	#include <sys/types.h>
+
+	/**
+	 * @brief Time page.
+	 *
+	 * @details Cycles are converted to nanoseconds as
+	 * (cycles*mult) >> shift.
+	 */
+	struct timepage
+	{
+		volatile unsigned seq; /**< Sequence number.               */
+		unsigned mult;         /**< Cycles to nanoseconds scale.   */
+		unsigned shift;        /**< Cycles to nanoseconds shift.   */
+		unsigned boot_sec;     /**< Boot time since the Epoch.     */
+		uint64_t base_cycles;  /**< Cycle counter at base.         */
+		unsigned base_sec;     /**< Monotonic seconds at base.     */
+		unsigned base_nsec;    /**< Monotonic nanoseconds at base. */
+	};
+
+	/**
+	 * @brief Reads the cycle counter.
+	 */
+	static inline uint64_t timepage_cycles(void)
+	{
+#ifdef i386
+		uint64_t cycles;
+
+		__asm__ __volatile__ ("rdtsc" : "=A" (cycles));
+
+		return (cycles);
+#else
+		return (0);
+#endif
+	}
+
+	/**
+	 * @brief Converts cycles elapsed since the base of a time page
+	 * to nanoseconds.
+	 *
+	 * @details Gaps longer than 2^32 cycles are clamped, as they only
+	 * happen if clock interrupts are lost.
+	 */
+	static inline uint64_t timepage_nsecs(const volatile struct timepage *tp, uint64_t cycles)
+	{
+#ifdef i386
+		uint64_t delta;
+
+		if (tp->mult == 0)
+			return (0);
+
+		delta = cycles - tp->base_cycles;
+		if (delta > 0xffffffff)
+			delta = 0xffffffff;
+
+		return (((uint64_t)((unsigned) delta)*tp->mult) >> tp->shift);
+#else
+		((void) tp);
+		((void) cycles);
+
+		return (0);
+#endif
+	}
+
+	/**
+	 * @brief Reads the monotonic clock from a time page.
+	 *
+	 * @details If @p boot is not a null pointer, the boot time is
+	 * stored there, read consistently with the monotonic clock.
+	 */
+	static inline void timepage_read(const volatile struct timepage *tp, struct timespec *ts, unsigned *boot)
+	{
+		unsigned seq;  /* Sequence number. */
+		unsigned sec;  /* Seconds.         */
+		unsigned bsec; /* Boot time.       */
+		uint64_t nsec; /* Nanoseconds.     */
+
+		do
+		{
+			while ((seq = tp->seq) & 1)
+				/* noop */ ;
+			__asm__ __volatile__ ("" ::: "memory");
+
+			sec = tp->base_sec;
+			bsec = tp->boot_sec;
+			nsec = tp->base_nsec + timepage_nsecs(tp, timepage_cycles());
+
+			__asm__ __volatile__ ("" ::: "memory");
+		} while (seq != tp->seq);
+
+		while (nsec >= NSEC_PER_SEC)
+		{
+			nsec -= NSEC_PER_SEC;
+			sec++;
+		}
+
+		ts->tv_sec = sec;
+		ts->tv_nsec = (long) nsec;
+
+		if (boot != NULL)
+			*boot = bsec;
+	}
+
+#endif /* _ASM_FILE_ */
+
+#endif /* SYS_TIMEPAGE_H_ */
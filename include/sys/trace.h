@@ -0,0 +1,71 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file sys/trace.h
+ *
+ * @brief Kernel tracing.
+ *
+ * @details Trace records are fixed-size binary records that are read
+ * from /dev/trace, in the byte order of the target machine, and decoded
+ * offline by the tracedump host tool.
+ */
+
+#ifndef SYS_TRACE_H_
+#define SYS_TRACE_H_
+
+	#include <stdint.h>
+
+	/**
+	 * @name Trace events
+	 */
+	/**@{*/
+	#define TRACE_SYSCALL_ENTER 1 /**< System call entry (nr, arg0, arg1). */
+	#define TRACE_SYSCALL_EXIT  2 /**< System call exit (nr, ret).         */
+	#define TRACE_SWITCH        3 /**< Context switch (prev, next, state). */
+	#define TRACE_PAGE_FAULT    4 /**< Page fault (addr, protection).      */
+	#define TRACE_BREAD_MISS    5 /**< Block cache miss (dev, block).      */
+	#define TRACE_ATA_DONE      6 /**< ATA request done (dev, write, blk). */
+	#define TRACE_NR_EVENTS     7 /**< Number of events.                   */
+	/**@}*/
+
+	/**
+	 * @name ioctl() commands for /dev/trace
+	 */
+	/**@{*/
+	#define TRACE_ENABLE  0x74100000 /**< Start tracing (off at boot). */
+	#define TRACE_DISABLE 0x74200000 /**< Stop tracing.                */
+	#define TRACE_CLEAR   0x74300000 /**< Discard unread records.      */
+	#define TRACE_LOST    0x74400000 /**< Get number of lost records.  */
+	/**@}*/
+
+	/**
+	 * @brief Trace record.
+	 */
+	struct trace_record
+	{
+		uint64_t time;    /**< Time stamp (cycles or clock ticks). */
+		uint32_t seq;     /**< Sequence number, per processor.     */
+		uint16_t cpu;     /**< Processor.                          */
+		uint16_t event;   /**< Event.                              */
+		int32_t pid;      /**< Running process.                    */
+		uint32_t args[3]; /**< Event arguments.                    */
+	};
+
+#endif /* SYS_TRACE_H_ */
@@ -89,6 +89,7 @@ int     _EXFUN(chown, (const char *__path, uid_t __owner, gid_t __group ));
 int     _EXFUN(chroot, (const char *__path ));
 #endif
 int     _EXFUN(close, (int __fildes ));
+ssize_t _EXFUN(copy_file_range, (int __fd_in, off_t *__off_in, int __fd_out, off_t *__off_out, size_t __len, unsigned __flags));
 #if defined(__CYGWIN__)
 size_t	_EXFUN(confstr, (int __name, char *__buf, size_t __len));
 #endif
@@ -252,6 +252,21 @@ int _EXFUN(nanosleep, (const struct timespec  *rqtp, struct timespec *rmtp));
 #endif
 #endif /* _POSIX_TIMERS */
 
+#if !defined(_POSIX_TIMERS) && defined(_POSIX_MONOTONIC_CLOCK)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Clocks, without per-process timers. */
+
+int _EXFUN(clock_gettime, (clockid_t clock_id, struct timespec *tp));
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* !_POSIX_TIMERS && _POSIX_MONOTONIC_CLOCK */
+
 #if defined(_POSIX_CLOCK_SELECTION)
 
 #ifdef __cplusplus
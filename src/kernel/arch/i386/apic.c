@@ -0,0 +1,405 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <i386/apic.h>
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/hal.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <stdint.h>
+
+/**
+ * @brief Number of clock ticks used to calibrate the local APIC timer.
+ */
+#define CALIBRATE_TICKS 10
+
+/**
+ * @brief CMOS ports.
+ */
+/**@{*/
+#define CMOS_ADDR 0x70 /**< Address register. */
+#define CMOS_DATA 0x71 /**< Data register.    */
+/**@}*/
+
+/**
+ * @brief Is there a local APIC?
+ */
+PUBLIC int lapic_present = 0;
+
+/**
+ * @brief Local APIC timer counts per clock tick.
+ */
+PRIVATE uint32_t lapic_ticks = 0;
+
+/**
+ * @brief Local APIC registers.
+ */
+PRIVATE volatile uint32_t *lapic = (volatile uint32_t *)LAPIC_PHYS;
+
+/**
+ * @brief I/O APIC registers.
+ */
+PRIVATE volatile uint32_t *ioapic = NULL;
+
+/*============================================================================*
+ *                                Local APIC                                  *
+ *============================================================================*/
+
+/**
+ * @brief Writes to a local APIC register.
+ *
+ * @param reg   Target register.
+ * @param value Value to write.
+ */
+PRIVATE void lapic_write(unsigned reg, uint32_t value)
+{
+	lapic[reg >> 2] = value;
+
+	/* Wait for write to finish. */
+	(void) lapic[LAPIC_ID >> 2];
+}
+
+/**
+ * @brief Reads a local APIC register.
+ *
+ * @param reg Target register.
+ *
+ * @returns The value of the register.
+ */
+PRIVATE uint32_t lapic_read(unsigned reg)
+{
+	return (lapic[reg >> 2]);
+}
+
+/**
+ * @brief Waits for about @p n microseconds.
+ */
+PRIVATE void udelay(unsigned n)
+{
+	/* Each dummy I/O takes about one microsecond. */
+	while (n-- > 0)
+		iowait();
+}
+
+/**
+ * @brief Initializes the local APIC of the calling processor.
+ *
+ * @param bsp Is the caller the bootstrap processor?
+ */
+PUBLIC void lapic_init(int bsp)
+{
+	if (!lapic_present)
+		return;
+
+	/* Enable local APIC and set spurious interrupt vector. */
+	lapic_write(LAPIC_SVR, LAPIC_SVR_ENABLE | APIC_VEC_SPURIOUS);
+
+	/* Timer stays masked until it is started. */
+	lapic_write(LAPIC_TDCR, LAPIC_TDCR_16);
+	lapic_write(LAPIC_TIMER, LAPIC_LVT_MASKED | APIC_VEC_TIMER);
+
+	/*
+	 * Legacy interrupts are delivered by the 8259 PIC
+	 * in virtual wire mode, to the bootstrap processor only.
+	 */
+	if (bsp)
+	{
+		lapic_write(LAPIC_LINT0, LAPIC_LVT_EXTINT);
+		lapic_write(LAPIC_LINT1, LAPIC_LVT_NMI);
+	}
+	else
+	{
+		lapic_write(LAPIC_LINT0, LAPIC_LVT_MASKED);
+		lapic_write(LAPIC_LINT1, LAPIC_LVT_MASKED);
+	}
+
+	/* Mask performance counter overflow interrupts. */
+	if (((lapic_read(LAPIC_VER) >> 16) & 0xff) >= 4)
+		lapic_write(LAPIC_PCINT, LAPIC_LVT_MASKED);
+
+	/* Clear error status. */
+	lapic_write(LAPIC_ERROR, LAPIC_LVT_MASKED);
+	lapic_write(LAPIC_ESR, 0);
+	lapic_write(LAPIC_ESR, 0);
+
+	/* Ack any outstanding interrupt and accept all. */
+	lapic_write(LAPIC_EOI, 0);
+	lapic_write(LAPIC_TPR, 0);
+}
+
+/**
+ * @brief Returns the local APIC ID of the calling processor.
+ */
+PUBLIC unsigned lapic_id(void)
+{
+	if (!lapic_present)
+		return (0);
+
+	return (lapic_read(LAPIC_ID) >> 24);
+}
+
+/**
+ * @brief Acknowledges a local APIC interrupt.
+ */
+PUBLIC void lapic_eoi(void)
+{
+	if (lapic_present)
+		lapic_write(LAPIC_EOI, 0);
+}
+
+/**
+ * @brief Sends an interrupt command to a processor.
+ *
+ * @param apicid Local APIC ID of the target processor.
+ * @param cmd    Command.
+ */
+PRIVATE void lapic_ipi(unsigned apicid, uint32_t cmd)
+{
+	lapic_write(LAPIC_ICRHI, apicid << 24);
+	lapic_write(LAPIC_ICRLO, cmd);
+
+	/* Wait for delivery. */
+	while (lapic_read(LAPIC_ICRLO) & LAPIC_ICR_DELIVS)
+		noop();
+}
+
+/**
+ * @brief Sends a fixed interrupt to a processor.
+ *
+ * @param apicid Local APIC ID of the target processor.
+ * @param vector Interrupt vector.
+ */
+PUBLIC void lapic_sendipi(unsigned apicid, unsigned vector)
+{
+	if (lapic_present)
+		lapic_ipi(apicid, LAPIC_ICR_ASSERT | vector);
+}
+
+/**
+ * @brief Starts an application processor.
+ *
+ * @details Runs the universal start-up algorithm of the MultiProcessor
+ * Specification: an INIT IPI followed by two STARTUP IPIs.
+ *
+ * @param apicid Local APIC ID of the target processor.
+ * @param addr   Physical address where the processor should start.
+ */
+PUBLIC void lapic_startap(unsigned apicid, uint32_t addr)
+{
+	uint16_t *wrv;
+
+	/* Warm reset vector, in case the BIOS needs it. */
+	outputb(CMOS_ADDR, 0x0f);
+	outputb(CMOS_DATA, 0x0a);
+	wrv = (uint16_t *)(KBASE_VIRT + 0x467);
+	wrv[0] = 0;
+	wrv[1] = addr >> 4;
+
+	/* INIT. */
+	lapic_ipi(apicid, LAPIC_ICR_INIT | LAPIC_ICR_LEVEL | LAPIC_ICR_ASSERT);
+	udelay(200);
+	lapic_ipi(apicid, LAPIC_ICR_INIT | LAPIC_ICR_LEVEL);
+	udelay(10000);
+
+	/* STARTUP, twice. */
+	for (int i = 0; i < 2; i++)
+	{
+		lapic_ipi(apicid, LAPIC_ICR_STARTUP | (addr >> 12));
+		udelay(200);
+	}
+}
+
+/**
+ * @brief Calibrates the local APIC timer against the system clock.
+ *
+ * @note Clock interrupts must be enabled.
+ */
+PUBLIC void lapic_timer_calibrate(void)
+{
+	unsigned t;
+	volatile unsigned *now = &ticks;
+
+	if (!lapic_present)
+		return;
+
+	lapic_write(LAPIC_TDCR, LAPIC_TDCR_16);
+	lapic_write(LAPIC_TIMER, LAPIC_LVT_MASKED | APIC_VEC_TIMER);
+
+	/* Align to a clock tick. */
+	t = *now;
+	while (*now == t)
+		noop();
+
+	lapic_write(LAPIC_TICR, 0xffffffff);
+
+	t += 1 + CALIBRATE_TICKS;
+	while (*now < t)
+		noop();
+
+	lapic_ticks = (0xffffffff - lapic_read(LAPIC_TCCR))/CALIBRATE_TICKS;
+	lapic_write(LAPIC_TICR, 0);
+
+	kprintf("apic: %d timer counts per tick", lapic_ticks);
+}
+
+/**
+ * @brief Starts the local APIC timer of the calling processor.
+ *
+ * @details The timer fires at the same frequency as the system clock.
+ */
+PUBLIC void lapic_timer_start(void)
+{
+	if ((!lapic_present) || (lapic_ticks == 0))
+		return;
+
+	lapic_write(LAPIC_TDCR, LAPIC_TDCR_16);
+	lapic_write(LAPIC_TIMER, LAPIC_TIMER_PERIODIC | APIC_VEC_TIMER);
+	lapic_write(LAPIC_TICR, lapic_ticks);
+}
+
+/**
+ * @brief Stops the local APIC timer of the calling processor.
+ *
+ * @returns Non-zero if the timer was stopped, and zero if it was not
+ * running in the first place.
+ */
+PUBLIC int lapic_timer_stop(void)
+{
+	if ((!lapic_present) || (lapic_ticks == 0))
+		return (0);
+
+	lapic_write(LAPIC_TIMER, LAPIC_LVT_MASKED | APIC_VEC_TIMER);
+	lapic_write(LAPIC_TICR, 0);
+
+	return (1);
+}
+
+/**
+ * @brief Handles a local APIC timer interrupt.
+ */
+PUBLIC void do_lapic_timer(void)
+{
+	lapic_eoi();
+	clock_account();
+}
+
+/**
+ * @brief Handles a reschedule interrupt.
+ *
+ * @details Nothing to do other than acknowledging it: the interrupted
+ * processor was idle, and it will look at its ready queue on return.
+ */
+PUBLIC void do_lapic_resched(void)
+{
+	lapic_eoi();
+}
+
+/*============================================================================*
+ *                                 I/O APIC                                   *
+ *============================================================================*/
+
+/**
+ * @brief Writes to an I/O APIC register.
+ *
+ * @param reg   Target register.
+ * @param value Value to write.
+ */
+PRIVATE void ioapic_write(unsigned reg, uint32_t value)
+{
+	ioapic[IOAPIC_REGSEL >> 2] = reg;
+	ioapic[IOAPIC_WIN >> 2] = value;
+}
+
+/**
+ * @brief Reads an I/O APIC register.
+ *
+ * @param reg Target register.
+ *
+ * @returns The value of the register.
+ */
+PRIVATE uint32_t ioapic_read(unsigned reg)
+{
+	ioapic[IOAPIC_REGSEL >> 2] = reg;
+	return (ioapic[IOAPIC_WIN >> 2]);
+}
+
+/**
+ * @brief Initializes the I/O APIC.
+ *
+ * @details All redirection entries are masked, since legacy interrupts
+ * keep flowing through the 8259 PIC. Use ioapic_route() to redirect an
+ * interrupt line to a given processor.
+ *
+ * @param addr   Physical address of the I/O APIC.
+ * @param apicid I/O APIC ID.
+ */
+PUBLIC void ioapic_init(uint32_t addr, unsigned apicid)
+{
+	unsigned maxintr;
+
+	/* Not in the APIC window. */
+	if (addr != IOAPIC_PHYS)
+	{
+		kprintf("apic: unsupported i/o apic at %x", addr);
+		return;
+	}
+
+	ioapic = (volatile uint32_t *)addr;
+
+	if (((ioapic_read(IOAPIC_REG_ID) >> 24) & 0xf) != apicid)
+		kprintf("apic: i/o apic id mismatch");
+
+	maxintr = (ioapic_read(IOAPIC_REG_VER) >> 16) & 0xff;
+
+	for (unsigned i = 0; i <= maxintr; i++)
+		ioapic_mask(i);
+
+	kprintf("apic: i/o apic with %d lines", maxintr + 1);
+}
+
+/**
+ * @brief Routes an interrupt line to a processor.
+ *
+ * @param irq    Interrupt line.
+ * @param vector Interrupt vector.
+ * @param apicid Local APIC ID of the target processor.
+ */
+PUBLIC void ioapic_route(unsigned irq, unsigned vector, unsigned apicid)
+{
+	if (ioapic == NULL)
+		return;
+
+	ioapic_write(IOAPIC_REG_TBL + 2*irq, vector);
+	ioapic_write(IOAPIC_REG_TBL + 2*irq + 1, apicid << 24);
+}
+
+/**
+ * @brief Masks an interrupt line.
+ *
+ * @param irq Interrupt line.
+ */
+PUBLIC void ioapic_mask(unsigned irq)
+{
+	if (ioapic == NULL)
+		return;
+
+	ioapic_write(IOAPIC_REG_TBL + 2*irq, IOAPIC_MASKED | (32 + irq));
+	ioapic_write(IOAPIC_REG_TBL + 2*irq + 1, 0);
+}
@@ -17,13 +17,26 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <i386/apic.h>
+#include <nanvix/clock.h>
 #include <nanvix/const.h>
 #include <nanvix/hal.h>
 #include <nanvix/klib.h>
 #include <nanvix/pm.h>
+#include <nanvix/smp.h>
+#include <stdint.h>
 
 /**
- * @brief Clock interrupts since system initialization.
+ * @brief Time stamp counter calibration period (in PIT cycles), about
+ * 50 ms.
+ */
+#define CALIBRATE_PERIOD (PIT_FREQUENCY/20)
+
+/* Forward definitions. */
+EXTERN void cpuid(unsigned *, unsigned *, unsigned *, unsigned *);
+
+/**
+ * @brief Clock ticks since system initialization.
  */
 PUBLIC unsigned ticks = 0;
 
@@ -32,12 +45,37 @@ PUBLIC unsigned ticks = 0;
  */
 PUBLIC unsigned startup_time = 0;
 
+/**
+ * @brief PIT divisor for a clock tick.
+ */
+PRIVATE uint16_t freq_divisor = 0;
+
+/**
+ * @brief Time stamp counter cycles per clock tick, zero if there is
+ * no time stamp counter.
+ */
+PRIVATE unsigned tsc_per_tick = 0;
+
+/**
+ * @brief Time stamp counter at the last clock tick.
+ */
+PRIVATE uint64_t tsc_last = 0;
+
+/**
+ * @brief Time stamp counter when processors stopped their clock.
+ */
+PRIVATE uint64_t tsc_stopped[CPU_MAX];
+
+/**
+ * @brief Is the PIT stopped?
+ */
+PRIVATE int pit_stopped = 0;
+
 /*
- * Handles a timer interrupt.
+ * Charges a clock tick to the running process.
  */
-PRIVATE void do_clock()
+PUBLIC void clock_account(void)
 {
-	ticks++;
 	curr_proc->counter--;
 	
 	if (KERNEL_WAS_RUNNING(curr_proc))
@@ -53,23 +91,225 @@ PRIVATE void do_clock()
 		yield();
 }
 
+/*
+ * Programs the PIT to interrupt periodically, once every clock tick.
+ */
+PRIVATE void pit_periodic(void)
+{
+	/* Send control byte: adjust frequency divisor. */
+	outputb(PIT_CTRL, 0x36);
+	
+	/* Send data byte: divisor_low and divisor_high. */
+	outputb(PIT_DATA, (byte_t)(freq_divisor & 0xff));
+	outputb(PIT_DATA, (byte_t)((freq_divisor >> 8)));
+}
+
+/*
+ * Programs the PIT to interrupt once, after some PIT cycles.
+ */
+PRIVATE void pit_oneshot(unsigned count)
+{
+	outputb(PIT_CTRL, 0x30);
+	outputb(PIT_DATA, (byte_t)(count & 0xff));
+	outputb(PIT_DATA, (byte_t)((count >> 8)));
+}
+
+/*
+ * Brings clock ticks up to date with the time stamp counter, so that
+ * ticks skipped while the PIT was stopped are not lost.
+ */
+PRIVATE void clock_catchup(void)
+{
+	uint64_t now = timepage_cycles();
+	
+	while (now - tsc_last >= tsc_per_tick)
+	{
+		tsc_last += tsc_per_tick;
+		ticks++;
+	}
+}
+
+/*
+ * Handles a timer interrupt.
+ *
+ * When there is a time stamp counter, clock ticks follow it rather than
+ * interrupts.
+ */
+PRIVATE void do_clock()
+{
+	if (tsc_per_tick == 0)
+		ticks++;
+	else
+		clock_catchup();
+	
+	/* Woken up from tickless idle. */
+	if (pit_stopped)
+	{
+		pit_stopped = 0;
+		pit_periodic();
+	}
+	
+	timepage_update();
+	clock_account();
+}
+
+/*
+ * Divides a 64-bit integer, without help from libgcc.
+ */
+PRIVATE uint64_t udiv64(uint64_t n, uint64_t d)
+{
+	uint64_t q = 0; /* Quotient.  */
+	uint64_t r = 0; /* Remainder. */
+	
+	for (int i = 63; i >= 0; i--)
+	{
+		r = (r << 1) | ((n >> i) & 1);
+		if (r >= d)
+		{
+			r -= d;
+			q |= (uint64_t)1 << i;
+		}
+	}
+	
+	return (q);
+}
+
+/*
+ * Calibrates the time stamp counter against the PIT, and sets up the
+ * time page accordingly.
+ */
+PRIVATE void tsc_calibrate(unsigned freq)
+{
+	unsigned eax, ebx, ecx, edx; /* CPUID output.              */
+	uint64_t cycles;             /* Cycles in a period.        */
+	uint64_t nsecs;              /* Nanoseconds in a period.   */
+	uint64_t mult;               /* Cycles to nanoseconds.     */
+	unsigned shift;              /* Cycles to nanoseconds.     */
+	byte_t gate;                 /* Saved gate of channel 2.   */
+	
+	/* No time stamp counter. */
+	eax = 1;
+	cpuid(&eax, &ebx, &ecx, &edx);
+	if (!(edx & (1 << 4)))
+	{
+		kprintf("dev: no time stamp counter");
+		timepage_init(0, 0);
+		return;
+	}
+	
+	/*
+	 * Count down a period on channel 2 in one-shot mode, with
+	 * the speaker off, and poll for its output to go high.
+	 */
+	gate = inputb(PIT_GATE);
+	outputb(PIT_GATE, (gate & ~0x02) | 0x01);
+	outputb(PIT_CTRL, 0xb0);
+	outputb(PIT_CH2, (byte_t)(CALIBRATE_PERIOD & 0xff));
+	outputb(PIT_CH2, (byte_t)(CALIBRATE_PERIOD >> 8));
+	cycles = timepage_cycles();
+	while (!(inputb(PIT_GATE) & 0x20))
+		noop();
+	cycles = timepage_cycles() - cycles;
+	outputb(PIT_GATE, gate);
+	
+	if (cycles == 0)
+	{
+		timepage_init(0, 0);
+		return;
+	}
+	
+	/* Largest shift that keeps the scale in 32 bits. */
+	nsecs = ((uint64_t)CALIBRATE_PERIOD*NSEC_PER_SEC)/PIT_FREQUENCY;
+	for (shift = 32; shift > 0; shift--)
+	{
+		if ((mult = udiv64(nsecs << shift, cycles)) <= 0xffffffff)
+			break;
+	}
+	
+	kprintf("dev: time stamp counter at %d kHz",
+		(unsigned) udiv64(cycles*20, 1000));
+	
+	tsc_per_tick = (unsigned) udiv64(cycles*PIT_FREQUENCY, CALIBRATE_PERIOD*freq);
+	timepage_init((unsigned) mult, shift);
+}
+
+/*
+ * Stops the clock of the calling processor, when it goes idle.
+ */
+PUBLIC int clock_stop(unsigned nticks)
+{
+	struct cpu *cpu = cpu_self();
+	
+	/* Skipped ticks could not be accounted. */
+	if (tsc_per_tick == 0)
+		return (0);
+	
+	/*
+	 * The bootstrap processor keeps time, so it has to wake up for
+	 * the next alarm, or once the PIT counter runs out.
+	 */
+	if (cpu == &cpus[0])
+	{
+		if ((nticks == 0) || (nticks > 0xffffu/freq_divisor))
+			nticks = 0xffffu/freq_divisor;
+		
+		/* Not worth it. */
+		if (nticks < 2)
+			return (0);
+		
+		pit_oneshot(nticks*freq_divisor);
+		pit_stopped = 1;
+	}
+	
+	/* Other processors are kicked when they have work to do. */
+	else if (!lapic_timer_stop())
+		return (0);
+	
+	tsc_stopped[cpu->id] = timepage_cycles();
+	
+	return (1);
+}
+
+/*
+ * Restarts the clock of the calling processor, when it leaves idle.
+ */
+PUBLIC void clock_resume(void)
+{
+	unsigned nticks;
+	struct cpu *cpu = cpu_self();
+	
+	if (cpu == &cpus[0])
+	{
+		if (pit_stopped)
+		{
+			pit_stopped = 0;
+			pit_periodic();
+			clock_catchup();
+			timepage_update();
+		}
+	}
+	else
+		lapic_timer_start();
+	
+	/* Charge skipped ticks to the idle process. */
+	nticks = (unsigned)
+		udiv64(timepage_cycles() - tsc_stopped[cpu->id], tsc_per_tick);
+	curr_proc->ktime += nticks;
+	cpu->nskipped += nticks;
+}
+
 /*
  * Initializes the system's clock.
  */
 PUBLIC void clock_init(unsigned freq)
 {
-	uint16_t freq_divisor;
-	
 	kprintf("dev: initializing clock device driver");
 	
 	set_hwint(INT_CLOCK, &do_clock);
 	
 	freq_divisor = PIT_FREQUENCY/freq;
+	pit_periodic();
+	tsc_last = timepage_cycles();
 	
-	/* Send control byte: adjust frequency divisor. */
-	outputb(PIT_CTRL, 0x36);
-	
-	/* Send data byte: divisor_low and divisor_high. */
-	outputb(PIT_DATA, (byte_t)(freq_divisor & 0xff));
-	outputb(PIT_DATA, (byte_t)((freq_divisor >> 8)));
+	tsc_calibrate(freq);
 }
@@ -54,6 +54,39 @@ PRIVATE void dumpregs(struct intstack *regs)
 	kprintf("  [eip: %x] [eflags: %x]", regs->eip, regs->eflags);
 }
 
+/*
+ * Exception table entry.
+ */
+struct extable
+{
+	addr_t insn;  /* Faulting instruction. */
+	addr_t fixup; /* Where to resume.      */
+};
+
+/* Exception table. */
+EXTERN const struct extable __ex_table_start[];
+EXTERN const struct extable __ex_table_end[];
+
+/*
+ * Resumes a faulting kernel instruction at its fixup code, if any.
+ */
+PRIVATE int fixup_exception(struct intstack *regs)
+{
+	const struct extable *e;
+	
+	for (e = __ex_table_start; e < __ex_table_end; e++)
+	{
+		/* Found. */
+		if (e->insn == regs->eip)
+		{
+			regs->eip = e->fixup;
+			return (1);
+		}
+	}
+	
+	return (0);
+}
+
 /* Easy-to-handle exceptions. */
 EXCEPTION(divide,                      SIGFPE,  "divide error")
 EXCEPTION(breakpoint,                  SIGTRAP, "breakpoint exception")
@@ -110,6 +143,10 @@ PUBLIC void do_page_fault(addr_t addr, int err, int dummy0, int dummy1, struct i
 	
 	if (KERNEL_WAS_RUNNING(curr_proc))
 	{
+		/* Bad user address in a user access routine. */
+		if (fixup_exception(&s))
+			return;
+		
 		dumpregs(&s);
 		kpanic("kernel page fault %d at %x", err, addr);
 	}
@@ -30,6 +30,11 @@ extern void cpuid(unsigned *, unsigned *,
  */
 PUBLIC struct fpu fpu_temp __attribute__((aligned(16)));
 
+/**
+ * @brief Are SSE2 instructions available?
+ */
+PUBLIC int fpu_sse2 = 0;
+
 /*
  * @brief Initializes the FPU.
  */
@@ -63,6 +68,8 @@ PUBLIC void fpu_init(void)
 			:
 			: "eax"
 		);	
+		
+		fpu_sse2 = (edx & (1 << 26)) ? 1 : 0;
 	}
 }
 
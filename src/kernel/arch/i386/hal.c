@@ -72,6 +72,18 @@ PRIVATE const uint16_t int_masks[6] = {
 	0x0000  /* Level 5: all hardware interrupts enabled.  */
 };
 
+/**
+ * @brief Loads the interrupt mask of an execution level.
+ *
+ * @details Legacy interrupts are only delivered to the bootstrap
+ * processor, so other processors must not touch the PIC masks.
+ */
+PRIVATE inline void processor_mask(unsigned irqlvl)
+{
+	if (cpu_self()->id == 0)
+		pic_mask(int_masks[irqlvl]);
+}
+
 /**
  * @brief Raises processor execution level.
  * 
@@ -82,7 +94,7 @@ PUBLIC unsigned processor_raise(unsigned irq)
 	unsigned old_irqlvl;
 	
 	old_irqlvl = curr_proc->irqlvl;
-	pic_mask(int_masks[curr_proc->irqlvl = irq_lvl(irq)]);
+	processor_mask(curr_proc->irqlvl = irq_lvl(irq));
 	
 	return (old_irqlvl);
 }
@@ -94,7 +106,7 @@ PUBLIC unsigned processor_raise(unsigned irq)
  */
 PUBLIC void processor_drop(unsigned irqlvl)
 {
-	pic_mask(int_masks[curr_proc->irqlvl = irqlvl]);
+	processor_mask(curr_proc->irqlvl = irqlvl);
 }
 
 /**
@@ -104,5 +116,5 @@ PUBLIC void processor_drop(unsigned irqlvl)
  */
 PUBLIC void processor_reload(void)
 {
-	pic_mask(int_masks[curr_proc->irqlvl]);
+	processor_mask(curr_proc->irqlvl);
 }
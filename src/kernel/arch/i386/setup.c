@@ -18,91 +18,102 @@
  */
 
 #include <i386/i386.h>
+#include <i386/apic.h>
 #include <i386/int.h>
 #include <nanvix/config.h>
 #include <nanvix/const.h>
 #include <nanvix/hal.h>
 #include <nanvix/klib.h>
 #include <nanvix/mm.h>
+#include <nanvix/smp.h>
 
 /* Descriptor tables. */
-PRIVATE struct gdte gdt[GDT_SIZE]; /* Global descriptor table.    */
-PRIVATE struct idte idt[IDT_SIZE]; /* Interrupt descriptor table. */
+PRIVATE struct gdte gdt[CPU_MAX][GDT_SIZE]; /* Global descriptor tables.   */
+PRIVATE struct idte idt[IDT_SIZE];          /* Interrupt descriptor table. */
 
 /* Descriptor tables pointers. */
-PRIVATE struct gdtptr gdtptr; /* Global descriptor table pointer.    */
-PRIVATE struct idtptr idtptr; /* Interrupt descriptor table pointer. */
+PRIVATE struct gdtptr gdtptr[CPU_MAX]; /* Global descriptor table pointers.   */
+PRIVATE struct idtptr idtptr;          /* Interrupt descriptor table pointer. */
 
-/* Task state segment. */
-PUBLIC struct tss tss;
+/* Task state segments. */
+PUBLIC struct tss tsstab[CPU_MAX];
 
 /*
  * Sets a GDT entry.
  */
 PRIVATE void set_gdte
-(int n, unsigned base, unsigned limit, unsigned granularity, unsigned access)
+(int id, int n, unsigned base, unsigned limit, unsigned granularity, unsigned access)
 {
     /* Set segment base address. */
-    gdt[n].base_low = (base & 0xffffff);
-    gdt[n].base_high = (base >> 24) & 0xff;
+    gdt[id][n].base_low = (base & 0xffffff);
+    gdt[id][n].base_high = (base >> 24) & 0xff;
 	
     /* Set segment limit. */ 
-    gdt[n].limit_low = (limit & 0xffff);
-    gdt[n].limit_high = (limit >> 16) & 0xf;
+    gdt[id][n].limit_low = (limit & 0xffff);
+    gdt[id][n].limit_high = (limit >> 16) & 0xf;
     
     /* Set granularity and access. */
-    gdt[n].granularity = granularity;
-    gdt[n].access = access;
+    gdt[id][n].granularity = granularity;
+    gdt[id][n].access = access;
 }
 
 /*
- * Sets up TSS.
+ * Sets up the TSS of a processor.
  */
-PRIVATE void tss_setup()
+PRIVATE void tss_setup(int id)
 {
+	struct tss *tss = &tsstab[id];
+	
 	/* Size-error checking. */
 	CHKSIZE(sizeof(struct tss), TSS_SIZE);
 	
 	/* Blank TSS. */
-	kmemset(&tss, 0, TSS_SIZE);
+	kmemset(tss, 0, TSS_SIZE);
 	
 	/* Fill up TSS. */
-	tss.ss0 = KERNEL_DS;
-	tss.iomap = (TSS_SIZE - 1) << 16;
+	tss->ss0 = KERNEL_DS;
+	tss->iomap = (TSS_SIZE - 1) << 16;
 	
 	/* Flush TSS. */
 	tss_flush();
-	
-	kprintf("kernel: tss at %x", &tss);
 }
 
 /*
- * Sets up GDT.
+ * Sets up the GDT of a processor.
  */
-PRIVATE void gdt_setup(void)
+PRIVATE void gdt_setup(int id)
 {
+	struct tss *tss = &tsstab[id];
+	struct cpu *cpu = &cpus[id];
+	
 	/* Size-error checking. */
 	CHKSIZE(sizeof(struct gdte), GDTE_SIZE);
 	CHKSIZE(sizeof(struct gdtptr), GDTPTR_SIZE);
 
 	/* Blank GDT and GDT pointer. */
-	kmemset(gdt, 0, sizeof(gdt));
-	kmemset(&gdtptr, 0, GDTPTR_SIZE);
+	kmemset(gdt[id], 0, sizeof(gdt[id]));
+	kmemset(&gdtptr[id], 0, GDTPTR_SIZE);
 	
     /* Set GDT entries. */
-    set_gdte(GDT_NULL, 0, 0x00000, 0x0, 0x00);
-    set_gdte(GDT_CODE_DPL0, 0, 0xfffff, 0xc, 0x9a);
-    set_gdte(GDT_DATA_DPL0, 0, 0xfffff, 0xc, 0x92);
-    set_gdte(GDT_CODE_DPL3, 0, 0xfffff, 0xc, 0xfa);
-    set_gdte(GDT_DATA_DPL3, 0, 0xfffff, 0xc, 0xf2);
-	set_gdte(GDT_TSS, (unsigned) &tss, (unsigned)&tss + TSS_SIZE, 0x0, 0xe9);
+    set_gdte(id, GDT_NULL, 0, 0x00000, 0x0, 0x00);
+    set_gdte(id, GDT_CODE_DPL0, 0, 0xfffff, 0xc, 0x9a);
+    set_gdte(id, GDT_DATA_DPL0, 0, 0xfffff, 0xc, 0x92);
+    set_gdte(id, GDT_CODE_DPL3, 0, 0xfffff, 0xc, 0xfa);
+    set_gdte(id, GDT_DATA_DPL3, 0, 0xfffff, 0xc, 0xf2);
+	set_gdte(id, GDT_TSS, (unsigned)tss, (unsigned)tss + TSS_SIZE, 0x0, 0xe9);
+	set_gdte(id, GDT_PERCPU, (unsigned)cpu, sizeof(struct cpu) - 1, 0x4, 0x92);
     
     /* Set GDT pointer. */
-    gdtptr.size = sizeof(gdt) - 1;
-    gdtptr.ptr = (unsigned) gdt;
+    gdtptr[id].size = sizeof(gdt[id]) - 1;
+    gdtptr[id].ptr = (unsigned) gdt[id];
     
     /* Flush GDT. */
-    gdt_flush(&gdtptr);
+    gdt_flush(&gdtptr[id]);
+    
+    /* Load per-CPU segment. */
+    cpu->self = cpu;
+    cpu->tss = tss;
+    __asm__ __volatile__ ("movw %w0, %%gs" : : "r" (KERNEL_GS));
 }
 
 /*
@@ -179,6 +190,11 @@ PRIVATE void idt_setup(void)
     set_idte(45, (unsigned)hwint13, KERNEL_CS, 0x8, IDT_INT32);
     set_idte(46, (unsigned)hwint14, KERNEL_CS, 0x8, IDT_INT32);
     set_idte(47, (unsigned)hwint15, KERNEL_CS, 0x8, IDT_INT32);
+    
+    /* Set local APIC interrupts. */
+    set_idte(APIC_VEC_TIMER, (unsigned)lapic_timer, KERNEL_CS, 0x8, IDT_INT32);
+    set_idte(APIC_VEC_RESCHED, (unsigned)lapic_resched, KERNEL_CS, 0x8, IDT_INT32);
+    set_idte(APIC_VEC_SPURIOUS, (unsigned)lapic_spurious, KERNEL_CS, 0x8, IDT_INT32);
      
     /* Set system call interrupt. */
     set_idte(128, (unsigned)syscall, KERNEL_CS, 0xe, IDT_INT32);
@@ -197,9 +213,20 @@ PRIVATE void idt_setup(void)
 PUBLIC void setup(void)
 {
 	/* Setup descriptor tables. */
-	gdt_setup();
+	gdt_setup(0);
     kprintf("boot: loading global descriptor table");
-	tss_setup();
+	tss_setup(0);
+	kprintf("kernel: tss at %x", &tsstab[0]);
     kprintf("boot: loading interrupt descriptor table");
 	idt_setup();
 }
+
+/*
+ * Sets up an application processor.
+ */
+PUBLIC void setup_ap(int id)
+{
+	gdt_setup(id);
+	tss_setup(id);
+	idt_flush(&idtptr);
+}
@@ -0,0 +1,534 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <i386/apic.h>
+#include <nanvix/clock.h>
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/hal.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/smp.h>
+#include <stdint.h>
+
+/**
+ * @brief Number of clock ticks to wait for an application processor.
+ */
+#define AP_TIMEOUT CLOCK_FREQ
+
+/**
+ * @brief MP floating pointer structure signature.
+ */
+#define MP_SIGNATURE 0x5f504d5f /* "_MP_" */
+
+/**
+ * @brief MP configuration table signature.
+ */
+#define MPC_SIGNATURE 0x504d4350 /* "PCMP" */
+
+/**
+ * @name MP configuration table entry types
+ */
+/**@{*/
+#define MPC_PROCESSOR 0 /**< Processor.           */
+#define MPC_BUS       1 /**< Bus.                 */
+#define MPC_IOAPIC    2 /**< I/O APIC.            */
+#define MPC_IOINTR    3 /**< I/O interrupt.       */
+#define MPC_LINTR     4 /**< Local interrupt.     */
+/**@}*/
+
+/**
+ * @name Processor entry flags
+ */
+/**@{*/
+#define MPC_CPU_ENABLED 0x01 /**< Usable processor.       */
+#define MPC_CPU_BSP     0x02 /**< Bootstrap processor.    */
+/**@}*/
+
+/**
+ * @brief MP floating pointer structure.
+ */
+struct mp
+{
+	uint32_t signature; /**< "_MP_".                     */
+	uint32_t physaddr;  /**< Configuration table.        */
+	uint8_t length;     /**< Length (in 16-byte units).  */
+	uint8_t revision;   /**< Revision.                   */
+	uint8_t checksum;   /**< All bytes must add up to 0. */
+	uint8_t type;       /**< Default configuration type. */
+	uint8_t imcrp;      /**< IMCR present?               */
+	uint8_t reserved[3];
+} __attribute__((packed));
+
+/**
+ * @brief MP configuration table header.
+ */
+struct mpconf
+{
+	uint32_t signature; /**< "PCMP".                     */
+	uint16_t length;    /**< Total table length.         */
+	uint8_t version;    /**< Version.                    */
+	uint8_t checksum;   /**< All bytes must add up to 0. */
+	uint8_t product[20];/**< Product ID.                 */
+	uint32_t oemtable;  /**< OEM table pointer.          */
+	uint16_t oemlength; /**< OEM table length.           */
+	uint16_t entries;   /**< Number of entries.          */
+	uint32_t lapicaddr; /**< Local APIC address.         */
+	uint16_t xlength;   /**< Extended table length.      */
+	uint8_t xchecksum;  /**< Extended table checksum.    */
+	uint8_t reserved;
+} __attribute__((packed));
+
+/**
+ * @brief MP configuration table processor entry.
+ */
+struct mpproc
+{
+	uint8_t type;         /**< MPC_PROCESSOR.      */
+	uint8_t apicid;       /**< Local APIC ID.      */
+	uint8_t version;      /**< Local APIC version. */
+	uint8_t flags;        /**< Processor flags.    */
+	uint32_t signature;   /**< CPU signature.      */
+	uint32_t feature;     /**< Feature flags.      */
+	uint8_t reserved[8];
+} __attribute__((packed));
+
+/**
+ * @brief MP configuration table I/O APIC entry.
+ */
+struct mpioapic
+{
+	uint8_t type;     /**< MPC_IOAPIC.      */
+	uint8_t apicid;   /**< I/O APIC ID.     */
+	uint8_t version;  /**< I/O APIC version. */
+	uint8_t flags;    /**< I/O APIC flags.  */
+	uint32_t addr;    /**< I/O APIC address. */
+} __attribute__((packed));
+
+/**
+ * @brief Idle processes of application processors.
+ */
+PRIVATE struct process idles[CPU_MAX];
+
+/**
+ * @brief Logical ID of the processor that is being started.
+ */
+PRIVATE volatile unsigned ap_booting = 0;
+
+/* Trampoline symbols. */
+EXTERN char trampoline[];
+EXTERN char trampoline_end[];
+EXTERN uint32_t trampoline_cr3;
+EXTERN uint32_t trampoline_stack;
+
+/* Idle process page directory. */
+EXTERN struct pde idle_pgdir[];
+
+/* Initializes CPU resources. */
+EXTERN void cpu_init(void);
+
+/**
+ * @brief Computes the checksum of a memory area.
+ *
+ * @param addr Target memory area.
+ * @param len  Length of the memory area.
+ *
+ * @returns The byte sum of the memory area.
+ */
+PRIVATE uint8_t mp_sum(const void *addr, unsigned len)
+{
+	uint8_t sum = 0;
+	const uint8_t *p = addr;
+
+	for (unsigned i = 0; i < len; i++)
+		sum += p[i];
+
+	return (sum);
+}
+
+/**
+ * @brief Searches for the MP floating pointer structure.
+ *
+ * @param phys Physical address of the memory area.
+ * @param len  Length of the memory area.
+ *
+ * @returns The MP floating pointer structure, or NULL if it was not found.
+ */
+PRIVATE struct mp *mp_search(addr_t phys, unsigned len)
+{
+	struct mp *mp;
+	struct mp *end;
+
+	mp = (struct mp *)(KBASE_VIRT + phys);
+	end = (struct mp *)(KBASE_VIRT + phys + len);
+
+	for (/* noop */; mp < end; mp++)
+	{
+		if (mp->signature != MP_SIGNATURE)
+			continue;
+
+		if (mp_sum(mp, sizeof(struct mp)) == 0)
+			return (mp);
+	}
+
+	return (NULL);
+}
+
+/**
+ * @brief Locates the MP floating pointer structure.
+ *
+ * @details As stated in the MultiProcessor Specification, the structure
+ * lies either in the first kilobyte of the extended BIOS data area, in
+ * the last kilobyte of base memory, or in the BIOS ROM.
+ *
+ * @returns The MP floating pointer structure, or NULL if it was not found.
+ */
+PRIVATE struct mp *mp_find(void)
+{
+	addr_t addr;
+	struct mp *mp;
+	const uint8_t *bda = (const uint8_t *)(KBASE_VIRT + 0x400);
+
+	/* Extended BIOS data area. */
+	if ((addr = ((bda[0x0f] << 8) | bda[0x0e]) << 4))
+	{
+		if ((mp = mp_search(addr, 1024)) != NULL)
+			return (mp);
+	}
+
+	/* Last kilobyte of base memory. */
+	else
+	{
+		addr = ((bda[0x14] << 8) | bda[0x13])*1024;
+		if ((mp = mp_search(addr - 1024, 1024)) != NULL)
+			return (mp);
+	}
+
+	return (mp_search(0xf0000, 0x10000));
+}
+
+/**
+ * @brief Parses the MP configuration table.
+ */
+PRIVATE void mp_parse(void)
+{
+	struct mp *mp;
+	struct mpconf *conf;
+	uint8_t *p, *end;
+
+	/* Uniprocessor. */
+	if ((mp = mp_find()) == NULL)
+	{
+		kprintf("smp: no mp table found");
+		return;
+	}
+
+	/*
+	 * Default configurations are not supported, and
+	 * only the first kernel page table is reachable.
+	 */
+	if ((mp->physaddr == 0) || (mp->physaddr >= PGTAB_SIZE))
+	{
+		kprintf("smp: unsupported mp configuration");
+		return;
+	}
+
+	conf = (struct mpconf *)(KBASE_VIRT + mp->physaddr);
+
+	/* Bad configuration table. */
+	if (conf->signature != MPC_SIGNATURE)
+		return;
+	if ((conf->version != 1) && (conf->version != 4))
+		return;
+	if (mp_sum(conf, conf->length) != 0)
+		return;
+
+	/* Only the default local APIC address is mapped. */
+	if (conf->lapicaddr != LAPIC_PHYS)
+	{
+		kprintf("smp: unsupported local apic at %x", conf->lapicaddr);
+		return;
+	}
+
+	lapic_present = 1;
+	ncpus = 0;
+
+	p = (uint8_t *)(conf + 1);
+	end = (uint8_t *)conf + conf->length;
+	while (p < end)
+	{
+		switch (*p)
+		{
+			case MPC_PROCESSOR:
+			{
+				struct mpproc *proc = (struct mpproc *)p;
+
+				p += sizeof(struct mpproc);
+
+				if (!(proc->flags & MPC_CPU_ENABLED))
+					continue;
+
+				if (ncpus >= CPU_MAX)
+				{
+					kprintf("smp: too many processors");
+					continue;
+				}
+
+				/* The bootstrap processor is always the first one. */
+				if (proc->flags & MPC_CPU_BSP)
+				{
+					for (unsigned i = ncpus; i > 0; i--)
+						cpus[i].apicid = cpus[i - 1].apicid;
+					cpus[0].apicid = proc->apicid;
+				}
+				else
+					cpus[ncpus].apicid = proc->apicid;
+
+				ncpus++;
+			} break;
+
+			case MPC_IOAPIC:
+			{
+				struct mpioapic *ioapic = (struct mpioapic *)p;
+
+				p += sizeof(struct mpioapic);
+
+				ioapic_init(ioapic->addr, ioapic->apicid);
+			} break;
+
+			case MPC_BUS:
+			case MPC_IOINTR:
+			case MPC_LINTR:
+				p += 8;
+				break;
+
+			/* Unknown entry. */
+			default:
+				kprintf("smp: unknown mp entry %d", *p);
+				p = end;
+				break;
+		}
+	}
+
+	/* Broken table. */
+	if (ncpus == 0)
+	{
+		lapic_present = 0;
+		ncpus = 1;
+	}
+}
+
+/**
+ * @brief Initializes multiprocessor support.
+ *
+ * @details Discovers the available processors and sets up the interrupt
+ * controllers of the bootstrap processor. Application processors are
+ * started later on, by smp_boot().
+ */
+PUBLIC void smp_init(void)
+{
+	mp_parse();
+
+	for (unsigned i = 0; i < ncpus; i++)
+		cpus[i].id = i;
+	cpus[0].online = 1;
+
+	lapic_init(1);
+
+	kprintf("smp: %d processor(s) found", ncpus);
+}
+
+/**
+ * @brief Handcrafts the idle process of an application processor.
+ *
+ * @param cpu Target processor.
+ *
+ * @returns Zero upon successful completion, and non-zero otherwise.
+ */
+PRIVATE int smp_mkidle(struct cpu *cpu)
+{
+	struct process *idle;
+
+	idle = &idles[cpu->id];
+
+	/* Get kernel stack. */
+	if ((cpu->kstack = getkpg(0)) == NULL)
+		return (-1);
+
+	kmemcpy(idle, IDLE, sizeof(struct process));
+	idle->kstack = cpu->kstack;
+	idle->intlvl = 1;
+	idle->flags = 0;
+	idle->received = 0;
+	idle->irqlvl = INT_LVL_5;
+	idle->pmcs.enable_counters = 0;
+	idle->state = PROC_RUNNING;
+	idle->counter = PROC_QUANTUM;
+	idle->priority = PRIO_USER;
+	idle->next = NULL;
+	idle->chain = NULL;
+	idle->rqnext = NULL;
+	idle->cpu = cpu->id;
+	idle->affinity = 1 << cpu->id;
+
+	cpu->idle = idle;
+
+	return (0);
+}
+
+/**
+ * @brief Starts application processors.
+ *
+ * @note Clock interrupts must be enabled.
+ */
+PUBLIC void smp_boot(void)
+{
+	unsigned now;
+	volatile unsigned *t = &ticks;
+
+	if (ncpus == 1)
+		return;
+
+	lapic_timer_calibrate();
+
+	/* Copy trampoline to low memory. */
+	kmemcpy((void *)(KBASE_VIRT + TRAMPOLINE_PHYS),
+		trampoline,
+		trampoline_end - trampoline
+	);
+
+	for (unsigned i = 1; i < ncpus; i++)
+	{
+		struct cpu *cpu = &cpus[i];
+
+		if (smp_mkidle(cpu))
+		{
+			kprintf("smp: cannot start processor %d", i);
+			break;
+		}
+
+		/* Patch trampoline. */
+		*(uint32_t *)(KBASE_VIRT + TRAMPOLINE_PHYS
+			+ ((char *)&trampoline_cr3 - trampoline)) = (uint32_t)idle_pgdir;
+		*(uint32_t *)(KBASE_VIRT + TRAMPOLINE_PHYS
+			+ ((char *)&trampoline_stack - trampoline)) =
+				(uint32_t)cpu->kstack + KSTACK_SIZE - DWORD_SIZE;
+
+		ap_booting = i;
+		lapic_startap(cpu->apicid, TRAMPOLINE_PHYS);
+
+		/* Wait for processor to come up. */
+		now = *t;
+		while ((!cpu->online) && (*t - now < AP_TIMEOUT))
+			noop();
+
+		if (!cpu->online)
+		{
+			kprintf("smp: processor %d did not start", i);
+			putkpg(cpu->kstack);
+			break;
+		}
+	}
+
+	/* Only count running processors. */
+	for (ncpus = 1; (ncpus < CPU_MAX) && (cpus[ncpus].online); ncpus++)
+		/* noop */;
+
+	kprintf("smp: %d processor(s) online", ncpus);
+}
+
+/**
+ * @brief Application processor entry point.
+ */
+PUBLIC void ap_main(void)
+{
+	struct cpu *cpu;
+
+	setup_ap(ap_booting);
+
+	cpu = cpu_self();
+	cpu->curr = cpu->idle;
+
+	cpu_init();
+	lapic_init(0);
+
+	cpu->online = 1;
+
+	kernel_lock();
+	lapic_timer_start();
+
+	/* Idle process. */
+	while (1)
+	{
+		cpu_idle();
+		yield();
+	}
+}
+
+/**
+ * @brief Kicks a processor out of idle.
+ *
+ * @details Sends a reschedule interrupt to the processor pointed to by
+ * @p cpu if it is idle, so that it looks at its ready queue again.
+ *
+ * @param cpu Target processor.
+ */
+PUBLIC void cpu_kick(struct cpu *cpu)
+{
+	if (cpu == cpu_self())
+		return;
+
+	if ((!cpu->online) || (cpu->curr != cpu->idle))
+		return;
+
+	lapic_sendipi(cpu->apicid, APIC_VEC_RESCHED);
+}
+
+/**
+ * @brief Idles the calling processor.
+ *
+ * @details Releases the kernel lock and halts the calling processor
+ * until an interrupt comes in. The kernel lock is held again when this
+ * function returns. The clock is stopped meanwhile, if nothing needs
+ * it, so that idle processors are not woken up on every tick.
+ */
+PUBLIC void cpu_idle(void)
+{
+	int tickless;    /* Clock stopped?  */
+	unsigned nticks; /* Next alarm.     */
+
+	disable_interrupts();
+
+	tickless = sched_idle(&nticks) && clock_stop(nticks);
+
+	curr_proc->intlvl = 0;
+	kernel_unlock();
+
+	idle_halt();
+	disable_interrupts();
+
+	kernel_lock();
+	curr_proc->intlvl = 1;
+
+	if (tickless)
+		clock_resume();
+
+	enable_interrupts();
+}
@@ -18,6 +18,7 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <nanvix/clock.h>
 #include <nanvix/const.h>
 #include <nanvix/hal.h>
 #include <nanvix/klib.h>
@@ -57,6 +58,7 @@ PRIVATE void clock_event()
 PRIVATE void do_clock()
 {
 	ticks++;
+	timepage_update();
 	
 	if (KERNEL_WAS_RUNNING(curr_proc))
 	{
@@ -73,6 +75,24 @@ PRIVATE void do_clock()
 		yield();
 }
 
+/*
+ * Stops the clock of the calling processor. The tick timer is left
+ * running, so this always fails.
+ */
+PUBLIC int clock_stop(unsigned nticks)
+{
+	((void) nticks);
+	
+	return (0);
+}
+
+/*
+ * Restarts the clock of the calling processor.
+ */
+PUBLIC void clock_resume(void)
+{
+}
+
 /*
  * Initializes the system's clock.
  */
@@ -94,6 +114,9 @@ PUBLIC void clock_init(unsigned freq)
 	mtspr(SPR_TTMR, SPR_TTMR_RT | SPR_TTMR_IE | rate);
 	mtspr(SPR_TTCR, 0);
 
+	/* No cycle counter: the time page advances on clock interrupts. */
+	timepage_init(0, 0);
+
 	/* Setup the clock event. */
 	clock_event();
 
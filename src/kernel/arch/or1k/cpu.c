@@ -19,6 +19,8 @@
 
 #include <nanvix/const.h>
 #include <nanvix/hal.h>
+#include <nanvix/smp.h>
+#include <nanvix/spinlock.h>
 
 /*
  * @brief Initializes the CPU resources.
@@ -27,3 +29,80 @@ PUBLIC void cpu_init(void)
 {
 	
 }
+
+/*
+ * @brief Initializes multiprocessor support.
+ */
+PUBLIC void smp_init(void)
+{
+
+}
+
+/*
+ * @brief Starts other processors.
+ */
+PUBLIC void smp_boot(void)
+{
+
+}
+
+/*
+ * @brief Idles the processor.
+ */
+PUBLIC void cpu_idle(void)
+{
+	halt();
+}
+
+/*
+ * @brief Kicks a processor out of idle.
+ */
+PUBLIC void cpu_kick(struct cpu *cpu)
+{
+	((void) cpu);
+}
+
+/*
+ * @brief Acquires the kernel lock.
+ */
+PUBLIC void kernel_lock(void)
+{
+
+}
+
+/*
+ * @brief Releases the kernel lock.
+ */
+PUBLIC void kernel_unlock(void)
+{
+
+}
+
+/*
+ * @brief Disables interrupts, and tells if they were enabled.
+ */
+PUBLIC unsigned irq_save(void)
+{
+	unsigned flags;
+	
+	flags = mfspr(SPR_SR) & SPR_SR_IEE;
+	disable_interrupts();
+	
+	return (flags);
+}
+
+/*
+ * @brief Sets a lock word, and returns its previous value.
+ * 
+ * @details There is a single processor, and interrupts are
+ * disabled by the caller, so a plain swap will do.
+ */
+PUBLIC unsigned test_and_set(volatile unsigned *word)
+{
+	unsigned old;
+	
+	old = *word;
+	*word = 1;
+	
+	return (old);
+}
@@ -35,6 +35,11 @@ PUBLIC void (*hwint_handlers[])(void) = {
 	&default_hwint, &default_hwint,	&default_hwint, &default_hwint
 };
 
+/**
+ * @brief Number of hardware interrupts that were dispatched, per line.
+ */
+PUBLIC unsigned hwint_count[NR_HWINT] = { 0, };
+
 /**
  * @brief Default hardware interrupt handler.
  */
@@ -101,6 +106,7 @@ PUBLIC void do_hwint(unsigned irq)
 	}
 
 	old_irqlvl = processor_raise(irq);
+	hwint_count[irq]++;
 
 	if (irq != INT_COM1)
 		enable_interrupts();
@@ -0,0 +1,117 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/hal.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <errno.h>
+
+/*
+ * There is no exception table on this architecture, so user
+ * pointers are validated against process regions before they
+ * are dereferenced.
+ */
+
+/**
+ * @brief Asserts if a memory area may be accessed.
+ *
+ * @param addr Start address.
+ * @param n    Size of the memory area.
+ *
+ * @returns Non-zero if the memory area lies in kernel space or
+ * within a single process region, and zero otherwise.
+ */
+PRIVATE int uaccess_ok(const void *addr, size_t n)
+{
+	struct pregion *preg;
+
+	if (IN_KERNEL(addr))
+		return (1);
+
+	if ((preg = findreg(curr_proc, ADDR(addr))) == NULL)
+		return (0);
+
+	return (withinreg(preg, ADDR(addr) + n - 1));
+}
+
+/**
+ * @brief Copies memory from/to user address space.
+ *
+ * @param to   Target memory area.
+ * @param from Source memory area.
+ * @param n    Number of bytes to copy.
+ *
+ * @returns Zero upon success, and -EFAULT upon failure.
+ */
+PUBLIC int ucopy(void *to, const void *from, size_t n)
+{
+	if (n == 0)
+		return (0);
+
+	if (!uaccess_ok(to, n) || !uaccess_ok(from, n))
+		return (-EFAULT);
+
+	kmemcpy(to, from, n);
+
+	return (0);
+}
+
+/**
+ * @brief Copies a string from user address space.
+ *
+ * @param to   Target string.
+ * @param from Source string.
+ * @param n    Maximum number of characters to copy.
+ *
+ * @returns The length of the string upon success, @p n if no null
+ * character was found within @p n characters, and -EFAULT if the
+ * string runs off accessible memory.
+ */
+PUBLIC ssize_t ustrncpy(char *to, const char *from, size_t n)
+{
+	size_t max;           /* Accessible characters. */
+	addr_t end;           /* End of process region. */
+	struct pregion *preg; /* Process region.        */
+
+	max = n;
+
+	/* Stop at the end of the process region. */
+	if (!IN_KERNEL(from))
+	{
+		if ((preg = findreg(curr_proc, ADDR(from))) == NULL)
+			return (-EFAULT);
+
+		end = (preg->reg->flags & REGION_DOWNWARDS) ?
+			preg->start + 1 : preg->start + preg->reg->size;
+
+		if (max > end - ADDR(from))
+			max = end - ADDR(from);
+	}
+
+	for (size_t i = 0; i < max; i++)
+	{
+		if ((to[i] = from[i]) == '\0')
+			return (i);
+	}
+
+	return ((max < n) ? -EFAULT : (ssize_t)n);
+}
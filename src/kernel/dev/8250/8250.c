@@ -35,6 +35,7 @@
  * they apply.
  */
 
+#include <nanvix/hal.h>
 #include <nanvix/klib.h>
 #include <dev/8250.h>
 #include "../tty/tty.h"
@@ -103,14 +104,21 @@
 #define IIR_TO   0xCC /**< Timeout.                            */
 #define IIR_THRE 0xC2 /**< Transmitter Holding Register Empty. */
 #define IIT_MS   0xC0 /**< Modem Status.                       */
+#define IIR_NONE 0x01 /**< No interrupt pending.               */
 /**@}*/
 
+/**
+ * @brief Interrupt identification, without FIFO status bits.
+ */
+#define IIR_ID(x) ((x) & 0x0f)
+
 /**
  * FIFO Control Register bits.
  */
 /**@{*/
-#define FCR_CLRRECV 0x1  /**< Clear receiver FIFO.    */
-#define FCR_CLRTMIT 0x2  /**< Clear transmitter FIFO. */
+#define FCR_ENABLE  0x1  /**< Enable FIFOs.           */
+#define FCR_CLRRECV 0x2  /**< Clear receiver FIFO.    */
+#define FCR_CLRTMIT 0x4  /**< Clear transmitter FIFO. */
 /**@}*/
 
 /**
@@ -123,6 +131,15 @@
 #define FCR_TRIG_14 0xC0 /**< Trigger level 14 bytes. */
 /**@}*/
 
+/**
+ * Modem Control Register bits.
+ */
+/**@{*/
+#define MCR_DTR  0x1 /**< Data Terminal Ready.                 */
+#define MCR_RTS  0x2 /**< Request To Send.                     */
+#define MCR_OUT2 0x8 /**< Auxiliary output 2 (IRQ line gate). */
+/**@}*/
+
 /**
  * Line Control Reigster values and bits.
  */
@@ -144,7 +161,7 @@
  * Line Status Register.
  */
 /**@{*/
-#define LSR_DR  0x0  /**< Data Ready.                  */
+#define LSR_DR  0x1  /**< Data Ready.                  */
 #define LSR_OE  0x2  /**< Overrun Error.               */
 #define LSR_PE  0x4  /**< Parity Error.                */
 #define LSR_FE  0x8  /**< Framing Error.               */
@@ -153,6 +170,76 @@
 #define LSR_TEI 0x40 /**< Transmitter Empty Indicator. */
 /**@}*/
 
+/**
+ * @brief Transmitter FIFO size (in bytes).
+ */
+#define UART_FIFO_SIZE 16
+
+/**
+ * @brief Transmit ring size (in bytes).
+ *
+ * @details Large enough to hold a few full TTY output buffers, so that
+ * writers seldom have to wait for the line.
+ */
+#define UART_TXBUF_SIZE 4096
+
+/**
+ * @brief Transmit ring.
+ */
+PRIVATE struct
+{
+	unsigned head;                      /**< First character in the ring. */
+	unsigned tail;                      /**< Next free slot in the ring.  */
+	int busy;                           /**< Waiting for THRE interrupt?  */
+	unsigned char buf[UART_TXBUF_SIZE]; /**< Ring buffer.                 */
+} tx = { 0, 0, 0, { 0, } };
+
+/**
+ * @brief Asserts if the transmit ring is empty.
+ */
+#define TX_EMPTY() (tx.head == tx.tail)
+
+/**
+ * @brief Asserts if the transmit ring is full.
+ */
+#define TX_FULL() (((tx.tail + 1) & (UART_TXBUF_SIZE - 1)) == tx.head)
+
+/**
+ * @brief Interrupts that are enabled when the transmitter is idle.
+ */
+#define IER_IDLE (1 << IER_RDAI)
+
+/**
+ * @brief Moves a burst of characters from the transmit ring to the device.
+ *
+ * @details Fills the transmitter FIFO, which must be empty, and arms the
+ * Transmitter Holding Register Empty interrupt if there are characters
+ * left in the ring. Otherwise, the transmitter is marked as idle.
+ */
+PRIVATE void uart8250_tx(void)
+{
+	for (int i = 0; (i < UART_FIFO_SIZE) && (!TX_EMPTY()); i++)
+	{
+		OUTPUTB(THR, tx.buf[tx.head]);
+		tx.head = (tx.head + 1) & (UART_TXBUF_SIZE - 1);
+	}
+
+	/* Done. */
+	if (TX_EMPTY())
+	{
+		if (tx.busy)
+			OUTPUTB(IER, IER_IDLE);
+		tx.busy = 0;
+	}
+
+	/* Wait for the FIFO to drain. */
+	else if (!tx.busy)
+	{
+		OUTPUTB(IER, IER_IDLE | (1 << IER_TEI));
+		tx.busy = 1;
+	}
+}
+
 /**
  * Reads from serial port.
  * @param c Data to be written.
@@ -164,25 +251,70 @@ PUBLIC char uart8250_read(void)
 }
 
 /**
- * Writes into serial port.
+ * @brief Writes into serial port.
+ *
+ * @details Queues @p c in the transmit ring, which is drained in FIFO
+ * sized bursts by the interrupt handler. The line is polled only when
+ * the ring is full.
+ *
  * @param c Data to be written.
+ *
+ * @note Interrupts must be disabled.
  */
 PUBLIC void uart8250_write(char c)
 {
-	/* Wait until FIFO is empty. */
-	while ( !(INPUTB(LSR) & LSR_TFE) );
+	/* Make room in the ring. */
+	if (TX_FULL())
+	{
+		while (!(INPUTB(LSR) & LSR_TFE))
+			noop();
+		uart8250_tx();
+	}
+
+	tx.buf[tx.tail] = c;
+	tx.tail = (tx.tail + 1) & (UART_TXBUF_SIZE - 1);
 
-	/* Write character to device. */
-	OUTPUTB(THR, c);
+	/* Start transmission. */
+	if (!tx.busy)
+	{
+		if (INPUTB(LSR) & LSR_TFE)
+			uart8250_tx();
+		
+		/* Wait for the FIFO to drain. */
+		else
+		{
+			OUTPUTB(IER, IER_IDLE | (1 << IER_TEI));
+			tx.busy = 1;
+		}
+	}
 }
 
 /**
- * Serial interrupt handler.
+ * @brief Flushes the transmit ring.
+ *
+ * @details Polls the line until all queued characters are sent. This
+ * is meant for contexts where interrupts will not be served anymore,
+ * such as a kernel panic.
+ *
+ * @note Interrupts must be disabled.
  */
-PUBLIC void uart8250_handler(void)
+PUBLIC void uart8250_flush(void)
 {
-	char ascii_code = uart8250_read();
+	while (!TX_EMPTY())
+	{
+		while (!(INPUTB(LSR) & LSR_TFE))
+			noop();
+		uart8250_tx();
+	}
+}
 
+/**
+ * @brief Handles a received character.
+ *
+ * @param ascii_code Received character.
+ */
+PRIVATE void uart8250_rx(char ascii_code)
+{
 	switch(ascii_code)
 	{
 		case 13:
@@ -197,6 +329,43 @@ PUBLIC void uart8250_handler(void)
 	tty_int(ascii_code);
 }
 
+/**
+ * Serial interrupt handler.
+ */
+PUBLIC void uart8250_handler(void)
+{
+	unsigned char iir;
+
+	while (!((iir = INPUTB(IIR)) & IIR_NONE))
+	{
+		switch (IIR_ID(iir))
+		{
+			/* Drain receiver FIFO. */
+			case IIR_ID(IIR_RDA):
+			case IIR_ID(IIR_TO):
+				while (INPUTB(LSR) & LSR_DR)
+					uart8250_rx(uart8250_read());
+				break;
+
+			/* Refill transmitter FIFO. */
+			case IIR_ID(IIR_THRE):
+				disable_interrupts();
+				uart8250_tx();
+				enable_interrupts();
+				break;
+
+			/* Clear line status. */
+			case IIR_ID(IIR_RLS):
+				INPUTB(LSR);
+				break;
+
+			/* Clear modem status. */
+			default:
+				INPUTB(MSR);
+				break;
+		}
+	}
+}
 /**
  * Initializes the serial device.
  */
@@ -220,11 +389,17 @@ PUBLIC void uart8250_init(void)
 	 */
 	OUTPUTB(LCR, LCR_BPC_8);
 
-	/* Reset FIFOs and set trigger level to 1 byte. */
-	OUTPUTB(FCR, FCR_CLRRECV | FCR_CLRTMIT | FCR_TRIG_1);
+	/*
+	 * Enable and reset FIFOs. Received data is only
+	 * signaled after 8 bytes, or after a timeout.
+	 */
+	OUTPUTB(FCR, FCR_ENABLE | FCR_CLRRECV | FCR_CLRTMIT | FCR_TRIG_8);
+
+	/* Gate interrupts to the interrupt controller. */
+	OUTPUTB(MCR, MCR_DTR | MCR_RTS | MCR_OUT2);
 
 	/* Enable 'Data Available Interrupt'. */
-	OUTPUTB(IER, 1);
+	OUTPUTB(IER, IER_IDLE);
 
 	set_hwint(INT_COM1, &uart8250_handler);
 }
@@ -17,6 +17,7 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <dev/trace.h>
 #include <nanvix/const.h>
 #include <nanvix/dev.h>
 #include <nanvix/fs.h>
@@ -24,6 +25,7 @@
 #include <nanvix/klib.h>
 #include <nanvix/mm.h>
 #include <nanvix/pm.h>
+#include <nanvix/spinlock.h>
 #include <sys/types.h>
 #include <errno.h>
 #include <stdarg.h>
@@ -57,6 +59,10 @@
 #define ATA_REG_CMD     7 /* Command register.          */
 #define ATA_REG_STATUS  7 /* Status register.           */
 #define ATA_REG_ASTATUS 8 /* Alternate status register. */
+#define ATA_REG_CTL     8 /* Control register.          */
+
+/* ATA control register. */
+#define ATA_NIEN (1 << 1) /* Interrupts disabled. */
 
 /* ATA status register. */
 #define ATA_ERR   (1 << 0) /* Device error. */
@@ -72,6 +78,11 @@
 #define ATA_CMD_READ_SECTORS_EXT	0x24 /* Read sectors using LBA 48-bit.  */
 #define ATA_CMD_WRITE_SECTORS		0x30 /* Write sectors using LBA 28-bit. */
 #define ATA_CMD_WRITE_SECTORS_EXT	0x34 /* Write sectors using LBA 48-bit. */
+#define ATA_CMD_READ_MULTIPLE		0xc4 /* Read mult. using LBA 28-bit.    */
+#define ATA_CMD_READ_MULTIPLE_EXT	0x29 /* Read mult. using LBA 48-bit.    */
+#define ATA_CMD_WRITE_MULTIPLE		0xc5 /* Write mult. using LBA 28-bit.   */
+#define ATA_CMD_WRITE_MULTIPLE_EXT	0x39 /* Write mult. using LBA 48-bit.   */
+#define ATA_CMD_SET_MULTIPLE		0xc6 /* Set multiple mode.              */
 #define ATA_CMD_FLUSH_CACHE			0xe7 /* Flush cache using LBA 28-bit.   */
 #define ATA_CMD_FLUSH_CACHE_EXT		0xeA /* Flush cache using LBA 48-bit.   */
 	
@@ -127,6 +138,18 @@
 #define ata_info_supports_dma(info) \
 	((info)[ATA_INFO_CAPABILITY_1] & (1 << 8))
 
+/*
+ * Asserts if ATA device supports LBA 48-bit.
+ */
+#define ata_info_supports_lba48(info) \
+	((info)[ATA_INFO_COMMAND_SET_2] & (1 << 10))
+
+/*
+ * Returns the maximum number of sectors per multiple transfer block.
+ */
+#define ata_info_max_multsect(info) \
+	((info)[ATA_INFO_MAX_MULTSECT] & 0xff)
+
 /* ATA drives. */
 #define ATA_PRI_MASTER 0 /* Primary master.   */
 #define ATA_PRI_SLAVE  1 /* Primary slave.    */
@@ -155,6 +178,18 @@
 #define ATADEV_PRESENT (1 << 0) /* Device present?   */
 #define ATADEV_LBA     (1 << 1) /* Is LBA supported? */
 #define ATADEV_DMA     (1 << 2) /* Is DMA supported? */
+#define ATADEV_LBA48   (1 << 3) /* LBA 48-bit?       */
+#define ATADEV_MULT    (1 << 4) /* Multiple mode?    */
+
+/* Maximum number of sectors per command. */
+#define ATA_MAX_NSECT_LBA28   256 /* LBA 28-bit. */
+#define ATA_MAX_NSECT_LBA48 65536 /* LBA 48-bit. */
+
+/*
+ * Number of bytes that are transferred in a raw
+ * request before giving up the processor.
+ */
+#define ATA_RAW_BURST (64*1024)
 
 /*
  * ATA device information.
@@ -163,6 +198,8 @@ struct ata_info
 {
 	unsigned flags;                   /* ATA device flags (see above).*/
 	unsigned nsectors;                /* Number of sectors.           */
+	unsigned maxnsect;                /* Max. # sectors per command.  */
+	unsigned multsect;                /* # sectors per data block.    */
 	unsigned type;                    /* Device type (see above).     */
 	uint16_t rawinfo[ATA_INFO_WORDS]; /* Raw, non parsed information. */
 };
@@ -178,6 +215,7 @@ struct ata_info
 #define REQ_WRITE (1 << 0) /* Write request?         */
 #define REQ_BUF   (1 << 1) /* Buffered request?      */
 #define REQ_SYNC  (1 << 2) /* Synchronous operation? */
+#define REQ_RAW   (1 << 3) /* Issued by its owner?   */
 
 /*
  * I/O operation request.
@@ -213,6 +251,8 @@ PRIVATE struct atadev
 	int flags;             /* Flags (see above).                         */
 	struct ata_info info;  /* Device information.                        */
 	struct process *chain; /* Process waiting for operation to complete. */
+	struct process *owner; /* Processes waiting to own the device.       */
+	struct spinlock lock;  /* Protects the device and its queue.          */
 	
 	/* Block operation queue. */
 	struct
@@ -297,6 +337,27 @@ PRIVATE void ata_bus_wait(int bus)
 		/* noop*/ ;
 }
 
+/*
+ * Sets the number of sectors per data block of multiple transfers.
+ */
+PRIVATE int ata_set_multiple(int atadevid, unsigned multsect)
+{
+	int bus;       /* Bus number.      */
+	byte_t status; /* Status register. */
+	
+	bus = ata_bus(atadevid);
+	
+	outputb(pio_ports[bus][ATA_REG_CTL], ATA_NIEN);
+	outputb(pio_ports[bus][ATA_REG_NSECT], multsect);
+	outputb(pio_ports[bus][ATA_REG_CMD], ATA_CMD_SET_MULTIPLE);
+	ata_delay();
+	ata_bus_wait(bus);
+	status = inputb(pio_ports[bus][ATA_REG_STATUS]);
+	outputb(pio_ports[bus][ATA_REG_CTL], 0);
+	
+	return ((status & (ATA_ERR | ATA_DF)) ? -1 : 0);
+}
+
 /*
  * Sets up PATA device.
  */
@@ -304,6 +365,7 @@ PRIVATE int pata_setup(int atadevid)
 {
 	int i;                    /* Loop index.             */
 	int bus;                  /* Bus number.             */
+	unsigned multsect;        /* Sectors per data block. */
 	uint16_t status;          /* Status register.        */
 	struct atadev *dev;       /* ATA device.             */
 	struct ata_info *devinfo; /* ATA device information. */
@@ -346,12 +408,40 @@ PRIVATE int pata_setup(int atadevid)
 	devinfo->flags = ATADEV_PRESENT | ATADEV_LBA;
 	devinfo->nsectors = devinfo->rawinfo[ATA_INFO_LBA_CAPACITY_1]
 					 | devinfo->rawinfo[ATA_INFO_LBA_CAPACITY_2] << 16;
+	devinfo->maxnsect = ATA_MAX_NSECT_LBA28;
+	devinfo->multsect = 1;
 	
 	/* Supports DMA. */
 	if (ata_info_supports_dma(devinfo->rawinfo))
 		devinfo->flags |= ATADEV_DMA;
 	
+	/* Supports LBA 48-bit. */
+	if (ata_info_supports_lba48(devinfo->rawinfo))
+	{
+		devinfo->flags |= ATADEV_LBA48;
+		devinfo->nsectors = devinfo->rawinfo[ATA_INFO_LBA48_CAPACITY]
+			| devinfo->rawinfo[ATA_INFO_LBA48_CAPACITY + 1] << 16;
+		devinfo->maxnsect = ATA_MAX_NSECT_LBA48;
+	}
+	
+	/*
+	 * Supports multiple transfers. The data block
+	 * size must be a power of two, so round it down.
+	 */
+	if ((multsect = ata_info_max_multsect(devinfo->rawinfo)) > 0)
+	{
+		while (multsect & (multsect - 1))
+			multsect &= multsect - 1;
+		
+		if (!ata_set_multiple(atadevid, multsect))
+		{
+			devinfo->flags |= ATADEV_MULT;
+			devinfo->multsect = multsect;
+		}
+	}
+	
 	dev->flags = ATADEV_VALID | ATADEV_DISCARD;
+	dev->owner = NULL;
 	dev->queue.chain = NULL;
 	dev->queue.size = 0;
 	dev->queue.head = 0;
@@ -552,6 +642,98 @@ PRIVATE void ata_write_op(unsigned atadevid, struct request *req)
 	iowait();
 }
 
+/*
+ * Issues a raw I/O operation. The device is told not to interrupt,
+ * since the transfer is polled by the process that owns the request.
+ */
+PRIVATE void ata_raw_op(unsigned atadevid, block_t num, unsigned nsect, int write)
+{
+	int bus;               /* Bus number.          */
+	byte_t cmd;            /* Command.             */
+	uint64_t addr;         /* LBA address.         */
+	struct ata_info *info; /* Device information.  */
+	
+	bus = ata_bus(atadevid);
+	info = &ata_devices[atadevid].info;
+	addr = (uint64_t)num << (BLOCK_SIZE_LOG2 - ATA_SECTOR_SIZE_LOG2);
+	
+	ata_device_select(atadevid);
+	ata_bus_wait(bus);
+	outputb(pio_ports[bus][ATA_REG_CTL], ATA_NIEN);
+	
+	/* LBA 48-bit. */
+	if (info->flags & ATADEV_LBA48)
+	{
+		outputb(pio_ports[bus][ATA_REG_DEVICE], 0x40 | ((atadevid & 1) << 4));
+		
+		/* Send the highest bytes of the count and the address. */
+		outputb(pio_ports[bus][ATA_REG_NSECT], (nsect >> 8) & 0xff);
+		outputb(pio_ports[bus][ATA_REG_LBAL], (addr >> 0x18) & 0xff);
+		outputb(pio_ports[bus][ATA_REG_LBAM], (addr >> 0x20) & 0xff);
+		outputb(pio_ports[bus][ATA_REG_LBAH], (addr >> 0x28) & 0xff);
+		
+		if (info->flags & ATADEV_MULT)
+			cmd = (write) ? ATA_CMD_WRITE_MULTIPLE_EXT : ATA_CMD_READ_MULTIPLE_EXT;
+		else
+			cmd = (write) ? ATA_CMD_WRITE_SECTORS_EXT : ATA_CMD_READ_SECTORS_EXT;
+	}
+	
+	/* LBA 28-bit. */
+	else
+	{
+		outputb(pio_ports[bus][ATA_REG_DEVICE],
+			0x40 | ((atadevid & 1) << 4) | ((addr >> 0x18) & 0x0f));
+		
+		if (info->flags & ATADEV_MULT)
+			cmd = (write) ? ATA_CMD_WRITE_MULTIPLE : ATA_CMD_READ_MULTIPLE;
+		else
+			cmd = (write) ? ATA_CMD_WRITE_SECTORS : ATA_CMD_READ_SECTORS;
+	}
+	
+	/* Send the lowest bytes of the count and the address. */
+	outputb(pio_ports[bus][ATA_REG_NSECT], nsect & 0xff);
+	outputb(pio_ports[bus][ATA_REG_LBAL], (addr >> 0x00) & 0xff);
+	outputb(pio_ports[bus][ATA_REG_LBAM], (addr >> 0x08) & 0xff);
+	outputb(pio_ports[bus][ATA_REG_LBAH], (addr >> 0x10) & 0xff);
+	
+	outputb(pio_ports[bus][ATA_REG_CMD], cmd);
+	ata_delay();
+}
+
+/*
+ * Waits for a data block to be ready for transfer.
+ */
+PRIVATE int ata_drq_wait(int bus)
+{
+	byte_t status; /* Status register. */
+	
+	do
+		status = inputb(pio_ports[bus][ATA_REG_ASTATUS]);
+	while ((status & ATA_BUSY) || !(status & (ATA_DRQ | ATA_ERR | ATA_DF)));
+	
+	return ((status & (ATA_ERR | ATA_DF)) ? -EIO : 0);
+}
+
+/*
+ * Starts the request at the head of the block operation queue.
+ */
+PRIVATE void ata_start(unsigned atadevid)
+{
+	struct atadev *dev;  /* ATA device. */
+	struct request *req; /* Request.    */
+	
+	dev = &ata_devices[atadevid];
+	req = &dev->queue.requests[dev->queue.head];
+	
+	/* Raw requests are carried out by their owners. */
+	if (req->flags & REQ_RAW)
+		wakeup(&dev->owner);
+	else if (req->flags & REQ_WRITE)
+		ata_write_op(atadevid, req);
+	else
+		ata_read_op(atadevid, req);
+}
+
 /*
  * Schedules a block disk IO operation.
  */
@@ -564,11 +746,11 @@ PRIVATE void ata_sched(unsigned atadevid, unsigned flags, ...)
 	
 	dev = &ata_devices[atadevid];
 
-	disable_interrupts();
+	spinlock_lock(&dev->lock);
 	
 		/* Wait for a slot in the block operation queue. */
 		while (dev->queue.size == ATADEV_QUEUE_SIZE)
-			sleep(&dev->queue.chain, PRIO_IO);
+			sleep_locked(&dev->queue.chain, PRIO_IO, &dev->lock);
 		
 		req = &dev->queue.requests[dev->queue.tail];
 		
@@ -605,18 +787,20 @@ PRIVATE void ata_sched(unsigned atadevid, unsigned flags, ...)
 		 * we can process this block right now.
 		 */
 		if (dev->queue.size == 1)
+			ata_start(atadevid);
+		
+		/* Wait to own the device. */
+		if (req->flags & REQ_RAW)
 		{
-			if (flags & REQ_WRITE)
-				ata_write_op(atadevid, req);
-			else
-				ata_read_op(atadevid, req);
+			while (req != &dev->queue.requests[dev->queue.head])
+				sleep_locked(&dev->owner, PRIO_IO, &dev->lock);
 		}
 		
 		/* Wait operation to complete. */
-		if (req->flags & REQ_SYNC)
-			sleep(&dev->chain, PRIO_IO);
+		else if (req->flags & REQ_SYNC)
+			sleep_locked(&dev->chain, PRIO_IO, &dev->lock);
 	
-	enable_interrupts();
+	spinlock_unlock(&dev->lock);
 }
 
 /*
@@ -629,12 +813,109 @@ ata_sched_buffered(unsigned atadevid, buffer_t buf, unsigned flags)
 }
 
 /*
- * Schedules a non-buffered I/O operation.
+ * Performs a raw I/O operation.
+ * 
+ * The transfer is polled and carried out by the calling process, so
+ * data moves straight between the device and the buffer, which should
+ * have been pinned beforehand. The whole transfer is issued as a single
+ * command, and the device moves as many sectors per data block as it
+ * can in multiple mode.
  */
-PRIVATE void
-ata_sched_raw(unsigned atadevid, block_t num, void *buf, size_t size, unsigned flags)
-{	
-	ata_sched(atadevid, flags, num, buf, size);
+PRIVATE int
+ata_raw(unsigned atadevid, block_t num, void *buf, size_t size, unsigned flags)
+{
+	int bus;               /* Bus number.          */
+	int ret;               /* Return value.        */
+	size_t i, j;           /* Loop indexes.        */
+	size_t n;              /* Data block size.     */
+	word_t word;           /* Word used for I/O.   */
+	unsigned char *p;      /* Working buffer.      */
+	struct atadev *dev;    /* ATA device.          */
+	struct ata_info *info; /* Device information.  */
+	
+	ret = 0;
+	bus = ata_bus(atadevid);
+	dev = &ata_devices[atadevid];
+	info = &dev->info;
+	p = buf;
+	
+	ata_sched(atadevid, flags | REQ_RAW, num, buf, size);
+	
+	ata_raw_op(atadevid, num, size >> ATA_SECTOR_SIZE_LOG2, flags & REQ_WRITE);
+	
+	for (i = 0; i < size; i += n)
+	{
+		n = info->multsect << ATA_SECTOR_SIZE_LOG2;
+		if (n > size - i)
+			n = size - i;
+		
+		if ((ret = ata_drq_wait(bus)) < 0)
+			break;
+		
+		/* Write data block. */
+		if (flags & REQ_WRITE)
+		{
+			for (j = 0; j < n; j += 2)
+			{
+				word = p[j];
+				word |= p[j + 1] << 8;
+				outputw(pio_ports[bus][ATA_REG_DATA], word);
+			}
+		}
+		
+		/* Read data block. */
+		else
+		{
+			for (j = 0; j < n; j += 2)
+			{
+				word = inputw(pio_ports[bus][ATA_REG_DATA]);
+				p[j] = word & 0xff;
+				p[j + 1] = (word >> 8) & 0xff;
+			}
+		}
+		
+		p += n;
+		
+		/* Avoid starvation. */
+		if ((((i + n) & (ATA_RAW_BURST - 1)) == 0) && (i + n < size))
+			yield();
+	}
+	
+	ata_delay();
+	ata_bus_wait(bus);
+	
+	/* Flush ATA cache. */
+	if ((flags & REQ_WRITE) && (ret == 0))
+	{
+		outputb(pio_ports[bus][ATA_REG_CMD], (info->flags & ATADEV_LBA48) ?
+			ATA_CMD_FLUSH_CACHE_EXT : ATA_CMD_FLUSH_CACHE);
+		ata_delay();
+		ata_bus_wait(bus);
+	}
+	
+	if (inputb(pio_ports[bus][ATA_REG_STATUS]) & (ATA_ERR | ATA_DF))
+		ret = -EIO;
+	outputb(pio_ports[bus][ATA_REG_CTL], 0);
+	
+	TRACE(TRACE_ATA_DONE, atadevid, flags & REQ_WRITE, num);
+	
+	/* Release device. */
+	spinlock_lock(&dev->lock);
+	
+		dev->queue.head = (dev->queue.head + 1)%ATADEV_QUEUE_SIZE;
+		dev->queue.size--;
+		
+		if (dev->queue.size > 0)
+			ata_start(atadevid);
+		
+		wakeup(&dev->queue.chain);
+	
+	spinlock_unlock(&dev->lock);
+	
+	if (ret < 0)
+		kprintf("ata: device error");
+	
+	return (ret);
 }
 
 /*============================================================================*
@@ -646,7 +927,8 @@ ata_sched_raw(unsigned atadevid, block_t num, void *buf, size_t size, unsigned f
  */
 PRIVATE int ata_readblk(unsigned minor, buffer_t buf)
 {
-	struct atadev *dev;
+	unsigned flags;     /* Request flags. */
+	struct atadev *dev; /* ATA device.    */
 	
 	/* Invalid minor device. */
 	if (minor >= 4)
@@ -658,7 +940,9 @@ PRIVATE int ata_readblk(unsigned minor, buffer_t buf)
 	if (!(dev->flags & ATADEV_VALID))
 		return (-EINVAL);
 	
-	ata_sched_buffered(minor, buf, REQ_BUF | REQ_SYNC);
+	flags = REQ_BUF | (buffer_is_async(buf) ? 0 : REQ_SYNC);
+	
+	ata_sched_buffered(minor, buf, flags);
 	
 	return (0);
 }
@@ -693,11 +977,11 @@ PRIVATE int ata_writeblk(unsigned minor, buffer_t buf)
  */
 PRIVATE ssize_t ata_read(unsigned minor, char *buf, size_t n, off_t off)
 {
-	size_t i;           /* Loop index.                   */
-	struct atadev *dev; /* ATA device.                   */
-	unsigned char *p;   /* Read pointer.                 */
-	unsigned char *kpg; /* Kernel page used for copying. */
-	block_t lastblk;    /* Last block.                   */
+	int ret;            /* Return value.               */
+	size_t i;           /* Loop index.                 */
+	struct atadev *dev; /* ATA device.                 */
+	block_t lastblk;    /* Last block.                 */
+	size_t maxsize;     /* Maximum size of a transfer. */
 	
 	/* Invalid minor device. */
 	if (minor >= 4)
@@ -718,13 +1002,11 @@ PRIVATE ssize_t ata_read(unsigned minor, char *buf, size_t n, off_t off)
 		return (-EINVAL);
 	
 	lastblk = (dev->info.nsectors>>(BLOCK_SIZE_LOG2 - ATA_SECTOR_SIZE_LOG2))-1;
+	maxsize = dev->info.maxnsect << ATA_SECTOR_SIZE_LOG2;
 	
-	/* Get a kernel page. */
-	kpg = getkpg(0);
-	if (kpg == NULL)
-		return (-ENOMEM);
-	
-	p = (unsigned char *)buf;
+	/* Data goes straight to the buffer. */
+	if (pin_user(buf, n, 1))
+		return (-EFAULT);
 	
 	/* Read in bursts. */
 	for (i = 0; i < n; noop())
@@ -738,7 +1020,7 @@ PRIVATE ssize_t ata_read(unsigned minor, char *buf, size_t n, off_t off)
 		if (blknum >= lastblk)
 			break;
 			
-		count = ((n - i) >= PAGE_SIZE) ? PAGE_SIZE : (n - i);
+		count = ((n - i) >= maxsize) ? maxsize : (n - i);
 		
 		/* Read as much as we can. */
 		if (blknum + (count >> BLOCK_SIZE_LOG2) >= lastblk)
@@ -746,20 +1028,14 @@ PRIVATE ssize_t ata_read(unsigned minor, char *buf, size_t n, off_t off)
 		    count -= ((blknum + (count >> BLOCK_SIZE_LOG2)) - lastblk) <<
 																BLOCK_SIZE_LOG2;
 		}
-		    
-		ata_sched_raw(minor, blknum, kpg, count, REQ_SYNC);
-		kmemcpy(p, kpg, count);
 		
-		p += count;
+		if ((ret = ata_raw(minor, blknum, buf + i, count, 0)) < 0)
+			return ((i > 0) ? (ssize_t)i : ret);
+		
 		i += count;
 		off += count;
-	
-		/* Avoid starvation. */
-		if ((n - i) > 0)
-			yield();
 	}
 	
-	putkpg(kpg);
 	return ((ssize_t)i);
 }
 
@@ -769,11 +1045,11 @@ PRIVATE ssize_t ata_read(unsigned minor, char *buf, size_t n, off_t off)
  */
 PRIVATE ssize_t ata_write(unsigned minor, const char *buf, size_t n, off_t off)
 {
-	size_t i;           /* Loop index.                   */
-	struct atadev *dev; /* ATA device.                   */
-	unsigned char *p;   /* Write pointer.                */
-	unsigned char *kpg; /* Kernel page used for copying. */
-	block_t lastblk;    /* Last block.                   */
+	int ret;            /* Return value.               */
+	size_t i;           /* Loop index.                 */
+	struct atadev *dev; /* ATA device.                 */
+	block_t lastblk;    /* Last block.                 */
+	size_t maxsize;     /* Maximum size of a transfer. */
 	
 	/* Invalid minor device. */
 	if (minor >= 4)
@@ -794,19 +1070,17 @@ PRIVATE ssize_t ata_write(unsigned minor, const char *buf, size_t n, off_t off)
 		return (-EINVAL);
 	
 	lastblk = (dev->info.nsectors>>(BLOCK_SIZE_LOG2 - ATA_SECTOR_SIZE_LOG2))-1;
+	maxsize = dev->info.maxnsect << ATA_SECTOR_SIZE_LOG2;
 	
-	/* Get a kernel page. */
-	kpg = getkpg(0);
-	if (kpg == NULL)
-		return (-ENOMEM);
-	
-	p = (unsigned char *)buf;
+	/* Data comes straight from the buffer. */
+	if (pin_user(buf, n, 0))
+		return (-EFAULT);
 	
 	/* Write in bursts. */
 	for (i = 0; i < n; noop())
 	{	
-		size_t count;   /* # bytes to read. */
-		block_t blknum; /* Block number.    */
+		size_t count;   /* # bytes to write. */
+		block_t blknum; /* Block number.     */
 		
 		blknum = off >> BLOCK_SIZE_LOG2;
 		
@@ -814,7 +1088,7 @@ PRIVATE ssize_t ata_write(unsigned minor, const char *buf, size_t n, off_t off)
 		if (blknum >= lastblk)
 			break;
 		
-		count = ((n - i) >= PAGE_SIZE) ? PAGE_SIZE : (n - i);
+		count = ((n - i) >= maxsize) ? maxsize : (n - i);
 		
 		/* Write as much as we can. */
 		if (blknum + (count >> BLOCK_SIZE_LOG2) >= lastblk)
@@ -823,19 +1097,14 @@ PRIVATE ssize_t ata_write(unsigned minor, const char *buf, size_t n, off_t off)
 																BLOCK_SIZE_LOG2;
 		}
 		
-		kmemcpy(kpg, p, count);
-		ata_sched_raw(minor, blknum, kpg, count, REQ_SYNC | REQ_WRITE);
+		ret = ata_raw(minor, blknum, (char *)buf + i, count, REQ_WRITE);
+		if (ret < 0)
+			return ((i > 0) ? (ssize_t)i : ret);
 		
-		p += count;
 		i += count;
 		off += count;
-		
-		/* Avoid starvation. */
-		if ((n - i) > 0)
-			yield();
 	}
 	
-	putkpg(kpg);
 	return ((ssize_t)i);
 }
 
@@ -843,10 +1112,11 @@ PRIVATE ssize_t ata_write(unsigned minor, const char *buf, size_t n, off_t off)
  * ATA device operations.
  */
 PRIVATE const struct bdev ata_ops = {
-	&ata_read,    /* read()     */
-	&ata_write,   /* write()    */
-	&ata_readblk, /* readblk()  */
-	&ata_writeblk /* writeblk() */
+	&ata_read,     /* read()     */
+	&ata_write,    /* write()    */
+	&ata_readblk,  /* readblk()  */
+	&ata_writeblk, /* writeblk() */
+	NULL           /* mapblk()   */
 };
 
 /*
@@ -874,11 +1144,14 @@ PRIVATE void ata_handler(int atadevid)
 		kprintf("ata: non valid device %d fired an IRQ", atadevid);
 		return;
 	}
+	
+	spinlock_lock(&dev->lock);
 		
 	/* We don't need to handle this IRQ. */
 	if (dev->flags & ATADEV_DISCARD)
 	{
 		dev->flags &= ~ATADEV_DISCARD;
+		spinlock_unlock(&dev->lock);
 		return;
 	}
 	
@@ -891,6 +1164,17 @@ PRIVATE void ata_handler(int atadevid)
 	
 	/* Get first request. */
 	req = &dev->queue.requests[dev->queue.head];
+	
+	/*
+	 * Raw requests are polled, so whatever
+	 * this is, it is none of our business.
+	 */
+	if (req->flags & REQ_RAW)
+	{
+		spinlock_unlock(&dev->lock);
+		return;
+	}
+	
 	dev->queue.head = (dev->queue.head + 1)%ATADEV_QUEUE_SIZE;
 	dev->queue.size--;
 	
@@ -899,6 +1183,8 @@ PRIVATE void ata_handler(int atadevid)
 	{
 		buf = buffer_data(req->u.buffered.buf);
 		size = BLOCK_SIZE;
+		TRACE(TRACE_ATA_DONE, atadevid, req->flags & REQ_WRITE,
+			buffer_num(req->u.buffered.buf));
 	}
 	
 	/* Raw I/O operation. */
@@ -906,6 +1192,8 @@ PRIVATE void ata_handler(int atadevid)
 	{
 		buf = req->u.raw.buf;
 		size = req->u.raw.size;
+		TRACE(TRACE_ATA_DONE, atadevid, req->flags & REQ_WRITE,
+			req->u.raw.num);
 	}
 	
 	/* Write operation. */
@@ -937,18 +1225,15 @@ PRIVATE void ata_handler(int atadevid)
 			buf[i] = word & 0xff;
 			buf[i + 1] = (word >> 8) & 0xff;
 		}
+		
+		/* Nobody is waiting for this one. */
+		if ((req->flags & REQ_BUF) && !(req->flags & REQ_SYNC))
+			bdone(req->u.buffered.buf);
 	}
 	
 	/* Process next operation. */
 	if (dev->queue.size > 0)
-	{
-		req = &dev->queue.requests[dev->queue.head];
-		
-		if (req->flags & REQ_WRITE)
-			ata_write_op(atadevid, req);
-		else
-			ata_read_op(atadevid, req);
-	}
+		ata_start(atadevid);
 
 out:
 
@@ -959,6 +1244,8 @@ out:
 	 */
 	wakeup(&dev->queue.chain);
 	wakeup(&dev->chain);
+	
+	spinlock_unlock(&dev->lock);
 }
 
 /*
@@ -977,10 +1264,25 @@ PRIVATE void ata2_handler(void)
 	ata_handler(1);
 }
 
+/**
+ * @brief Gets the number of pending requests of an ATA device.
+ *
+ * @param atadevid ATA device ID.
+ *
+ * @returns The number of requests in the block operation queue of the
+ *          device, or a negative number if there is no such device.
+ */
+PUBLIC int ata_queue_depth(unsigned atadevid)
+{
+	/* Invalid device. */
+	if ((atadevid >= 4) || !(ata_devices[atadevid].info.flags & ATADEV_PRESENT))
+		return (-1);
+
+	return (ata_devices[atadevid].queue.size);
+}
+
 /**
  * @brief Initializes the generic ATA device driver.
- * 
- * @todo Check for multiple read/write sectors capability.
  */
 PUBLIC void ata_init(void)
 {
@@ -991,6 +1293,7 @@ PUBLIC void ata_init(void)
 	for (i = 0, dvrl = 'a'; i < 4; i++, dvrl++)
 	{		
 		kmemset(&ata_devices[i], 0, sizeof(struct atadev));
+		spinlock_init(&ata_devices[i].lock);
 		
 		ata_device_select(i);
 		
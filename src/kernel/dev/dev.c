@@ -24,6 +24,7 @@
 #include <dev/tty.h>
 #include <dev/cmos.h>
 #include <dev/ramdisk.h>
+#include <dev/trace.h>
 #include <dev/8250.h>
 #include <nanvix/const.h>
 #include <nanvix/dev.h>
@@ -32,21 +33,23 @@
 #include <nanvix/clock.h>
 #include <nanvix/debug.h>
 #include <errno.h>
+#include <poll.h>
 
 /*============================================================================*
  *                            Character Devices                               *
  *============================================================================*/
 
 /* Number of character devices. */
-#define NR_CHRDEV 3
+#define NR_CHRDEV 4
 
 /*
  * Character devices table.
  */
 PRIVATE const struct cdev *cdevsw[NR_CHRDEV] = {
-	NULL, /* /dev/null */
-	NULL, /* /dev/tty  */
-	NULL  /* /dev/klog */
+	NULL, /* /dev/null  */
+	NULL, /* /dev/tty   */
+	NULL, /* /dev/klog  */
+	NULL  /* /dev/trace */
 };
 
 /**
@@ -127,6 +130,32 @@ PUBLIC ssize_t cdev_read(dev_t dev, void *buf, size_t n)
 	return (cdevsw[MAJOR(dev)]->read(MINOR(dev), buf, n));
 }
 
+/**
+ * @brief Polls a character device.
+ *
+ * @details Checks which of the @p events are ready on the character
+ * device identified by @p dev. Devices that do not provide a poll
+ * operation never block, so they are always ready.
+ *
+ * @returns The events that are ready.
+ */
+PUBLIC int cdev_poll(dev_t dev, int events)
+{
+	/* Null device. */
+	if (MAJOR(dev) == NULL_MAJOR)
+		return (events);
+	
+	/* Invalid device. */
+	if (cdevsw[MAJOR(dev)] == NULL)
+		return (POLLNVAL);
+	
+	/* Never blocks. */
+	if (cdevsw[MAJOR(dev)]->poll == NULL)
+		return (events);
+	
+	return (cdevsw[MAJOR(dev)]->poll(MINOR(dev), events));
+}
+
 /*
  * Opens a character device.
  */
@@ -401,6 +430,22 @@ PUBLIC void bdev_readblk(buffer_t buf)
 		kpanic("failed to read block from device");
 }
 
+/*
+ * Maps a block of a memory-backed block device.
+ */
+PUBLIC void *bdev_mapblk(dev_t dev, block_t num)
+{
+	/* Invalid device. */
+	if (bdevsw[MAJOR(dev)] == NULL)
+		return (NULL);
+	
+	/* Operation not supported. */
+	if (bdevsw[MAJOR(dev)]->mapblk == NULL)
+		return (NULL);
+	
+	return (bdevsw[MAJOR(dev)]->mapblk(MINOR(dev), num));
+}
+
 /**
  * @brief Tests if all block devices are correctly registered.
  * 
@@ -495,6 +540,7 @@ PUBLIC void dev_init(void)
 {
 	uart8250_init();
 	klog_init();
+	trace_init();
 	cmos_init();
 	clock_init(CLOCK_FREQ);
 	tty_init();
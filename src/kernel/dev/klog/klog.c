@@ -23,8 +23,10 @@
 #include <nanvix/debug.h>
 #include <nanvix/dev.h>
 #include <nanvix/klib.h>
+#include <nanvix/mm.h>
 #include <nanvix/syscall.h> 
 #include <sys/types.h>  
+#include <errno.h>
 
 /* Error checking. */
 #if KLOG_SIZE > KBUFFER_SIZE
@@ -187,6 +189,10 @@ PUBLIC ssize_t klog_read(unsigned minor, char *buffer, size_t n)
 	
 	UNUSED(minor);
 	
+	/* Characters are written in place. */
+	if (pin_user(buffer, n, 1))
+		return (-EFAULT);
+	
 	p = buffer;
 	
 	i = klog.head;
@@ -230,7 +236,8 @@ PRIVATE struct cdev klog_driver = {
 	&klog_read,  /* read()  */
 	NULL,        /* write() */
 	NULL,        /* ioctl() */
-	&klog_close  /* close() */
+	&klog_close, /* close() */
+	NULL         /* poll()  */
 };
 
 /**
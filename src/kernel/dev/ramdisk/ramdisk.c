@@ -40,6 +40,11 @@
 
 char ramdisk1 [RAMDISK1_SIZE];
 
+/*
+ * Number of bytes copied between yields.
+ */
+#define RAMDISK_BURST (64*BLOCK_SIZE)
+
 /*
  * RAM disks.
  */
@@ -76,15 +81,17 @@ PRIVATE ssize_t ramdisk_write(unsigned minor, const char *buf, size_t n, off_t o
 	/* Write in bursts. */
 	for (i = 0; i < n; /* noop */)
 	{
-		count = ((n - i) > BLOCK_SIZE) ? BLOCK_SIZE : (n - i);
+		count = ((n - i) > RAMDISK_BURST) ? RAMDISK_BURST : (n - i);
 		
-		kmemcpy((void *)ptr, buf, count);
+		if (copy_from_user((void *)ptr, buf, count))
+			return ((i > 0) ? (ssize_t)i : -EFAULT);
 		
 		i += count;
+		buf += count;
 		ptr += count;
 		
 		/* Avoid starvation. */
-		if (n > 0)
+		if (i < n)
 			yield();
 	}
 	
@@ -117,15 +124,17 @@ PRIVATE ssize_t ramdisk_read(unsigned minor, char *buf, size_t n, off_t off)
 	/* Read in bursts. */
 	for (i = 0; i < n; /* noop */)
 	{
-		count = ((n - i) > BLOCK_SIZE) ? BLOCK_SIZE : (n - i);
+		count = ((n - i) > RAMDISK_BURST) ? RAMDISK_BURST : (n - i);
 		
-		kmemcpy(buf, (void *)ptr, count);
+		if (copy_to_user(buf, (void *)ptr, count))
+			return ((i > 0) ? (ssize_t)i : -EFAULT);
 		
 		i += count;
+		buf += count;
 		ptr += count;
 		
 		/* Avoid starvation. */
-		if (n > 0)
+		if (i < n)
 			yield();
 	}
 	
@@ -143,6 +152,10 @@ PRIVATE int ramdisk_readblk(unsigned minor, buffer_t buf)
 	
 	kmemcpy(buffer_data(buf), (void *)ptr, BLOCK_SIZE);
 	
+	/* Asynchronous reads are done, too. */
+	if (buffer_is_async(buf))
+		bdone(buf);
+	
 	return (0);
 }
 
@@ -163,6 +176,26 @@ PRIVATE int ramdisk_writeblk(unsigned minor, buffer_t buf)
 	return (0);
 }
 
+/*
+ * Maps a block of a RAM disk device.
+ */
+PRIVATE void *ramdisk_mapblk(unsigned minor, block_t num)
+{
+	addr_t ptr;
+	
+	/* Invalid device. */
+	if (minor >= NR_RAMDISKS)
+		return (NULL);
+	
+	ptr = ramdisks[minor].start + (num << BLOCK_SIZE_LOG2);
+	
+	/* Invalid block. */
+	if (ptr + BLOCK_SIZE > ramdisks[minor].end)
+		return (NULL);
+	
+	return ((void *)ptr);
+}
+
 /*
  * RAM disk device driver interface.
  */
@@ -170,7 +203,8 @@ PRIVATE const struct bdev ramdisk_driver = {
 	&ramdisk_read,     /* read()     */
 	&ramdisk_write,    /* write()    */
 	&ramdisk_readblk,  /* readblk()  */
-	&ramdisk_writeblk  /* writeblk() */
+	&ramdisk_writeblk, /* writeblk() */
+	&ramdisk_mapblk    /* mapblk()   */
 };
 
 /**
@@ -229,6 +263,32 @@ PRIVATE int rmdtst_rw(char *buffer, int tstrmd_lenght)
 	return 1;
 }
 
+/**
+ * @brief Used for debugging
+ * @details Tests if RAM disk blocks are correctly mapped
+ * 
+ * @returns Upon successful completion one is returned. Upon failure, a 
+ *          zero is returned instead.
+ */
+PRIVATE int rmdtst_mapblk(void)
+{
+	block_t nblocks = ramdisks[1].size >> BLOCK_SIZE_LOG2;
+
+	if (ramdisk_mapblk(1, 1) != (void *)(ramdisks[1].start + BLOCK_SIZE))
+	{
+		kprintf(KERN_DEBUG "rmdsk test: ramdisk_mapblk failed: wrong address");
+		return 0;
+	}
+
+	if (ramdisk_mapblk(1, nblocks) != NULL)
+	{
+		kprintf(KERN_DEBUG "rmdsk test: ramdisk_mapblk failed: block out of range");
+		return 0;
+	}
+
+	return 1;
+}
+
 PUBLIC void test_rmd(void)
 {
 	char buffer[KBUFFER_SIZE]; /* Temporary buffer.        */
@@ -246,6 +306,12 @@ PUBLIC void test_rmd(void)
 		tst_failed();
 		return;
 	}
+
+	if(!rmdtst_mapblk())
+	{
+		tst_failed();
+		return;
+	}
 	tst_passed();
 	return;
 }
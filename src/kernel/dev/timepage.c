@@ -0,0 +1,140 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <sys/stat.h>
+#include <sys/timepage.h>
+#include <errno.h>
+
+/**
+ * @brief Time page, as seen by the kernel.
+ */
+PUBLIC struct timepage *timepage = NULL;
+
+/**
+ * @brief Memory region of the time page.
+ */
+PRIVATE struct region *timereg = NULL;
+
+/**
+ * @brief Initializes the time page.
+ *
+ * @param mult  Cycles to nanoseconds scale, zero if there is no usable
+ *              cycle counter.
+ * @param shift Cycles to nanoseconds shift.
+ */
+PUBLIC void timepage_init(unsigned mult, unsigned shift)
+{
+	if ((timepage = getkpg(1)) == NULL)
+		kpanic("dev: cannot allocate time page");
+
+	timepage->mult = mult;
+	timepage->shift = shift;
+	timepage->boot_sec = startup_time;
+	timepage->base_cycles = timepage_cycles();
+}
+
+/**
+ * @brief Advances the time page, on a clock interrupt.
+ *
+ * @details The base moves to the current cycle count, by as many
+ * nanoseconds as readers would have added, so that the clock never
+ * goes backwards.
+ */
+PUBLIC void timepage_update(void)
+{
+	uint64_t cycles; /* Cycle counter.      */
+	uint64_t nsec;   /* New base, in nsecs. */
+
+	if (timepage == NULL)
+		return;
+
+	cycles = timepage_cycles();
+	if (timepage->mult != 0)
+		nsec = timepage_nsecs(timepage, cycles);
+	else
+		nsec = NSEC_PER_SEC/CLOCK_FREQ;
+	nsec += timepage->base_nsec;
+
+	timepage->seq++;
+	__asm__ __volatile__ ("" ::: "memory");
+
+	timepage->base_cycles = cycles;
+	while (nsec >= NSEC_PER_SEC)
+	{
+		nsec -= NSEC_PER_SEC;
+		timepage->base_sec++;
+	}
+	timepage->base_nsec = (unsigned) nsec;
+	timepage->boot_sec = startup_time;
+
+	__asm__ __volatile__ ("" ::: "memory");
+	timepage->seq++;
+}
+
+/**
+ * @brief Maps the time page read-only in the calling process.
+ *
+ * @returns 0 upon successful completion, a negative error code
+ * otherwise.
+ */
+PUBLIC int timepage_attach(void)
+{
+	struct pregion *preg; /* Process memory region. */
+
+	/* First process ever. */
+	if (timereg == NULL)
+	{
+		timereg = kpgreg(timepage, S_IRUSR | S_IRGRP | S_IROTH,
+			REGION_SHARED | REGION_STICKY);
+
+		if (timereg == NULL)
+			return (-ENOMEM);
+
+		unlockreg(timereg);
+	}
+
+	/* Look for a free process region. */
+	for (preg = DATA(curr_proc); preg < &curr_proc->pregs[NR_PREGIONS]; preg++)
+	{
+		if (preg->reg == NULL)
+			goto found;
+	}
+
+	return (-ENOMEM);
+
+found:
+
+	lockreg(timereg);
+
+	if (attachreg(curr_proc, preg, TIMEPAGE_ADDR, timereg))
+	{
+		unlockreg(timereg);
+		return (-ENOMEM);
+	}
+
+	unlockreg(timereg);
+
+	return (0);
+}
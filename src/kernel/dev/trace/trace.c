@@ -0,0 +1,410 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <dev/trace.h>
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/debug.h>
+#include <nanvix/dev.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/smp.h>
+#include <sys/trace.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <stdint.h>
+
+/**
+ * @brief Number of trace records per processor (power of two).
+ */
+#define TRACE_RING_SIZE 1024
+
+/**
+ * @brief Compiler barrier.
+ */
+#define trace_barrier() __asm__ __volatile__ ("" ::: "memory")
+
+/**
+ * @brief Trace ring of a processor.
+ *
+ * @details A ring is only written by its own processor. Writers reserve
+ * a slot with a single instruction, so that tracepoints may nest into
+ * interrupt handlers without locking, and publish the record by writing
+ * its sequence number last. Readers copy a record and then check that
+ * the sequence number did not change meanwhile.
+ */
+PRIVATE struct trace_ring
+{
+	volatile uint32_t head; /**< Next record to write. */
+	uint32_t tail;          /**< Next record to read.  */
+	struct trace_record records[TRACE_RING_SIZE]; /**< Records. */
+} rings[CPU_MAX];
+
+/**
+ * @brief Is tracing enabled?
+ *
+ * @details Tracing is off at boot, and is started with the TRACE_ENABLE
+ * ioctl() command on /dev/trace.
+ */
+PUBLIC volatile int trace_enabled = 0;
+
+/**
+ * @brief Number of records that were overwritten before being read.
+ */
+PRIVATE unsigned trace_lost = 0;
+
+/**
+ * @brief Reads the time stamp.
+ *
+ * @returns A time stamp, in CPU cycles when supported by the
+ * underlying hardware, and in clock ticks otherwise.
+ */
+PRIVATE inline uint64_t trace_time(void)
+{
+#ifdef i386
+	uint64_t t;
+
+	__asm__ __volatile__ ("rdtsc" : "=A" (t));
+
+	return (t);
+#else
+	return (ticks);
+#endif
+}
+
+/**
+ * @brief Reserves a slot in a trace ring.
+ *
+ * @param ring Target trace ring.
+ *
+ * @returns The sequence number of the reserved slot.
+ */
+PRIVATE inline uint32_t trace_reserve(struct trace_ring *ring)
+{
+#ifdef i386
+	uint32_t seq = 1;
+
+	/* Atomic with respect to interrupts. */
+	__asm__ __volatile__ (
+		"xaddl %0, %1"
+		: "+r" (seq), "+m" (ring->head)
+		:
+		: "memory"
+	);
+
+	return (seq);
+#else
+	return (ring->head++);
+#endif
+}
+
+/**
+ * @brief Records a trace event.
+ *
+ * @param event Event.
+ * @param a0    First argument.
+ * @param a1    Second argument.
+ * @param a2    Third argument.
+ *
+ * @note Use the TRACE() tracepoint instead of calling this directly.
+ */
+PUBLIC void trace_event(unsigned event, uint32_t a0, uint32_t a1, uint32_t a2)
+{
+	uint32_t seq;                /* Sequence number. */
+	struct cpu *cpu;             /* Processor.       */
+	struct trace_ring *ring;     /* Trace ring.      */
+	struct trace_record *rec;    /* Trace record.    */
+
+	cpu = cpu_self();
+	ring = &rings[cpu->id];
+
+	seq = trace_reserve(ring);
+	rec = &ring->records[seq & (TRACE_RING_SIZE - 1)];
+
+	/* Invalidate record while it is being written. */
+	rec->seq = 0;
+	trace_barrier();
+
+	rec->time = trace_time();
+	rec->cpu = cpu->id;
+	rec->event = event;
+	rec->pid = (cpu->curr != NULL) ? cpu->curr->pid : -1;
+	rec->args[0] = a0;
+	rec->args[1] = a1;
+	rec->args[2] = a2;
+
+	/* Publish record. */
+	trace_barrier();
+	rec->seq = seq + 1;
+}
+
+/**
+ * @brief System call entry tracepoint.
+ *
+ * @param nr   System call number.
+ * @param arg0 First argument.
+ * @param arg1 Second argument.
+ */
+PUBLIC void trace_syscall_enter(unsigned nr, uint32_t arg0, uint32_t arg1)
+{
+	TRACE(TRACE_SYSCALL_ENTER, nr, arg0, arg1);
+}
+
+/**
+ * @brief System call exit tracepoint.
+ *
+ * @param ret Return value.
+ */
+PUBLIC void trace_syscall_exit(int ret)
+{
+	TRACE(TRACE_SYSCALL_EXIT, curr_proc->syscall_nr, ret, 0);
+}
+
+/**
+ * @brief Reads trace records.
+ *
+ * @details Moves as many whole records as fit in @p buf out of the
+ * trace rings, processor by processor. Records are not sorted by time
+ * stamp, this is left to the decoder.
+ *
+ * @param minor Minor device number.
+ * @param buf   Target buffer.
+ * @param n     Size of target buffer.
+ *
+ * @returns The number of bytes read, or -EINVAL if @p buf cannot hold a
+ * single record.
+ */
+PRIVATE ssize_t trace_read(unsigned minor, char *buf, size_t n)
+{
+	size_t i, nrecs;               /* Records read, records to read. */
+	struct trace_record rec;       /* Working record.                */
+	struct trace_record *out;      /* Output records.                */
+
+	UNUSED(minor);
+
+	if ((nrecs = n/sizeof(struct trace_record)) == 0)
+		return (-EINVAL);
+
+	/* Records are written in place. */
+	if (pin_user(buf, n, 1))
+		return (-EFAULT);
+
+	i = 0;
+	out = (struct trace_record *)buf;
+	for (unsigned c = 0; (c < ncpus) && (i < nrecs); c++)
+	{
+		struct trace_ring *ring = &rings[c];
+		uint32_t head = ring->head;
+
+		/* Skip records that were overwritten. */
+		if (head - ring->tail > TRACE_RING_SIZE)
+		{
+			trace_lost += head - ring->tail - TRACE_RING_SIZE;
+			ring->tail = head - TRACE_RING_SIZE;
+		}
+
+		while ((ring->tail != head) && (i < nrecs))
+		{
+			struct trace_record *r;
+			uint32_t seq = ring->tail + 1;
+
+			r = &ring->records[ring->tail++ & (TRACE_RING_SIZE - 1)];
+
+			kmemcpy(&rec, r, sizeof(struct trace_record));
+			trace_barrier();
+
+			/* Overwritten or not yet published. */
+			if ((rec.seq != seq) || (r->seq != seq))
+			{
+				trace_lost++;
+				continue;
+			}
+
+			kmemcpy(&out[i++], &rec, sizeof(struct trace_record));
+		}
+	}
+
+	return ((ssize_t)(i*sizeof(struct trace_record)));
+}
+
+/**
+ * @brief Performs control operations on the trace device.
+ *
+ * @param minor Minor device number.
+ * @param cmd   Command.
+ * @param arg   Command argument.
+ *
+ * @returns The number of lost records for TRACE_LOST, zero for other
+ * valid commands, and -EINVAL otherwise.
+ */
+PRIVATE int trace_ioctl(unsigned minor, unsigned cmd, unsigned arg)
+{
+	UNUSED(minor);
+	UNUSED(arg);
+
+	switch (cmd)
+	{
+		case TRACE_ENABLE:
+			trace_enabled = 1;
+			break;
+
+		case TRACE_DISABLE:
+			trace_enabled = 0;
+			break;
+
+		case TRACE_CLEAR:
+			for (unsigned c = 0; c < CPU_MAX; c++)
+				rings[c].tail = rings[c].head;
+			trace_lost = 0;
+			break;
+
+		case TRACE_LOST:
+			return (trace_lost);
+
+		default:
+			return (-EINVAL);
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Dummy open() operation.
+ */
+PRIVATE int trace_open(unsigned minor)
+{
+	UNUSED(minor);
+
+	return (0);
+}
+
+/**
+ * @brief Dummy close() operation.
+ */
+PRIVATE int trace_close(unsigned minor)
+{
+	UNUSED(minor);
+
+	return (0);
+}
+
+/**
+ * @brief Trace driver.
+ */
+PRIVATE struct cdev trace_driver = {
+	&trace_open,  /* open()  */
+	&trace_read,  /* read()  */
+	NULL,         /* write() */
+	&trace_ioctl, /* ioctl() */
+	&trace_close, /* close() */
+	NULL          /* poll()  */
+};
+
+/*============================================================================*
+ *                                   Tests                                    *
+ *============================================================================*/
+
+/**
+ * @brief Magic argument of test records.
+ */
+#define TRACE_TEST_MAGIC 0x74726163
+
+/**
+ * @brief Reads back test records.
+ *
+ * @param buf Working page.
+ *
+ * @returns The number of test records read, in order, or a negative
+ * number if they came out of order.
+ */
+PRIVATE int trace_test_read(char *buf)
+{
+	ssize_t n;
+	int count = 0;
+	struct trace_record *rec = (struct trace_record *)buf;
+
+	while ((n = trace_read(0, buf, PAGE_SIZE)) > 0)
+	{
+		for (unsigned i = 0; i < n/sizeof(struct trace_record); i++)
+		{
+			if (rec[i].args[0] != TRACE_TEST_MAGIC)
+				continue;
+
+			if (rec[i].args[1] < (uint32_t)count)
+				return (-1);
+			count++;
+		}
+	}
+
+	return (count);
+}
+
+/**
+ * @brief Trace ring test.
+ *
+ * @details Checks that records are read back in order, and that lost
+ * records are accounted when a ring overflows.
+ */
+PUBLIC void test_trace(void)
+{
+	char *buf;
+	int enabled;
+
+	if ((buf = getkpg(0)) == NULL)
+		goto error0;
+
+	enabled = trace_enabled;
+	trace_ioctl(0, TRACE_ENABLE, 0);
+	trace_ioctl(0, TRACE_CLEAR, 0);
+
+	/* Few records. */
+	for (int i = 0; i < 16; i++)
+		TRACE(0, TRACE_TEST_MAGIC, i, 0);
+	if (trace_test_read(buf) != 16)
+		goto error1;
+
+	/* Overflow. */
+	for (int i = 0; i < TRACE_RING_SIZE + 16; i++)
+		TRACE(0, TRACE_TEST_MAGIC, i, 0);
+	if (trace_test_read(buf) < 0)
+		goto error1;
+	if (trace_ioctl(0, TRACE_LOST, 0) < 16)
+		goto error1;
+
+	trace_enabled = enabled;
+	putkpg(buf);
+	tst_passed();
+	return;
+
+error1:
+	trace_enabled = enabled;
+	putkpg(buf);
+error0:
+	tst_failed();
+}
+
+/**
+ * @brief Initializes the trace driver.
+ */
+PUBLIC void trace_init(void)
+{
+	cdev_register(TRACE_MAJOR, &trace_driver);
+	dbg_register(test_trace, "test_trace");
+}
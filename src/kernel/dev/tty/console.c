@@ -20,6 +20,7 @@
 #include <nanvix/const.h>
 #include <nanvix/dev.h>
 #include <nanvix/hal.h>
+#include <nanvix/klib.h>
 #include <dev/8250.h>
 #include <sys/types.h>
 #include <stdint.h>
@@ -30,6 +31,7 @@
 #define VIDEO_ADDR  0xb8000 /* Video memory address. */
 #define VIDEO_WIDTH      80 /* Video width.          */
 #define VIDEO_HIGH       25 /* Video high.           */
+#define VIDEO_ROWS      200 /* Rows in video memory. */
 
 /* Video registers. */
 #define VIDEO_CRTL_REG 0x3d4 /* Video control register. */
@@ -74,12 +76,29 @@ PRIVATE struct
 /* Video memory.*/
 PRIVATE uint16_t *video = (uint16_t*)VIDEO_ADDR;
 
+/*
+ * First character on the screen. The screen is a window over a video
+ * memory that is much larger than the screen, and scrolling moves the
+ * window down by changing the CRTC start address.
+ */
+PRIVATE unsigned origin = 0;
+
+/*
+ * Screen window that is currently set in hardware.
+ */
+PRIVATE unsigned hw_origin = 0;
+
+/*
+ * Screen.
+ */
+#define SCREEN (video + origin)
+
 /*
  * Moves the hardware console cursor.
  */
 PRIVATE void cursor_move(void)
 {
-	word_t cursor_location = cursor.y*VIDEO_WIDTH + cursor.x;
+	word_t cursor_location = origin + cursor.y*VIDEO_WIDTH + cursor.x;
 	
 	outputb(VIDEO_CRTL_REG, VIDEO_CLH);
 	outputb(VIDEO_DATA_REG, (byte_t) ((cursor_location >> 8) & 0xFF));
@@ -87,34 +106,59 @@ PRIVATE void cursor_move(void)
 	outputb(VIDEO_DATA_REG, (byte_t) (cursor_location & 0xFF));
 }
 
+/*
+ * Moves the hardware screen window.
+ */
+PRIVATE void origin_move(void)
+{
+	hw_origin = origin;
+
+	outputb(VIDEO_CRTL_REG, VIDEO_SAH);
+	outputb(VIDEO_DATA_REG, (byte_t) ((origin >> 8) & 0xFF));
+	outputb(VIDEO_CRTL_REG, VIDEO_SAL);
+	outputb(VIDEO_DATA_REG, (byte_t) (origin & 0xFF));
+}
+
+/*
+ * Blanks a range of characters.
+ */
+PRIVATE void console_blank(uint16_t *p, unsigned n)
+{
+	while (n-- > 0)
+		*p++ = (BLACK << 8) | (' ');
+}
+
 /*
  * Scrolls down the console by one row.
  */
 PRIVATE void console_scrolldown(void)
 {
-	uint16_t *p;
-	
-	/* Pull lines up. */
-	for (p = video; p < (video + (VIDEO_HIGH-1)*(VIDEO_WIDTH)); p++)
-		*p = *(p + VIDEO_WIDTH);
+	/*
+	 * Out of video memory, so pull the screen
+	 * back to the top. This is seldom done.
+	 */
+	if (origin + (VIDEO_HIGH + 1)*VIDEO_WIDTH > VIDEO_ROWS*VIDEO_WIDTH)
+	{
+		kmemcpy(video, SCREEN + VIDEO_WIDTH,
+			(VIDEO_HIGH - 1)*VIDEO_WIDTH*sizeof(uint16_t));
+		origin = 0;
+	}
+	else
+		origin += VIDEO_WIDTH;
 	
 	/* Blank last line. */
-	for (; p < video + VIDEO_HIGH*VIDEO_WIDTH; p++)
-		*p = (BLACK << 8) | (' ');
+	console_blank(SCREEN + (VIDEO_HIGH - 1)*VIDEO_WIDTH, VIDEO_WIDTH);
 		
 	/* Set cursor position. */
 	cursor.x = 0; cursor.y = VIDEO_HIGH - 1;
 }
 
 /*
- * Outputs a colored ASCII character on the console device.
+ * Renders a colored ASCII character on the screen, without
+ * updating the hardware cursor and screen window.
  */
-PUBLIC void console_put(uint8_t ch, uint8_t color)
+PRIVATE void console_render(uint8_t ch, uint8_t color)
 {
-	((void)color);
-	((void)console_scrolldown);
-
-#ifdef VGA_ENABLE
 	/* Parse character. */
     switch (ch)
     {
@@ -139,12 +183,12 @@ PUBLIC void console_put(uint8_t ch, uint8_t color)
                 cursor.x = VIDEO_WIDTH - 1;
                 cursor.y--;
             }
-            video[cursor.y*VIDEO_WIDTH +cursor.x] = (color << 8) | (' ');
+            SCREEN[cursor.y*VIDEO_WIDTH +cursor.x] = (color << 8) | (' ');
             break;			
         
         /* Any other. */
         default:
-            video[cursor.y*VIDEO_WIDTH +cursor.x] = (color << 8) | (ch);
+            SCREEN[cursor.y*VIDEO_WIDTH +cursor.x] = (color << 8) | (ch);
             cursor.x++;
             break;
     }
@@ -157,7 +201,31 @@ PUBLIC void console_put(uint8_t ch, uint8_t color)
     }
     if (cursor.y >= VIDEO_HIGH)
         console_scrolldown();
-    cursor_move();
+}
+
+/*
+ * Updates the hardware cursor and screen window.
+ */
+PRIVATE void console_update(void)
+{
+	if (origin != hw_origin)
+		origin_move();
+
+	cursor_move();
+}
+
+/*
+ * Outputs a colored ASCII character on the console device.
+ */
+PUBLIC void console_put(uint8_t ch, uint8_t color)
+{
+	((void)color);
+	((void)console_render);
+	((void)console_update);
+
+#ifdef VGA_ENABLE
+	console_render(ch, color);
+	console_update();
 #endif
 
 #ifdef SERIAL_ENABLE
@@ -171,33 +239,47 @@ PUBLIC void console_put(uint8_t ch, uint8_t color)
  */
 PUBLIC void console_clear(void)
 {
-	uint16_t *p;
-	
 	/* Blank all lines. */
-	for (p = video; p < (video + VIDEO_HIGH*VIDEO_WIDTH); p++)
-		*p = (BLACK << 8) | (' ');
+	origin = 0;
+	console_blank(video, VIDEO_HIGH*VIDEO_WIDTH);
 	
 	/* Set console cursor position. */
 	cursor.x = cursor.y = 0;
+	origin_move();
 	cursor_move();
 }
 
 /*
  * Flushes a buffer on the console device.
+ *
+ * The whole buffer is rendered before the hardware
+ * cursor and screen window are updated, at once.
  */
 PUBLIC void console_write(struct kbuffer *buffer)
 {
 	uint8_t ch;
+
+	if (KBUFFER_EMPTY((*buffer)))
+		return;
 	
 	/* Outputs all characters. */
 	while (!KBUFFER_EMPTY((*buffer)))
 	{ 
 		KBUFFER_GET((*buffer), ch);
-	
-		console_put(ch, WHITE);
+
+#ifdef VGA_ENABLE
+		console_render(ch, WHITE);
+#endif
+
+#ifdef SERIAL_ENABLE
+		uart8250_write(ch);
+#endif
 	}
-}
 
+#ifdef VGA_ENABLE
+	console_update();
+#endif
+}
 /*
  * Initializes the console driver.
  */
@@ -28,6 +28,7 @@
 #include <nanvix/pm.h>
 #include <nanvix/syscall.h>
 #include <errno.h>
+#include <poll.h>
 #include <termios.h>
 #include <stropts.h>
 #include "tty.h"
@@ -91,6 +92,12 @@ PUBLIC void tty_int(unsigned char ch)
 				goto out1;
 		}
 		
+		/*
+		 * Interrupt handlers run with interrupts enabled,
+		 * but the console must not be preempted.
+		 */
+		disable_interrupts();
+
 		/* Non-printable characters. */
 		if ((ch < 32) && (ch != '\n') && (ch != '\t'))
 		{
@@ -102,6 +109,8 @@ PUBLIC void tty_int(unsigned char ch)
 		/* Any character. */
 		else
 			console_put(ch, WHITE);
+
+		enable_interrupts();
 	}
 	
 	/*
@@ -133,6 +142,7 @@ PUBLIC void tty_int(unsigned char ch)
 		{
 			active->flags &= ~TTY_STOPPED;
 			wakeup(&active->output.chain);
+			selwakeup(&active->sel);
 			return;
 		}
 		
@@ -155,6 +165,7 @@ out1:
 	KBUFFER_PUT(active->rinput, ch);
 out0:
 	wakeup(&active->rinput.chain);
+	selwakeup(&active->sel);
 }
 
 /**
@@ -231,6 +242,10 @@ PRIVATE ssize_t tty_write(unsigned minor, const char *buf, size_t n)
 	
 	UNUSED(minor);
 	
+	/* Characters are read in place. */
+	if (pin_user(buf, n, 0))
+		return (-EFAULT);
+	
 	p = buf;
 	
 	/* Write n characters. */
@@ -283,6 +298,10 @@ PRIVATE ssize_t tty_read(unsigned minor, char *buf, size_t n)
 	
 	UNUSED(minor);
 	
+	/* Characters are written in place. */
+	if (pin_user(buf, n, 1))
+		return (-EFAULT);
+	
 	i = n;
 	p = (unsigned char *)buf;
 	
@@ -423,6 +442,73 @@ out:
 	return ((ssize_t)((char *)p - buf));
 }
 
+/**
+ * @brief Asserts if a TTY device may be read without blocking.
+ *
+ * @details In canonical mode, a read blocks until a whole line is
+ *          available, so the raw input buffer is looked up for a line
+ *          delimiter. In non-canonical mode, any input will do.
+ *
+ * @param ttyp TTY device to check.
+ *
+ * @returns Non-zero if the TTY device is readable, and zero otherwise.
+ */
+PRIVATE int tty_readable(struct tty *ttyp)
+{
+	unsigned char ch; /* Working character. */
+	
+	/* Non canonical mode. */
+	if (!(ttyp->term.c_lflag & ICANON))
+		return (!KBUFFER_EMPTY(ttyp->rinput) || (MIN_CHAR(ttyp->term) == 0));
+	
+	/* Leftovers of a line. */
+	if (!KBUFFER_EMPTY(ttyp->cinput))
+		return (1);
+	
+	/* Whole line. */
+	for (unsigned i = ttyp->rinput.head; i != ttyp->rinput.tail; i = (i + 1)&(KBUFFER_SIZE - 1))
+	{
+		ch = ttyp->rinput.buffer[i];
+		
+		if ((ch == '\n') || (ch == EOL_CHAR(ttyp->term)) || (ch == EOF_CHAR(ttyp->term)))
+			return (1);
+	}
+	
+	return (0);
+}
+
+/**
+ * @brief Polls a TTY device.
+ * 
+ * @details Checks which of the @p events are ready on the TTY device which
+ *          minor device number is @p minor.
+ * 
+ * @param minor  Minor device number of target TTY device.
+ * @param events Events of interest.
+ * 
+ * @returns The events that are ready.
+ */
+PRIVATE int tty_poll(unsigned minor, int events)
+{
+	int revents = 0;
+	
+	UNUSED(minor);
+	
+	disable_interrupts();
+	
+	if ((events & POLLIN) && (tty_readable(&tty)))
+		revents |= POLLIN;
+	if ((events & POLLOUT) && (!KBUFFER_FULL(tty.output)))
+		revents |= POLLOUT;
+	
+	if (revents == 0)
+		selrecord(&tty.sel);
+	
+	enable_interrupts();
+	
+	return (revents);
+}
+
 /*
  * Opens a tty device.
  */
@@ -562,7 +648,8 @@ PRIVATE struct cdev tty_driver = {
 	&tty_read,  /* read().  */
 	&tty_write, /* write(). */
 	&tty_ioctl, /* ioctl(). */
-	&tty_close  /* ioctl(). */
+	&tty_close, /* close(). */
+	&tty_poll   /* poll().  */
 };
 
 /**
@@ -595,6 +682,8 @@ PUBLIC void tty_init(void)
 	KBUFFER_INIT(tty.output);
 	KBUFFER_INIT(tty.cinput);
 	KBUFFER_INIT(tty.rinput);
+	tty.sel.proc = NULL;
+	tty.sel.collision = 0;
 	tty.term.c_lflag = ICANON | ECHO | ISIG;
 	for (unsigned i = 0; i < NCCS; i++)
 		tty.term.c_cc[i] = init_c_cc[i];
@@ -62,6 +62,7 @@
 		struct kbuffer output; /**< Output buffer.       */
 		struct kbuffer rinput; /**< Cooked input buffer. */
 		struct kbuffer cinput; /**< Raw input buffer.    */
+		struct selinfo sel;    /**< Polling.             */
 	};
 	
 	/**
@@ -17,6 +17,7 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <dev/trace.h>
 #include <nanvix/const.h>
 #include <nanvix/dev.h>
 #include <nanvix/fs.h>
@@ -24,6 +25,7 @@
 #include <nanvix/klib.h>
 #include <nanvix/mm.h>
 #include <nanvix/pm.h>
+#include <nanvix/spinlock.h>
 #include "fs.h"
 
 /*
@@ -65,7 +67,8 @@ enum buffer_flags
 	BUFFER_DIRTY  = (1 << 0), /**< Dirty?             */
 	BUFFER_VALID  = (1 << 1), /**< Valid?             */
 	BUFFER_LOCKED = (1 << 2), /**< Locked?            */
-	BUFFER_SYNC   = (1 << 3)  /**< Synchronous write? */
+	BUFFER_SYNC   = (1 << 3), /**< Synchronous write? */
+	BUFFER_ASYNC  = (1 << 4)  /**< Asynchronous read? */
 };
 
 /**
@@ -127,6 +130,25 @@ PRIVATE struct process *chain = NULL;
  */
 PRIVATE struct buffer hashtab[BUFFERS_HASHTAB_SIZE];
 
+/**
+ * @brief Block buffer cache lock.
+ *
+ * @details Protects the hash table, the free list, and the reference
+ *          counters and flags of all block buffers. Interrupt handlers
+ *          release buffers, so it is a spinlock.
+ */
+PRIVATE struct spinlock cache_lock = SPINLOCK_INITIALIZER;
+
+/**
+ * @brief Block reads served from the block buffer cache.
+ */
+PUBLIC unsigned buffer_hits = 0;
+
+/**
+ * @brief Block reads that went to the device.
+ */
+PUBLIC unsigned buffer_misses = 0;
+
 /**
  * @brief Sets/clears buffer's dirty flag.
  * 
@@ -210,6 +232,40 @@ PUBLIC inline int buffer_is_sync(const struct buffer *buf)
 	return (buf->flags & BUFFER_SYNC);
 }
 
+/**
+ * @brief Asserts if a block buffer is marked as asynchronous read.
+ * 
+ * @details Asserts if the block buffer pointed to by buf is marked as
+ * asynchronous read.
+ * 
+ * @param buf Buffer to be asserted.
+ * 
+ * @returns Non-zero if the buffer is marked as asynchronous read, and
+ * zero otherwise.
+ * 
+ * @note The buffer must be locked.
+ */
+PUBLIC inline int buffer_is_async(const struct buffer *buf)
+{
+	return (buf->flags & BUFFER_ASYNC);
+}
+
+/**
+ * @brief Asserts if a block buffer holds valid data.
+ * 
+ * @details Asserts if the block buffer pointed to by buf holds the
+ * data of its block, that is, if it is not waiting for a read to
+ * complete.
+ * 
+ * @param buf Buffer to be asserted.
+ * 
+ * @returns Non-zero if the buffer is valid, and zero otherwise.
+ */
+PUBLIC inline int buffer_is_valid(const struct buffer *buf)
+{
+	return (buf->flags & BUFFER_VALID);
+}
+
 /**
  * @brief Increments reference counter of a block buffer. 
  *
@@ -232,6 +288,31 @@ PUBLIC void buffer_share(struct buffer *buf)
 #define HASH(dev, block) \
 	(((dev)^(block))%BUFFERS_HASHTAB_SIZE)
 
+/**
+ * @brief Locks a block buffer, with the cache lock held.
+ *
+ * @param buf Block buffer to be locked.
+ */
+PRIVATE void _blklock(struct buffer *buf)
+{
+	/* Wait for block buffer to become unlocked. */
+	while (buf->flags & BUFFER_LOCKED)
+		sleep_locked(&buf->chain, PRIO_BUFFER, &cache_lock);
+
+	buf->flags |= BUFFER_LOCKED;
+}
+
+/**
+ * @brief Unlocks a block buffer, with the cache lock held.
+ *
+ * @param buf Block buffer to be unlocked.
+ */
+PRIVATE void _blkunlock(struct buffer *buf)
+{
+	buf->flags &= ~BUFFER_LOCKED;
+	wakeup(&buf->chain);
+}
+
 /**
  * @brief Gets a block buffer from the block buffer cache.
  * 
@@ -255,12 +336,12 @@ PRIVATE struct buffer *getblk(dev_t dev, block_t num)
 	if ((dev == 0) && (num == 0))
 		kpanic("getblk(0, 0)");
 
+	spinlock_lock(&cache_lock);
+
 repeat:
 
 	i = HASH(dev, num);
 
-	disable_interrupts();
-
 	/* Search in hash table. */
 	for (buf = hashtab[i].hash_next; buf != &hashtab[i]; buf = buf->hash_next)
 	{		
@@ -274,7 +355,7 @@ repeat:
 		 */
 		if (buf->flags & BUFFER_LOCKED)
 		{
-			sleep(&buf->chain, PRIO_BUFFER);
+			sleep_locked(&buf->chain, PRIO_BUFFER, &cache_lock);
 			goto repeat;
 		}
 		
@@ -285,8 +366,8 @@ repeat:
 			buf->free_next->free_prev = buf->free_prev;
 		}
 		
-		blklock(buf);
-		enable_interrupts();
+		_blklock(buf);
+		spinlock_unlock(&cache_lock);
 		
 		return (buf);
 	}
@@ -298,7 +379,7 @@ repeat:
 	if (&free_buffers == free_buffers.free_next)
 	{
 		kprintf("fs: no free buffers");
-		sleep(&chain, PRIO_BUFFER);
+		sleep_locked(&chain, PRIO_BUFFER, &cache_lock);
 		goto repeat;
 	}
 	
@@ -314,9 +395,10 @@ repeat:
 	 */
 	if (buf->flags & BUFFER_DIRTY)
 	{
-		blklock(buf);
-		enable_interrupts();
+		_blklock(buf);
+		spinlock_unlock(&cache_lock);
 		bwrite(buf);
+		spinlock_lock(&cache_lock);
 		goto repeat;
 	}
 	
@@ -335,8 +417,8 @@ repeat:
 	buf->hash_next = hashtab[i].hash_next;
 	hashtab[i].hash_next = buf;
 	
-	blklock(buf);
-	enable_interrupts();
+	_blklock(buf);
+	spinlock_unlock(&cache_lock);
 	
 	return (buf);
 }
@@ -352,15 +434,9 @@ repeat:
  */
 PUBLIC void blklock(struct buffer *buf)
 {
-	disable_interrupts();
-	
-	/* Wait for block buffer to become unlocked. */
-	while (buf->flags & BUFFER_LOCKED)
-		sleep(&buf->chain, PRIO_BUFFER);
-		
-	buf->flags |= BUFFER_LOCKED;
-
-	enable_interrupts();
+	spinlock_lock(&cache_lock);
+	_blklock(buf);
+	spinlock_unlock(&cache_lock);
 }
 
 /**
@@ -375,12 +451,9 @@ PUBLIC void blklock(struct buffer *buf)
  */
 PUBLIC void blkunlock(struct buffer *buf)
 {
-	disable_interrupts();
-
-	buf->flags &= ~BUFFER_LOCKED;
-	wakeup(&buf->chain);
-
-	enable_interrupts();
+	spinlock_lock(&cache_lock);
+	_blkunlock(buf);
+	spinlock_unlock(&cache_lock);
 }
 
 /**
@@ -395,7 +468,7 @@ PUBLIC void blkunlock(struct buffer *buf)
  */
 PUBLIC void brelse(struct buffer *buf)
 {
-	disable_interrupts();
+	spinlock_lock(&cache_lock);
 	
 	/* Double free. */
 	if (buf->count == 0)
@@ -429,8 +502,8 @@ PUBLIC void brelse(struct buffer *buf)
 		}
 	}
 
-	blkunlock(buf);
-	enable_interrupts();
+	_blkunlock(buf);
+	spinlock_unlock(&cache_lock);
 }
 
 /**
@@ -458,7 +531,13 @@ PUBLIC struct buffer *bread(dev_t dev, block_t num)
 	
 	/* Valid buffer? */
 	if (buf->flags & BUFFER_VALID)
+	{
+		buffer_hits++;
 		return (buf);
+	}
+
+	buffer_misses++;
+	TRACE(TRACE_BREAD_MISS, dev, num, 0);
 
 	bdev_readblk(buf);
 	
@@ -469,6 +548,123 @@ PUBLIC struct buffer *bread(dev_t dev, block_t num)
 	return (buf);
 }
 
+/**
+ * @brief Reads a block from a device asynchronously.
+ * 
+ * @details Starts reading the block numbered num from the device
+ *          numbered dev, and returns without waiting for the read to
+ *          complete. The device driver completes the read with
+ *          bdone(), possibly from an interrupt handler, and bwait()
+ *          waits for that to happen.
+ * 
+ * @param dev Device number.
+ * @param num Block number.
+ * 
+ * @returns A pointer to a buffer for the requested block. The block
+ *          buffer is referenced, but it is not locked, and it becomes
+ *          valid once the read completes.
+ * 
+ * @note The device number should be valid.
+ * @note The block number should be valid.
+ */
+PUBLIC struct buffer *breada(dev_t dev, block_t num)
+{
+	struct buffer *buf;
+	
+	buf = getblk(dev, num);
+	
+	/* Valid buffer? */
+	if (buf->flags & BUFFER_VALID)
+	{
+		buffer_hits++;
+		blkunlock(buf);
+		return (buf);
+	}
+
+	buffer_misses++;
+	TRACE(TRACE_BREAD_MISS, dev, num, 0);
+
+	buf->flags |= BUFFER_ASYNC;
+	bdev_readblk(buf);
+	
+	return (buf);
+}
+
+/**
+ * @brief Completes an asynchronous read.
+ * 
+ * @details Marks the block buffer pointed to by buf as valid and
+ *          unlocks it, waking up processes that were waiting for it.
+ *          The reference taken by breada() is kept.
+ * 
+ * @param buf Block buffer that has just been read.
+ * 
+ * @note The block buffer must be locked.
+ */
+PUBLIC void bdone(struct buffer *buf)
+{
+	spinlock_lock(&cache_lock);
+	
+	buf->flags |= BUFFER_VALID;
+	buf->flags &= ~(BUFFER_DIRTY | BUFFER_ASYNC);
+	_blkunlock(buf);
+	
+	spinlock_unlock(&cache_lock);
+}
+
+/**
+ * @brief Waits for an asynchronous read to complete.
+ * 
+ * @param buf Block buffer returned by breada().
+ */
+PUBLIC void bwait(struct buffer *buf)
+{
+	spinlock_lock(&cache_lock);
+	
+	while (!(buf->flags & BUFFER_VALID))
+		sleep_locked(&buf->chain, PRIO_BUFFER, &cache_lock);
+	
+	spinlock_unlock(&cache_lock);
+}
+
+/**
+ * @brief Asserts if a block is in the block buffer cache.
+ *
+ * @details Memory-backed devices may be accessed directly, bypassing the
+ *          block buffer cache. This is only safe for blocks that are not
+ *          cached, because a cached copy may be more recent than the one
+ *          in the device.
+ *
+ * @param dev Device number.
+ * @param num Block number.
+ *
+ * @returns Non-zero if the block is cached, and zero otherwise.
+ */
+PUBLIC int bcached(dev_t dev, block_t num)
+{
+	unsigned i;         /* Hash table index. */
+	struct buffer *buf; /* Buffer.           */
+	int cached = 0;     /* Block cached?     */
+
+	spinlock_lock(&cache_lock);
+
+	i = HASH(dev, num);
+
+	/* Search in hash table. */
+	for (buf = hashtab[i].hash_next; buf != &hashtab[i]; buf = buf->hash_next)
+	{
+		if ((buf->dev == dev) && (buf->num == num))
+		{
+			cached = 1;
+			break;
+		}
+	}
+
+	spinlock_unlock(&cache_lock);
+
+	return (cached);
+}
+
 /**
  * @brief Writes a block buffer to the underlying device.
  * 
@@ -522,13 +718,13 @@ PUBLIC void bsync(void)
 		 * Prevent double free, since a call
 		 * to brelse() will follow.
 		 */
-		disable_interrupts();
+		spinlock_lock(&cache_lock);
 		if (buf->count++ == 0)
 		{
 			buf->free_prev->free_next = buf->free_next;
 			buf->free_next->free_prev = buf->free_prev;
 		}
-		enable_interrupts();
+		spinlock_unlock(&cache_lock);
 		
 		/*
 		 * This will cause the buffer to be
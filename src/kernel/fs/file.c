@@ -23,6 +23,7 @@
 #include <nanvix/const.h>
 #include <nanvix/fs.h>
 #include <nanvix/klib.h>
+#include <nanvix/region.h>
 #include <sys/types.h>
 #include <dirent.h>
 #include <errno.h>
@@ -103,11 +104,146 @@ PUBLIC ssize_t file_write(struct inode *i, const void *buf, size_t n, off_t off)
 	return retour;
 }
 
+/*
+ * Reads from a regular file into a vector of buffers.
+ */
+PUBLIC ssize_t file_readv(struct inode *i, const struct iovec *iov, int iovcnt, off_t off)
+{
+	ssize_t count;     /* Bytes read in a step. */
+	ssize_t total = 0; /* Total bytes read.     */
+	
+	/* Check if the operation is valid */
+	if (!i || !i->i_op || !i->i_op->file_read)
+		return 0;
+	inode_lock(i);
+	for (int j = 0; j < iovcnt; j++)
+	{
+		if (iov[j].iov_len == 0)
+			continue;
+		
+		count = i->i_op->file_read(i, iov[j].iov_base, iov[j].iov_len, off);
+		
+		/* Failed to read. */
+		if (count < 0)
+		{
+			if (total == 0)
+				total = count;
+			break;
+		}
+		
+		total += count;
+		off += count;
+		
+		/* End of file reached. */
+		if ((size_t)count < iov[j].iov_len)
+			break;
+	}
+	inode_touch(i);
+	inode_unlock(i);
+	return total;
+}
+
+/*
+ * Writes to a regular file from a vector of buffers.
+ */
+PUBLIC ssize_t file_writev(struct inode *i, const struct iovec *iov, int iovcnt, off_t off)
+{
+	ssize_t count;     /* Bytes written in a step. */
+	ssize_t total = 0; /* Total bytes written.     */
+	
+	/* Check if the operation is valid */
+	if (!i || !i->i_op || !i->i_op->file_write)
+		return 0;
+	
+	/* Blocks are mapped in place. */
+	if (ismapped(i))
+	{
+		curr_proc->errno = -EBUSY;
+		return (-1);
+	}
+	
+	inode_lock(i);
+	for (int j = 0; j < iovcnt; j++)
+	{
+		if (iov[j].iov_len == 0)
+			continue;
+		
+		count = i->i_op->file_write(i, iov[j].iov_base, iov[j].iov_len, off);
+		
+		/* Failed to write. */
+		if (count < 0)
+		{
+			if (total == 0)
+				total = count;
+			break;
+		}
+		
+		total += count;
+		off += count;
+		
+		/* File system full. */
+		if ((size_t)count < iov[j].iov_len)
+			break;
+	}
+	inode_touch(i);
+	inode_unlock(i);
+	return total;
+}
+
+/*
+ * Maps a page of a regular file.
+ */
+PUBLIC void *file_map(struct inode *i, off_t off)
+{
+	/* Check if the operation is valid */
+	if (!i || !i->i_op || !i->i_op->file_map)
+		return (NULL);
+	inode_lock(i);
+	void *kpg = i->i_op->file_map(i, off);
+	inode_unlock(i);
+	return (kpg);
+}
+
+/*
+ * Asserts if the size of a regular file tells how much data it holds.
+ */
+PUBLIC int file_sized(struct inode *i)
+{
+	return (!(i->sb->fs->flags & FS_NOSIZE));
+}
+
+/*
+ * Reads the block of a regular file that holds a given offset.
+ */
+PUBLIC struct buffer *file_bread(struct inode *i, off_t off)
+{
+	/* Check if the operation is valid */
+	if (!i || !i->i_op || !i->i_op->file_bread)
+		return (NULL);
+	inode_lock(i);
+	struct buffer *buf = i->i_op->file_bread(i, off);
+	inode_unlock(i);
+	return (buf);
+}
+
+/*
+ * Starts reading the block of a regular file that holds a given offset.
+ */
+PUBLIC struct buffer *file_breada(struct inode *i, off_t off)
+{
+	/* Check if the operation is valid */
+	if (!i || !i->i_op || !i->i_op->file_breada)
+		return (NULL);
+	inode_lock(i);
+	struct buffer *buf = i->i_op->file_breada(i, off);
+	inode_unlock(i);
+	return (buf);
+}
+
 PUBLIC ino_t dir_search(struct inode *ip, const char *filename)
 {
-	struct buffer *buf; /* Block buffer.    */
-	struct d_dirent *d; /* Directory entry. */
-	int i;
+	ino_t num; /* Inode number.          */
+	int i = 0; /* Crossed a mount point? */
 
 	/* Cross mount point*/
 	if ((ip->flags & INODE_MOUNT) && (kstrcmp (filename,"..")) )
@@ -123,14 +259,10 @@ PUBLIC ino_t dir_search(struct inode *ip, const char *filename)
 	}
 	
 	/* Search directory entry. */
-	d = ip->i_op->dirent_search(ip,filename, &buf, 0);
+	num = ip->i_op->dir_search(ip, filename);
 
-	if (d == NULL)
-		return (INODE_NULL);
-	
-	brelse(buf);
 	if (i == 1)
 		inode_unlock(ip);
 	
-	return (d->d_ino);
+	return (num);
 }
\ No newline at end of file
@@ -25,12 +25,9 @@
 #include <nanvix/pm.h>
 #include <dirent.h>
 #include <errno.h>
+#include <limits.h>
 #include "fs.h"
 
-#if NR_FILES < OPEN_MAX*NR_PROCS
-	#error "file table too big"
-#endif
-
 /*
  * Root device.
  */
@@ -42,9 +39,9 @@ PUBLIC struct superblock *rootdev = NULL;
 PUBLIC struct inode *root = NULL;
 
 /*
- * File table.
+ * File cache.
  */
-PUBLIC struct file filetab[NR_FILES];
+PRIVATE struct kcache *file_cache = NULL;
 
 /*
  * Gets an empty file descriptor table entry.
@@ -65,24 +62,66 @@ PUBLIC int getfildes(void)
 }
 
 /*
- * Gets an empty file table entry.
+ * Gets an empty file.
  */
 PUBLIC struct file *getfile(void)
 {
 	struct file *f;
 	
-	/* Look for empty file table entry. */
-	for (f = &filetab[0]; f < &filetab[NR_FILES]; f++)
+	if ((f = kcache_alloc(file_cache)) == NULL)
+		return (NULL);
+	
+	f->count = 0;
+	
+	return (f);
+}
+
+/*
+ * Puts back a file.
+ */
+PUBLIC void putfile(struct file *f)
+{
+	kcache_free(file_cache, f);
+}
+
+
+/*
+ * Checks an I/O vector. Buffers are only range checked here, since
+ * data is moved with copy_to_user() and copy_from_user() later on.
+ */
+PUBLIC ssize_t chkiov(const struct iovec *iov, int iovcnt)
+{
+	size_t total; /* Total size. */
+	
+	/* Invalid vector size. */
+	if ((iovcnt <= 0) || (iovcnt > IOV_MAX))
+		return (-EINVAL);
+	
+	/* Invalid vector. */
+	if (!chkmem(iov, iovcnt*sizeof(struct iovec), MAY_READ))
+		return (-EFAULT);
+	
+	total = 0;
+	for (int i = 0; i < iovcnt; i++)
 	{
-		/* Found. */
-		if (f->count == 0)
-			return (f);
+		/* Empty buffer. */
+		if (iov[i].iov_len == 0)
+			continue;
+		
+		/* Invalid buffer. */
+		if (!chkuser(iov[i].iov_base, iov[i].iov_len))
+			return (-EFAULT);
+		
+		total += iov[i].iov_len;
+		
+		/* Total size overflows. */
+		if ((total < iov[i].iov_len) || ((ssize_t)total < 0))
+			return (-EINVAL);
 	}
 	
-	return (NULL);
+	return ((ssize_t)total);
 }
 
-
 /*
  * Closes a file.
  */
@@ -103,7 +142,15 @@ PUBLIC void do_close(int fd)
 	if (--f->count)
 		return;
 	
-	inode_lock(i = f->inode);
+	i = f->inode;
+	putfile(f);
+	
+	inode_lock(i);
+	
+	/* Tell pollers that this end is gone. */
+	if (S_ISFIFO(i->mode))
+		selwakeup(&i->sel);
+	
 	inode_put(i);
 }
 
@@ -138,42 +185,22 @@ PUBLIC mode_t permission(mode_t mode, uid_t uid, gid_t gid, struct process *proc
  */
 PUBLIC char *getname(const char *name)
 {
-	int ch;        /* Temporary character. */
-	char *kname;   /* Kernel user name.    */
-	const char *r; /* Read pointer.        */
-	char *w;       /* Write pointer.       */
+	ssize_t ret; /* Return value.     */
+	char *kname; /* Kernel user name. */
 	
-	/* Grab a kernel page. */
-	if ((kname = getkpg(0)) == NULL)
+	if ((kname = kmalloc(PATH_MAX)) == NULL)
 	{
 		curr_proc->errno = -ENOMEM;
 		return (NULL);
 	}
 
 	/* Copy user file name. */
-	for (r = name, w = kname; (ch = fubyte(r)) != '\0'; r++, w++)
-	{	
-		/* Bad user file name. */
-		if (ch < 0)
-		{
-			putkpg(kname);
-			curr_proc->errno = -EFAULT;
-			return (NULL);
-			
-		}
-		
-		/* File name too long. */
-		if ((w - kname) > PAGE_SIZE - 1)
-		{
-			putkpg(kname);
-			curr_proc->errno = -ENAMETOOLONG;
-			return (NULL);
-		}
-		
-		*w = ch;
+	if ((ret = strncpy_from_user(kname, name, PATH_MAX)) < 0)
+	{
+		kfree(kname);
+		curr_proc->errno = ret;
+		return (NULL);
 	}
-
-	*w = '\0';
 	
 	return (kname);
 }
@@ -183,7 +210,7 @@ PUBLIC char *getname(const char *name)
  */
 PUBLIC void putname(char *name)
 {
-	putkpg(name);
+	kfree(name);
 }
 
 /*
@@ -191,19 +218,22 @@ PUBLIC void putname(char *name)
  */
 PUBLIC void fs_init(void)
 {
+	file_cache = kcache_create("file", sizeof(struct file), 0, NULL);
+	if (file_cache == NULL)
+		kpanic("fs: cannot create file cache");
+	
 	binit();
 	inode_init();
 	superblock_init();
 	
-	/* Sanity check. */
-	CHKSIZE(sizeof(struct d_dirent), sizeof(struct dirent));
-	mountRoot();
 	rootdev = superblock_read(ROOT_DEV);
 	
 	/* Failed to read root super block. */
 	if (rootdev == NULL)
 		kpanic("Failed to mount root file system");
-		
+	
+	mountRoot(rootdev->fs);
+	
 	superblock_unlock(rootdev);
 	
 	root = inode_get(ROOT_DEV, 1);
@@ -79,6 +79,9 @@
 
   typedef struct superblock superblock;
 
+  /* Forward definitions. */
+  struct tmpfs;
+
   /**
    *@brief In-core superblock operations.
    */
@@ -119,8 +122,11 @@
     block_t zsearch;                /**< Zones below this are in use.  */
     struct process *chain;          /**< Waiting chain.                */
     struct super_operations *s_op;  /**< Super operation of filesystem */
+    struct file_system_type *fs;    /**< File system.                  */
     union {
     	struct d_superblock minix;
+    	struct d_superblock_v3 minix3;
+    	struct tmpfs *tmpfs;
     } u;
   };
 
@@ -128,6 +134,12 @@
  *                       Virtual File System  Library                         *
  *============================================================================*/
   
+  /**
+   * @brief File system flags.
+   */
+  #define FS_NODEV  (1 << 0) /**< Not backed by a block device.     */
+  #define FS_NOSIZE (1 << 1) /**< File sizes do not tell contents. */
+
   /**
    * @brief File system of the virtual file system.
    */
@@ -135,6 +147,7 @@
     struct superblock *(*superblock_read) (dev_t, struct superblock *);  /**< Function to read the superblock        */
     struct super_operations *so;                                         /**< Stucture of file system's functio      */
     char *name;                                                          /**< Name of the file system                */
+    int flags;                                                           /**< File system flags                      */
   };
 
   /**
@@ -152,23 +165,27 @@
   /**
    * @brief Number of the file system.
    */
-  #define MINIX 0
+  #define MINIX  0 /**< Minix v1. */
+  #define MINIX3 1 /**< Minix v3. */
+  #define TMPFS  2 /**< tmpfs.    */
+  #define PROCFS 3 /**< procfs.   */
   
   /**
    * @brief Maximum nunber of file system.
    */
-  #define NR_FILE_SYSTEM 1
+  #define NR_FILE_SYSTEM 4
 
   /**
    * @brief Function too register file system in the virtual file system .
    */
   PUBLIC int fs_register( int nb , struct file_system_type *fs );
+  PUBLIC struct file_system_type *fs_get(int);
 
 	  /**
    * @brief add the ROOT_DEV in the mount table.
    */
   //PUBLIC struct inode * mountRoot ();
-  PUBLIC void mountRoot();
+  PUBLIC void mountRoot(struct file_system_type *);
   PUBLIC struct file_system_type *fs_from_device (dev_t);
   /**@}*/
 
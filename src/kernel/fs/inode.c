@@ -35,6 +35,9 @@
 #include <nanvix/syscall.h>
 #include "fs.h"
 #include "minix/minix.h"
+#include "minix3/minix3.h"
+#include "tmpfs/tmpfs.h"
+#include "procfs/procfs.h"
 
 #include <sys/fcntl.h>
 
@@ -57,6 +60,12 @@ PRIVATE struct inode *free_inodes = NULL;
 /* Inodes hash table. */
 PRIVATE struct inode *hashtab[HASHTAB_SIZE];
 
+/* Inode lookups served from the inode cache. */
+PUBLIC unsigned inode_hits = 0;
+
+/* Inode lookups that went to the file system. */
+PUBLIC unsigned inode_misses = 0;
+
 /* File system's table.	*/
 PRIVATE struct file_system_type *file_system_table [NR_FILE_SYSTEM] = {
 	NULL
@@ -91,6 +100,21 @@ PUBLIC int fs_register( int nb , struct file_system_type *fs )
 	return (0);
 }
 
+/**
+ * @brief Gets a file system from the file_system_table.
+ *
+ * @details Gets the file sytem at the index nb of the file_system_table.
+ *
+ * @returns The file system, or NULL if there is none at that index.
+ */
+PUBLIC struct file_system_type *fs_get(int nb)
+{
+	if ((nb < 0) || (nb >= NR_FILE_SYSTEM))
+		return (NULL);
+	
+	return (file_system_table[nb]);
+}
+
 /**
  * @brief Found a free spot in the mouting table.
  * 
@@ -337,21 +361,13 @@ PUBLIC int mount (char *device, char *mountPoint)
 	}
 
 	/* Search which file system is on the device */
-	for (int i = 0; i < NR_FILE_SYSTEM; i++){
-		if (file_system_table[i] != NULL)
-		{
-			sb = superblock_read (dev); 
-			if (sb != NULL)
-			{
-				fs = file_system_table[i];
-				goto found;
-			}
-		}
+	sb = superblock_read (dev);
+	if (sb == NULL)
+	{
+		kprintf ("The file system of the device is not recognized.");
+		goto error1;
 	}
-	kprintf ("The file system of the device is not recognized.");
-	goto error1;
-
-found:
+	fs = sb->fs;
 
 	/* Insert the mouting point in the mount table */
 	mount_table[ind_mp].dev = dev;
@@ -745,10 +761,6 @@ PUBLIC struct inode *inode_alloc(struct superblock *sb)
 		kpanic("No super operation in the superblock.");
 	}
 
-	/* Allocate inode. */
-	if (inode_alloc_minix(sb,ip))
-		return (NULL);
-	
 	/* Operation not supported. */
 	if (sb->s_op->inode_alloc == NULL)
 		kpanic("Operation not supported by the file system.");
@@ -803,10 +815,13 @@ repeat:
 		
 		ip->count++;
 		inode_lock(ip);
+		inode_hits++;
 		
 		return (ip);
 	}
 	
+	inode_misses++;
+	
 	/* Read inode. */
 	fs = fs_from_device(dev);
 	if (fs == NULL)
@@ -916,6 +931,8 @@ PUBLIC struct inode *inode_pipe(void)
 	inode->pipe = pipe;
 	inode->head = 0;
 	inode->tail = 0;
+	inode->sel.proc = NULL;
+	inode->sel.collision = 0;
 	
 	return (inode);
 
@@ -1274,10 +1291,10 @@ PRIVATE void init_mount_table(void)
  * @brief put the ROOTDEV in the mountable. 
  * 		  Need to be done only once, at the initialisation.
  */
-PUBLIC void mountRoot ()
+PUBLIC void mountRoot (struct file_system_type *fs)
 {
 	mount_table[0].dev=ROOT_DEV;
-	mount_table[0].fs= file_system_table[MINIX];
+	mount_table[0].fs= fs;
 	mount_table[0].no_inode_root_fs=1;
 	mount_table[0].no_inode_mount=-1;
 	mount_table[0].free= 0;
@@ -1311,6 +1328,9 @@ PUBLIC void inode_init(void)
 
 	/*Initialize FileSystemTable*/
 	init_minix();
+	init_minix3();
+	init_tmpfs();
+	init_procfs();
 
 	/*Initialize MountTable*/
 	init_mount_table();
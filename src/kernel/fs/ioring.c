@@ -0,0 +1,561 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <nanvix/syscall.h>
+#include <sys/ioring.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+
+/**
+ * @brief Maximum number of blocks that an asynchronous read spans.
+ *
+ * @details Longer reads complete short, as they could on a pipe.
+ */
+#define IORING_MAX_BLOCKS 8
+
+/**
+ * @brief Maximum number of blocks in flight per ring.
+ *
+ * @details Blocks stay referenced until their reads are reaped, so
+ * this keeps a single ring from draining the block buffer cache.
+ */
+#define IORING_MAX_INFLIGHT (NR_BUFFERS/8)
+
+/**
+ * @brief Keeps the compiler from reordering accesses to the ring.
+ */
+#define ioring_barrier() __asm__ __volatile__ ("" ::: "memory")
+
+/**
+ * @brief Asynchronous read.
+ */
+struct ioring_op
+{
+	int busy;                                 /**< In use?                */
+	unsigned long user_data;                  /**< As submitted.          */
+	char *buf;                                /**< User buffer.           */
+	size_t len;                               /**< Number of bytes.       */
+	size_t blkoff;                            /**< Offset in first block. */
+	int nblocks;                              /**< Number of blocks.      */
+	struct buffer *blocks[IORING_MAX_BLOCKS]; /**< Blocks being read.     */
+};
+
+/**
+ * @brief Kernel side of an asynchronous I/O ring.
+ */
+struct ioring
+{
+	struct io_ring *ring;                 /**< Shared page.          */
+	int nops;                             /**< Reads in flight.      */
+	int nblocks;                          /**< Blocks in flight.     */
+	struct ioring_op ops[IORING_NR_SQES]; /**< Reads.                */
+};
+
+/**
+ * @brief Posts a completion.
+ *
+ * @param ior       Target ring.
+ * @param user_data Data passed at submission.
+ * @param res       Result of the operation.
+ */
+PRIVATE void ioring_post(struct ioring *ior, unsigned long user_data, ssize_t res)
+{
+	struct io_cqe *cqe;
+	
+	cqe = &ior->ring->cqes[ior->ring->cq_tail & (IORING_NR_CQES - 1)];
+	cqe->user_data = user_data;
+	cqe->res = res;
+	
+	/* Entry must be there before the process sees it. */
+	ioring_barrier();
+	ior->ring->cq_tail++;
+}
+
+/**
+ * @brief Asserts if a ring may take another operation.
+ *
+ * @details Every operation ends up in the completion queue, so
+ * operations in flight and completions that were not consumed yet
+ * must fit in there.
+ *
+ * @param ior Target ring.
+ *
+ * @returns Non-zero if there is room for another operation, and zero
+ * otherwise.
+ */
+PRIVATE int ioring_room(struct ioring *ior)
+{
+	unsigned used;
+	
+	used = ior->ring->cq_tail - ior->ring->cq_head;
+	
+	return ((used <= IORING_NR_CQES) &&
+		(used + ior->nops < IORING_NR_CQES) &&
+		(ior->nops < IORING_NR_SQES));
+}
+
+/**
+ * @brief Finishes an asynchronous read.
+ *
+ * @param ior  Target ring.
+ * @param op   Target read, whose blocks are all in.
+ * @param post Copy data and post completion?
+ */
+PRIVATE void ioring_finish(struct ioring *ior, struct ioring_op *op, int post)
+{
+	char *p;       /* Write pointer.   */
+	size_t n;      /* Bytes left.      */
+	size_t blkoff; /* Block offset.    */
+	ssize_t res;   /* Operation result. */
+	
+	p = op->buf;
+	n = op->len;
+	blkoff = op->blkoff;
+	res = op->len;
+	
+	/*
+	 * The process may have forked since the read was
+	 * submitted, and the kernel ignores write protection,
+	 * so break copy-on-write sharing again.
+	 */
+	if ((post) && (pinupg(ADDR(op->buf), op->len, 1)))
+		res = -EFAULT;
+	
+	for (int k = 0; k < op->nblocks; k++)
+	{
+		size_t chunk;
+		struct buffer *buf;
+		
+		buf = op->blocks[k];
+		chunk = (n < BLOCK_SIZE - blkoff) ? n : BLOCK_SIZE - blkoff;
+		
+		if ((post) && (res >= 0))
+		{
+			if (copy_to_user(p, (char *)buffer_data(buf) + blkoff, chunk))
+				res = -EFAULT;
+		}
+		
+		blklock(buf);
+		brelse(buf);
+		
+		p += chunk;
+		n -= chunk;
+		blkoff = 0;
+	}
+	
+	op->busy = 0;
+	ior->nops--;
+	ior->nblocks -= op->nblocks;
+	
+	if (post)
+		ioring_post(ior, op->user_data, res);
+}
+
+/**
+ * @brief Starts an asynchronous read.
+ *
+ * @details The blocks of the file are read into the block buffer cache
+ * asynchronously, and the data is copied to the process later on, by
+ * ioring_reap(). Holes end the read, as they do for read().
+ *
+ * @param ior Target ring.
+ * @param sqe Submission queue entry.
+ * @param f   Regular file to read from.
+ *
+ * @returns Zero if the operation was consumed, and -EAGAIN if too many
+ * blocks are in flight already.
+ */
+PRIVATE int ioring_read(struct ioring *ior, const struct io_sqe *sqe, struct file *f)
+{
+	int k;                /* Loop index.             */
+	off_t off;            /* File offset.            */
+	size_t len;           /* Bytes to read.          */
+	size_t blkoff;        /* Offset in first block.  */
+	int nblocks;          /* Blocks to read.         */
+	struct inode *i;      /* Underlying inode.       */
+	struct ioring_op *op; /* Working read.           */
+	
+	i = f->inode;
+	off = (sqe->off == -1) ? f->pos : sqe->off;
+	len = sqe->len;
+	
+	/* Invalid offset or buffer. */
+	if ((off < 0) || (!chkmem(sqe->buf, len, MAY_WRITE)))
+	{
+		ioring_post(ior, sqe->user_data, -EINVAL);
+		return (0);
+	}
+	
+	/* Nothing to do. */
+	if ((len == 0) || (off >= i->size))
+	{
+		ioring_post(ior, sqe->user_data, 0);
+		return (0);
+	}
+	
+	if ((off_t)len > i->size - off)
+		len = i->size - off;
+	
+	blkoff = off & (BLOCK_SIZE - 1);
+	nblocks = (blkoff + len + BLOCK_SIZE - 1) >> BLOCK_SIZE_LOG2;
+	if (nblocks > IORING_MAX_BLOCKS)
+	{
+		nblocks = IORING_MAX_BLOCKS;
+		len = (nblocks << BLOCK_SIZE_LOG2) - blkoff;
+	}
+	
+	/* Too many blocks in flight. */
+	if ((ior->nblocks > 0) && (ior->nblocks + nblocks > IORING_MAX_INFLIGHT))
+		return (-EAGAIN);
+	
+	/* Data will be copied without the process around. */
+	if (pinupg(ADDR(sqe->buf), len, 1))
+	{
+		ioring_post(ior, sqe->user_data, -EFAULT);
+		return (0);
+	}
+	
+	for (op = &ior->ops[0]; op->busy; op++)
+		/* noop */ ;
+	
+	for (k = 0; k < nblocks; k++)
+	{
+		op->blocks[k] = file_breada(i, off - blkoff + (k << BLOCK_SIZE_LOG2));
+		
+		/* Hole. */
+		if (op->blocks[k] == NULL)
+			break;
+	}
+	
+	/* Nothing to read. */
+	if (k == 0)
+	{
+		ioring_post(ior, sqe->user_data, 0);
+		return (0);
+	}
+	
+	if (len > (size_t)(k << BLOCK_SIZE_LOG2) - blkoff)
+		len = (k << BLOCK_SIZE_LOG2) - blkoff;
+	
+	op->busy = 1;
+	op->user_data = sqe->user_data;
+	op->buf = sqe->buf;
+	op->len = len;
+	op->blkoff = blkoff;
+	op->nblocks = k;
+	ior->nops++;
+	ior->nblocks += k;
+	curr_proc->flags |= 1 << PROC_AIO;
+	
+	inode_touch(i);
+	if (sqe->off == -1)
+		f->pos = off + len;
+	
+	return (0);
+}
+
+/**
+ * @brief Starts an operation.
+ *
+ * @details Reads from regular files that are kept in block buffers go
+ * asynchronous. Everything else is carried out right away, as the
+ * matching system call would, and completes before this function
+ * returns.
+ *
+ * @param ior Target ring.
+ * @param sqe Submission queue entry.
+ *
+ * @returns Zero if the operation was consumed, and -EAGAIN if it
+ * should be submitted again later.
+ */
+PRIVATE int ioring_start(struct ioring *ior, const struct io_sqe *sqe)
+{
+	ssize_t res;    /* Operation result. */
+	struct file *f; /* File.             */
+	
+	switch (sqe->opcode)
+	{
+		case IORING_OP_NOP:
+			res = 0;
+			break;
+		
+		case IORING_OP_READ:
+			if ((sqe->fd >= 0) && (sqe->fd < OPEN_MAX))
+			{
+				f = curr_proc->ofiles[sqe->fd];
+				
+				if ((f != NULL) && (S_ISREG(f->inode->mode)) &&
+					(f->inode->i_op->file_breada != NULL) &&
+					(ACCMODE(f->oflag) != O_WRONLY))
+					return (ioring_read(ior, sqe, f));
+			}
+			
+			res = (sqe->off == -1) ?
+				sys_read(sqe->fd, sqe->buf, sqe->len) :
+				sys_pread(sqe->fd, sqe->buf, sqe->len, sqe->off);
+			break;
+		
+		case IORING_OP_WRITE:
+			res = (sqe->off == -1) ?
+				sys_write(sqe->fd, sqe->buf, sqe->len) :
+				sys_pwrite(sqe->fd, sqe->buf, sqe->len, sqe->off);
+			break;
+		
+		default:
+			res = -EINVAL;
+			break;
+	}
+	
+	ioring_post(ior, sqe->user_data, res);
+	
+	return (0);
+}
+
+/**
+ * @brief Submits operations from the submission queue.
+ *
+ * @param n Maximum number of operations to submit.
+ *
+ * @returns The number of operations submitted. This may be fewer than
+ * requested, if the queue runs dry, or if completions would not fit
+ * in the completion queue.
+ */
+PUBLIC unsigned ioring_submit(unsigned n)
+{
+	unsigned i;          /* Loop index.               */
+	struct io_sqe sqe;   /* Submission queue entry.   */
+	struct ioring *ior;  /* Ring of calling process.  */
+	
+	ior = curr_proc->ioring;
+	
+	/* Make room. */
+	ioring_reap();
+	
+	for (i = 0; i < n; i++)
+	{
+		/* Submission queue is empty. */
+		if (ior->ring->sq_head == ior->ring->sq_tail)
+			break;
+		
+		/* Completion queue would overflow. */
+		if (!ioring_room(ior))
+			break;
+		
+		/* The process may change the entry at any time. */
+		ioring_barrier();
+		kmemcpy(&sqe,
+			&ior->ring->sqes[ior->ring->sq_head & (IORING_NR_SQES - 1)],
+			sizeof(struct io_sqe));
+		
+		if (ioring_start(ior, &sqe) == -EAGAIN)
+			break;
+		
+		ior->ring->sq_head++;
+	}
+	
+	return (i);
+}
+
+/**
+ * @brief Completes asynchronous reads.
+ *
+ * @details Copies the data of the reads of the calling process whose
+ * blocks are all in, and posts their completions. This runs at the end
+ * of every system call, so that the process may poll the completion
+ * queue without entering the kernel just for that. It may fault and
+ * sleep, so it must not run on the way out of interrupt handlers.
+ */
+PUBLIC void ioring_reap(void)
+{
+	struct ioring *ior; /* Ring of calling process. */
+	
+	ior = curr_proc->ioring;
+	
+	if (ior != NULL)
+	{
+		for (int j = 0; j < IORING_NR_SQES; j++)
+		{
+			struct ioring_op *op = &ior->ops[j];
+			
+			if (!op->busy)
+				continue;
+			
+			/* Still in flight. */
+			for (int k = 0; k < op->nblocks; k++)
+			{
+				if (!buffer_is_valid(op->blocks[k]))
+					goto next;
+			}
+			
+			ioring_finish(ior, op, 1);
+			
+		next:
+			noop();
+		}
+		
+		/* Still waiting for something. */
+		if (ior->nops > 0)
+			return;
+	}
+	
+	curr_proc->flags &= ~(1 << PROC_AIO);
+}
+
+/**
+ * @brief Waits for completions.
+ *
+ * @param n Number of completions to wait for.
+ *
+ * @details Returns early if nothing is in flight, as then no more
+ * completions will come.
+ */
+PUBLIC void ioring_wait(unsigned n)
+{
+	struct ioring *ior; /* Ring of calling process. */
+	
+	ior = curr_proc->ioring;
+	
+	ioring_reap();
+	
+	while ((ior->ring->cq_tail - ior->ring->cq_head < n) && (ior->nops > 0))
+	{
+		/* Wait for any block in flight. */
+		for (int j = 0; j < IORING_NR_SQES; j++)
+		{
+			struct ioring_op *op = &ior->ops[j];
+			
+			if (!op->busy)
+				continue;
+			
+			for (int k = 0; k < op->nblocks; k++)
+			{
+				if (!buffer_is_valid(op->blocks[k]))
+				{
+					bwait(op->blocks[k]);
+					goto reap;
+				}
+			}
+		}
+		
+	reap:
+		ioring_reap();
+	}
+}
+
+/**
+ * @brief Sets up an asynchronous I/O ring for the calling process.
+ *
+ * @details The ring lives in a kernel page, which is mapped at
+ * #IORING_ADDR. Children do not inherit it.
+ *
+ * @returns Zero upon successful completion, and a negative error
+ * number otherwise.
+ */
+PUBLIC int ioring_attach(void)
+{
+	struct ioring *ior;   /* Ring.                 */
+	struct io_ring *ring; /* Shared page.          */
+	struct region *reg;   /* Memory region.        */
+	struct pregion *preg; /* Process memory region. */
+	
+	/* Address already in use. */
+	if ((curr_proc->ioring != NULL) || (findreg(curr_proc, IORING_ADDR) != NULL))
+		return (-EBUSY);
+	
+	/* Look for a free process region. */
+	for (preg = DATA(curr_proc); preg < &curr_proc->pregs[NR_PREGIONS]; preg++)
+	{
+		if (preg->reg == NULL)
+			goto found;
+	}
+	
+	return (-ENOMEM);
+
+found:
+
+	if ((ior = kmalloc(sizeof(struct ioring))) == NULL)
+		goto error0;
+	if ((ring = getkpg(1)) == NULL)
+		goto error1;
+	if ((reg = kpgreg(ring, S_IRUSR | S_IWUSR, REGION_PRIVATE)) == NULL)
+		goto error2;
+	if (attachreg(curr_proc, preg, IORING_ADDR, reg))
+		goto error3;
+	
+	unlockreg(reg);
+	
+	kmemset(ior, 0, sizeof(struct ioring));
+	ior->ring = ring;
+	curr_proc->ioring = ior;
+	
+	return (0);
+
+error3:
+	freereg(reg);
+error2:
+	putkpg(ring);
+error1:
+	kfree(ior);
+error0:
+	return (-ENOMEM);
+}
+
+/**
+ * @brief Tears down the asynchronous I/O ring of the calling process.
+ *
+ * @details Waits for reads in flight, since they hold blocks, and
+ * drops their data.
+ */
+PUBLIC void ioring_detach(void)
+{
+	struct ioring *ior;   /* Ring of calling process. */
+	struct pregion *preg; /* Process memory region.   */
+	
+	if ((ior = curr_proc->ioring) == NULL)
+		return;
+	
+	for (int j = 0; j < IORING_NR_SQES; j++)
+	{
+		struct ioring_op *op = &ior->ops[j];
+		
+		if (!op->busy)
+			continue;
+		
+		for (int k = 0; k < op->nblocks; k++)
+			bwait(op->blocks[k]);
+		
+		ioring_finish(ior, op, 0);
+	}
+	
+	if ((preg = findreg(curr_proc, IORING_ADDR)) != NULL)
+		detachreg(curr_proc, preg);
+	
+	putkpg(ior->ring);
+	kfree(ior);
+	curr_proc->ioring = NULL;
+	curr_proc->flags &= ~(1 << PROC_AIO);
+}
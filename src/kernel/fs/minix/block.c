@@ -159,8 +159,8 @@ PRIVATE void block_free_indirect(struct superblock *sb, block_t num)
 	/* Free indirect disk block. */
 	for (i = 0; i < NR_SINGLE; i++)
 	{
-		block_free_direct(sb, ((block_t *)buffer_data(buf))[i]);
-		((block_t *)buffer_data(buf))[i] = BLOCK_NULL;
+		block_free_direct(sb, ((uint16_t *)buffer_data(buf))[i]);
+		((uint16_t *)buffer_data(buf))[i] = BLOCK_NULL;
 	}
 	block_free_direct(sb, num);
 		
@@ -192,8 +192,8 @@ PRIVATE void block_free_dindirect(struct superblock *sb, block_t num)
 	/* Free direct zone. */
 	for (i = 0; i < NR_SINGLE; i++)
 	{
-		block_free_indirect(sb, ((block_t *)buffer_data(buf))[i]);
-		((block_t *)buffer_data(buf))[i] = BLOCK_NULL;
+		block_free_indirect(sb, ((uint16_t *)buffer_data(buf))[i]);
+		((uint16_t *)buffer_data(buf))[i] = BLOCK_NULL;
 	}
 	block_free_direct(sb, num);
 	
@@ -258,7 +258,7 @@ PUBLIC block_t create_indirect_block
 {
 	block_t phys; /* Physical block number. */
 
-	if (((block_t *)buffer_data(dest))[offset] == BLOCK_NULL && create)
+	if (((uint16_t *)buffer_data(dest))[offset] == BLOCK_NULL && create)
 	{
 		/* Allocate an block. */
 		superblock_lock(ip->sb);
@@ -267,7 +267,7 @@ PUBLIC block_t create_indirect_block
 
 		if (phys != BLOCK_NULL)
 		{
-			((block_t *)buffer_data(dest))[offset] = phys;
+			((uint16_t *)buffer_data(dest))[offset] = phys;
 			buffer_dirty(dest, 1);
 			inode_touch(ip);
 			brelse(dest);
@@ -282,7 +282,7 @@ PUBLIC block_t create_indirect_block
 	else
 	{
 		brelse(dest);
-		return ((block_t *)buffer_data(dest))[offset];
+		return ((uint16_t *)buffer_data(dest))[offset];
 	}
 }
 
@@ -410,7 +410,7 @@ PUBLIC block_t block_map(struct inode *ip, off_t off, int create)
 		buf = bread(ip->dev, phys);
 		
 		/* Create direct block. */
-		if (((block_t *)buffer_data(buf))[logic] == BLOCK_NULL && create)
+		if (((uint16_t *)buffer_data(buf))[logic] == BLOCK_NULL && create)
 		{
 			superblock_lock(ip->sb);
 			phys = block_alloc(ip->sb);
@@ -418,7 +418,7 @@ PUBLIC block_t block_map(struct inode *ip, off_t off, int create)
 			
 			if (phys != BLOCK_NULL)
 			{
-				((block_t *)buffer_data(buf))[logic] = phys;
+				((uint16_t *)buffer_data(buf))[logic] = phys;
 				buffer_dirty(buf, 1);
 				inode_touch(ip);
 			}
@@ -426,7 +426,7 @@ PUBLIC block_t block_map(struct inode *ip, off_t off, int create)
 		
 		brelse(buf);
 		
-		return (((block_t *)buffer_data(buf))[logic]);
+		return (((uint16_t *)buffer_data(buf))[logic]);
 	}
 	
 	logic = off - REMAINING_OFFSET;
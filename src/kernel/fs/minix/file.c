@@ -21,8 +21,10 @@
 
 #include <nanvix/clock.h>
 #include <nanvix/const.h>
+#include <nanvix/dev.h>
 #include <nanvix/fs.h>
 #include <nanvix/klib.h>
+#include <nanvix/mm.h>
 #include <sys/types.h>
 #include <dirent.h>
 #include <errno.h>
@@ -107,13 +109,17 @@ PUBLIC int dir_add_minix(struct inode *dinode, struct inode *inode, const char *
 	struct buffer *buf; /* Block buffer.         */
 	struct d_dirent *d; /* Disk directory entry. */
 	
+	/* Name does not fit in a directory entry. */
+	if (kstrlen(name) > MINIX_NAME_MAX)
+		return (-ENAMETOOLONG);
+	
 	d = dirent_search_minix(dinode, name, &buf, 1);
 	
 	/* Failed to create directory entry. */
 	if (d == NULL)
 		return (-1);
 	
-	kstrncpy(d->d_name, name, NAME_MAX);
+	kstrncpy(d->d_name, name, MINIX_NAME_MAX);
 	d->d_ino = inode->num;
 	buffer_dirty(buf, 1);
 	brelse(buf);
@@ -121,6 +127,19 @@ PUBLIC int dir_add_minix(struct inode *dinode, struct inode *inode, const char *
 	return (0);
 }
 
+/*
+ * Maps a block of a memory-backed device, bypassing the block buffer
+ * cache. Cached blocks are not mapped, since the cached copy may be
+ * more recent than the one in the device.
+ */
+PRIVATE char *block_dax(dev_t dev, block_t blk)
+{
+	if (bcached(dev, blk))
+		return (NULL);
+	
+	return (bdev_mapblk(dev, blk));
+}
+
 /*
  * Reads from a regular file.
  */
@@ -131,6 +150,8 @@ PUBLIC ssize_t file_read_minix(struct inode *i, void *buf, size_t n, off_t off)
 	size_t chunk;        /* Data chunk size.      */
 	block_t blk;         /* Working block number. */
 	struct buffer *bbuf; /* Working block buffer. */
+	char *data;          /* Mapped block.         */
+	int err;             /* Copy failed?          */
 		
 	p = buf;
 	
@@ -143,8 +164,6 @@ PUBLIC ssize_t file_read_minix(struct inode *i, void *buf, size_t n, off_t off)
 		if (blk == BLOCK_NULL)
 			goto out;
 		
-		bbuf = bread(i->dev, blk);
-			
 		blkoff = off % BLOCK_SIZE;
 		
 		/* Calculate read chunk size. */
@@ -153,14 +172,24 @@ PUBLIC ssize_t file_read_minix(struct inode *i, void *buf, size_t n, off_t off)
 		{
 			chunk = i->size - off;
 			if (chunk == 0)
-			{
-				brelse(bbuf);
 				goto out;
-			}
 		}
 		
-		kmemcpy(p, (char *)buffer_data(bbuf) + blkoff, chunk);
-		brelse(bbuf);
+		/* Read straight from a memory-backed device. */
+		if ((data = block_dax(i->dev, blk)) != NULL)
+		{
+			if (copy_to_user(p, data + blkoff, chunk))
+				goto fault;
+		}
+		
+		else
+		{
+			bbuf = bread(i->dev, blk);
+			err = copy_to_user(p, (char *)buffer_data(bbuf) + blkoff, chunk);
+			brelse(bbuf);
+			if (err)
+				goto fault;
+		}
 		
 		n -= chunk;
 		off += chunk;
@@ -169,57 +198,68 @@ PUBLIC ssize_t file_read_minix(struct inode *i, void *buf, size_t n, off_t off)
 
 out:
 	return ((ssize_t)(p - (char *)buf));
+
+fault:
+	if (p != buf)
+		goto out;
+	curr_proc->errno = -EFAULT;
+	return (-1);
 }
 
 /*
- * Reads from a regular directory.
+ * Reads from a regular directory. Disk directory entries are
+ * translated into dirent structures, so offsets are given in
+ * dirent structures rather than in disk directory entries.
  */
 PUBLIC ssize_t dir_read_minix(struct inode *i, void *buf, size_t n, off_t off)
 {
-	char *p;             /* Writing pointer.      */
-	size_t blkoff;       /* Block offset.         */
-	size_t chunk;        /* Data chunk size.      */
-	block_t blk;         /* Working block number. */
-	struct buffer *bbuf; /* Working block buffer. */
-		
+	struct dirent *p;    /* Writing pointer.         */
+	struct dirent de;    /* Working dirent.          */
+	struct d_dirent *d;  /* Disk directory entry.    */
+	int entry;           /* Working entry.           */
+	int nentries;        /* Number of entries.       */
+	block_t blk;         /* Working block number.    */
+	struct buffer *bbuf; /* Working block buffer.    */
+	
 	p = buf;
-
+	entry = off/sizeof(struct dirent);
+	nentries = i->size/sizeof(struct d_dirent);
+	
 	/* Read data. */
-	do
+	while ((n >= sizeof(struct dirent)) && (entry < nentries))
 	{
-		blk = block_map(i, off, 0);
+		blk = block_map(i, entry*sizeof(struct d_dirent), 0);
 		
-		/* End of file reached. */
-		if (blk == BLOCK_NULL)
-			goto out;
+		kmemset(&de, 0, sizeof(struct dirent));
 		
-		bbuf = bread(i->dev, blk);
-			
-		blkoff = off % BLOCK_SIZE;
+		/* Hole in the directory. */
+		if (blk == BLOCK_NULL)
+			de.d_ino = INODE_NULL;
 		
-		/* Calculate read chunk size. */
-		chunk = (n < BLOCK_SIZE - blkoff) ? n : BLOCK_SIZE - blkoff;
-		if ((off_t)chunk > i->size - off)
+		else
 		{
-			chunk = i->size - off;
-			if (chunk == 0)
-			{
-				brelse(bbuf);
-				goto out;
-			}
+			bbuf = bread(i->dev, blk);
+			d = &((struct d_dirent *)buffer_data(bbuf))
+				[entry%(BLOCK_SIZE/sizeof(struct d_dirent))];
+			de.d_ino = d->d_ino;
+			kmemcpy(de.d_name, d->d_name, MINIX_NAME_MAX);
+			brelse(bbuf);
 		}
 		
-		kmemcpy(p, (char *)buffer_data(bbuf) + blkoff, chunk);
-		brelse(bbuf);
+		if (copy_to_user(p, &de, sizeof(struct dirent)))
+		{
+			if (p != buf)
+				break;
+			curr_proc->errno = -EFAULT;
+			return (-1);
+		}
 		
-		n -= chunk;
-		off += chunk;
-		p += chunk;
-	} while (n > 0);
-
-out:
+		n -= sizeof(struct dirent);
+		entry++;
+		p++;
+	}
 
-	return ((ssize_t)(p - (char *)buf));
+	return ((ssize_t)((char *)p - (char *)buf));
 }
 
 /*
@@ -232,6 +272,8 @@ PUBLIC ssize_t file_write_minix(struct inode *i, const void *buf, size_t n, off_
 	size_t chunk;        /* Data chunk size.      */
 	block_t blk;         /* Working block number. */
 	struct buffer *bbuf; /* Working block buffer. */
+	char *data;          /* Mapped block.         */
+	int err;             /* Copy failed?          */
 		
 	p = buf;
 	
@@ -244,14 +286,26 @@ PUBLIC ssize_t file_write_minix(struct inode *i, const void *buf, size_t n, off_
 		if (blk == BLOCK_NULL)
 			goto out;
 		
-		bbuf = bread(i->dev, blk);
-		
 		blkoff = off % BLOCK_SIZE;
 		
 		chunk = (n < BLOCK_SIZE - blkoff) ? n : BLOCK_SIZE - blkoff;
-		kmemcpy((char *)buffer_data(bbuf) + blkoff, p, chunk);
-		buffer_dirty(bbuf, 1);
-		brelse(bbuf);
+		
+		/* Write straight to a memory-backed device. */
+		if ((data = block_dax(i->dev, blk)) != NULL)
+		{
+			if (copy_from_user(data + blkoff, p, chunk))
+				goto fault;
+		}
+		
+		else
+		{
+			bbuf = bread(i->dev, blk);
+			err = copy_from_user((char *)buffer_data(bbuf) + blkoff, p, chunk);
+			buffer_dirty(bbuf, 1);
+			brelse(bbuf);
+			if (err)
+				goto fault;
+		}
 		
 		n -= chunk;
 		off += chunk;
@@ -268,6 +322,91 @@ PUBLIC ssize_t file_write_minix(struct inode *i, const void *buf, size_t n, off_
 
 out:
 	return ((ssize_t)(p - (char *)buf));
+
+fault:
+	if (p != buf)
+		goto out;
+	curr_proc->errno = -EFAULT;
+	return (-1);
+}
+
+/*
+ * Maps a page of a regular file that lives in a memory-backed device.
+ */
+PUBLIC void *file_map_minix(struct inode *i, off_t off)
+{
+	char *data;  /* Mapped page.          */
+	block_t blk; /* Working block number. */
+	
+	/* Page must be block-aligned and lie within the file. */
+	if ((off % BLOCK_SIZE) || (off + PAGE_SIZE > i->size))
+		return (NULL);
+	
+	if ((blk = block_map(i, off, 0)) == BLOCK_NULL)
+		return (NULL);
+	
+	/* Page must be aligned in the device. */
+	data = block_dax(i->dev, blk);
+	if ((data == NULL) || (ADDR(data) & ~PAGE_MASK))
+		return (NULL);
+	
+	/* Blocks must be contiguous and not cached. */
+	for (unsigned j = 1; j < PAGE_SIZE/BLOCK_SIZE; j++)
+	{
+		if (block_map(i, off + j*BLOCK_SIZE, 0) != blk + j)
+			return (NULL);
+		if (bcached(i->dev, blk + j))
+			return (NULL);
+	}
+	
+	return (data);
+}
+
+/*
+ * Reads the block of a regular file that holds a given offset.
+ */
+PUBLIC struct buffer *file_bread_minix(struct inode *i, off_t off)
+{
+	block_t blk; /* Working block number. */
+	
+	/* End of file reached. */
+	if ((blk = block_map(i, off, 0)) == BLOCK_NULL)
+		return (NULL);
+	
+	return (bread(i->dev, blk));
+}
+
+/*
+ * Starts reading the block of a regular file that holds a given offset.
+ */
+PUBLIC struct buffer *file_breada_minix(struct inode *i, off_t off)
+{
+	block_t blk; /* Working block number. */
+	
+	/* End of file reached. */
+	if ((blk = block_map(i, off, 0)) == BLOCK_NULL)
+		return (NULL);
+	
+	return (breada(i->dev, blk));
+}
+
+/*
+ * Searches for a directory entry and returns its inode number.
+ */
+PUBLIC ino_t dir_search_minix(struct inode *dip, const char *filename)
+{
+	ino_t num;          /* Inode number.    */
+	struct buffer *buf; /* Block buffer.    */
+	struct d_dirent *d; /* Directory entry. */
+	
+	/* Not found. */
+	if ((d = dirent_search_minix(dip, filename, &buf, 0)) == NULL)
+		return (INODE_NULL);
+	
+	num = d->d_ino;
+	brelse(buf);
+	
+	return (num);
 }
 
 /**
@@ -300,6 +439,10 @@ PUBLIC struct d_dirent *dirent_search_minix
 	int nentries;       /* Number of directory entries.         */
 	struct d_dirent *d; /* Directory entry.                     */
 
+	/* Name does not fit in a directory entry. */
+	if (kstrlen(filename) > MINIX_NAME_MAX)
+		return (NULL);
+	
 	nentries = dip->size/sizeof(struct d_dirent);
 	
 	/* Search from very first block. */
@@ -343,7 +486,7 @@ PUBLIC struct d_dirent *dirent_search_minix
 		if (d->d_ino != INODE_NULL)
 		{
 			/* Found */
-			if (!kstrncmp(d->d_name, filename, NAME_MAX))
+			if (!kstrncmp(d->d_name, filename, MINIX_NAME_MAX))
 			{
 				/* Duplicated entry. */
 				if (create)
@@ -523,6 +523,8 @@ PUBLIC int minix_mkfs
 	kprintf ("Mkfs: Initialisation of the file system");
 	of = 0;
 	kmemset(buf, 0, BLOCK_SIZE);
+	kmemset(imap_bitmap, 0, sizeof(imap_bitmap));
+	kmemset(zmap_bitmap, 0, sizeof(zmap_bitmap));
 	for (size_t i = 0; i < size; i += BLOCK_SIZE) //size
 	{
 		bdev_write(dev, buf, BLOCK_SIZE, of);
@@ -584,13 +586,17 @@ PUBLIC struct inode_operations inode_o_minix =
 	&dir_remove_minix,
 	&file_read_minix,
 	&file_write_minix,
-	&dirent_search_minix
+	&dir_search_minix,
+	&file_map_minix,
+	&file_bread_minix,
+	&file_breada_minix
 };
 
 PRIVATE struct file_system_type fs_minix = {
 	superblock_read_minix,
 	&super_o_minix,
-	"minix"
+	"minix",
+	0
 };
 
 PUBLIC struct super_operations * so_minix(void){
@@ -52,7 +52,11 @@
 	PUBLIC int dir_remove_minix(struct inode *, const char *);
 	PUBLIC ssize_t file_read_minix(struct inode *, void *, size_t , off_t );
 	PUBLIC ssize_t file_write_minix(struct inode *, const void *, size_t , off_t);
+	EXTERN void *file_map_minix(struct inode *, off_t);
+	EXTERN struct buffer *file_bread_minix(struct inode *, off_t);
+	EXTERN struct buffer *file_breada_minix(struct inode *, off_t);
 	EXTERN struct d_dirent *dirent_search_minix (struct inode *, const char *, struct buffer **, int);
+	EXTERN ino_t dir_search_minix(struct inode *, const char *);
 
 
 	EXTERN struct inode_operations inode_o_minix;
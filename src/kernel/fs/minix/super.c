@@ -137,10 +137,7 @@ PUBLIC struct superblock *superblock_read_minix(dev_t dev, superblock * sb)
 	
 	/* Bad magic number. */
 	if (d_sb->s_magic != SUPER_MAGIC)
-	{
-		kprintf("fs: bad superblock magic number");
 		goto error1;
-	}
 	
 	/* Too many blocks in the inode/zone map. */
 	if ((d_sb->s_imap_nblocks > IMAP_SIZE)||(d_sb->s_bmap_nblocks > ZMAP_SIZE))
@@ -0,0 +1,347 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/clock.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <errno.h>
+#include "../fs.h"
+#include "minix3.h"
+
+/**
+ * @file
+ * 
+ * @brief Minix v3 block module implementation.
+ * 
+ * @details Minix v3 blocks span several cache blocks. Indirect blocks
+ *          hold 32-bit zone numbers, so an entry always lies in a single
+ *          cache block.
+ */
+
+/**
+ * @brief Number of zone numbers in a cache block.
+ */
+#define ZONES_PER_BLOCK (BLOCK_SIZE/sizeof(uint32_t))
+
+/**
+ * @brief Maximum indirection level.
+ */
+#define MAX_LEVEL 3
+
+/**
+ * @brief Allocates a disk block.
+ * 
+ * @details Allocates a disk block by searching in the bitmap of blocks for a
+ *          free block. The block is cleaned, a cache block at a time.
+ * 
+ * @param sb Superblock in which the disk block should be allocated.
+ * 
+ * @return Upon successful completion, the block number of the allocated block
+ *         is returned. Upon failed, #BLOCK_NULL is returned instead.
+ * 
+ * @note The superblock must be locked.
+ */
+PRIVATE block_t zone_alloc(struct superblock *sb)
+{
+	bit_t bit;          /* Bit number in the bitmap. */
+	block_t num;        /* Block number.             */
+	block_t blk;        /* Working block.            */
+	block_t firstblk;   /* First block to check.     */
+	struct buffer *buf; /* Working buffer.           */
+
+	/* Search for a free block. */
+	firstblk = (sb->zsearch - sb->first_data_block)/(BLOCK_SIZE << 3);
+	blk = firstblk;
+	do
+	{
+		bit = bitmap_first_free(buffer_data(sb->zmap[blk]), BLOCK_SIZE);
+		
+		/* Found. */
+		if (bit != BITMAP_FULL)
+		{
+			num = sb->first_data_block + bit + blk*(BLOCK_SIZE << 3);
+			if (num < sb->zones)
+				goto found;
+		}
+		
+		/* Wrap around. */
+		blk = (blk + 1 < sb->zmap_blocks) ? blk + 1 : 0;
+	} while (blk != firstblk);
+	
+	return (BLOCK_NULL);
+
+found:
+	
+	/* 
+	 * Remember disk block number to 
+	 * speedup next block allocation.
+	 */
+	sb->zsearch = num;
+	
+	/* Allocate block. */
+	bitmap_set(buffer_data(sb->zmap[blk]), bit);
+	buffer_dirty(sb->zmap[blk], 1);
+	sb->flags |= SUPERBLOCK_DIRTY;
+	
+	/* Clean block to avoid security issues. */
+	for (unsigned i = 0; i < MINIX3_SUBBLOCKS; i++)
+	{
+		buf = bread(sb->dev, ZONE_BLOCK(num) + i);
+		kmemset(buffer_data(buf), 0, BLOCK_SIZE);
+		buffer_dirty(buf, 1);
+		brelse(buf);
+	}
+		
+	return (num);
+}
+
+/**
+ * @brief Frees a direct disk block.
+ * 
+ * @param sb  Superblock in which the disk block should be freed.
+ * @param num Number of the direct disk block that shall be freed.
+ * 
+ * @note The superblock must be locked.
+ */
+PRIVATE void zone_free(struct superblock *sb, block_t num)
+{
+	unsigned idx; /* Bitmap index.  */
+	unsigned off; /* Bitmap offset. */
+	
+	/* 
+	 * Remember free disk block to
+	 * speedup next block allocation.
+	 */
+	if (num < sb->zsearch)
+		sb->zsearch = num;
+	
+	num -= sb->first_data_block;
+	
+	/*
+	 * Compute block index and offset 
+	 * in the bitmap.
+	 */
+	idx = num/(BLOCK_SIZE << 3);
+	off = num%(BLOCK_SIZE << 3);
+	
+	/* Free disk block. */
+	bitmap_clear(buffer_data(sb->zmap[idx]), off);
+	buffer_dirty(sb->zmap[idx], 1);
+	sb->flags |= SUPERBLOCK_DIRTY;
+}
+
+/**
+ * @brief Frees a disk block.
+ * 
+ * @details Frees a disk block by freeing all underlying disk blocks.
+ * 
+ * @param sb  Superblock in which the disk block should be freed.
+ * @param num Number of the disk block that shall be freed.
+ * @param lvl Level of indirection to be parsed: zero for direct blocks, one for
+ *        single indirect blocks, two for doubly indirect blocks, and three
+ *        for triply indirect blocks.
+ * 
+ * @note The superblock must be locked.
+ */
+PUBLIC void block_free_minix3(struct superblock *sb, block_t num, int lvl)
+{
+	struct buffer *buf; /* Block buffer. */
+	uint32_t *zones;    /* Zone numbers. */
+	
+	/* Nothing to be done. */
+	if (num == BLOCK_NULL)
+		return;
+	
+	/* Should not happen. */
+	if ((lvl < 0) || (lvl > MAX_LEVEL))
+		kpanic("fs: bad indirection level");
+	
+	/* Free underlying disk blocks. */
+	if (lvl > 0)
+	{
+		for (unsigned i = 0; i < MINIX3_SUBBLOCKS; i++)
+		{
+			buf = bread(sb->dev, ZONE_BLOCK(num) + i);
+			zones = buffer_data(buf);
+			
+			for (unsigned j = 0; j < ZONES_PER_BLOCK; j++)
+			{
+				block_free_minix3(sb, zones[j], lvl - 1);
+				zones[j] = BLOCK_NULL;
+			}
+			
+			brelse(buf);
+		}
+	}
+	
+	zone_free(sb, num);
+}
+
+/**
+ * @brief Gets a zone number from an indirect block.
+ *
+ * @param ip     File to use.
+ * @param num    Indirect block.
+ * @param idx    Index of the zone number in the indirect block.
+ * @param create If 1, creates an block, otherwise, just return this value.
+ *
+ * @returns If successful, the block number created/obtained, otherwise
+ *          BLOCK_NULL is returned.
+ *
+ * @note @p ip must be locked.
+ */
+PRIVATE block_t zone_indirect(struct inode *ip, block_t num, block_t idx, int create)
+{
+	block_t phys;       /* Physical block number. */
+	struct buffer *buf; /* Indirect block buffer. */
+	uint32_t *zones;    /* Zone numbers.          */
+	
+	buf = bread(ip->dev, ZONE_BLOCK(num) + idx/ZONES_PER_BLOCK);
+	zones = buffer_data(buf);
+	idx %= ZONES_PER_BLOCK;
+	
+	/* Create block. */
+	if (zones[idx] == BLOCK_NULL && create)
+	{
+		superblock_lock(ip->sb);
+		phys = zone_alloc(ip->sb);
+		superblock_unlock(ip->sb);
+		
+		if (phys != BLOCK_NULL)
+		{
+			zones[idx] = phys;
+			buffer_dirty(buf, 1);
+			inode_touch(ip);
+		}
+	}
+	
+	phys = zones[idx];
+	brelse(buf);
+	
+	return (phys);
+}
+
+/**
+ * @brief Gets a zone number from an inode.
+ *
+ * @param ip     File to use.
+ * @param idx    Index of the zone number in the inode.
+ * @param create If 1, creates an block, otherwise, just return this value.
+ *
+ * @returns If successful, the block number created/obtained, otherwise
+ *          BLOCK_NULL is returned.
+ *
+ * @note @p ip must be locked.
+ */
+PRIVATE block_t zone_direct(struct inode *ip, unsigned idx, int create)
+{
+	block_t phys; /* Physical block number. */
+
+	/* Create block. */
+	if (ip->blocks[idx] == BLOCK_NULL && create)
+	{
+		superblock_lock(ip->sb);
+		phys = zone_alloc(ip->sb);
+		superblock_unlock(ip->sb);
+
+		if (phys != BLOCK_NULL)
+		{
+			ip->blocks[idx] = phys;
+			inode_touch(ip);
+		}
+	}
+	
+	return (ip->blocks[idx]);
+}
+
+/**
+ * @brief Maps a file byte offset in a disk block number.
+ * 
+ * @details Maps the offset @p off in the file pointed to by @p ip in a disk
+ *          block number. If @p create is not zero and such file by offset is
+ *          invalid, the file is expanded accordingly to make it valid.
+ *          Indirect zones are walked one level at a time, so single,
+ *          double and triple indirect zones share the same code.
+ * 
+ * @param ip     File to use
+ * @param off    File byte offset.
+ * @param create Create offset?
+ * 
+ * @returns Upon successful completion, the disk block number that is associated
+ *          with the file byte offset is returned. Upon failure, #BLOCK_NULL is
+ *          returned instead.
+ * 
+ * @note @p ip must be locked.
+ */
+PUBLIC block_t block_map_minix3(struct inode *ip, off_t off, int create)
+{
+	block_t phys;  /* Physical block number. */
+	block_t logic; /* Logical block number.  */
+	block_t span;  /* Blocks per entry.      */
+	unsigned lvl;  /* Indirection level.     */
+	
+	/* File offset too big. */
+	if ((off < 0) || (off >= ip->sb->max_size))
+	{
+		curr_proc->errno = -EFBIG;
+		return (BLOCK_NULL);
+	}
+	
+	logic = off >> BLOCK_SIZE_V3_LOG2;
+	
+	/* 
+	 * Create blocks that are
+	 * in a valid offset.
+	 */
+	if (off < ip->size)
+		create = 1;
+	
+	/* Direct block. */
+	if (logic < NR_ZONES_DIRECT)
+		return (zone_direct(ip, logic, create));
+	
+	logic -= NR_ZONES_DIRECT;
+	
+	/* Find indirection level. */
+	span = NR_SINGLE_V3;
+	for (lvl = 1; logic >= span; lvl++)
+	{
+		/* File offset too big. */
+		if (lvl == MAX_LEVEL)
+		{
+			curr_proc->errno = -EFBIG;
+			return (BLOCK_NULL);
+		}
+		
+		logic -= span;
+		span *= NR_SINGLE_V3;
+	}
+	
+	/* Walk down indirect blocks. */
+	phys = zone_direct(ip, ZONE_SINGLE + lvl - 1, create);
+	while ((phys != BLOCK_NULL) && (lvl-- > 0))
+	{
+		span /= NR_SINGLE_V3;
+		phys = zone_indirect(ip, phys, logic/span, create);
+		logic %= span;
+	}
+	
+	return (phys);
+}
@@ -0,0 +1,537 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/dev.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <errno.h>
+#include "../fs.h"
+#include "minix3.h"
+
+/**
+ * @brief Number of directory entries in a cache block.
+ */
+#define DIRENTS_PER_BLOCK (BLOCK_SIZE/sizeof(struct d_dirent_v3))
+
+/*
+ * Searches for a directory entry.
+ */
+PRIVATE struct d_dirent_v3 *dirent_search
+(struct inode *dip, const char *filename, struct buffer **buf, int create)
+{
+	int entry;             /* Index of first free directory entry. */
+	int nentries;          /* Number of directory entries.         */
+	block_t blk;           /* Working block number.                */
+	struct d_dirent_v3 *d; /* Directory entry.                     */
+	
+	nentries = dip->size/sizeof(struct d_dirent_v3);
+	entry = -1;
+	(*buf) = NULL;
+	
+	/* Search directory entry, a cache block at a time. */
+	for (int i = 0; i < nentries; i += DIRENTS_PER_BLOCK)
+	{
+		blk = block_map_minix3(dip, i*sizeof(struct d_dirent_v3), 0);
+		
+		/*
+		 * Skip invalid blocks. As directory entries
+		 * are removed from a directory, a whole block
+		 * may become free.
+		 */
+		if (blk == BLOCK_NULL)
+			continue;
+		
+		(*buf) = bread(dip->dev,
+			MINIX3_BLOCK(blk, i*sizeof(struct d_dirent_v3)));
+		d = buffer_data(*buf);
+		
+		for (int j = i; (j < nentries) && (j < i + (int)DIRENTS_PER_BLOCK); j++, d++)
+		{
+			/* Remember entry index. */
+			if (d->d_ino == INODE_NULL)
+			{
+				if (entry < 0)
+					entry = j;
+				continue;
+			}
+			
+			/* Found */
+			if (!kstrncmp(d->d_name, filename, MINIX3_NAME_MAX))
+			{
+				/* Duplicated entry. */
+				if (create)
+				{
+					brelse((*buf));
+					(*buf) = NULL;
+					curr_proc->errno = -EEXIST;
+					return (NULL);
+				}
+				
+				return (d);
+			}
+		}
+		
+		brelse((*buf));
+		(*buf) = NULL;
+	}
+	
+	/* Not found. */
+	if (!create)
+		return (NULL);
+	
+	/* Expand directory. */
+	if (entry < 0)
+	{
+		entry = nentries;
+		
+		blk = block_map_minix3(dip, entry*sizeof(struct d_dirent_v3), 1);
+		
+		/* Failed to create entry. */
+		if (blk == BLOCK_NULL)
+		{
+			curr_proc->errno = -ENOSPC;
+			return (NULL);
+		}
+		
+		dip->size += sizeof(struct d_dirent_v3);
+		inode_touch(dip);
+	}
+	
+	else
+		blk = block_map_minix3(dip, entry*sizeof(struct d_dirent_v3), 0);
+	
+	(*buf) = bread(dip->dev,
+		MINIX3_BLOCK(blk, entry*sizeof(struct d_dirent_v3)));
+	d = &((struct d_dirent_v3 *)buffer_data(*buf))[entry%DIRENTS_PER_BLOCK];
+	
+	return (d);
+}
+
+/*
+ * Searches for a directory entry and returns its inode number.
+ */
+PUBLIC ino_t dir_search_minix3(struct inode *dip, const char *filename)
+{
+	ino_t num;             /* Inode number.    */
+	struct buffer *buf;    /* Block buffer.    */
+	struct d_dirent_v3 *d; /* Directory entry. */
+	
+	/* Not found. */
+	if ((d = dirent_search(dip, filename, &buf, 0)) == NULL)
+		return (INODE_NULL);
+	
+	num = d->d_ino;
+	brelse(buf);
+	
+	return (num);
+}
+
+/*
+ * Removes an entry from a directory.
+ */
+PUBLIC int dir_remove_minix3(struct inode *dinode, const char *filename)
+{
+	struct buffer *buf;    /* Block buffer.    */
+	struct d_dirent_v3 *d; /* Directory entry. */
+	struct inode *file;    /* File inode.      */
+	
+	d = dirent_search(dinode, filename, &buf, 0);
+	
+	/* Not found. */
+	if (d == NULL)
+		return (-ENOENT);
+
+	/* Cannot remove '.' */
+	if (d->d_ino == dinode->num)
+	{
+		brelse(buf);
+		return (-EBUSY);
+	}
+	
+	file = inode_get(dinode->dev, d->d_ino);
+	
+	/* Failed to get file's inode. */
+	if (file == NULL)
+	{
+		brelse(buf);
+		return (-ENOENT);
+	}
+	
+	/* Unlinking directory. */
+	if (S_ISDIR(file->mode))
+	{
+		/* Not allowed. */
+		if (!IS_SUPERUSER(curr_proc))
+		{
+			inode_put(file);
+			brelse(buf);
+			return (-EPERM);
+		}
+		
+		/* Directory not empty. */
+		if ((file->size/sizeof(struct d_dirent_v3)) > 2)
+		{
+			inode_put(file);
+			brelse(buf);
+			return (-EBUSY);			
+		}
+	}
+	
+	/* Remove directory entry. */
+	d->d_ino = INODE_NULL;
+	
+	buffer_dirty(buf, 1);
+	inode_touch(dinode);
+	file->nlinks--;
+	inode_touch(file);
+	inode_put(file);
+	brelse(buf);
+	
+	return (0);
+}
+
+/*
+ * Adds an entry to a directory.
+ */
+PUBLIC int dir_add_minix3(struct inode *dinode, struct inode *inode, const char *name)
+{
+	struct buffer *buf;    /* Block buffer.         */
+	struct d_dirent_v3 *d; /* Disk directory entry. */
+	
+	d = dirent_search(dinode, name, &buf, 1);
+	
+	/* Failed to create directory entry. */
+	if (d == NULL)
+		return (-1);
+	
+	kstrncpy(d->d_name, name, MINIX3_NAME_MAX);
+	d->d_ino = inode->num;
+	buffer_dirty(buf, 1);
+	brelse(buf);
+	
+	return (0);
+}
+
+/*
+ * Reads from a regular directory. Disk directory entries are
+ * translated into dirent structures, so offsets are given in
+ * dirent structures rather than in disk directory entries.
+ */
+PUBLIC ssize_t dir_read_minix3(struct inode *i, void *buf, size_t n, off_t off)
+{
+	struct dirent *p;      /* Writing pointer.      */
+	struct dirent de;      /* Working dirent.       */
+	struct d_dirent_v3 *d; /* Disk directory entry. */
+	int entry;             /* Working entry.        */
+	int nentries;          /* Number of entries.    */
+	block_t blk;           /* Working block number. */
+	struct buffer *bbuf;   /* Working block buffer. */
+	
+	p = buf;
+	entry = off/sizeof(struct dirent);
+	nentries = i->size/sizeof(struct d_dirent_v3);
+	
+	/* Read data. */
+	while ((n >= sizeof(struct dirent)) && (entry < nentries))
+	{
+		blk = block_map_minix3(i, entry*sizeof(struct d_dirent_v3), 0);
+		
+		kmemset(&de, 0, sizeof(struct dirent));
+		
+		/* Hole in the directory. */
+		if (blk == BLOCK_NULL)
+			de.d_ino = INODE_NULL;
+		
+		else
+		{
+			bbuf = bread(i->dev,
+				MINIX3_BLOCK(blk, entry*sizeof(struct d_dirent_v3)));
+			d = &((struct d_dirent_v3 *)buffer_data(bbuf))
+				[entry%DIRENTS_PER_BLOCK];
+			de.d_ino = d->d_ino;
+			kmemcpy(de.d_name, d->d_name, MINIX3_NAME_MAX);
+			brelse(bbuf);
+		}
+		
+		if (copy_to_user(p, &de, sizeof(struct dirent)))
+		{
+			if (p != buf)
+				break;
+			curr_proc->errno = -EFAULT;
+			return (-1);
+		}
+		
+		n -= sizeof(struct dirent);
+		entry++;
+		p++;
+	}
+
+	return ((ssize_t)((char *)p - (char *)buf));
+}
+
+/*
+ * Maps a block of a memory-backed device, bypassing the block buffer
+ * cache. Cached blocks are not mapped, since the cached copy may be
+ * more recent than the one in the device.
+ */
+PRIVATE char *block_dax(dev_t dev, block_t blk)
+{
+	if (bcached(dev, blk))
+		return (NULL);
+	
+	return (bdev_mapblk(dev, blk));
+}
+
+/*
+ * Reads the cache block of a zone that holds a given offset. Cache
+ * blocks are smaller than zones, so asynchronous reads for the other
+ * uncached blocks of the zone are queued first. The block driver still
+ * gets one request per cache block, but they go out back to back, and
+ * the whole zone is cached once this returns.
+ */
+PRIVATE struct buffer *zone_bread(dev_t dev, block_t zone, off_t off)
+{
+	struct buffer *buf;                      /* Requested block buffer. */
+	struct buffer *ahead[MINIX3_SUBBLOCKS];  /* Read ahead buffers.     */
+	block_t blk;                             /* Requested cache block.  */
+	
+	blk = MINIX3_BLOCK(zone, off);
+	
+	/* Start reading sibling cache blocks. */
+	for (unsigned j = 0; j < MINIX3_SUBBLOCKS; j++)
+	{
+		ahead[j] = NULL;
+		if ((ZONE_BLOCK(zone) + j != blk) && !bcached(dev, ZONE_BLOCK(zone) + j))
+			ahead[j] = breada(dev, ZONE_BLOCK(zone) + j);
+	}
+	
+	buf = bread(dev, blk);
+	
+	/* Release sibling cache blocks. */
+	for (unsigned j = 0; j < MINIX3_SUBBLOCKS; j++)
+	{
+		if (ahead[j] != NULL)
+		{
+			blklock(ahead[j]);
+			brelse(ahead[j]);
+		}
+	}
+	
+	return (buf);
+}
+
+/*
+ * Reads from a regular file.
+ */
+PUBLIC ssize_t file_read_minix3(struct inode *i, void *buf, size_t n, off_t off)
+{
+	char *p;             /* Writing pointer.      */
+	size_t blkoff;       /* Block offset.         */
+	size_t chunk;        /* Data chunk size.      */
+	block_t blk;         /* Working block number. */
+	struct buffer *bbuf; /* Working block buffer. */
+	char *data;          /* Mapped block.         */
+	int err;             /* Copy failed?          */
+		
+	p = buf;
+	
+	/* Read data. */
+	do
+	{
+		blk = block_map_minix3(i, off, 0);
+		
+		/* End of file reached. */
+		if (blk == BLOCK_NULL)
+			goto out;
+		
+		blkoff = off % BLOCK_SIZE;
+		
+		/* Calculate read chunk size. */
+		chunk = (n < BLOCK_SIZE - blkoff) ? n : BLOCK_SIZE - blkoff;
+		if ((off_t)chunk > i->size - off)
+		{
+			chunk = i->size - off;
+			if (chunk == 0)
+				goto out;
+		}
+		
+		/* Read straight from a memory-backed device. */
+		if ((data = block_dax(i->dev, MINIX3_BLOCK(blk, off))) != NULL)
+		{
+			if (copy_to_user(p, data + blkoff, chunk))
+				goto fault;
+		}
+		
+		else
+		{
+			bbuf = zone_bread(i->dev, blk, off);
+			err = copy_to_user(p, (char *)buffer_data(bbuf) + blkoff, chunk);
+			brelse(bbuf);
+			if (err)
+				goto fault;
+		}
+		
+		n -= chunk;
+		off += chunk;
+		p += chunk;
+	} while (n > 0);
+
+out:
+	return ((ssize_t)(p - (char *)buf));
+
+fault:
+	if (p != buf)
+		goto out;
+	curr_proc->errno = -EFAULT;
+	return (-1);
+}
+
+/*
+ * Writes to a regular file.
+ */
+PUBLIC ssize_t file_write_minix3(struct inode *i, const void *buf, size_t n, off_t off)
+{
+	const char *p;       /* Reading pointer.      */
+	size_t blkoff;       /* Block offset.         */
+	size_t chunk;        /* Data chunk size.      */
+	block_t blk;         /* Working block number. */
+	struct buffer *bbuf; /* Working block buffer. */
+	char *data;          /* Mapped block.         */
+	int err;             /* Copy failed?          */
+		
+	p = buf;
+	
+	/* Write data. */
+	do
+	{
+		blk = block_map_minix3(i, off, 1);
+		
+		/* End of file reached. */
+		if (blk == BLOCK_NULL)
+			goto out;
+		
+		blk = MINIX3_BLOCK(blk, off);
+		blkoff = off % BLOCK_SIZE;
+		
+		chunk = (n < BLOCK_SIZE - blkoff) ? n : BLOCK_SIZE - blkoff;
+		
+		/* Write straight to a memory-backed device. */
+		if ((data = block_dax(i->dev, blk)) != NULL)
+		{
+			if (copy_from_user(data + blkoff, p, chunk))
+				goto fault;
+		}
+		
+		else
+		{
+			bbuf = bread(i->dev, blk);
+			err = copy_from_user((char *)buffer_data(bbuf) + blkoff, p, chunk);
+			buffer_dirty(bbuf, 1);
+			brelse(bbuf);
+			if (err)
+				goto fault;
+		}
+		
+		n -= chunk;
+		off += chunk;
+		p += chunk;
+		
+		/* Update file size. */
+		if (off > i->size)
+		{
+			i->size = off;
+			i->flags |= INODE_DIRTY;
+		}
+		
+	} while (n > 0);
+
+out:
+	return ((ssize_t)(p - (char *)buf));
+
+fault:
+	if (p != buf)
+		goto out;
+	curr_proc->errno = -EFAULT;
+	return (-1);
+}
+
+/*
+ * Maps a page of a regular file that lives in a memory-backed device.
+ */
+PUBLIC void *file_map_minix3(struct inode *i, off_t off)
+{
+	char *data;  /* Mapped page.          */
+	block_t blk; /* Working block number. */
+	
+	/* Page must be zone-aligned and lie within the file. */
+	if ((off % BLOCK_SIZE_V3) || (off + PAGE_SIZE > i->size))
+		return (NULL);
+	
+	if ((blk = block_map_minix3(i, off, 0)) == BLOCK_NULL)
+		return (NULL);
+	
+	/* Page must be aligned in the device. */
+	data = block_dax(i->dev, ZONE_BLOCK(blk));
+	if ((data == NULL) || (ADDR(data) & ~PAGE_MASK))
+		return (NULL);
+	
+	/* Blocks must be contiguous and not cached. */
+	for (unsigned j = 1; j < PAGE_SIZE/BLOCK_SIZE; j++)
+	{
+		if (block_map_minix3(i, off + j*BLOCK_SIZE, 0) != blk + j/MINIX3_SUBBLOCKS)
+			return (NULL);
+		if (bcached(i->dev, ZONE_BLOCK(blk) + j))
+			return (NULL);
+	}
+	
+	return (data);
+}
+
+/*
+ * Reads the block of a regular file that holds a given offset.
+ */
+PUBLIC struct buffer *file_bread_minix3(struct inode *i, off_t off)
+{
+	block_t blk; /* Working block number. */
+	
+	/* End of file reached. */
+	if ((blk = block_map_minix3(i, off, 0)) == BLOCK_NULL)
+		return (NULL);
+	
+	return (zone_bread(i->dev, blk, off));
+}
+
+/*
+ * Starts reading the block of a regular file that holds a given offset.
+ */
+PUBLIC struct buffer *file_breada_minix3(struct inode *i, off_t off)
+{
+	block_t blk; /* Working block number. */
+	
+	/* End of file reached. */
+	if ((blk = block_map_minix3(i, off, 0)) == BLOCK_NULL)
+		return (NULL);
+	
+	return (breada(i->dev, MINIX3_BLOCK(blk, off)));
+}
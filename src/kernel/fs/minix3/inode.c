@@ -0,0 +1,365 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief Minix v3 inode module implementation.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/config.h>
+#include <nanvix/const.h>
+#include <nanvix/dev.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <errno.h>
+#include <limits.h>
+#include "../fs.h"
+#include "../minix/minix.h"
+#include "minix3.h"
+
+/* Number of inodes per cache block. */
+#define INODES_PER_BLOCK (BLOCK_SIZE/sizeof(struct d_inode_v3))
+
+/**
+ * @brief Computes the cache block that holds an inode.
+ * 
+ * @param sb  Superblock.
+ * @param num Inode number.
+ * 
+ * @returns The cache block that holds the disk inode @p num.
+ */
+PRIVATE inline block_t inode_block(struct superblock *sb, ino_t num)
+{
+	block_t first; /* First inode block. */
+	
+	first = 2 + sb->u.minix3.s_imap_nblocks + sb->u.minix3.s_bmap_nblocks;
+	
+	return (ZONE_BLOCK(first) + (num - 1)/INODES_PER_BLOCK);
+}
+
+/**
+ * @brief Writes an inode to disk.
+ * 
+ * @details Writes the inode pointed to by @p ip to disk.
+ * 
+ * @param ip Inode to be written to disk.
+ * 
+ * @note The inode must be locked.
+ */
+PUBLIC void inode_write_minix3(struct inode *ip)
+{
+	struct buffer *buf;     /* Buffer.      */
+	struct d_inode_v3 *d_i; /* Disk inode.  */
+	struct superblock *sb;  /* Super block. */
+	
+	/* Nothing to be done. */
+	if (!(ip->flags & INODE_DIRTY))
+		return;
+	
+	superblock_lock(sb = ip->sb);
+	
+	/* Read chunk of disk inodes. */
+	buf = bread(ip->dev, inode_block(sb, ip->num));
+	
+	d_i = &(((struct d_inode_v3 *)buffer_data(buf))[(ip->num - 1)%INODES_PER_BLOCK]);
+	
+	/* Write inode to buffer. */
+	d_i->i_mode = ip->mode;
+	d_i->i_nlinks = ip->nlinks;
+	d_i->i_uid = ip->uid;
+	d_i->i_gid = ip->gid;
+	d_i->i_size = ip->size;
+	d_i->i_atime = ip->time;
+	d_i->i_mtime = ip->time;
+	d_i->i_ctime = ip->time;
+	for (unsigned i = 0; i < NR_ZONES_V3; i++)
+		d_i->i_zones[i] = ip->blocks[i];
+	ip->flags &= ~INODE_DIRTY;
+	buffer_dirty(buf, 1);
+	
+	brelse(buf);
+	superblock_unlock(sb);
+}
+
+/**
+ * @brief Reads an inode from the disk.
+ * 
+ * @details Reads the inode with number @p num from the device @p dev.
+ * 
+ * @param dev Device where the inode is located.
+ * @param num Number of the inode that shall be read.
+ * @param ip Inode of the cache where the result of the reading is written.
+ * 
+ * @returns Upon successful completion zero is returned. Upon failure, non-zero
+ * is returned instead.
+ * 
+ * @note The device number must be valid.
+ * @note The inode number must be valid.
+ * @note The inode must be initialized
+ */
+PUBLIC int inode_read_minix3(dev_t dev, ino_t num, struct inode *ip)
+{
+	struct buffer *buf;     /* Buffer.        */
+	struct d_inode_v3 *d_i; /* Disk inode.    */
+	struct superblock *sb;  /* Super block.   */
+	
+	/* Get superblock. */
+	sb = superblock_get(dev);
+	if (sb == NULL)
+		goto error0;
+	
+	/* Invalid inode number. */
+	if ((num == INODE_NULL) || (num > sb->ninodes))
+		goto error1;
+	
+	/* Read chunk of disk inodes. */
+	buf = bread(dev, inode_block(sb, num));
+	
+	d_i = &(((struct d_inode_v3 *)buffer_data(buf))[(num - 1)%INODES_PER_BLOCK]);
+	
+	/* Invalid disk inode. */ 
+	if (d_i->i_nlinks == 0)
+		goto error2;
+
+	/* Initialize in-core inode. */
+	ip->mode = d_i->i_mode;
+	ip->nlinks = d_i->i_nlinks;
+	ip->uid = d_i->i_uid;
+	ip->gid = d_i->i_gid;
+	ip->size = d_i->i_size;
+	ip->time = d_i->i_mtime;
+	for (unsigned i = 0; i < NR_ZONES_V3; i++)
+		ip->blocks[i] = d_i->i_zones[i];
+	ip->dev = dev;
+	ip->num = num;
+	ip->sb = sb;
+	ip->i_op = &inode_o_minix3;
+	ip->flags &= ~(INODE_DIRTY | INODE_MOUNT | INODE_PIPE);
+	ip->flags |= INODE_VALID;
+	
+	brelse(buf);
+	superblock_put(sb);
+
+	return (0);
+
+error2:
+	brelse(buf);
+error1:
+	superblock_put(sb);
+error0:
+	return (1);
+}
+
+/**
+ * @brief Frees an inode.
+ * 
+ * @details Frees the inode pointed to by @p ip.
+ * 
+ * @details The inode must be locked.
+ */
+PUBLIC void inode_free_minix3(struct inode *ip)
+{
+	block_t blk;           /* Block number.           */
+	struct superblock *sb; /* Underlying super block. */
+	
+	blk = (ip->num - 1)/(BLOCK_SIZE << 3);
+	
+	superblock_lock(sb = ip->sb);
+	
+	bitmap_clear(buffer_data(sb->imap[blk]), (ip->num - 1)%(BLOCK_SIZE << 3));
+	
+	buffer_dirty(sb->imap[blk], 1);
+	if (ip->num < sb->isearch)
+		sb->isearch = ip->num;
+	sb->flags |= SUPERBLOCK_DIRTY;
+	
+	superblock_unlock(sb);
+}
+
+/**
+ * @brief Truncates an inode.
+ * 
+ * @details Truncates the inode pointed to by @p ip by freeing all underling 
+ *          blocks.
+ * 
+ * @param ip Inode that shall be truncated.
+ * 
+ * @note The inode must be locked.
+ */
+PUBLIC void inode_truncate_minix3(struct inode *ip)
+{
+	struct superblock *sb;
+	
+	superblock_lock(sb = ip->sb);
+	
+	/* Free direct zones. */
+	for (unsigned j = 0; j < NR_ZONES_DIRECT; j++)
+	{
+		block_free_minix3(sb, ip->blocks[j], 0);
+		ip->blocks[j] = BLOCK_NULL;
+	}
+	
+	/* Free single, double and triple indirect zones. */
+	for (unsigned j = ZONE_SINGLE; j < NR_ZONES_V3; j++)
+	{
+		block_free_minix3(sb, ip->blocks[j], j - ZONE_SINGLE + 1);
+		ip->blocks[j] = BLOCK_NULL;
+	}
+	
+	superblock_unlock(sb);
+	
+	ip->size = 0;
+	inode_touch(ip);
+}
+
+/**
+ * @brief Allocates an inode.
+ * 
+ * @details Allocates an inode in the file system that is associated to the 
+ *          superblock pointed to by @p sb.
+ * 
+ * @param sb Superblock where the inode shall be allocated.
+ * @param ip Inode of the cache which is allocated.
+ * 
+ * @returns Upon successful completion zero is returned. Upon failure, non-zero
+ * is returned instead.
+ * 
+ * @note The superblock must not be locked.
+ */
+PUBLIC int inode_alloc_minix3(struct superblock *sb, struct inode *ip)
+{
+	ino_t num;  /* Inode number.             */
+	bit_t bit;  /* Bit number in the bitmap. */
+	unsigned i; /* Number of current block.  */
+	
+	superblock_lock(sb);
+	
+	/* Search for free inode. */
+	for (i = 0; i < sb->imap_blocks; i++)
+	{
+		bit = bitmap_first_free(buffer_data(sb->imap[i]), BLOCK_SIZE);
+		
+		/* Found. */
+		if (bit != BITMAP_FULL)
+			goto found;
+	}
+	
+	goto error0;
+	
+found:
+
+	/* Past the last inode. */
+	if (bit + i*(BLOCK_SIZE << 3) >= sb->ninodes)
+		goto error0;
+	
+	num = bit + i*(BLOCK_SIZE << 3) + 1;
+
+	/*
+	 * Remember disk block number to
+	 * speedup next allocation. 
+	 */
+	sb->isearch = num;
+	
+	/* Allocate inode. */
+	bitmap_set(buffer_data(sb->imap[i]), bit);
+	buffer_dirty(sb->imap[i], 1);
+	sb->flags |= SUPERBLOCK_DIRTY;
+	
+	/* 
+	 * Initialize inode. 
+	 * mode will be initialized later.
+	 */
+	ip->nlinks = 1;
+	ip->uid = curr_proc->euid;
+	ip->gid = curr_proc->egid;
+	ip->size = 0;
+	for (unsigned j = 0; j < NR_ZONES_V3; j++)
+		ip->blocks[j] = BLOCK_NULL;
+	ip->dev = sb->dev;
+	ip->num = num;
+	ip->sb = sb;
+	ip->flags &= ~(INODE_MOUNT | INODE_PIPE);
+	ip->flags |= INODE_VALID;
+	ip->i_op = &inode_o_minix3;
+	superblock_unlock(sb);
+
+	return (0);
+	
+error0:
+	superblock_unlock(sb);
+	return (1);
+}
+
+/**
+ * @brief Minix v3 file system operations.
+ * 
+ * @details Superblocks of Minix v1 and v3 file systems hold the same
+ *          buffers, so both are written back and released alike.
+ */
+PRIVATE struct super_operations super_o_minix3 = 
+{
+	&inode_read_minix3,     /* inode_read      */ 
+	&inode_write_minix3,    /* inode_write     */
+	&inode_free_minix3,     /* inode_free      */
+	&inode_truncate_minix3, /* inode_truncate  */
+	&inode_alloc_minix3,    /* inode_alloc     */
+	NULL,                   /* notify_change   */
+	NULL,                   /* put inode       */
+	&superblock_put_minix,  /* put_super       */
+	&superblock_write_minix,/* write_super     */
+	&superblock_stat_minix3,/* superblock_stat */
+	NULL                    /* remount_fs      */
+};
+
+PUBLIC struct inode_operations inode_o_minix3 =
+{
+	&dir_read_minix3,
+	&dir_add_minix3,
+	&dir_remove_minix3,
+	&file_read_minix3,
+	&file_write_minix3,
+	&dir_search_minix3,
+	&file_map_minix3,
+	&file_bread_minix3,
+	&file_breada_minix3
+};
+
+PRIVATE struct file_system_type fs_minix3 = {
+	superblock_read_minix3,
+	&super_o_minix3,
+	"minix3",
+	0
+};
+
+PUBLIC struct super_operations *so_minix3(void)
+{
+	return (&super_o_minix3);
+}
+
+/**
+ * @brief Initialise the file system in the virtual file system.
+ */
+PUBLIC void init_minix3(void)
+{
+	if (fs_register(MINIX3, &fs_minix3))
+		kpanic("Failed to register minix3 file system");
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief Minix v3 file system private interface.
+ */
+#ifndef _MINIX3_H_
+#define _MINIX3_H_
+
+	#include <nanvix/const.h>
+	#include <nanvix/dev.h>
+	#include <nanvix/fs.h>
+
+	/**
+	 * @brief Number of cache blocks in a Minix v3 block.
+	 */
+	#define MINIX3_SUBBLOCKS (BLOCK_SIZE_V3/BLOCK_SIZE)
+
+	/**
+	 * @brief First cache block of a Minix v3 block.
+	 */
+	#define ZONE_BLOCK(z) \
+		((block_t)(z) << (BLOCK_SIZE_V3_LOG2 - BLOCK_SIZE_LOG2))
+
+	/**
+	 * @brief Cache block of a Minix v3 block that holds a file offset.
+	 */
+	#define MINIX3_BLOCK(z, off) \
+		(ZONE_BLOCK(z) + (((off) & (BLOCK_SIZE_V3 - 1)) >> BLOCK_SIZE_LOG2))
+
+	/* Forward definitions. */
+	EXTERN void inode_write_minix3(struct inode *);
+	EXTERN int inode_read_minix3(dev_t, ino_t, struct inode *);
+	EXTERN int inode_alloc_minix3(struct superblock *, struct inode *);
+	EXTERN void inode_free_minix3(struct inode *);
+	EXTERN void inode_truncate_minix3(struct inode *);
+	
+	EXTERN void init_minix3(void);
+	EXTERN struct super_operations *so_minix3(void);
+
+	EXTERN struct superblock *superblock_read_minix3(dev_t, struct superblock *);
+	EXTERN void superblock_stat_minix3(struct superblock *, struct ustat *);
+
+	EXTERN block_t block_map_minix3(struct inode *, off_t, int);
+	EXTERN void block_free_minix3(struct superblock *, block_t, int);
+
+	EXTERN ssize_t dir_read_minix3(struct inode *, void *, size_t , off_t );
+	EXTERN int dir_add_minix3(struct inode *, struct inode *, const char *);
+	EXTERN int dir_remove_minix3(struct inode *, const char *);
+	EXTERN ino_t dir_search_minix3(struct inode *, const char *);
+	EXTERN ssize_t file_read_minix3(struct inode *, void *, size_t , off_t );
+	EXTERN ssize_t file_write_minix3(struct inode *, const void *, size_t , off_t);
+	EXTERN void *file_map_minix3(struct inode *, off_t);
+	EXTERN struct buffer *file_bread_minix3(struct inode *, off_t);
+	EXTERN struct buffer *file_breada_minix3(struct inode *, off_t);
+
+	EXTERN struct inode_operations inode_o_minix3;
+
+#endif /* _MINIX3_H_ */
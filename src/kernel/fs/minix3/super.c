@@ -0,0 +1,170 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/klib.h>
+#include <nanvix/fs.h>
+#include <ustat.h>
+
+#include "../fs.h"
+#include "minix3.h"
+
+/**
+ * @file
+ * 
+ * @brief Minix v3 superblock module implementation.
+ */
+
+/**
+ * @addtogroup Superblock
+ */
+/**@{*/
+
+/**
+ * @brief Reads a Minix v3 superblock from a device.
+ * 
+ * @details Reads the superblock that lives at byte offset 1024 of a device.
+ *          Once the read has completed, the magic number of the block is
+ *          asserted and in-core fields are filled. Bitmaps are kept in
+ *          block buffers, so only the cache blocks that hold valid bits
+ *          are read.
+ * 
+ * @param dev Device number.
+ * @param sb  In-core superblock to be filled.
+ * 
+ * @returns Upon successful completion, a pointer to the in-core superblock
+ *          is returned. Upon failure, a NULL pointer is returned instead.
+ * 
+ * @note The device number should be valid.
+ * @note The superblock must be locked.
+ */
+PUBLIC struct superblock *superblock_read_minix3(dev_t dev, superblock *sb)
+{
+	struct buffer *buf;           /* Buffer disk superblock. */
+	struct d_superblock_v3 *d_sb; /* Disk superblock.        */
+	unsigned imap_blocks;         /* Inode map cache blocks. */
+	unsigned zmap_blocks;         /* Zone map cache blocks.  */
+	block_t first;                /* First inode map block.  */
+	
+	/* Read superblock from device. */
+	buf = bread(dev, 1);
+	d_sb = (struct d_superblock_v3 *)buffer_data(buf);
+	
+	/* Bad magic number. */
+	if (d_sb->s_magic != SUPER_MAGIC_V3)
+		goto error1;
+	
+	/* Unsupported block size. */
+	if ((d_sb->s_block_size != BLOCK_SIZE_V3) || (d_sb->s_log_zone_size != 0))
+	{
+		kprintf("fs: unsupported minix3 block size");
+		goto error1;
+	}
+	
+	/* Inode numbers do not fit in ino_t. */
+	if ((ino_t)d_sb->s_ninodes != d_sb->s_ninodes)
+	{
+		kprintf("fs: too many inodes");
+		goto error1;
+	}
+	
+	imap_blocks = (d_sb->s_ninodes + (BLOCK_SIZE << 3) - 1)/(BLOCK_SIZE << 3);
+	zmap_blocks = (d_sb->s_nblocks - d_sb->s_first_data_block
+		+ (BLOCK_SIZE << 3) - 1)/(BLOCK_SIZE << 3);
+	
+	/* Too many blocks in the inode/zone map. */
+	if ((imap_blocks > IMAP_SIZE) || (zmap_blocks > ZMAP_SIZE) ||
+		(imap_blocks > d_sb->s_imap_nblocks*MINIX3_SUBBLOCKS) ||
+		(zmap_blocks > d_sb->s_bmap_nblocks*MINIX3_SUBBLOCKS))
+	{
+		kprintf("fs: too many blocks in the inode/zone map");
+		goto error1;
+	}
+	
+	/* Initialize superblock. */
+	kmemcpy(&sb->u.minix3, d_sb, sizeof(struct d_superblock_v3));
+	sb->buf = buf;
+	sb->ninodes = d_sb->s_ninodes;
+	first = ZONE_BLOCK(2);
+	sb->imap_blocks = imap_blocks;
+	for (unsigned i = 0; i < sb->imap_blocks; i++)
+		blkunlock(sb->imap[i] = bread(dev, first + i));
+	first = ZONE_BLOCK(2 + d_sb->s_imap_nblocks);
+	sb->zmap_blocks = zmap_blocks;
+	for (unsigned i = 0; i < sb->zmap_blocks; i++)
+		blkunlock(sb->zmap[i] = bread(dev, first + i));
+	sb->first_data_block = d_sb->s_first_data_block;
+	sb->max_size = d_sb->s_max_size;
+	sb->zones = d_sb->s_nblocks;
+	sb->root = NULL;
+	sb->mp = NULL;
+	sb->dev = dev;
+	sb->flags &= ~(SUPERBLOCK_DIRTY | SUPERBLOCK_RDONLY);
+	sb->flags |= SUPERBLOCK_VALID;
+	sb->isearch = 0;
+	sb->zsearch = d_sb->s_first_data_block;
+	sb->chain = NULL;
+	sb->count++;
+	sb->s_op = so_minix3();
+	
+	blkunlock(buf);
+	
+	return (sb);
+	
+error1:
+	brelse(buf);
+	return (NULL);
+}
+
+/**
+ * @brief Gets file system statistics.
+ * 
+ * @details Gets file system statics from the superblock of the file system
+ *          pointed to by sb, and stores information in the buffer pointed to
+ *          by ubuf.
+ * 
+ * @param sb   Superblock of the file system to be inspected.
+ * @param ubuf Place where statics should be stored.
+ * 
+ * @note The superblock must be valid.
+ * @note The superblock must be locked.
+ * @note The buffer must be valid.
+ */
+PUBLIC void superblock_stat_minix3(struct superblock *sb, struct ustat *ubuf)
+{
+	int tfree;  /* Total free blocks. */
+	int tinode; /* Total free inodes. */
+	
+	/* Count number of free blocks. */
+	tfree = 0;
+	for (unsigned i = 0; i < sb->zmap_blocks; i++)
+		tfree += bitmap_nclear(buffer_data(sb->zmap[i]), BLOCK_SIZE);
+	
+	/* Count number of free inodes. */
+	tinode = 0;
+	for (unsigned i = 0; i < sb->imap_blocks; i++)
+		tinode += bitmap_nclear(buffer_data(sb->imap[i]), BLOCK_SIZE);
+	
+	ubuf->f_tfree = tfree;
+	ubuf->f_tinode = tinode;
+	ubuf->f_fname[0] = '\0';
+	ubuf->f_fpack[0] = '\0';
+}
+
+/**@}*/
@@ -19,8 +19,10 @@
 
 #include <nanvix/const.h>
 #include <nanvix/fs.h>
+#include <nanvix/mm.h>
 #include <nanvix/pm.h>
 #include <errno.h>
+#include <poll.h>
 
 /*
  * Reads data from a pipe.
@@ -28,6 +30,7 @@
 PUBLIC ssize_t pipe_read(struct inode *inode, char *buf, size_t n)
 {
 	char *r;
+	size_t chunk;
 	
 	r = buf;
 	
@@ -36,8 +39,18 @@ PUBLIC ssize_t pipe_read(struct inode *inode, char *buf, size_t n)
 	if (inode->count != 2)
 		return (0);
 	
+	/*
+	 * Bring the buffer in up front, so that copying
+	 * out does not sleep with data half consumed.
+	 */
+	if (pin_user(buf, n, 1))
+	{
+		curr_proc->errno = -EFAULT;
+		return (-1);
+	}
+	
 	/* Read from pipe. */
-	while (n-- > 0)
+	while (n > 0)
 	{	
 		/* Sleep while pipe is empty. */
 		while (inode->head == inode->tail)
@@ -46,7 +59,8 @@ PUBLIC ssize_t pipe_read(struct inode *inode, char *buf, size_t n)
 			wakeup(&inode->chain);
 			if (inode->count != 2)
 				return (r - buf);
-				
+			
+			selwakeup(&inode->sel);
 			sleep(&inode->chain, PRIO_INODE);
 			
 			/* Awaken by a signal. */
@@ -58,11 +72,29 @@ PUBLIC ssize_t pipe_read(struct inode *inode, char *buf, size_t n)
 			
 		}
 		
-		*r++ = inode->pipe[inode->tail];
-		inode->tail = (inode->tail + 1)%inode->size;
+		/* Data up to the end of the pipe buffer. */
+		chunk = ((inode->head > inode->tail) ? inode->head : inode->size)
+			- inode->tail;
+		if (chunk > n)
+			chunk = n;
+		
+		/* Data is consumed only once it is out. */
+		if (copy_to_user(r, &inode->pipe[inode->tail], chunk))
+		{
+			if (r != buf)
+				break;
+			curr_proc->errno = -EFAULT;
+			return (-1);
+		}
+		
+		r += chunk;
+		n -= chunk;
+		inode->tail = (inode->tail + chunk)%inode->size;
 		wakeup(&inode->chain);
 	}
 	
+	selwakeup(&inode->sel);
+	
 	return (r - buf);
 	
 }
@@ -73,6 +105,7 @@ PUBLIC ssize_t pipe_read(struct inode *inode, char *buf, size_t n)
 PUBLIC ssize_t pipe_write(struct inode *inode, const char *buf, size_t n)
 {
 	const char *w;
+	size_t chunk;
 	
 	w = buf;
 	
@@ -85,8 +118,15 @@ PUBLIC ssize_t pipe_write(struct inode *inode, const char *buf, size_t n)
 		return (-1);
 	}
 	
+	/* Bring the buffer in up front, as for reading. */
+	if (pin_user(buf, n, 0))
+	{
+		curr_proc->errno = -EFAULT;
+		return (-1);
+	}
+	
 	/* Write to pipe. */
-	while (n-- > 0)
+	while (n > 0)
 	{
 		/* Sleep while pipe is full. */
 		while ((inode->head + 1)%inode->size == inode->tail)
@@ -100,6 +140,7 @@ PUBLIC ssize_t pipe_write(struct inode *inode, const char *buf, size_t n)
 				return (-1);
 			}
 	
+			selwakeup(&inode->sel);
 			sleep(&inode->chain, PRIO_INODE);
 			
 			/* Awaken by a signal. */
@@ -110,11 +151,57 @@ PUBLIC ssize_t pipe_write(struct inode *inode, const char *buf, size_t n)
 			}
 		}
 		
-		inode->pipe[inode->head] = *w++;
-		inode->head = (inode->head + 1)%inode->size;
+		/* Room up to the end of the pipe buffer. */
+		chunk = ((inode->tail > inode->head) ? inode->tail - 1 :
+			inode->size - (inode->tail == 0)) - inode->head;
+		if (chunk > n)
+			chunk = n;
+		
+		if (copy_from_user(&inode->pipe[inode->head], w, chunk))
+		{
+			if (w != buf)
+				break;
+			curr_proc->errno = -EFAULT;
+			return (-1);
+		}
+		
+		w += chunk;
+		n -= chunk;
+		inode->head = (inode->head + chunk)%inode->size;
 		wakeup(&inode->chain);
 	}
 	
+	selwakeup(&inode->sel);
+	
 	return (w - buf);
 	
 }
+
+/*
+ * Polls a pipe.
+ */
+PUBLIC int pipe_poll(struct inode *inode, int events)
+{
+	int revents = 0;
+	
+	/* Data to read. */
+	if ((events & POLLIN) && (inode->head != inode->tail))
+		revents |= POLLIN;
+	
+	/* Room to write. */
+	if ((events & POLLOUT) && ((inode->head + 1)%inode->size != inode->tail))
+		revents |= POLLOUT;
+	
+	/* The other end is gone. */
+	if (inode->count != 2)
+	{
+		revents |= POLLHUP;
+		if (events & POLLOUT)
+			revents |= POLLERR;
+	}
+	
+	if (revents == 0)
+		selrecord(&inode->sel);
+	
+	return (revents);
+}
@@ -0,0 +1,548 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief procfs file module implementation.
+ */
+
+#include <dev/ata.h>
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/hal.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/smp.h>
+#include <dirent.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include "../fs.h"
+#include "procfs.h"
+
+/*============================================================================*
+ *                                 generators                                 *
+ *============================================================================*/
+
+/**
+ * @brief Process state names.
+ */
+PRIVATE const char *procfs_states[] = {
+	"dead", "zombie", "running", "ready", "waiting", "sleeping", "stopped"
+};
+
+/**
+ * @brief Appends formatted text to a file being generated.
+ * 
+ * @param p   Writing pointer.
+ * @param fmt Formatted string.
+ * 
+ * @returns The new writing pointer.
+ */
+PRIVATE char *procfs_printf(char *p, const char *fmt, ...)
+{
+	va_list args;
+	
+	va_start(args, fmt);
+	p += kvsprintf(p, fmt, args);
+	va_end(args);
+	
+	return (p);
+}
+
+/**
+ * @brief Formats a 64-bit number in hexadecimal.
+ * 
+ * @param str Target string, with room for 17 characters.
+ * @param x   Number to format.
+ * 
+ * @returns @p str.
+ */
+PRIVATE char *procfs_hex64(char *str, uint64_t x)
+{
+	char *p = str;
+	
+	for (int i = 60; i >= 0; i -= 4)
+		*p++ = "0123456789abcdef"[(x >> i) & 0xf];
+	*p = '\0';
+	
+	return (str);
+}
+
+/**
+ * @brief Computes a percentage without overflowing.
+ * 
+ * @param part  Part.
+ * @param total Total.
+ * 
+ * @returns @p part as a percentage of @p total.
+ */
+PRIVATE unsigned procfs_percent(unsigned part, unsigned total)
+{
+	/* Scale down, keeping the ratio. */
+	while (total >= (1 << 24))
+	{
+		part >>= 1;
+		total >>= 1;
+	}
+	
+	return ((total == 0) ? 0 : (part*100)/total);
+}
+
+/**
+ * @brief Generates the status file of a process.
+ * 
+ * @param proc Target process.
+ * @param buf  Page where the file is generated.
+ * 
+ * @returns The size of the file.
+ */
+PRIVATE size_t procfs_status(struct process *proc, char *buf)
+{
+	char *p;      /* Writing pointer. */
+	char hex[17]; /* 64-bit number.   */
+	
+	p = buf;
+	p = procfs_printf(p, "name %s\n", proc->name);
+	p = procfs_printf(p, "pid %d\n", proc->pid);
+	p = procfs_printf(p, "ppid %d\n", (proc->father != NULL) ? proc->father->pid : 0);
+	p = procfs_printf(p, "uid %d\n", proc->uid);
+	p = procfs_printf(p, "gid %d\n", proc->gid);
+	p = procfs_printf(p, "state %s\n", procfs_states[proc->state]);
+	p = procfs_printf(p, "priority %d\n", proc->priority);
+	p = procfs_printf(p, "nice %d\n", proc->nice);
+	p = procfs_printf(p, "cpu %d\n", proc->cpu);
+	p = procfs_printf(p, "utime %d\n", proc->utime);
+	p = procfs_printf(p, "ktime %d\n", proc->ktime);
+	p = procfs_printf(p, "cutime %d\n", proc->cutime);
+	p = procfs_printf(p, "cktime %d\n", proc->cktime);
+	p = procfs_printf(p, "size %d\n", proc->size);
+	p = procfs_printf(p, "minflt %d\n", proc->minflt);
+	p = procfs_printf(p, "majflt %d\n", proc->majflt);
+	p = procfs_printf(p, "pmc0 0x%s\n", procfs_hex64(hex, proc->pmcs.C1));
+	p = procfs_printf(p, "pmc1 0x%s\n", procfs_hex64(hex, proc->pmcs.C2));
+	
+	return (p - buf);
+}
+
+/**
+ * @brief Generates the memory usage file.
+ * 
+ * @details Sizes are given in pages.
+ * 
+ * @param buf Page where the file is generated.
+ * 
+ * @returns The size of the file.
+ */
+PRIVATE size_t procfs_meminfo(char *buf)
+{
+	char *p = buf;
+	
+	p = procfs_printf(p, "user_total %d\n", UMEM_SIZE/PAGE_SIZE);
+	p = procfs_printf(p, "user_free %d\n", frame_nfree());
+	p = procfs_printf(p, "kernel_total %d\n", KPOOL_SIZE/PAGE_SIZE);
+	p = procfs_printf(p, "kernel_free %d\n", kpg_nfree());
+	p = procfs_printf(p, "buffers %d\n", NR_BUFFERS);
+	p = procfs_printf(p, "inodes %d\n", NR_INODES);
+	
+	return (p - buf);
+}
+
+/**
+ * @brief Generates the cache statistics file.
+ * 
+ * @param buf Page where the file is generated.
+ * 
+ * @returns The size of the file.
+ */
+PRIVATE size_t procfs_bufstat(char *buf)
+{
+	char *p = buf;
+	unsigned bhits, bmisses; /* Block buffer cache. */
+	unsigned ihits, imisses; /* Inode cache.        */
+	
+	/* Take a snapshot. */
+	bhits = buffer_hits;
+	bmisses = buffer_misses;
+	ihits = inode_hits;
+	imisses = inode_misses;
+	
+	p = procfs_printf(p, "buffer_hits %d\n", bhits);
+	p = procfs_printf(p, "buffer_misses %d\n", bmisses);
+	p = procfs_printf(p, "buffer_hit_rate %d\n", procfs_percent(bhits, bhits + bmisses));
+	p = procfs_printf(p, "inode_hits %d\n", ihits);
+	p = procfs_printf(p, "inode_misses %d\n", imisses);
+	p = procfs_printf(p, "inode_hit_rate %d\n", procfs_percent(ihits, ihits + imisses));
+	
+	return (p - buf);
+}
+
+/**
+ * @brief Generates the disk queues file.
+ * 
+ * @param buf Page where the file is generated.
+ * 
+ * @returns The size of the file.
+ */
+PRIVATE size_t procfs_iostat(char *buf)
+{
+	char *p = buf;
+	int depth;
+	
+	for (unsigned i = 0; i < 4; i++)
+	{
+		/* No such device. */
+		if ((depth = ata_queue_depth(i)) < 0)
+			continue;
+		
+		p = procfs_printf(p, "hd%c %d\n", 'a' + i, depth);
+	}
+	
+	return (p - buf);
+}
+
+/**
+ * @brief Generates the interrupt counts file.
+ * 
+ * @param buf Page where the file is generated.
+ * 
+ * @returns The size of the file.
+ */
+PRIVATE size_t procfs_interrupts(char *buf)
+{
+	char *p = buf;
+	
+	for (unsigned i = 0; i < NR_HWINT; i++)
+		p = procfs_printf(p, "irq%d %d\n", i, hwint_count[i]);
+	
+	return (p - buf);
+}
+
+/**
+ * @brief Generates the scheduler counters file.
+ * 
+ * @param buf Page where the file is generated.
+ * 
+ * @returns The size of the file.
+ */
+PRIVATE size_t procfs_sched(char *buf)
+{
+	char *p = buf;
+	
+	p = procfs_printf(p, "ticks %d\n", ticks);
+	p = procfs_printf(p, "nprocs %d\n", nprocs);
+	for (unsigned i = 0; i < ncpus; i++)
+	{
+		p = procfs_printf(p, "cpu%d ready %d switches %d skipped %d\n",
+			i, cpus[i].rq.nready, cpus[i].nswitches, cpus[i].nskipped);
+	}
+	
+	return (p - buf);
+}
+
+/**
+ * @brief System-wide files.
+ */
+PRIVATE const struct
+{
+	const char *name;          /**< File name. */
+	size_t (*generate)(char *); /**< Generator. */
+} procfs_files[] = {
+	{ "meminfo",    procfs_meminfo    }, /* PROCFS_MEMINFO    */
+	{ "bufstat",    procfs_bufstat    }, /* PROCFS_BUFSTAT    */
+	{ "iostat",     procfs_iostat     }, /* PROCFS_IOSTAT     */
+	{ "interrupts", procfs_interrupts }, /* PROCFS_INTERRUPTS */
+	{ "sched",      procfs_sched      }  /* PROCFS_SCHED      */
+};
+
+/**
+ * @brief Number of system-wide files.
+ */
+#define PROCFS_NR_FILES ((int)(sizeof(procfs_files)/sizeof(procfs_files[0])))
+
+/*============================================================================*
+ *                                directories                                 *
+ *============================================================================*/
+
+/**
+ * @brief Emits a directory entry.
+ * 
+ * @param p    Writing pointer.
+ * @param n    Room left in the buffer.
+ * @param skip Number of entries left to skip.
+ * @param ino  Inode number of the entry.
+ * @param name Name of the entry.
+ * 
+ * @returns Zero if the caller should go on, and non-zero if the buffer is
+ *          full.
+ */
+PRIVATE int procfs_emit
+(struct dirent **p, size_t *n, off_t *skip, ino_t ino, const char *name)
+{
+	/* Already read. */
+	if (*skip > 0)
+	{
+		(*skip)--;
+		return (0);
+	}
+	
+	/* Buffer is full. */
+	if (*n < sizeof(struct dirent))
+		return (-1);
+	
+	(*p)->d_ino = ino;
+	kstrncpy((*p)->d_name, name, NAME_MAX);
+	
+	*n -= sizeof(struct dirent);
+	(*p)++;
+	
+	return (0);
+}
+
+/**
+ * @brief Reads a directory.
+ * 
+ * @details The root directory lists the system-wide files and a directory
+ *          for each process, named after its ID.
+ * 
+ * @param i   Directory to read.
+ * @param buf Target buffer.
+ * @param n   Number of bytes to read.
+ * @param off Read offset.
+ * 
+ * @returns Upon successful completion, the number of bytes read is returned.
+ *          Upon failure, -1 is returned instead.
+ */
+PUBLIC ssize_t dir_read_procfs(struct inode *i, void *buf, size_t n, off_t off)
+{
+	struct dirent *p; /* Writing pointer. */
+	off_t skip;       /* Entries to skip. */
+	char name[16];    /* Process ID.      */
+	
+	/* Entries are written in place. */
+	if (pin_user(buf, n, 1))
+	{
+		curr_proc->errno = -EFAULT;
+		return (-1);
+	}
+	
+	p = buf;
+	skip = off/sizeof(struct dirent);
+	
+	if (procfs_emit(&p, &n, &skip, i->num, ".") ||
+		procfs_emit(&p, &n, &skip, INODE_ROOT, ".."))
+		goto out;
+	
+	/* Process directory. */
+	if (i->num != INODE_ROOT)
+	{
+		if (procfs_proc(i->num) != NULL)
+			procfs_emit(&p, &n, &skip, i->num + 1, "status");
+		goto out;
+	}
+	
+	/* System-wide files. */
+	for (int j = 0; j < PROCFS_NR_FILES; j++)
+	{
+		if (procfs_emit(&p, &n, &skip, PROCFS_MEMINFO + j, procfs_files[j].name))
+			goto out;
+	}
+	
+	/* Processes. */
+	for (int j = 1; j < PROC_MAX; j++)
+	{
+		/* Skip invalid processes. */
+		if (!IS_VALID(&proctab[j]))
+			continue;
+		
+		name[itoa(name, proctab[j].pid, 'd')] = '\0';
+		if (procfs_emit(&p, &n, &skip, PROCFS_PID_DIR(&proctab[j]), name))
+			goto out;
+	}
+
+out:
+	return ((ssize_t)((char *)p - (char *)buf));
+}
+
+/**
+ * @brief Searches for a directory entry.
+ * 
+ * @param dip      Directory where the directory entry shall be searched.
+ * @param filename Name of the directory entry that shall be searched.
+ * 
+ * @returns The inode number of the entry, or #INODE_NULL if there is no such
+ *          entry.
+ */
+PUBLIC ino_t dir_search_procfs(struct inode *dip, const char *filename)
+{
+	pid_t pid; /* Process ID.    */
+	
+	if (!kstrcmp(filename, "."))
+		return (dip->num);
+	if (!kstrcmp(filename, ".."))
+		return (INODE_ROOT);
+	
+	/* Process directory. */
+	if (dip->num != INODE_ROOT)
+	{
+		if ((procfs_proc(dip->num) != NULL) && !kstrcmp(filename, "status"))
+			return (dip->num + 1);
+		return (INODE_NULL);
+	}
+	
+	/* System-wide files. */
+	for (int j = 0; j < PROCFS_NR_FILES; j++)
+	{
+		if (!kstrcmp(filename, procfs_files[j].name))
+			return (PROCFS_MEMINFO + j);
+	}
+	
+	/* Parse process ID. */
+	pid = 0;
+	for (const char *s = filename; *s != '\0'; s++)
+	{
+		if ((*s < '0') || (*s > '9') || (pid > 100000000))
+			return (INODE_NULL);
+		pid = pid*10 + (*s - '0');
+	}
+	
+	/* Search for process. */
+	for (int j = 1; j < PROC_MAX; j++)
+	{
+		if (IS_VALID(&proctab[j]) && (proctab[j].pid == pid))
+			return (PROCFS_PID_DIR(&proctab[j]));
+	}
+	
+	return (INODE_NULL);
+}
+
+/**
+ * @brief Adds an entry to a directory.
+ * 
+ * @returns -1, always, as procfs is read-only.
+ */
+PUBLIC int dir_add_procfs(struct inode *dinode, struct inode *inode, const char *name)
+{
+	UNUSED(dinode);
+	UNUSED(inode);
+	UNUSED(name);
+	
+	curr_proc->errno = -EROFS;
+	
+	return (-1);
+}
+
+/**
+ * @brief Removes an entry from a directory.
+ * 
+ * @returns -EROFS, always, as procfs is read-only. The error code is set
+ *          in the process as well.
+ */
+PUBLIC int dir_remove_procfs(struct inode *dinode, const char *filename)
+{
+	UNUSED(dinode);
+	UNUSED(filename);
+	
+	return (curr_proc->errno = -EROFS);
+}
+
+/*============================================================================*
+ *                                   files                                    *
+ *============================================================================*/
+
+/**
+ * @brief Reads a file.
+ * 
+ * @details The whole file is generated on every read, so reading a file in
+ *          several steps may see data from different moments.
+ * 
+ * @param i   File to read.
+ * @param buf Target buffer.
+ * @param n   Number of bytes to read.
+ * @param off Read offset.
+ * 
+ * @returns Upon successful completion, the number of bytes read is returned.
+ *          Upon failure, -1 is returned instead.
+ */
+PUBLIC ssize_t file_read_procfs(struct inode *i, void *buf, size_t n, off_t off)
+{
+	char *page;           /* Generated file. */
+	size_t size;          /* File size.      */
+	struct process *proc; /* Process.        */
+	
+	if ((page = getkpg(0)) == NULL)
+	{
+		curr_proc->errno = -ENOMEM;
+		return (-1);
+	}
+	
+	/* Process file. */
+	if (i->num >= PROCFS_PID)
+	{
+		/* Process is gone. */
+		if ((proc = procfs_proc(i->num)) == NULL)
+		{
+			putkpg(page);
+			curr_proc->errno = -ESRCH;
+			return (-1);
+		}
+		
+		size = procfs_status(proc, page);
+	}
+	
+	/* System-wide file. */
+	else
+		size = procfs_files[i->num - PROCFS_MEMINFO].generate(page);
+	
+	/* Copy requested window. */
+	if (off >= (off_t)size)
+		n = 0;
+	else if (n > size - off)
+		n = size - off;
+	if (copy_to_user(buf, page + off, n))
+	{
+		putkpg(page);
+		curr_proc->errno = -EFAULT;
+		return (-1);
+	}
+	
+	putkpg(page);
+	
+	return ((ssize_t)n);
+}
+
+/**
+ * @brief Writes to a file.
+ * 
+ * @returns -1, always, as procfs is read-only.
+ */
+PUBLIC ssize_t file_write_procfs(struct inode *i, const void *buf, size_t n, off_t off)
+{
+	UNUSED(i);
+	UNUSED(buf);
+	UNUSED(n);
+	UNUSED(off);
+	
+	curr_proc->errno = -EROFS;
+	
+	return (-1);
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief procfs inode module implementation.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/pm.h>
+#include <errno.h>
+#include "../fs.h"
+#include "procfs.h"
+
+/**
+ * @brief Gets the process of a process inode.
+ * 
+ * @param num Inode number.
+ * 
+ * @returns The process whose directory or file has inode number @p num, or
+ *          a NULL pointer if there is no such process, including when
+ *          its process table slot now holds another process.
+ */
+PUBLIC struct process *procfs_proc(ino_t num)
+{
+	struct process *p;
+	
+	/* Not a process inode. */
+	if ((num < PROCFS_PID) || (num > PROCFS_NR_INODES))
+		return (NULL);
+	
+	p = &proctab[PROCFS_SLOT(num)];
+	
+	/* Process is gone. */
+	if (!IS_VALID(p) || ((p->pid % PROCFS_NR_GEN) != PROCFS_GEN(num)))
+		return (NULL);
+	
+	return (p);
+}
+
+/**
+ * @brief Writes an inode back.
+ * 
+ * @details There is nowhere to write inodes to, so changes to them are
+ *          lost once they leave the inode cache.
+ * 
+ * @param ip Inode to be written back.
+ * 
+ * @note The inode must be locked.
+ */
+PRIVATE void inode_write_procfs(struct inode *ip)
+{
+	ip->flags &= ~INODE_DIRTY;
+}
+
+/**
+ * @brief Reads an inode.
+ * 
+ * @details Builds the inode from its number: the root directory and the
+ *          system-wide files belong to the superuser, and the directory
+ *          of a process and the files in it belong to the owner of the
+ *          process.
+ * 
+ * @param dev Device where the inode is located.
+ * @param num Number of the inode that shall be read.
+ * @param ip  Inode of the cache where the result of the reading is written.
+ * 
+ * @returns Upon successful completion zero is returned. Upon failure, non-zero
+ * is returned instead.
+ */
+PRIVATE int inode_read_procfs(dev_t dev, ino_t num, struct inode *ip)
+{
+	struct process *p;     /* Process.     */
+	struct superblock *sb; /* Super block. */
+	
+	/* Get superblock. */
+	sb = superblock_get(dev);
+	if (sb == NULL)
+		goto error0;
+	
+	ip->uid = 0;
+	ip->gid = 0;
+	
+	/* Root directory. */
+	if (num == INODE_ROOT)
+	{
+		ip->mode = PROCFS_DIR_MODE;
+		ip->nlinks = 2;
+	}
+	
+	/* System-wide file. */
+	else if ((num >= PROCFS_MEMINFO) && (num <= PROCFS_SCHED))
+	{
+		ip->mode = PROCFS_FILE_MODE;
+		ip->nlinks = 1;
+	}
+	
+	/* Process directory or file. */
+	else if ((p = procfs_proc(num)) != NULL)
+	{
+		if (num == PROCFS_PID_DIR(p))
+		{
+			ip->mode = PROCFS_DIR_MODE;
+			ip->nlinks = 2;
+		}
+		else
+		{
+			ip->mode = PROCFS_FILE_MODE;
+			ip->nlinks = 1;
+		}
+		ip->uid = p->uid;
+		ip->gid = p->gid;
+	}
+	
+	/* Invalid inode number. */
+	else
+		goto error1;
+	
+	/* Initialize in-core inode. */
+	ip->size = 0;
+	ip->time = CURRENT_TIME;
+	for (unsigned i = 0; i < NR_ZONES_V3; i++)
+		ip->blocks[i] = BLOCK_NULL;
+	ip->dev = dev;
+	ip->num = num;
+	ip->sb = sb;
+	ip->i_op = &inode_o_procfs;
+	ip->flags &= ~(INODE_DIRTY | INODE_MOUNT | INODE_PIPE);
+	ip->flags |= INODE_VALID;
+	
+	superblock_put(sb);
+	
+	return (0);
+
+error1:
+	superblock_put(sb);
+error0:
+	return (1);
+}
+
+/**
+ * @brief Frees an inode.
+ * 
+ * @details procfs files are never unlinked, so there is nothing to free.
+ * 
+ * @note The inode must be locked.
+ */
+PRIVATE void inode_free_procfs(struct inode *ip)
+{
+	UNUSED(ip);
+}
+
+/**
+ * @brief Truncates an inode.
+ * 
+ * @details procfs files hold no data, so there is nothing to truncate.
+ * 
+ * @param ip Inode that shall be truncated.
+ * 
+ * @note The inode must be locked.
+ */
+PRIVATE void inode_truncate_procfs(struct inode *ip)
+{
+	UNUSED(ip);
+}
+
+/**
+ * @brief Allocates an inode.
+ * 
+ * @details Files cannot be created in procfs.
+ * 
+ * @param sb Superblock where the inode shall be allocated.
+ * @param ip Inode of the cache which is allocated.
+ * 
+ * @returns Non-zero, always.
+ */
+PRIVATE int inode_alloc_procfs(struct superblock *sb, struct inode *ip)
+{
+	UNUSED(sb);
+	UNUSED(ip);
+	
+	curr_proc->errno = -EROFS;
+	
+	return (1);
+}
+
+/**
+ * @brief procfs file system operations.
+ */
+PRIVATE struct super_operations super_o_procfs = 
+{
+	&inode_read_procfs,      /* inode_read      */ 
+	&inode_write_procfs,     /* inode_write     */
+	&inode_free_procfs,      /* inode_free      */
+	&inode_truncate_procfs,  /* inode_truncate  */
+	&inode_alloc_procfs,     /* inode_alloc     */
+	NULL,                    /* notify_change   */
+	NULL,                    /* put inode       */
+	&superblock_put_procfs,  /* put_super       */
+	NULL,                    /* write_super     */
+	&superblock_stat_procfs, /* superblock_stat */
+	NULL                     /* remount_fs      */
+};
+
+/**
+ * @brief procfs inode operations.
+ * 
+ * @details Files are generated when they are read, so they can be neither
+ *          mapped in place nor read block-wise.
+ */
+PUBLIC struct inode_operations inode_o_procfs =
+{
+	&dir_read_procfs,
+	&dir_add_procfs,
+	&dir_remove_procfs,
+	&file_read_procfs,
+	&file_write_procfs,
+	&dir_search_procfs,
+	NULL,
+	NULL,
+	NULL
+};
+
+PRIVATE struct file_system_type fs_procfs = {
+	superblock_read_procfs,
+	&super_o_procfs,
+	"proc",
+	FS_NODEV | FS_NOSIZE
+};
+
+/**
+ * @brief Initialise the file system in the virtual file system.
+ */
+PUBLIC void init_procfs(void)
+{
+	if (fs_register(PROCFS, &fs_procfs))
+		kpanic("Failed to register procfs file system");
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief procfs private interface.
+ */
+#ifndef _PROCFS_H_
+#define _PROCFS_H_
+
+	#include <nanvix/config.h>
+	#include <nanvix/const.h>
+	#include <nanvix/fs.h>
+	#include <nanvix/pm.h>
+	#include <sys/types.h>
+
+	/**
+	 * @name procfs inode numbers
+	 * 
+	 * @details Inode numbers are computed rather than stored: the root
+	 *          directory and the system-wide files come first, and then
+	 *          each process gets a directory and its files, numbered
+	 *          after its process table slot and the low bits of its ID,
+	 *          so that a slot taken over by another process does not
+	 *          reuse the inode numbers of the former one.
+	 */
+	/**@{*/
+	#define PROCFS_MEMINFO    2 /**< Memory usage.        */
+	#define PROCFS_BUFSTAT    3 /**< Cache hit rates.     */
+	#define PROCFS_IOSTAT     4 /**< Disk queues.         */
+	#define PROCFS_INTERRUPTS 5 /**< Interrupt counts.    */
+	#define PROCFS_SCHED      6 /**< Scheduler counters.  */
+	#define PROCFS_PID       16 /**< First process inode. */
+	#define PROCFS_NR_PIDINO  2 /**< Inodes per process.  */
+	#define PROCFS_NR_GEN   256 /**< Process ID values.   */
+	/**@}*/
+
+	/**
+	 * @brief Number of inodes.
+	 */
+	#define PROCFS_NR_INODES \
+		(PROCFS_PID + PROCFS_NR_GEN*PROC_MAX*PROCFS_NR_PIDINO - 1)
+
+	/**
+	 * @brief Inode number of the directory of a process.
+	 */
+	#define PROCFS_PID_DIR(p)                                        \
+		(PROCFS_PID + (((p)->pid % PROCFS_NR_GEN)*PROC_MAX +         \
+		((p) - proctab))*PROCFS_NR_PIDINO)
+
+	/**
+	 * @brief Inode number of the status file of a process.
+	 */
+	#define PROCFS_PID_STATUS(p) (PROCFS_PID_DIR(p) + 1)
+
+	/**
+	 * @brief Process table slot of a process inode.
+	 */
+	#define PROCFS_SLOT(num) \
+		((((num) - PROCFS_PID)/PROCFS_NR_PIDINO) % PROC_MAX)
+
+	/**
+	 * @brief Low bits of the process ID of a process inode.
+	 */
+	#define PROCFS_GEN(num) \
+		((((num) - PROCFS_PID)/PROCFS_NR_PIDINO) / PROC_MAX)
+
+	/**
+	 * @name procfs file modes
+	 */
+	/**@{*/
+	#define PROCFS_DIR_MODE  (S_IFDIR | MAY_READ | MAY_EXEC) /**< Directories. */
+	#define PROCFS_FILE_MODE (S_IFREG | MAY_READ)            /**< Files.       */
+	/**@}*/
+
+	/* Forward definitions. */
+	EXTERN struct process *procfs_proc(ino_t);
+
+	EXTERN void init_procfs(void);
+
+	EXTERN struct superblock *superblock_read_procfs(dev_t, struct superblock *);
+	EXTERN void superblock_put_procfs(struct superblock *);
+	EXTERN void superblock_stat_procfs(struct superblock *, struct ustat *);
+
+	EXTERN ssize_t dir_read_procfs(struct inode *, void *, size_t , off_t );
+	EXTERN int dir_add_procfs(struct inode *, struct inode *, const char *);
+	EXTERN int dir_remove_procfs(struct inode *, const char *);
+	EXTERN ino_t dir_search_procfs(struct inode *, const char *);
+	EXTERN ssize_t file_read_procfs(struct inode *, void *, size_t , off_t );
+	EXTERN ssize_t file_write_procfs(struct inode *, const void *, size_t , off_t );
+
+	EXTERN struct inode_operations inode_o_procfs;
+
+#endif /* _PROCFS_H_ */
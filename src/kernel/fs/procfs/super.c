@@ -0,0 +1,124 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/dev.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <ustat.h>
+#include "../fs.h"
+#include "procfs.h"
+
+/**
+ * @file
+ * 
+ * @brief procfs superblock module implementation.
+ */
+
+/**
+ * @addtogroup Superblock
+ */
+/**@{*/
+
+/**
+ * @brief Reads a procfs superblock.
+ * 
+ * @details There is nothing to read: procfs has no state of its own, and
+ *          its files are built from kernel structures when they are read.
+ * 
+ * @param dev Device number.
+ * @param sb  In-core superblock to be filled.
+ * 
+ * @returns Upon successful completion, a pointer to the in-core superblock
+ *          is returned. Upon failure, a NULL pointer is returned instead.
+ * 
+ * @note The superblock must be locked.
+ */
+PUBLIC struct superblock *superblock_read_procfs(dev_t dev, struct superblock *sb)
+{
+	/* Not a procfs device. */
+	if ((MAJOR(dev) != PROC_MAJOR) || ((dev & 1) != CHRDEV) || (MINOR(dev) != 0))
+		return (NULL);
+	
+	/* Initialize superblock. */
+	sb->buf = NULL;
+	sb->ninodes = PROCFS_NR_INODES;
+	sb->imap_blocks = 0;
+	sb->zmap_blocks = 0;
+	sb->first_data_block = 0;
+	sb->max_size = 0;
+	sb->zones = 0;
+	sb->root = NULL;
+	sb->mp = NULL;
+	sb->dev = dev;
+	sb->flags &= ~SUPERBLOCK_DIRTY;
+	sb->flags |= SUPERBLOCK_VALID | SUPERBLOCK_RDONLY;
+	sb->isearch = 0;
+	sb->zsearch = 0;
+	sb->chain = NULL;
+	sb->count++;
+	sb->s_op = fs_get(PROCFS)->so;
+	
+	return (sb);
+}
+
+/**
+ * @brief Releases a superblock.
+ * 
+ * @details Releases a superblock. If its reference count drops to zero, the
+ *          superblock is marked as invalid.
+ * 
+ * @param sb Superblock to be released.
+ * 
+ * @note The superblock must be valid.
+ * @note The superblock must be locked.
+ */
+PUBLIC void superblock_put_procfs(struct superblock *sb)
+{
+	/* Double free. */
+	if (sb->count == 0)
+		kpanic("freeing superblock twice");
+	
+	if (--sb->count == 0)
+		sb->flags &= ~SUPERBLOCK_VALID;
+}
+
+/**
+ * @brief Gets file system statistics.
+ * 
+ * @details procfs takes no room, so there is nothing free.
+ * 
+ * @param sb   Superblock of the file system to be inspected.
+ * @param ubuf Place where statics should be stored.
+ * 
+ * @note The superblock must be valid.
+ * @note The superblock must be locked.
+ * @note The buffer must be valid.
+ */
+PUBLIC void superblock_stat_procfs(struct superblock *sb, struct ustat *ubuf)
+{
+	UNUSED(sb);
+	
+	ubuf->f_tfree = 0;
+	ubuf->f_tinode = 0;
+	kstrcpy(ubuf->f_fname, "proc");
+	ubuf->f_fpack[0] = '\0';
+}
+
+/**@}*/
@@ -20,11 +20,11 @@
  */
 
 #include <nanvix/const.h>
+#include <nanvix/dev.h>
 #include <nanvix/klib.h>
 #include <nanvix/fs.h>
 #include <ustat.h>
 #include "fs.h"
-#include "minix/minix.h"
 
 /**
  * @file
@@ -237,25 +237,45 @@ PUBLIC void superblock_put(struct superblock *sb)
  */
 PUBLIC struct superblock *superblock_read(dev_t dev)
 {
-
-	struct superblock *sb;     /* In-core superblock.     */
-	struct file_system_type *fs;
+	struct superblock *sb;       /* In-core superblock. */
+	struct file_system_type *fs; /* File system.        */
 		
 	/* Get empty superblock. */	
 	sb = superblock_empty();
 	if (sb == NULL)
 		return NULL;
 
-	/*Get the file_system of the device*/
-	fs = fs_from_device(dev);
-	if (fs != NULL)
+	/* The file system of the device is known. */
+	if ((fs = fs_from_device(dev)) != NULL)
 	{
-		fs->superblock_read(dev,sb);	
-		return (sb);
+		if (fs->superblock_read(dev, sb) != NULL)
+			goto found;
 	}
-	else 
-		superblock_read_minix(dev,sb);
+	
+	/* Probe registered file systems. */
+	else
+	{
+		for (int i = 0; i < NR_FILE_SYSTEM; i++)
+		{
+			if ((fs = fs_get(i)) == NULL)
+				continue;
+			
+			/* Disk file systems live on block devices only. */
+			if (!(fs->flags & FS_NODEV) != ((dev & 1) == BLKDEV))
+				continue;
+			
+			if (fs->superblock_read(dev, sb) != NULL)
+				goto found;
+		}
+	}
+	
+	kprintf("fs: unknown file system on device %x", dev);
+	superblock_unlock(sb);
+	
+	return (NULL);
 
+found:
+	sb->fs = fs;
 	return (sb);
 }
 
@@ -0,0 +1,504 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <errno.h>
+#include "../fs.h"
+#include "tmpfs.h"
+
+/**
+ * @brief Pages in use by all tmpfs instances.
+ */
+PUBLIC unsigned tmpfs_npages = 0;
+
+/*============================================================================*
+ *                                   pages                                    *
+ *============================================================================*/
+
+/*
+ * Gets a clean page, if the page budget allows.
+ */
+PRIVATE void *tmpfs_getpg(void)
+{
+	void *pg; /* Page. */
+	
+	/* Page budget exhausted. */
+	if (tmpfs_npages >= TMPFS_NR_PAGES)
+		return (NULL);
+	
+	if ((pg = getkpg(1)) == NULL)
+		return (NULL);
+	
+	tmpfs_npages++;
+	
+	return (pg);
+}
+
+/*
+ * Releases a page, along with the pages that it refers to.
+ */
+PRIVATE void tmpfs_putpg(void *pg, int level)
+{
+	/* Nothing to be done. */
+	if (pg == NULL)
+		return;
+	
+	/* Release pages that are referred to. */
+	if (level > 0)
+	{
+		for (unsigned i = 0; i < TMPFS_NR_SLOTS; i++)
+			tmpfs_putpg(((void **)pg)[i], level - 1);
+	}
+	
+	putkpg(pg);
+	tmpfs_npages--;
+}
+
+/*
+ * Gets an entry of a page table, creating the page table if asked to.
+ */
+PRIVATE void **tmpfs_slot(void **table, unsigned idx, int create)
+{
+	if (*table == NULL)
+	{
+		if ((!create) || ((*table = tmpfs_getpg()) == NULL))
+			return (NULL);
+	}
+	
+	return (&((void **)(*table))[idx]);
+}
+
+/*
+ * Gets the page pointer of a node that covers a file offset.
+ */
+PRIVATE void **tmpfs_page(struct tmpfs_node *node, off_t off, int create)
+{
+	void **slot; /* Working slot. */
+	unsigned pg; /* Page number.  */
+	
+	pg = off >> PAGE_SHIFT;
+	
+	/* Direct page. */
+	if (pg < TMPFS_NR_DIRECT)
+		return (&node->pages[pg]);
+	
+	pg -= TMPFS_NR_DIRECT;
+	
+	/* Single indirect page. */
+	if (pg < TMPFS_NR_SLOTS)
+		return (tmpfs_slot(&node->single, pg, create));
+	
+	pg -= TMPFS_NR_SLOTS;
+	
+	/* Double indirect page. */
+	if ((slot = tmpfs_slot(&node->dbl, pg/TMPFS_NR_SLOTS, create)) == NULL)
+		return (NULL);
+	
+	return (tmpfs_slot(slot, pg%TMPFS_NR_SLOTS, create));
+}
+
+/**
+ * @brief Releases all pages of a node.
+ * 
+ * @param node Target node.
+ */
+PUBLIC void tmpfs_free(struct tmpfs_node *node)
+{
+	for (unsigned i = 0; i < TMPFS_NR_DIRECT; i++)
+	{
+		tmpfs_putpg(node->pages[i], 0);
+		node->pages[i] = NULL;
+	}
+	
+	tmpfs_putpg(node->single, 1);
+	tmpfs_putpg(node->dbl, 2);
+	node->single = NULL;
+	node->dbl = NULL;
+}
+
+/*============================================================================*
+ *                             directory entries                              *
+ *============================================================================*/
+
+/*
+ * Hashes a directory entry.
+ */
+PRIVATE unsigned tmpfs_hash(ino_t dir, const char *name)
+{
+	unsigned h; /* Hash value. */
+	
+	h = dir;
+	for (int i = 0; (i < NAME_MAX) && (name[i] != '\0'); i++)
+		h = h*31 + (unsigned char)name[i];
+	
+	return (h%TMPFS_HASHTAB_SIZE);
+}
+
+/*
+ * Searches for a directory entry.
+ */
+PRIVATE struct tmpfs_dirent **dirent_search
+(struct tmpfs *fs, ino_t dir, const char *name)
+{
+	struct tmpfs_dirent **d; /* Working entry. */
+	
+	for (d = &fs->hashtab[tmpfs_hash(dir, name)]; *d != NULL; d = &(*d)->hash_next)
+	{
+		if (((*d)->dir == dir) && (!kstrncmp((*d)->name, name, NAME_MAX)))
+			break;
+	}
+	
+	return (d);
+}
+
+/*
+ * Releases a directory entry that has already been unhashed.
+ */
+PRIVATE void dirent_unlink(struct tmpfs *fs, struct tmpfs_dirent *d)
+{
+	struct tmpfs_node *node;   /* Directory.      */
+	struct tmpfs_dirent **p;   /* Working entry.  */
+	struct tmpfs_dirent *prev; /* Previous entry. */
+	
+	node = fs->nodes[d->dir - 1];
+	
+	/* Remove entry from the directory. */
+	prev = NULL;
+	for (p = &node->entries; *p != d; p = &(*p)->next)
+		prev = *p;
+	*p = d->next;
+	if (node->last == d)
+		node->last = prev;
+	
+	kfree(d);
+}
+
+/**
+ * @brief Adds an entry to a directory.
+ * 
+ * @param fs   Target instance.
+ * @param dir  Directory.
+ * @param ino  Inode number of the file.
+ * @param name File name.
+ * 
+ * @returns Zero upon success, and a negative error code upon failure.
+ */
+PUBLIC int tmpfs_dirent_add(struct tmpfs *fs, ino_t dir, ino_t ino, const char *name)
+{
+	struct tmpfs_dirent **p; /* Hash table slot. */
+	struct tmpfs_dirent *d;  /* Directory entry. */
+	struct tmpfs_node *node; /* Directory.       */
+	
+	p = dirent_search(fs, dir, name);
+	
+	/* Duplicated entry. */
+	if (*p != NULL)
+		return (-EEXIST);
+	
+	if ((d = kmalloc(sizeof(struct tmpfs_dirent))) == NULL)
+		return (-ENOSPC);
+	
+	d->dir = dir;
+	d->ino = ino;
+	kstrncpy(d->name, name, NAME_MAX);
+	d->name[NAME_MAX] = '\0';
+	
+	/* Hash entry. */
+	d->hash_next = *p;
+	*p = d;
+	
+	/* Append entry to the directory. */
+	node = fs->nodes[dir - 1];
+	d->next = NULL;
+	if (node->last != NULL)
+		node->last->next = d;
+	else
+		node->entries = d;
+	node->last = d;
+	
+	return (0);
+}
+
+/**
+ * @brief Removes all entries of a directory.
+ * 
+ * @param fs  Target instance.
+ * @param dir Directory.
+ */
+PUBLIC void tmpfs_dirent_purge(struct tmpfs *fs, ino_t dir)
+{
+	struct tmpfs_dirent *d;  /* Working entry. */
+	struct tmpfs_dirent **p; /* Hash slot.     */
+	
+	while ((d = fs->nodes[dir - 1]->entries) != NULL)
+	{
+		p = dirent_search(fs, dir, d->name);
+		*p = d->hash_next;
+		dirent_unlink(fs, d);
+	}
+}
+
+/*
+ * Searches for a directory entry and returns its inode number.
+ */
+PUBLIC ino_t dir_search_tmpfs(struct inode *dip, const char *filename)
+{
+	struct tmpfs_dirent *d; /* Directory entry. */
+	
+	d = *dirent_search(dip->sb->u.tmpfs, dip->num, filename);
+	
+	return ((d != NULL) ? d->ino : INODE_NULL);
+}
+
+/*
+ * Removes an entry from a directory.
+ */
+PUBLIC int dir_remove_tmpfs(struct inode *dinode, const char *filename)
+{
+	struct tmpfs_dirent **p; /* Hash table slot. */
+	struct tmpfs_dirent *d;  /* Directory entry. */
+	struct inode *file;      /* File inode.      */
+	
+	p = dirent_search(dinode->sb->u.tmpfs, dinode->num, filename);
+	
+	/* Not found. */
+	if ((d = *p) == NULL)
+		return (-ENOENT);
+	
+	/* Cannot remove '.' */
+	if (d->ino == dinode->num)
+		return (-EBUSY);
+	
+	file = inode_get(dinode->dev, d->ino);
+	
+	/* Failed to get file's inode. */
+	if (file == NULL)
+		return (-ENOENT);
+	
+	/* Unlinking directory. */
+	if (S_ISDIR(file->mode))
+	{
+		/* Not allowed. */
+		if (!IS_SUPERUSER(curr_proc))
+		{
+			inode_put(file);
+			return (-EPERM);
+		}
+		
+		/* Directory not empty. */
+		if ((file->size/sizeof(struct dirent)) > 2)
+		{
+			inode_put(file);
+			return (-EBUSY);
+		}
+	}
+	
+	/* Remove directory entry. */
+	*p = d->hash_next;
+	dirent_unlink(dinode->sb->u.tmpfs, d);
+	
+	dinode->size -= sizeof(struct dirent);
+	inode_touch(dinode);
+	file->nlinks--;
+	inode_touch(file);
+	inode_put(file);
+	
+	return (0);
+}
+
+/*
+ * Adds an entry to a directory.
+ */
+PUBLIC int dir_add_tmpfs(struct inode *dinode, struct inode *inode, const char *name)
+{
+	int err; /* Error code. */
+	
+	err = tmpfs_dirent_add(dinode->sb->u.tmpfs, dinode->num, inode->num, name);
+	
+	/* Failed to create directory entry. */
+	if (err)
+	{
+		curr_proc->errno = err;
+		return (-1);
+	}
+	
+	dinode->size += sizeof(struct dirent);
+	inode_touch(dinode);
+	
+	return (0);
+}
+
+/*
+ * Reads from a directory. Offsets are given in dirent structures.
+ */
+PUBLIC ssize_t dir_read_tmpfs(struct inode *i, void *buf, size_t n, off_t off)
+{
+	struct dirent *p;       /* Writing pointer. */
+	struct dirent de;       /* Working dirent.  */
+	struct tmpfs_dirent *d; /* Working entry.   */
+	
+	p = buf;
+	
+	/* Skip entries that were already read. */
+	d = tmpfs_node(i)->entries;
+	for (off_t entry = off/sizeof(struct dirent); (d != NULL) && (entry > 0); entry--)
+		d = d->next;
+	
+	/* Read data. */
+	for (/* noop */; (n >= sizeof(struct dirent)) && (d != NULL); d = d->next)
+	{
+		kmemset(&de, 0, sizeof(struct dirent));
+		de.d_ino = d->ino;
+		kstrncpy(de.d_name, d->name, NAME_MAX);
+		
+		if (copy_to_user(p, &de, sizeof(struct dirent)))
+		{
+			if (p != buf)
+				break;
+			curr_proc->errno = -EFAULT;
+			return (-1);
+		}
+		
+		n -= sizeof(struct dirent);
+		p++;
+	}
+	
+	return ((ssize_t)((char *)p - (char *)buf));
+}
+
+/*============================================================================*
+ *                                file data                                   *
+ *============================================================================*/
+
+/*
+ * Reads from a regular file. Holes read as zeros.
+ */
+PUBLIC ssize_t file_read_tmpfs(struct inode *i, void *buf, size_t n, off_t off)
+{
+	char *p;                 /* Writing pointer. */
+	size_t pgoff;            /* Page offset.     */
+	size_t chunk;            /* Data chunk size. */
+	void **pg;               /* Working page.    */
+	struct tmpfs_node *node; /* Underlying node. */
+	
+	p = buf;
+	node = tmpfs_node(i);
+	
+	/* Read data. */
+	while ((n > 0) && (off < i->size))
+	{
+		pgoff = off & ~PAGE_MASK;
+		
+		/* Calculate read chunk size. */
+		chunk = (n < PAGE_SIZE - pgoff) ? n : PAGE_SIZE - pgoff;
+		if ((off_t)chunk > i->size - off)
+			chunk = i->size - off;
+		
+		pg = tmpfs_page(node, off, 0);
+		
+		/* Hole. */
+		if ((pg == NULL) || (*pg == NULL))
+		{
+			if (pin_user(p, chunk, 1))
+				goto fault;
+			kmemset(p, 0, chunk);
+		}
+		
+		else if (copy_to_user(p, (char *)(*pg) + pgoff, chunk))
+			goto fault;
+		
+		n -= chunk;
+		off += chunk;
+		p += chunk;
+	}
+	
+	return ((ssize_t)(p - (char *)buf));
+
+fault:
+	if (p != buf)
+		return ((ssize_t)(p - (char *)buf));
+	curr_proc->errno = -EFAULT;
+	return (-1);
+}
+
+/*
+ * Writes to a regular file.
+ */
+PUBLIC ssize_t file_write_tmpfs(struct inode *i, const void *buf, size_t n, off_t off)
+{
+	const char *p;           /* Reading pointer. */
+	size_t pgoff;            /* Page offset.     */
+	size_t chunk;            /* Data chunk size. */
+	void **pg;               /* Working page.    */
+	struct tmpfs_node *node; /* Underlying node. */
+	
+	p = buf;
+	node = tmpfs_node(i);
+	
+	/* Write data. */
+	while ((n > 0) && (off < i->sb->max_size))
+	{
+		pgoff = off & ~PAGE_MASK;
+		chunk = (n < PAGE_SIZE - pgoff) ? n : PAGE_SIZE - pgoff;
+		if ((off_t)chunk > i->sb->max_size - off)
+			chunk = i->sb->max_size - off;
+		
+		pg = tmpfs_page(node, off, 1);
+		
+		/* Out of pages. */
+		if ((pg == NULL) || ((*pg == NULL) && ((*pg = tmpfs_getpg()) == NULL)))
+			break;
+		
+		/* Bad buffer. */
+		if (copy_from_user((char *)(*pg) + pgoff, p, chunk))
+		{
+			if (p == buf)
+			{
+				curr_proc->errno = -EFAULT;
+				return (-1);
+			}
+			break;
+		}
+		
+		n -= chunk;
+		off += chunk;
+		p += chunk;
+		
+		/* Update file size. */
+		if (off > i->size)
+		{
+			i->size = off;
+			i->flags |= INODE_DIRTY;
+		}
+	}
+	
+	/* File system full. */
+	if ((p == buf) && (n > 0))
+	{
+		curr_proc->errno = -ENOSPC;
+		return (-1);
+	}
+	
+	return ((ssize_t)(p - (const char *)buf));
+}
@@ -0,0 +1,292 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief tmpfs inode module implementation.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <errno.h>
+#include "../fs.h"
+#include "tmpfs.h"
+
+/**
+ * @brief Gets the node of an inode.
+ * 
+ * @param ip Target inode.
+ * 
+ * @returns The node of the inode pointed to by @p ip, or a NULL pointer if
+ *          the inode has already been freed.
+ */
+PUBLIC struct tmpfs_node *tmpfs_node(struct inode *ip)
+{
+	return (ip->sb->u.tmpfs->nodes[ip->num - 1]);
+}
+
+/**
+ * @brief Writes an inode back to its node.
+ * 
+ * @param ip Inode to be written back.
+ * 
+ * @note The inode must be locked.
+ */
+PRIVATE void inode_write_tmpfs(struct inode *ip)
+{
+	struct tmpfs_node *node; /* Underlying node. */
+	
+	/* Nothing to be done. */
+	if (!(ip->flags & INODE_DIRTY))
+		return;
+	
+	/* Write inode to node, unless the node is gone. */
+	if ((node = tmpfs_node(ip)) != NULL)
+	{
+		node->mode = ip->mode;
+		node->nlinks = ip->nlinks;
+		node->uid = ip->uid;
+		node->gid = ip->gid;
+		node->size = ip->size;
+		node->time = ip->time;
+	}
+	
+	ip->flags &= ~INODE_DIRTY;
+}
+
+/**
+ * @brief Reads an inode from its node.
+ * 
+ * @param dev Device where the inode is located.
+ * @param num Number of the inode that shall be read.
+ * @param ip  Inode of the cache where the result of the reading is written.
+ * 
+ * @returns Upon successful completion zero is returned. Upon failure, non-zero
+ * is returned instead.
+ */
+PRIVATE int inode_read_tmpfs(dev_t dev, ino_t num, struct inode *ip)
+{
+	struct tmpfs_node *node; /* Underlying node. */
+	struct superblock *sb;   /* Super block.     */
+	
+	/* Get superblock. */
+	sb = superblock_get(dev);
+	if (sb == NULL)
+		goto error0;
+	
+	/* Invalid inode number. */
+	if ((num == INODE_NULL) || (num > sb->ninodes))
+		goto error1;
+	
+	/* Invalid node. */
+	if ((node = sb->u.tmpfs->nodes[num - 1]) == NULL)
+		goto error1;
+	
+	/* Initialize in-core inode. */
+	ip->mode = node->mode;
+	ip->nlinks = node->nlinks;
+	ip->uid = node->uid;
+	ip->gid = node->gid;
+	ip->size = node->size;
+	ip->time = node->time;
+	for (unsigned i = 0; i < NR_ZONES_V3; i++)
+		ip->blocks[i] = BLOCK_NULL;
+	ip->dev = dev;
+	ip->num = num;
+	ip->sb = sb;
+	ip->i_op = &inode_o_tmpfs;
+	ip->flags &= ~(INODE_DIRTY | INODE_MOUNT | INODE_PIPE);
+	ip->flags |= INODE_VALID;
+	
+	superblock_put(sb);
+	
+	return (0);
+
+error1:
+	superblock_put(sb);
+error0:
+	return (1);
+}
+
+/**
+ * @brief Frees an inode.
+ * 
+ * @details Frees the inode pointed to by @p ip, along with its data pages
+ *          and the directory entries that it holds.
+ * 
+ * @note The inode must be locked.
+ */
+PRIVATE void inode_free_tmpfs(struct inode *ip)
+{
+	struct tmpfs_node *node; /* Underlying node. */
+	
+	node = tmpfs_node(ip);
+	
+	tmpfs_dirent_purge(ip->sb->u.tmpfs, ip->num);
+	tmpfs_free(node);
+	kfree(node);
+	
+	ip->sb->u.tmpfs->nodes[ip->num - 1] = NULL;
+	if (ip->num < ip->sb->isearch)
+		ip->sb->isearch = ip->num;
+}
+
+/**
+ * @brief Truncates an inode.
+ * 
+ * @details Truncates the inode pointed to by @p ip by freeing all of its
+ *          data pages.
+ * 
+ * @param ip Inode that shall be truncated.
+ * 
+ * @note The inode must be locked.
+ */
+PRIVATE void inode_truncate_tmpfs(struct inode *ip)
+{
+	struct tmpfs_node *node; /* Underlying node. */
+	
+	/* Node may be gone already. */
+	if ((node = tmpfs_node(ip)) != NULL)
+		tmpfs_free(node);
+	
+	ip->size = 0;
+	inode_touch(ip);
+}
+
+/**
+ * @brief Allocates an inode.
+ * 
+ * @param sb Superblock where the inode shall be allocated.
+ * @param ip Inode of the cache which is allocated.
+ * 
+ * @returns Upon successful completion zero is returned. Upon failure, non-zero
+ * is returned instead.
+ * 
+ * @note The superblock must not be locked.
+ */
+PRIVATE int inode_alloc_tmpfs(struct superblock *sb, struct inode *ip)
+{
+	ino_t num;               /* Inode number. */
+	struct tmpfs_node *node; /* New node.     */
+	
+	superblock_lock(sb);
+	
+	/* Search for free node. */
+	for (num = sb->isearch; num <= sb->ninodes; num++)
+	{
+		if (sb->u.tmpfs->nodes[num - 1] == NULL)
+			goto found;
+	}
+	
+	curr_proc->errno = -ENOSPC;
+	goto error0;
+
+found:
+	
+	if ((node = kmalloc(sizeof(struct tmpfs_node))) == NULL)
+	{
+		curr_proc->errno = -ENOSPC;
+		goto error0;
+	}
+	
+	kmemset(node, 0, sizeof(struct tmpfs_node));
+	sb->u.tmpfs->nodes[num - 1] = node;
+	sb->isearch = num + 1;
+	
+	/* 
+	 * Initialize inode. 
+	 * mode will be initialized later.
+	 */
+	ip->nlinks = 1;
+	ip->uid = curr_proc->euid;
+	ip->gid = curr_proc->egid;
+	ip->size = 0;
+	for (unsigned j = 0; j < NR_ZONES_V3; j++)
+		ip->blocks[j] = BLOCK_NULL;
+	ip->dev = sb->dev;
+	ip->num = num;
+	ip->sb = sb;
+	ip->flags &= ~(INODE_MOUNT | INODE_PIPE);
+	ip->flags |= INODE_VALID;
+	ip->i_op = &inode_o_tmpfs;
+	superblock_unlock(sb);
+	
+	return (0);
+
+error0:
+	superblock_unlock(sb);
+	return (1);
+}
+
+/**
+ * @brief tmpfs file system operations.
+ */
+PRIVATE struct super_operations super_o_tmpfs = 
+{
+	&inode_read_tmpfs,      /* inode_read      */ 
+	&inode_write_tmpfs,     /* inode_write     */
+	&inode_free_tmpfs,      /* inode_free      */
+	&inode_truncate_tmpfs,  /* inode_truncate  */
+	&inode_alloc_tmpfs,     /* inode_alloc     */
+	NULL,                   /* notify_change   */
+	NULL,                   /* put inode       */
+	&superblock_put_tmpfs,  /* put_super       */
+	NULL,                   /* write_super     */
+	&superblock_stat_tmpfs, /* superblock_stat */
+	NULL                    /* remount_fs      */
+};
+
+/**
+ * @brief tmpfs inode operations.
+ * 
+ * @details Files live in kernel pages rather than in block buffers, so
+ *          they can be neither mapped in place nor read block-wise.
+ */
+PUBLIC struct inode_operations inode_o_tmpfs =
+{
+	&dir_read_tmpfs,
+	&dir_add_tmpfs,
+	&dir_remove_tmpfs,
+	&file_read_tmpfs,
+	&file_write_tmpfs,
+	&dir_search_tmpfs,
+	NULL,
+	NULL,
+	NULL
+};
+
+PRIVATE struct file_system_type fs_tmpfs = {
+	superblock_read_tmpfs,
+	&super_o_tmpfs,
+	"tmpfs",
+	FS_NODEV
+};
+
+/**
+ * @brief Initialise the file system in the virtual file system.
+ */
+PUBLIC void init_tmpfs(void)
+{
+	if (fs_register(TMPFS, &fs_tmpfs))
+		kpanic("Failed to register tmpfs file system");
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/dev.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <dirent.h>
+#include <ustat.h>
+#include "../fs.h"
+#include "tmpfs.h"
+
+/**
+ * @file
+ * 
+ * @brief tmpfs superblock module implementation.
+ */
+
+/**
+ * @addtogroup Superblock
+ */
+/**@{*/
+
+/**
+ * @brief tmpfs instances.
+ * 
+ * @details Instances are picked by the minor number of the device and
+ *          outlive unmounting, as the contents of a disk would.
+ */
+PRIVATE struct tmpfs tmpfs_table[NR_TMPFS];
+
+/**
+ * @brief Creates the root directory of an instance.
+ * 
+ * @param fs Target instance.
+ * 
+ * @returns Zero upon success, and non-zero otherwise.
+ */
+PRIVATE int tmpfs_mkroot(struct tmpfs *fs)
+{
+	struct tmpfs_node *node; /* Root directory. */
+	
+	if ((node = kmalloc(sizeof(struct tmpfs_node))) == NULL)
+		return (-1);
+	
+	kmemset(node, 0, sizeof(struct tmpfs_node));
+	node->mode = S_IFDIR | MAY_ALL;
+	node->nlinks = 2;
+	node->time = CURRENT_TIME;
+	fs->nodes[INODE_ROOT - 1] = node;
+	
+	/* Create '.' and '..' */
+	if (tmpfs_dirent_add(fs, INODE_ROOT, INODE_ROOT, ".") ||
+		tmpfs_dirent_add(fs, INODE_ROOT, INODE_ROOT, ".."))
+	{
+		tmpfs_dirent_purge(fs, INODE_ROOT);
+		fs->nodes[INODE_ROOT - 1] = NULL;
+		kfree(node);
+		return (-1);
+	}
+	node->size = 2*sizeof(struct dirent);
+	
+	return (0);
+}
+
+/**
+ * @brief Reads a tmpfs superblock.
+ * 
+ * @details There is nothing to read: the device number only picks a tmpfs
+ *          instance, which is created on first use with an empty root
+ *          directory.
+ * 
+ * @param dev Device number.
+ * @param sb  In-core superblock to be filled.
+ * 
+ * @returns Upon successful completion, a pointer to the in-core superblock
+ *          is returned. Upon failure, a NULL pointer is returned instead.
+ * 
+ * @note The superblock must be locked.
+ */
+PUBLIC struct superblock *superblock_read_tmpfs(dev_t dev, struct superblock *sb)
+{
+	struct tmpfs *fs; /* tmpfs instance. */
+	
+	/* Not a tmpfs device. */
+	if ((MAJOR(dev) != TMPFS_MAJOR) || ((dev & 1) != CHRDEV) ||
+		(MINOR(dev) >= NR_TMPFS))
+		return (NULL);
+	
+	fs = &tmpfs_table[MINOR(dev)];
+	
+	/* First use. */
+	if (!fs->used)
+	{
+		if (tmpfs_mkroot(fs))
+			return (NULL);
+		fs->used = 1;
+	}
+	
+	/* Initialize superblock. */
+	sb->u.tmpfs = fs;
+	sb->buf = NULL;
+	sb->ninodes = TMPFS_NR_INODES;
+	sb->imap_blocks = 0;
+	sb->zmap_blocks = 0;
+	sb->first_data_block = 0;
+	sb->max_size = 0x7fffffff;
+	sb->zones = TMPFS_NR_PAGES;
+	sb->root = NULL;
+	sb->mp = NULL;
+	sb->dev = dev;
+	sb->flags &= ~(SUPERBLOCK_DIRTY | SUPERBLOCK_RDONLY);
+	sb->flags |= SUPERBLOCK_VALID;
+	sb->isearch = INODE_ROOT + 1;
+	sb->zsearch = 0;
+	sb->chain = NULL;
+	sb->count++;
+	sb->s_op = fs_get(TMPFS)->so;
+	
+	return (sb);
+}
+
+/**
+ * @brief Releases a superblock.
+ * 
+ * @details Releases a superblock. If its reference count drops to zero, the
+ *          superblock is marked as invalid. The tmpfs instance is kept.
+ * 
+ * @param sb Superblock to be released.
+ * 
+ * @note The superblock must be valid.
+ * @note The superblock must be locked.
+ */
+PUBLIC void superblock_put_tmpfs(struct superblock *sb)
+{
+	/* Double free. */
+	if (sb->count == 0)
+		kpanic("freeing superblock twice");
+	
+	if (--sb->count == 0)
+		sb->flags &= ~SUPERBLOCK_VALID;
+}
+
+/**
+ * @brief Gets file system statistics.
+ * 
+ * @details Free blocks are counted in pages, and are shared by all tmpfs
+ *          instances.
+ * 
+ * @param sb   Superblock of the file system to be inspected.
+ * @param ubuf Place where statics should be stored.
+ * 
+ * @note The superblock must be valid.
+ * @note The superblock must be locked.
+ * @note The buffer must be valid.
+ */
+PUBLIC void superblock_stat_tmpfs(struct superblock *sb, struct ustat *ubuf)
+{
+	int tinode; /* Total free inodes. */
+	
+	/* Count number of free inodes. */
+	tinode = 0;
+	for (unsigned i = 0; i < sb->ninodes; i++)
+	{
+		if (sb->u.tmpfs->nodes[i] == NULL)
+			tinode++;
+	}
+	
+	ubuf->f_tfree = TMPFS_NR_PAGES - tmpfs_npages;
+	ubuf->f_tinode = tinode;
+	kstrcpy(ubuf->f_fname, "tmpfs");
+	ubuf->f_fpack[0] = '\0';
+}
+
+/**@}*/
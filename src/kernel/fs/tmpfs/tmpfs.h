@@ -0,0 +1,135 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file
+ * 
+ * @brief tmpfs private interface.
+ */
+#ifndef _TMPFS_H_
+#define _TMPFS_H_
+
+	#include <nanvix/config.h>
+	#include <nanvix/const.h>
+	#include <nanvix/fs.h>
+	#include <nanvix/mm.h>
+	#include <sys/types.h>
+	#include <limits.h>
+
+	/**
+	 * @name tmpfs limits
+	 */
+	/**@{*/
+	#define NR_TMPFS                            4 /**< tmpfs instances.         */
+	#define TMPFS_NR_INODES                   256 /**< Inodes per instance.     */
+	#define TMPFS_NR_PAGES (TMPFS_SIZE/PAGE_SIZE) /**< Pages for all instances. */
+	#define TMPFS_HASHTAB_SIZE                 61 /**< Directory hash table.    */
+	/**@}*/
+
+	/*
+	 * File data lives in kernel pages, so tmpfs may take at most half of
+	 * the kernel page pool. Writes fail with ENOSPC once TMPFS_SIZE bytes
+	 * are in use, or if the pool runs dry before that.
+	 */
+	#if (TMPFS_SIZE > KPOOL_SIZE/2)
+		#error "TMPFS_SIZE must be at most half of KPOOL_SIZE"
+	#endif
+
+	/**
+	 * @brief Number of pages that are directly referenced by a node.
+	 */
+	#define TMPFS_NR_DIRECT 8
+
+	/**
+	 * @brief Number of page pointers in a page table.
+	 */
+	#define TMPFS_NR_SLOTS (PAGE_SIZE/sizeof(void *))
+
+	/**
+	 * @brief Directory entry.
+	 * 
+	 * @details Directory entries of an instance live in a single hash table,
+	 *          keyed by directory and file name. Entries of a directory are
+	 *          also chained in the order they were added, for dir_read().
+	 */
+	struct tmpfs_dirent
+	{
+		ino_t dir;                      /**< Directory.             */
+		ino_t ino;                      /**< Inode number.          */
+		struct tmpfs_dirent *hash_next; /**< Next entry in bucket.  */
+		struct tmpfs_dirent *next;      /**< Next entry in dir.     */
+		char name[NAME_MAX + 1];        /**< File name.             */
+	};
+
+	/**
+	 * @brief Node.
+	 * 
+	 * @details A node is what a disk inode is to disk file systems: it holds
+	 *          the file while no in-core inode refers to it. File data lives
+	 *          in kernel pages, reached through direct pointers, a single
+	 *          indirect and a double indirect page table.
+	 */
+	struct tmpfs_node
+	{
+		mode_t mode;                   /**< Access permissions.          */
+		nlink_t nlinks;                /**< Number of links to the file. */
+		uid_t uid;                     /**< User id of the file's owner. */
+		gid_t gid;                     /**< Group number of owner user.  */
+		off_t size;                    /**< File size (in bytes).        */
+		time_t time;                   /**< Time of last access.         */
+		void *pages[TMPFS_NR_DIRECT];  /**< Direct pages.                */
+		void *single;                  /**< Single indirect page table.  */
+		void *dbl;                     /**< Double indirect page table.  */
+		struct tmpfs_dirent *entries;  /**< First directory entry.       */
+		struct tmpfs_dirent *last;     /**< Last directory entry.        */
+	};
+
+	/**
+	 * @brief tmpfs instance.
+	 */
+	struct tmpfs
+	{
+		int used;                                         /**< In use?    */
+		struct tmpfs_node *nodes[TMPFS_NR_INODES];        /**< Nodes.     */
+		struct tmpfs_dirent *hashtab[TMPFS_HASHTAB_SIZE]; /**< Dir table. */
+	};
+
+	/* Forward definitions. */
+	EXTERN unsigned tmpfs_npages;
+	EXTERN struct tmpfs_node *tmpfs_node(struct inode *);
+	EXTERN void tmpfs_free(struct tmpfs_node *);
+	EXTERN int tmpfs_dirent_add(struct tmpfs *, ino_t, ino_t, const char *);
+	EXTERN void tmpfs_dirent_purge(struct tmpfs *, ino_t);
+
+	EXTERN void init_tmpfs(void);
+
+	EXTERN struct superblock *superblock_read_tmpfs(dev_t, struct superblock *);
+	EXTERN void superblock_put_tmpfs(struct superblock *);
+	EXTERN void superblock_stat_tmpfs(struct superblock *, struct ustat *);
+
+	EXTERN ssize_t dir_read_tmpfs(struct inode *, void *, size_t , off_t );
+	EXTERN int dir_add_tmpfs(struct inode *, struct inode *, const char *);
+	EXTERN int dir_remove_tmpfs(struct inode *, const char *);
+	EXTERN ino_t dir_search_tmpfs(struct inode *, const char *);
+	EXTERN ssize_t file_read_tmpfs(struct inode *, void *, size_t , off_t );
+	EXTERN ssize_t file_write_tmpfs(struct inode *, const void *, size_t , off_t);
+
+	EXTERN struct inode_operations inode_o_tmpfs;
+
+#endif /* _TMPFS_H_ */
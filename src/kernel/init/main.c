@@ -50,11 +50,16 @@ PUBLIC void kmain(const char* cmdline)
 {		
 	struct process *p; /* Working process.  */
 	
+	/* Serialize kernel among processors. */
+	kernel_lock();
+
 	if(!kstrcmp(cmdline,"debug"))
 		dbg_init();
 
 	/* Initialize system modules. */
+	klib_init();
 	cpu_init();
+	smp_init();
 	dev_init();
 	mm_init();
 	pm_init();
@@ -64,6 +69,9 @@ PUBLIC void kmain(const char* cmdline)
 
 	dbg_execute();
 
+	/* Start other processors. */
+	smp_boot();
+
 	/* Spawn init process. */
 	init();
 	
@@ -90,7 +98,7 @@ PUBLIC void kmain(const char* cmdline)
 			}
 		}
 		
-		halt();
+		cpu_idle();
 		yield();
 	}
 }
@@ -0,0 +1,324 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/debug.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/**
+ * @brief Number of times each benchmark is run.
+ */
+#define KBENCH_NITERATIONS 64
+
+/**
+ * @brief Buffer sizes that are benchmarked.
+ */
+PRIVATE const size_t kbench_sizes[] = { 16, 64, 512, 2048 };
+
+/**
+ * @brief Number of buffer sizes that are benchmarked.
+ */
+#define KBENCH_NSIZES ((int)(sizeof(kbench_sizes)/sizeof(kbench_sizes[0])))
+
+/**
+ * @brief Reads the time stamp.
+ *
+ * @returns A time stamp, in CPU cycles when supported by the
+ * underlying hardware, and in clock ticks otherwise.
+ */
+PRIVATE inline unsigned kbench_time(void)
+{
+#ifdef i386
+	unsigned lo, hi;
+
+	__asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+
+	UNUSED(hi);
+
+	return (lo);
+#else
+	return (ticks);
+#endif
+}
+
+/*============================================================================*
+ *                          reference implementations                         *
+ *============================================================================*/
+
+/**
+ * @brief Byte-by-byte memory copy.
+ */
+PRIVATE void ref_memcpy(void *dest, const void *src, size_t n)
+{
+	char *d = dest;
+	const char *s = src;
+
+	while (n-- > 0)
+		*d++ = *s++;
+}
+
+/**
+ * @brief Byte-by-byte memory fill.
+ */
+PRIVATE void ref_memset(void *ptr, int c, size_t n)
+{
+	char *p = ptr;
+
+	while (n-- > 0)
+		*p++ = c;
+}
+
+/**
+ * @brief Byte-by-byte string length.
+ */
+PRIVATE size_t ref_strlen(const char *str)
+{
+	const char *p;
+
+	for (p = str; *p != '\0'; p++)
+		noop();
+
+	return (p - str);
+}
+
+/*============================================================================*
+ *                                benchmarks                                  *
+ *============================================================================*/
+
+/**
+ * @brief Benchmarks kmemcpy().
+ *
+ * @param dst    Target buffer.
+ * @param src    Source buffer.
+ * @param offset Misalignment of the target buffer.
+ *
+ * @returns Zero if the copies were correct, and non-zero otherwise.
+ */
+PRIVATE int kbench_memcpy(char *dst, char *src, int offset)
+{
+	unsigned t0, t1, t2;
+
+	for (int i = 0; i < KBENCH_NSIZES; i++)
+	{
+		size_t n = kbench_sizes[i];
+
+		/* Reference. */
+		t0 = kbench_time();
+		for (int j = 0; j < KBENCH_NITERATIONS; j++)
+			ref_memcpy(dst + offset, src, n);
+		t1 = kbench_time();
+
+		/* Optimized. */
+		for (int j = 0; j < KBENCH_NITERATIONS; j++)
+		{
+			dst[offset + n] = 0x5a;
+			if (kmemcpy(dst + offset, src, n) != dst + offset)
+				return (-1);
+		}
+		t2 = kbench_time();
+
+		/* Check. */
+		for (size_t j = 0; j < n; j++)
+		{
+			if (dst[offset + j] != src[j])
+				return (-1);
+		}
+		if (dst[offset + n] != 0x5a)
+			return (-1);
+
+		kprintf(KERN_DEBUG "kbench: kmemcpy  %d+%d bytes: %d vs %d",
+			n, offset, (t2 - t1)/KBENCH_NITERATIONS,
+			(t1 - t0)/KBENCH_NITERATIONS);
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Benchmarks kmemset().
+ *
+ * @param dst    Target buffer.
+ * @param offset Misalignment of the target buffer.
+ *
+ * @returns Zero if the fills were correct, and non-zero otherwise.
+ */
+PRIVATE int kbench_memset(char *dst, int offset)
+{
+	unsigned t0, t1, t2;
+
+	for (int i = 0; i < KBENCH_NSIZES; i++)
+	{
+		size_t n = kbench_sizes[i];
+
+		/* Reference. */
+		t0 = kbench_time();
+		for (int j = 0; j < KBENCH_NITERATIONS; j++)
+			ref_memset(dst + offset, 0, n);
+		t1 = kbench_time();
+
+		/* Optimized. */
+		for (int j = 0; j < KBENCH_NITERATIONS; j++)
+		{
+			dst[offset + n] = 0x5a;
+			if (kmemset(dst + offset, 0xa5, n) != dst + offset)
+				return (-1);
+		}
+		t2 = kbench_time();
+
+		/* Check. */
+		for (size_t j = 0; j < n; j++)
+		{
+			if ((dst[offset + j] & 0xff) != 0xa5)
+				return (-1);
+		}
+		if (dst[offset + n] != 0x5a)
+			return (-1);
+
+		kprintf(KERN_DEBUG "kbench: kmemset  %d+%d bytes: %d vs %d",
+			n, offset, (t2 - t1)/KBENCH_NITERATIONS,
+			(t1 - t0)/KBENCH_NITERATIONS);
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Benchmarks kstrlen() and kstrncmp().
+ *
+ * @param str1   String buffer.
+ * @param str2   String buffer.
+ * @param offset Misalignment of the strings.
+ *
+ * @returns Zero if the results were correct, and non-zero otherwise.
+ */
+PRIVATE int kbench_string(char *str1, char *str2, int offset)
+{
+	unsigned t0, t1, t2;
+
+	for (int i = 0; i < KBENCH_NSIZES; i++)
+	{
+		size_t n = kbench_sizes[i];
+		size_t len = 0;
+
+		ref_memset(str1 + offset, 'a', n);
+		ref_memset(str2 + offset, 'a', n);
+		str1[offset + n] = '\0';
+		str2[offset + n] = '\0';
+
+		/* Reference. */
+		t0 = kbench_time();
+		for (int j = 0; j < KBENCH_NITERATIONS; j++)
+			len += ref_strlen(str1 + offset);
+		t1 = kbench_time();
+
+		/* Optimized. */
+		for (int j = 0; j < KBENCH_NITERATIONS; j++)
+			len -= kstrlen(str1 + offset);
+		t2 = kbench_time();
+
+		if (len != 0)
+			return (-1);
+
+		kprintf(KERN_DEBUG "kbench: kstrlen  %d+%d bytes: %d vs %d",
+			n, offset, (t2 - t1)/KBENCH_NITERATIONS,
+			(t1 - t0)/KBENCH_NITERATIONS);
+
+		/* Equal strings, and bounded comparisons. */
+		if (kstrncmp(str1 + offset, str2 + offset, n + 1) != 0)
+			return (-1);
+		if (kstrncmp(str1 + offset, str2 + offset, 2*n) != 0)
+			return (-1);
+
+		/* Strings that differ at the very end. */
+		str2[offset + n - 1] = 'b';
+		t0 = kbench_time();
+		for (int j = 0; j < KBENCH_NITERATIONS; j++)
+		{
+			if (kstrncmp(str1 + offset, str2 + offset, n) >= 0)
+				return (-1);
+		}
+		t1 = kbench_time();
+		if (kstrncmp(str1 + offset, str2 + offset, n - 1) != 0)
+			return (-1);
+
+		kprintf(KERN_DEBUG "kbench: kstrncmp %d+%d bytes: %d",
+			n, offset, (t1 - t0)/KBENCH_NITERATIONS);
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Kernel library micro-benchmarks.
+ *
+ * @details Checks and times the kernel memory and string functions
+ * against byte-by-byte reference implementations, on aligned and
+ * misaligned buffers. Timings are reported in cycles per call on i386
+ * and in clock ticks per call elsewhere.
+ */
+PUBLIC void test_klib(void)
+{
+	char *buf1, *buf2;
+
+	if ((buf1 = getkpg(0)) == NULL)
+		goto error0;
+	if ((buf2 = getkpg(0)) == NULL)
+		goto error1;
+
+	for (int i = 0; i < PAGE_SIZE; i++)
+		buf2[i] = i;
+
+	/*
+	 * Aligned buffers exercise the fast paths, misaligned
+	 * ones exercise alignment prologues and epilogues.
+	 */
+	for (int offset = 0; offset < 4; offset += 3)
+	{
+		if (kbench_memcpy(buf1, buf2 + 1, offset))
+			goto error2;
+		if (kbench_memset(buf1, offset))
+			goto error2;
+		if (kbench_string(buf1, buf2, offset))
+			goto error2;
+	}
+
+	putkpg(buf2);
+	putkpg(buf1);
+	tst_passed();
+	return;
+
+error2:
+	putkpg(buf2);
+error1:
+	putkpg(buf1);
+error0:
+	tst_failed();
+}
+
+/**
+ * @brief Initializes the kernel library.
+ */
+PUBLIC void klib_init(void)
+{
+	dbg_register(test_klib, "test_klib");
+}
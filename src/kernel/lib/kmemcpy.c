@@ -22,45 +22,193 @@
 #include <nanvix/klib.h>
 #include <sys/types.h>
 
+#ifdef i386
+
+#include <i386/fpu.h>
+
+/**
+ * @brief Minimum number of bytes for a SIMD copy.
+ */
+#define KMEMCPY_SIMD_MIN 1024
+
+/**
+ * @brief Copies 64-byte blocks using SSE2 instructions.
+ *
+ * @details The destination must be 16-byte aligned. The SIMD registers
+ * that are used hold the state of the running process, so they are
+ * saved and restored around the copy.
+ *
+ * @param d Target memory area.
+ * @param s Source memory area.
+ * @param n Number of bytes to copy (multiple of 64).
+ */
+PRIVATE inline void kmemcpy_simd(char *d, const char *s, size_t n)
+{
+	char xmm[64]; /* Saved SIMD registers. */
+
+	__asm__ __volatile__ (
+		"movdqu %%xmm0,   (%0)\n"
+		"movdqu %%xmm1, 16(%0)\n"
+		"movdqu %%xmm2, 32(%0)\n"
+		"movdqu %%xmm3, 48(%0)\n"
+		:
+		: "r" (xmm)
+		: "memory"
+	);
+
+	for (/* noop */; n > 0; n -= 64, s += 64, d += 64)
+	{
+		__asm__ __volatile__ (
+			"movdqu   (%1), %%xmm0\n"
+			"movdqu 16(%1), %%xmm1\n"
+			"movdqu 32(%1), %%xmm2\n"
+			"movdqu 48(%1), %%xmm3\n"
+			"movdqa %%xmm0,   (%0)\n"
+			"movdqa %%xmm1, 16(%0)\n"
+			"movdqa %%xmm2, 32(%0)\n"
+			"movdqa %%xmm3, 48(%0)\n"
+			:
+			: "r" (d), "r" (s)
+			: "memory"
+		);
+	}
+
+	__asm__ __volatile__ (
+		"movdqu   (%0), %%xmm0\n"
+		"movdqu 16(%0), %%xmm1\n"
+		"movdqu 32(%0), %%xmm2\n"
+		"movdqu 48(%0), %%xmm3\n"
+		:
+		: "r" (xmm)
+		: "memory"
+	);
+}
+
 /**
  * @brief Copy bytes in memory.
  * 
+ * @details Aligns the target memory area with a byte string copy, moves
+ * the bulk of the data with a double word string copy and finishes up
+ * with a byte string copy. Large copies go through SSE2, if available.
+ * 
  * @param dest Target memory area.
  * @param src  Source memory area.
  * @param n    Number of bytes to be copied.
  * 
  * @returns A pointer to the target memory area.
  */
-PUBLIC void *kmemcpy (void* dest, const void *src, size_t n)
+PUBLIC void *kmemcpy(void *dest, const void *src, size_t n)
 {
-    char *d;              /* 8-bit write pointer.  */
-    const char* s;        /* 8-bit read pointer.   */
-    addr_t *dalign;       /* 32-bit write pointer. */
-    const addr_t *salign; /* 32-bit read pointer.  */
-
-    s = src;
-    d = dest;
-
-    /* Check if the addresses are aligned and at least 1-dword size. */
-    if (n >= sizeof(dword_t) &&
-		ALIGNED(src, sizeof(addr_t)) && ALIGNED(dest, sizeof(addr_t)))
-    {
-		salign = (addr_t *) src;
-		dalign = (addr_t *) dest;
-		
+	size_t head;      /* Bytes to align target.    */
+	size_t words;     /* Double words to copy.     */
+	char *d = dest;   /* Write pointer.            */
+	const char *s = src; /* Read pointer.          */
+
+	/* Large copy. */
+	if ((n >= KMEMCPY_SIMD_MIN) && (fpu_sse2))
+	{
+		size_t blocks;
+
+		head = (-(addr_t)d) & 15;
+		n -= head;
+		__asm__ __volatile__ (
+			"rep movsb"
+			: "+D" (d), "+S" (s), "+c" (head)
+			:
+			: "memory"
+		);
+
+		blocks = n & ~63;
+		kmemcpy_simd(d, s, blocks);
+		d += blocks;
+		s += blocks;
+		n -= blocks;
+	}
+
+	/* Align target. */
+	head = (-(addr_t)d) & 3;
+	if (head > n)
+		head = n;
+	n -= head;
+
+	words = n >> 2;
+	n &= 3;
+
+	__asm__ __volatile__ (
+		"rep movsb\n"
+		"movl %3, %%ecx\n"
+		"rep movsl\n"
+		"movl %4, %%ecx\n"
+		"rep movsb\n"
+		: "+D" (d), "+S" (s), "+c" (head)
+		: "g" (words), "g" (n)
+		: "memory"
+	);
+
+	return (dest);
+}
+
+#else
+
+/**
+ * @brief Copy bytes in memory.
+ * 
+ * @details Copies a word at a time whenever the source and target
+ * memory areas can be aligned at the same time.
+ * 
+ * @param dest Target memory area.
+ * @param src  Source memory area.
+ * @param n    Number of bytes to be copied.
+ * 
+ * @returns A pointer to the target memory area.
+ */
+PUBLIC void *kmemcpy(void *dest, const void *src, size_t n)
+{
+	char *d;              /* 8-bit write pointer.  */
+	const char *s;        /* 8-bit read pointer.   */
+	addr_t *dalign;       /* Word write pointer.   */
+	const addr_t *salign; /* Word read pointer.    */
+
+	s = src;
+	d = dest;
+
+	/* Source and target can be aligned together. */
+	if ((((addr_t)s ^ (addr_t)d) & (sizeof(addr_t) - 1)) == 0)
+	{
+		/* Align. */
+		while ((n > 0) && (!ALIGNED(d, sizeof(addr_t))))
+			*d++ = *s++, n--;
+
+		salign = (const addr_t *) s;
+		dalign = (addr_t *) d;
+
+		/* Unrolled copy. */
+		while (n >= 4*sizeof(addr_t))
+		{
+			dalign[0] = salign[0];
+			dalign[1] = salign[1];
+			dalign[2] = salign[2];
+			dalign[3] = salign[3];
+			dalign += 4;
+			salign += 4;
+			n -= 4*sizeof(addr_t);
+		}
+
 		while (n >= sizeof(addr_t))
 		{
 			*dalign++ = *salign++;
 			n -= sizeof(addr_t);
 		}
 
-		s = (char *) salign;
+		s = (const char *) salign;
 		d = (char *) dalign;
-    }
+	}
 
 	/* Remaining bytes if any. */
 	while (n-- > 0)
 		*d++ = *s++;
 
-    return (d);
+	return (dest);
 }
+
+#endif
@@ -22,9 +22,67 @@
 #include <nanvix/klib.h>
 #include <sys/types.h>
 
+#ifdef i386
+
+#include <i386/fpu.h>
+
+/**
+ * @brief Minimum number of bytes for a SIMD fill.
+ */
+#define KMEMSET_SIMD_MIN 1024
+
+/**
+ * @brief Fills 64-byte blocks using SSE2 instructions.
+ *
+ * @details The target must be 16-byte aligned. The SIMD register that
+ * is used holds the state of the running process, so it is saved and
+ * restored around the fill.
+ *
+ * @param p    Target memory area.
+ * @param word Fill pattern.
+ * @param n    Number of bytes to fill (multiple of 64).
+ */
+PRIVATE inline void kmemset_simd(char *p, dword_t word, size_t n)
+{
+	char xmm[16];                                    /* Saved register. */
+	dword_t pattern[4] = { word, word, word, word }; /* Fill pattern.   */
+
+	__asm__ __volatile__ (
+		"movdqu %%xmm0, (%0)\n"
+		"movdqu (%1), %%xmm0\n"
+		:
+		: "r" (xmm), "r" (pattern)
+		: "memory"
+	);
+
+	for (/* noop */; n > 0; n -= 64, p += 64)
+	{
+		__asm__ __volatile__ (
+			"movdqa %%xmm0,   (%0)\n"
+			"movdqa %%xmm0, 16(%0)\n"
+			"movdqa %%xmm0, 32(%0)\n"
+			"movdqa %%xmm0, 48(%0)\n"
+			:
+			: "r" (p)
+			: "memory"
+		);
+	}
+
+	__asm__ __volatile__ (
+		"movdqu (%0), %%xmm0\n"
+		:
+		: "r" (xmm)
+		: "memory"
+	);
+}
+
 /**
  * @brief Sets bytes in memory.
  * 
+ * @details Aligns the target memory area with a byte string store, fills
+ * the bulk of it with a double word string store and finishes up with a
+ * byte string store. Large fills go through SSE2, if available.
+ * 
  * @param ptr Pointer to target memory area.
  * @param c   Character to use.
  * @param n   Number of bytes to be set.
@@ -33,35 +91,109 @@
  */
 PUBLIC void *kmemset(void *ptr, int c, size_t n)
 {
-    unsigned char *p;
-    addr_t *addr;
-   	dword_t buff;
-
-    p = ptr;
-
-    /* Copy until address be aligned. */
-    while (!ALIGNED(p, sizeof(addr_t)))
-    {
-    	if (n--)
-			*p++ = (unsigned char) c;
-		else
-			return (ptr);
+	size_t head;    /* Bytes to align target. */
+	size_t words;   /* Double words to fill.  */
+	dword_t word;   /* Fill pattern.          */
+	char *p = ptr;  /* Write pointer.         */
+
+	word = (unsigned char) c;
+	word |= word << 8;
+	word |= word << 16;
+
+	/* Large fill. */
+	if ((n >= KMEMSET_SIMD_MIN) && (fpu_sse2))
+	{
+		size_t blocks;
+
+		head = (-(addr_t)p) & 15;
+		n -= head;
+		__asm__ __volatile__ (
+			"rep stosb"
+			: "+D" (p), "+c" (head)
+			: "a" (word)
+			: "memory"
+		);
+
+		blocks = n & ~63;
+		kmemset_simd(p, word, blocks);
+		p += blocks;
+		n -= blocks;
 	}
 
-	/* Copy 4-bytes at a time. */
-	buff = (c << 24) | (c << 16) | (c << 8) | c;
+	/* Align target. */
+	head = (-(addr_t)p) & 3;
+	if (head > n)
+		head = n;
+	n -= head;
+
+	words = n >> 2;
+	n &= 3;
+
+	__asm__ __volatile__ (
+		"rep stosb\n"
+		"movl %3, %%ecx\n"
+		"rep stosl\n"
+		"movl %4, %%ecx\n"
+		"rep stosb\n"
+		: "+D" (p), "+c" (head)
+		: "a" (word), "g" (words), "g" (n)
+		: "memory"
+	);
+
+	return (ptr);
+}
+
+#else
+
+/**
+ * @brief Sets bytes in memory.
+ * 
+ * @param ptr Pointer to target memory area.
+ * @param c   Character to use.
+ * @param n   Number of bytes to be set.
+ * 
+ * @returns A pointer to the target memory area. 
+ */
+PUBLIC void *kmemset(void *ptr, int c, size_t n)
+{
+	unsigned char *p;
+	addr_t *addr;
+	addr_t word;
+
+	p = ptr;
+
+	/* Fill until address be aligned. */
+	while ((n > 0) && (!ALIGNED(p, sizeof(addr_t))))
+		*p++ = (unsigned char) c, n--;
+
+	/* Fill a word at a time. */
+	word = (unsigned char) c;
+	word |= word << 8;
+	word |= word << 16;
 	addr = (addr_t *)p;
 
+	while (n >= 4*sizeof(addr_t))
+	{
+		addr[0] = word;
+		addr[1] = word;
+		addr[2] = word;
+		addr[3] = word;
+		addr += 4;
+		n -= 4*sizeof(addr_t);
+	}
+
 	while (n >= sizeof(addr_t))
 	{
-		*addr++ = buff;
+		*addr++ = word;
 		n -= sizeof(addr_t);
 	}
 
-	/* Copy remaining bytes if any. */
+	/* Fill remaining bytes if any. */
 	p = (unsigned char *)addr;
 	while (n-- > 0)
 		*p++ = (unsigned char) c;
 
 	return (ptr);	
 }
+
+#endif
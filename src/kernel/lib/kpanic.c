@@ -17,6 +17,7 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <dev/8250.h>
 #include <nanvix/const.h>
 #include <nanvix/dev.h>
 #include <nanvix/hal.h>
@@ -51,6 +52,11 @@ PUBLIC void kpanic(const char *fmt, ...)
 	 * be bothered.
 	 */
 	disable_interrupts();
+
+#ifdef SERIAL_ENABLE
+	/* Nobody will drain the serial line anymore. */
+	uart8250_flush();
+#endif
 	
 	while(1);
 
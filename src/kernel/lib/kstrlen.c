@@ -16,14 +16,19 @@
  * You should have received a copy of the GNU General Public License
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
- 
+
 #include <nanvix/const.h>
 #include <nanvix/klib.h>
+#include <stdint.h>
 #include <sys/types.h>
 
 /**
  * @brief Returns the length of a string.
  * 
+ * @details Scans the string a word at a time once it is aligned.
+ * Aligned loads never cross a page boundary, so no byte past the
+ * page that holds the terminating null character is touched.
+ * 
  * @param str String to be evaluated.
  * 
  * @returns The length of the string. 
@@ -31,9 +36,21 @@
 PUBLIC size_t kstrlen(const char *str)
 {
 	const char *p;
+	const uint32_t *w;
+	
+	/* Align. */
+	for (p = str; !ALIGNED(p, sizeof(uint32_t)); p++)
+	{
+		if (*p == '\0')
+			return (p - str);
+	}
+	
+	/* Find word with the null character. */
+	for (w = (const uint32_t *)p; !HAS_ZERO_BYTE(*w); w++)
+		noop();
 	
-	/* Count the number of characters. */
-	for (p = str; *p != '\0'; p++)
+	/* Find null character. */
+	for (p = (const char *)w; *p != '\0'; p++)
 		noop();
 	
 	return (p - str);
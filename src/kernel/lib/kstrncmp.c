@@ -18,11 +18,17 @@
  */
 
 #include <nanvix/const.h>
+#include <nanvix/klib.h>
+#include <stdint.h>
 #include <sys/types.h>
 
 /**
  * @brief Compares part of two strings.
  * 
+ * @details When both strings share the same alignment, equal words are
+ * skipped a word at a time, until a word that differs or that holds the
+ * null character is found.
+ * 
  * @param str1 String one.
  * @param str2 String two.
  * @param n    Number of characters to be compared.
@@ -31,20 +37,55 @@
  */
 PUBLIC int kstrncmp(const char *str1, const char *str2, size_t n)
 {
-	/* Compare strings. */
-	while (n-- > 0)
+	const unsigned char *s1 = (const unsigned char *)str1;
+	const unsigned char *s2 = (const unsigned char *)str2;
+	
+	/* Same alignment, so compare words. */
+	if ((((addr_t)s1 ^ (addr_t)s2) & (sizeof(uint32_t) - 1)) == 0)
+	{
+		const uint32_t *w1, *w2;
+		
+		/* Align. */
+		for (/* noop */; !ALIGNED(s1, sizeof(uint32_t)); s1++, s2++, n--)
+		{
+			if (n == 0)
+				return (0);
+			
+			/* Strings differ. */
+			if (*s1 != *s2)
+				return (*s1 - *s2);
+			
+			/* End of string. */
+			if (*s1 == '\0')
+				return (0);
+		}
+		
+		w1 = (const uint32_t *)s1;
+		w2 = (const uint32_t *)s2;
+		
+		/* Skip equal words. */
+		while ((n >= sizeof(uint32_t)) && (*w1 == *w2) && (!HAS_ZERO_BYTE(*w1)))
+		{
+			w1++;
+			w2++;
+			n -= sizeof(uint32_t);
+		}
+		
+		s1 = (const unsigned char *)w1;
+		s2 = (const unsigned char *)w2;
+	}
+	
+	/* Compare remaining characters. */
+	for (/* noop */; n > 0; s1++, s2++, n--)
 	{
 		/* Strings differ. */
-		if (*str1 != *str2)
-			break;
+		if (*s1 != *s2)
+			return (*s1 - *s2);
 			
 		/* End of string. */
-		if (*str1 == '\0')
+		if (*s1 == '\0')
 			return (0);
-		
-		str1++;
-		str2++;
 	}
 	
-	return (*str1 - *str2);
+	return (0);
 }
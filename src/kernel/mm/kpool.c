@@ -34,6 +34,11 @@
  */
 PRIVATE int kpages[NR_KPAGES] = { 0,  };
 
+/**
+ * @brief Where to start looking for a free kernel page.
+ */
+PRIVATE unsigned kpages_next = 0;
+
 /**
  * @brief Translates a kernel page ID into a virtual address.
  *
@@ -72,11 +77,19 @@ PUBLIC void *getkpg(int clean)
 	void *kpg;  /* Kernel page. */
 	
 	/* Search for a free kernel page. */
-	for (i = 0; i < NR_KPAGES; i++)
+	for (int retry = 0; retry < 2; retry++)
 	{
-		/* Found it. */
-		if (kpages[i] == 0)
-			goto found;
+		for (unsigned j = 0; j < NR_KPAGES; j++)
+		{
+			i = (kpages_next + j)%NR_KPAGES;
+
+			/* Found it. */
+			if (kpages[i] == 0)
+				goto found;
+		}
+
+		/* Take back free slabs from object caches. */
+		kcache_reap();
 	}
 
 	kprintf("mm: kernel page pool overflow");
@@ -88,6 +101,7 @@ found:
 	/* Set page as used. */
 	kpg = (void *) kpg_id_to_addr(i);
 	kpages[i]++;
+	kpages_next = (i + 1)%NR_KPAGES;
 	
 	/* Clean page. */
 	if (clean)
@@ -111,3 +125,21 @@ PUBLIC void putkpg(void *kpg)
 	if (kpages[i]-- == 0)
 		kpanic("mm: double free on kernel page");
 }
+
+/**
+ * @brief Counts free kernel pages.
+ *
+ * @returns The number of kernel pages that are not in use.
+ */
+PUBLIC unsigned kpg_nfree(void)
+{
+	unsigned n = 0;
+
+	for (unsigned i = 0; i < NR_KPAGES; i++)
+	{
+		if (kpages[i] == 0)
+			n++;
+	}
+
+	return (n);
+}
@@ -19,11 +19,13 @@
  */
 
 #include <nanvix/const.h>
+#include <nanvix/hal.h>
 #include <nanvix/pm.h>
 #include <nanvix/region.h>
 #include <nanvix/klib.h>
 #include <nanvix/mm.h>
 #include <nanvix/debug.h>
+#include <errno.h>
 
 /*
  * Bad KPOOL_PHYS ?
@@ -82,6 +84,7 @@ PUBLIC unsigned const BUFFERS_VIRT = 0;
  */
 PUBLIC void mm_init(void)
 {
+	kcache_init();
 	initreg();
 	dbg_register(test_mm, "test_mm");
 }
@@ -97,26 +100,171 @@ PUBLIC void mm_init(void)
  */
 PUBLIC int chkmem(const void *addr, size_t size, mode_t mask)
 {
-	int ret;              /* Return value.           */
 	struct region *reg;   /* Working memory region.  */
 	struct pregion *preg; /* Working process region. */
 	
 	/* Get associated process memory region. */
 	if ((preg = findreg(curr_proc, ADDR(addr))) == NULL)
-		return (-1);
+		return (0);
 	
-	lockreg(reg = preg->reg);
+	/*
+	 * No need to lock the region: its fields are
+	 * only changed with the kernel lock held.
+	 */
+	reg = preg->reg;
 	
 	/* Not allowed. */
 	if (!(accessreg(curr_proc, reg) & mask))
+		return (0);
+	
+	return (withinreg(preg, ADDR(addr) + size));
+}
+
+/**
+ * @brief Asserts if a memory area may be accessed on behalf of the
+ * current process, without looking at process regions.
+ * 
+ * @details System calls check the buffers they get with this function,
+ * so kernel buffers that reach the copy helpers below were handed down
+ * by the kernel itself.
+ * 
+ * @param addr Start address of the memory area.
+ * @param size Size of memory area.
+ * 
+ * @returns Non-zero if the memory area lies entirely in user space, or
+ * if the kernel itself is the caller, and zero otherwise.
+ */
+PUBLIC int chkuser(const void *addr, size_t size)
+{
+	/* Kernel address space. */
+	if (IN_KERNEL(addr))
+		return (KERNEL_WAS_RUNNING(curr_proc) || (curr_proc == INIT));
+	
+	return (size <= KBASE_VIRT - ADDR(addr));
+}
+
+/**
+ * @brief Prepares a user buffer to be accessed in place.
+ * 
+ * @details The kernel does not honor write protection of user pages, so
+ * permissions are checked up front. Pages are then brought in, so that
+ * drivers may move data straight to or from the buffer.
+ * 
+ * @param addr     Start address of the buffer.
+ * @param size     Size of the buffer.
+ * @param writable Will the buffer be written to?
+ * 
+ * @returns Zero upon success, and -EFAULT upon failure.
+ */
+PUBLIC int pin_user(const void *addr, size_t size, int writable)
+{
+	/* Kernel buffer. */
+	if (IN_KERNEL(addr))
+		return (0);
+	
+	if (!chkmem(addr, size, (writable) ? MAY_WRITE : MAY_READ))
+		return (-EFAULT);
+	
+	if (pinupg(ADDR(addr), size, writable))
+		return (-EFAULT);
+	
+	return (0);
+}
+
+/**
+ * @brief Copies data from user address space.
+ * 
+ * @details The source memory area is not looked up in the process regions.
+ * Bad addresses are caught by the page fault handler instead, which resumes
+ * the copy at a recovery point. Kernel buffers are copied right away.
+ * 
+ * @param to   Target memory area (kernel).
+ * @param from Source memory area (user or kernel).
+ * @param n    Number of bytes to copy.
+ * 
+ * @returns Zero upon success, and -EFAULT upon failure.
+ */
+PUBLIC int copy_from_user(void *to, const void *from, size_t n)
+{
+	/* Kernel buffer. */
+	if (IN_KERNEL(from))
 	{
-		unlockreg(reg);
-		return (-1);
+		kmemcpy(to, from, n);
+		return (0);
 	}
-		
-	ret = withinreg(preg, ADDR(addr) + size);
+	
+	if (!chkuser(from, n))
+		return (-EFAULT);
+	
+	return (ucopy(to, from, n));
+}
+
+/**
+ * @brief Copies data to user address space.
+ * 
+ * @details The target memory area is prepared with pin_user(), so that
+ * copy-on-write pages are broken before the kernel writes to them. Kernel
+ * buffers are copied right away.
+ * 
+ * @param to   Target memory area (user or kernel).
+ * @param from Source memory area (kernel).
+ * @param n    Number of bytes to copy.
+ * 
+ * @returns Zero upon success, and -EFAULT upon failure.
+ */
+PUBLIC int copy_to_user(void *to, const void *from, size_t n)
+{
+	/* Kernel buffer. */
+	if (IN_KERNEL(to))
+	{
+		kmemcpy(to, from, n);
+		return (0);
+	}
+	
+	if (pin_user(to, n, 1))
+		return (-EFAULT);
+	
+	return (ucopy(to, from, n));
+}
 
-	unlockreg(reg);
+/**
+ * @brief Copies a string from user address space.
+ * 
+ * @details The string is range checked once, as a whole, and then
+ * copied in a single pass.
+ * 
+ * @param to   Target string (kernel).
+ * @param from Source string (user).
+ * @param n    Size of the target string.
+ * 
+ * @returns Upon successful completion, the length of the string is
+ * returned. Upon failure, -EFAULT is returned if the string is not
+ * accessible, and -ENAMETOOLONG if it does not fit in @p n characters.
+ */
+PUBLIC ssize_t strncpy_from_user(char *to, const char *from, size_t n)
+{
+	size_t max;  /* Accessible characters. */
+	ssize_t ret; /* Return value.          */
+	
+	max = n;
+	
+	/* Kernel address space. */
+	if (IN_KERNEL(from))
+	{
+		if (!(KERNEL_WAS_RUNNING(curr_proc) || (curr_proc == INIT)))
+			return (-EFAULT);
+	}
+	
+	/* Do not run into kernel space. */
+	else if (max > KBASE_VIRT - ADDR(from))
+		max = KBASE_VIRT - ADDR(from);
+	
+	if ((ret = ustrncpy(to, from, max)) < 0)
+		return (ret);
+	
+	/* No null character. */
+	if ((size_t)ret == max)
+		return ((max < n) ? -EFAULT : -ENAMETOOLONG);
 	
 	return (ret);
 }
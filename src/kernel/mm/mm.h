@@ -27,8 +27,10 @@
 	/* Forward definitions. */
 	EXTERN void freeupg(struct pte *);
 	EXTERN void linkupg(struct pte *, struct pte *);
+	EXTERN void mapkpg(struct pte *, void *, int);
 	EXTERN void mappgtab(struct process *, addr_t, void *);
 	EXTERN void markpg(struct pte *, int);
+	EXTERN void splitpg(struct process *, addr_t, void *);
 	EXTERN void umappgtab(struct process *, addr_t);
 
 #endif /* _MM_H_ */
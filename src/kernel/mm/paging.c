@@ -18,6 +18,7 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <dev/trace.h>
 #include <nanvix/config.h>
 #include <nanvix/const.h>
 #include <nanvix/fs.h>
@@ -27,6 +28,10 @@
 #include <nanvix/region.h>
 #include "mm.h"
 
+#ifdef i386
+	#include <i386/apic.h>
+#endif
+
 /*============================================================================*
  *                             Page Frames Subsystem                          *
  *============================================================================*/
@@ -87,6 +92,92 @@ PRIVATE addr_t frame_alloc(void)
 	return (0);
 }
 
+/**
+ * @brief Counts free page frames.
+ *
+ * @returns The number of page frames that are not in use.
+ */
+PUBLIC unsigned frame_nfree(void)
+{
+	unsigned n = 0;
+
+	for (unsigned i = 0; i < NR_FRAMES; i++)
+	{
+		if (frames[i] == 0)
+			n++;
+	}
+
+	return (n);
+}
+
+#ifdef i386
+
+/*
+ * Large page frames must be aligned.
+ */
+#if (UBASE_PHYS & (LPAGE_SIZE - 1))
+	#error "UBASE_PHYS should be multiple of LPAGE_SIZE"
+#endif
+
+/**
+ * @brief Number of page frames in a large page frame.
+ */
+#define LPAGE_FRAMES (LPAGE_SIZE/PAGE_SIZE)
+
+/**
+ * @brief Allocates a large page frame.
+ *
+ * @details Large page frames are searched for from the top of user
+ * memory, since page frames are allocated from the bottom.
+ *
+ * @returns The number of the first page frame upon success, and zero
+ * upon failure.
+ */
+PRIVATE addr_t frame_alloc_large(void)
+{
+	unsigned i, j;
+
+	for (i = NR_FRAMES & ~(LPAGE_FRAMES - 1); i > 0; i -= LPAGE_FRAMES)
+	{
+		/* Busy frame. */
+		for (j = i - LPAGE_FRAMES; j < i; j++)
+		{
+			if (frames[j] != 0)
+				break;
+		}
+		
+		/* Found it. */
+		if (j == i)
+		{
+			for (j = i - LPAGE_FRAMES; j < i; j++)
+				frames[j] = 1;
+			
+			return (frame_id_to_addr(i - LPAGE_FRAMES));
+		}
+	}
+	
+	return (0);
+}
+
+#endif
+
+/**
+ * @brief Asserts if a page frame lies in user memory.
+ *
+ * @details Pages of memory-backed devices and kernel pages may be mapped
+ * into user space as well, but they are not reference counted.
+ *
+ * @param addr Frame number of target page frame.
+ *
+ * @returns Non zero if the page frame lies in user memory, and zero
+ * otherwise.
+ */
+PRIVATE inline int frame_is_user(addr_t addr)
+{
+	return ((addr >= (UBASE_PHYS >> PAGE_SHIFT)) &&
+		(addr < (UBASE_PHYS >> PAGE_SHIFT) + NR_FRAMES));
+}
+
 /**
  * @brief Frees a page frame.
  *
@@ -94,6 +185,10 @@ PRIVATE addr_t frame_alloc(void)
  */
 PRIVATE inline void frame_free(addr_t addr)
 {
+	/* Not handed out by the page frame allocator. */
+	if (!frame_is_user(addr))
+		return;
+
 	if (frames[frame_addr_to_id(addr)]-- == 0)
 		kpanic("mm: double free on page frame");
 }
@@ -105,7 +200,8 @@ PRIVATE inline void frame_free(addr_t addr)
  */
 PRIVATE inline void frame_share(addr_t addr)
 {
-	frames[frame_addr_to_id(addr)]++;
+	if (frame_is_user(addr))
+		frames[frame_addr_to_id(addr)]++;
 }
 
 /**
@@ -118,6 +214,10 @@ PRIVATE inline void frame_share(addr_t addr)
  */
 PRIVATE inline int frame_is_shared(addr_t addr)
 {
+	/* Page frames outside user memory are never stolen. */
+	if (!frame_is_user(addr))
+		return (1);
+
 	return (frames[frame_addr_to_id(addr)] > 1);
 }
 
@@ -165,6 +265,9 @@ PRIVATE inline void pde_init(struct pde *pde)
 	pde_present_set(pde, 1);
 	pde_user_set(pde, 1);
 	pde_write_set(pde, 1);
+#ifdef i386
+	pde_large_set(pde, 0);
+#endif
 }
 
 /**
@@ -177,6 +280,9 @@ PRIVATE inline void pde_clear(struct pde *pde)
 	pde_present_set(pde, 0);
 	pde_user_set(pde, 0);
 	pde_write_set(pde, 0);
+#ifdef i386
+	pde_large_set(pde, 0);
+#endif
 }
 
 /**
@@ -309,8 +415,14 @@ PUBLIC int crtpgdir(struct process *proc)
 	/* Build page directory. */
 	pgdir[0] = curr_proc->pgdir[0];
 	pgdir[PGTAB(KBASE_VIRT)] = curr_proc->pgdir[PGTAB(KBASE_VIRT)];
-	pgdir[PGTAB(KPOOL_VIRT)] = curr_proc->pgdir[PGTAB(KPOOL_VIRT)];	
 	pgdir[PGTAB(SERIAL_VIRT)] = curr_proc->pgdir[PGTAB(SERIAL_VIRT)];
+#ifdef i386
+	pgdir[PGTAB(APIC_VIRT)] = curr_proc->pgdir[PGTAB(APIC_VIRT)];
+#endif
+
+	/* KPOOL page directory entries. */
+	for (int i = 0; i < KPOOL_SIZE >> PGTAB_SHIFT; i++)
+		pgdir[PGTAB(KPOOL_VIRT) + i] = curr_proc->pgdir[PGTAB(KPOOL_VIRT) + i];
 
 	/* INITRD page directory entries. */
 	for (int i = 0; i < INITRD_SIZE >> PGTAB_SHIFT; i++)
@@ -403,6 +515,158 @@ PRIVATE int allocupg(addr_t vaddr, int writable)
 	return (0);
 }
 
+/**
+ * @brief Maps a kernel page into a user page.
+ *
+ * @details The kernel page is shared with user space as is. It lies
+ * outside user memory, so freeupg() leaves it alone and copy-on-write
+ * always clones it. Not all kernel memory sits at a fixed offset from
+ * its frame (the initial RAM disk does not), so the frame is looked up
+ * in the kernel page tables.
+ *
+ * @param pg       Target user page.
+ * @param kpg      Kernel page.
+ * @param writable Is the page writable?
+ */
+PUBLIC void mapkpg(struct pte *pg, void *kpg, int writable)
+{
+#ifdef i386
+	struct pde *pde;
+#endif
+
+	pte_init(pg, writable);
+#ifdef i386
+	pde = getpde(IDLE, ADDR(kpg));
+	
+	/* Large kernel page. */
+	if (pde_is_large(pde))
+		pg->frame = pde->frame + PG(ADDR(kpg));
+	else
+		pg->frame = getpte(IDLE, ADDR(kpg))->frame;
+#else
+	pg->frame = (ADDR(kpg) - KBASE_VIRT) >> PAGE_SHIFT;
+#endif
+}
+
+#ifdef i386
+
+/**
+ * @brief Asserts if large pages are enabled.
+ *
+ * @returns Non-zero if large pages are enabled, and zero otherwise.
+ */
+PRIVATE inline int largepg_enabled(void)
+{
+	unsigned cr4;
+	
+	__asm__ __volatile__ ("movl %%cr4, %0" : "=r" (cr4));
+	
+	return (cr4 & CR4_PSE);
+}
+
+/**
+ * @brief Allocates a large user page.
+ * 
+ * @details A large page backs a whole page table of a private region that
+ * grows upwards, as long as all pages in that page table are still demand
+ * zero. Underlying page table entries are kept up to date, so that the
+ * large page can be split back into small pages at any time.
+ * 
+ * @param preg Process region where the page resides.
+ * @param addr Address where the page resides.
+ * 
+ * @returns Zero upon successful completion, and non-zero otherwise, in
+ * which case a small page should be allocated instead.
+ */
+PRIVATE int allocupg_large(struct pregion *preg, addr_t addr)
+{
+	addr_t paddr;        /* Large page frame.   */
+	struct pde *pde;     /* Page directory entry. */
+	struct pte *pgtab;   /* Page table.           */
+	struct region *reg;  /* Memory region.        */
+	
+	reg = preg->reg;
+	addr &= PGTAB_MASK;
+	
+	if (!largepg_enabled())
+		return (-1);
+	
+	/* Private regions that grow upwards only. */
+	if ((reg->flags & (REGION_SHARED | REGION_DOWNWARDS)) || (reg->count != 1))
+		return (-1);
+	
+	/* Large page would not fit in the region. */
+	if ((addr < preg->start) || (addr + LPAGE_SIZE > preg->start + reg->size))
+		return (-1);
+	
+	pde = getpde(curr_proc, addr);
+	pgtab = getpte(curr_proc, addr);
+	
+	/* All pages should be demand zero. */
+	for (int i = 0; i < PAGE_SIZE/PTE_SIZE; i++)
+	{
+		if (pte_is_present(&pgtab[i]) || !pte_is_zero(&pgtab[i]))
+			return (-1);
+	}
+	
+	/* Failed to allocate large page frame. */
+	if (!(paddr = frame_alloc_large()))
+		return (-1);
+	
+	for (int i = 0; i < PAGE_SIZE/PTE_SIZE; i++)
+	{
+		pte_init(&pgtab[i], reg->mode & MAY_WRITE);
+		pgtab[i].frame = paddr + i;
+	}
+	
+	pde_large_set(pde, 1);
+	pde_write_set(pde, reg->mode & MAY_WRITE);
+	pde->frame = paddr;
+	tlb_flush();
+	
+	kmemset((void *)(addr), 0, LPAGE_SIZE);
+	
+	return (0);
+}
+
+#endif
+
+/**
+ * @brief Splits a large page.
+ * 
+ * @details Maps back the page table that describes a large page, so that
+ * the underlying small pages can be handled on their own.
+ * 
+ * @param proc  Target process.
+ * @param addr  Address of the large page.
+ * @param pgtab Underlying page table.
+ */
+PUBLIC void splitpg(struct process *proc, addr_t addr, void *pgtab)
+{
+#ifdef i386
+	struct pde *pde;
+	
+	pde = getpde(proc, addr);
+	
+	/* Not a large page. */
+	if (!pde_is_large(pde))
+		return;
+	
+	/* Small pages carry their own protection. */
+	pde_large_set(pde, 0);
+	pde_write_set(pde, 1);
+	pde->frame = (ADDR(pgtab) - KBASE_VIRT) >> PAGE_SHIFT;
+	
+	/* Flush changes. */
+	if (proc == curr_proc)
+		tlb_flush();
+#else
+	UNUSED(proc);
+	UNUSED(addr);
+	UNUSED(pgtab);
+#endif
+}
+
 /**
  * @brief Reads a page from a file.
  * 
@@ -421,9 +685,29 @@ PRIVATE int readpg(struct region *reg, addr_t addr)
 	struct pregion *preg; /* Process region pointer.   */
 	addr_t bss_start;     /* BSS start address.        */
 	size_t bss_size;      /* BSS size.                 */
+	void *kpg;            /* Mapped file page.         */
 	
 	addr &= PAGE_MASK;
 	
+	/*
+	 * Read-only pages of files that live in memory-backed
+	 * devices are mapped in place, instead of being copied.
+	 * The file may not be written or truncated from then on,
+	 * until the region goes away.
+	 */
+	if (!(reg->mode & MAY_WRITE))
+	{
+		off = reg->file.off + ((addr - reg->preg->start) & PAGE_MASK);
+		
+		if ((kpg = file_map(reg->file.inode, off)) != NULL)
+		{
+			reg->flags |= REGION_DAX;
+			mapkpg(getpte(curr_proc, addr), kpg, 0);
+			tlb_flush();
+			return (0);
+		}
+	}
+	
 	/* Assign a user page. */
 	if (allocupg(addr, reg->mode & MAY_WRITE))
 		return (-1);
@@ -635,6 +919,8 @@ PUBLIC int vfault(addr_t addr)
 
 	addr2 = addr;
 
+	TRACE(TRACE_PAGE_FAULT, addr, 0, 0);
+
 	/*
 	 * Number of attempts to allocate a faulting page to a (possible)
 	 * stack.
@@ -690,8 +976,15 @@ PUBLIC int vfault(addr_t addr)
 	{
 		if (readpg(reg, addr))
 			goto error1;
+		curr_proc->majflt++;
 	}
 
+#ifdef i386
+	/* Demand zero, on a large page. */
+	else if (!allocupg_large(preg, addr))
+		curr_proc->minflt++;
+#endif
+
 	/* Demand zero. */
 	else
 	{
@@ -709,6 +1002,7 @@ PUBLIC int vfault(addr_t addr)
 			i++;
 		}
 		while (i < page_count);
+		curr_proc->minflt++;
 	}
 
 	unlockreg(reg);
@@ -733,6 +1027,8 @@ PUBLIC int pfault(addr_t addr)
 	struct pte *pg;       /* Faulting page.          */
 	struct pregion *preg; /* Working process region. */
 
+	TRACE(TRACE_PAGE_FAULT, addr, 1, 0);
+
 	/* Outside virtual address space. */
 	if ((preg = findreg(curr_proc, addr)) == NULL)
 		goto error0;
@@ -748,6 +1044,7 @@ PUBLIC int pfault(addr_t addr)
 	/* Copy page. */
 	if (cow_disable(pg))
 		goto error1;
+	curr_proc->minflt++;
 
 	unlockreg(preg->reg);
 	return(0);
@@ -757,3 +1054,62 @@ error1:
 error0:
 	return (-1);
 }
+
+/**
+ * @brief Faults in user pages.
+ *
+ * @details Makes every page that overlaps a memory area present, and
+ * breaks copy-on-write sharing if the pages are going to be written,
+ * so that the kernel can then access the area without faulting. This
+ * is what drivers that transfer data directly to or from user memory
+ * need, since they cannot fault halfway through a device transfer.
+ * User pages are never evicted, so they stay in place until the area
+ * is detached.
+ *
+ * @param addr     Start address of the memory area.
+ * @param size     Size of the memory area.
+ * @param writable Is the memory area going to be written?
+ *
+ * @returns Zero upon successful completion, and non-zero otherwise.
+ */
+PUBLIC int pinupg(addr_t addr, size_t size, int writable)
+{
+	addr_t end; /* End of memory area. */
+
+	end = addr + size;
+
+	for (addr &= PAGE_MASK; addr < end; addr += PAGE_SIZE)
+	{
+		struct pte *pg;
+
+		/* Kernel memory is always there. */
+		if (IN_KERNEL(addr))
+			continue;
+
+		/* No page table. */
+		if (!pde_is_present(getpde(curr_proc, addr)))
+			return (-1);
+
+#ifdef i386
+		/* Large pages are always present and private. */
+		if (pde_is_large(getpde(curr_proc, addr)))
+			continue;
+#endif
+
+		pg = getpte(curr_proc, addr);
+
+		if (!pte_is_present(pg))
+		{
+			if (vfault(addr))
+				return (-1);
+		}
+
+		if ((writable) && (cow_is_enabled(pg)))
+		{
+			if (pfault(addr))
+				return (-1);
+		}
+	}
+
+	return (0);
+}
@@ -80,6 +80,87 @@ PRIVATE inline void freemreg(struct miniregion *mreg)
 	mreg->flags = MREGION_FREE;
 }
 
+/**
+ * @brief Splits the large pages of a memory region.
+ * 
+ * @details Large pages are only used by regions that grow upwards,
+ * so regions that grow downwards are left untouched.
+ * 
+ * @param proc Process where the memory region is attached.
+ * @param reg  Target memory region.
+ */
+PRIVATE void splitreg(struct process *proc, struct region *reg)
+{
+	addr_t addr;   /* Working address. */
+	unsigned i, j; /* Loop indexes.    */
+	
+	if (reg->flags & REGION_DOWNWARDS)
+		return;
+	
+	addr = reg->preg->start;
+	for (i = 0; i < MREGIONS; i++)
+	{
+		/* Only valid mini regions. */
+		if (reg->mtab[i] != NULL)
+		{
+			for (j = 0; j < REGION_PGTABS; j++)
+			{
+				/* Only valid page tables. */
+				if (reg->mtab[i]->pgtab[j] != NULL)
+					splitpg(proc, addr, reg->mtab[i]->pgtab[j]);
+				addr += PGTAB_SIZE;
+			}
+		}
+		else
+			addr += (PGTAB_SIZE * REGION_PGTABS);
+	}
+}
+
+/**
+ * @brief Locates a page of a memory region.
+ * 
+ * @details Pages are numbered from the start of the memory region,
+ *          in the direction that it grows. Regions that grow downwards
+ *          are laid out backwards in their mini regions and page tables.
+ * 
+ * @param reg Target memory region.
+ * @param pg  Page number.
+ * @param i   Store location for the mini region index.
+ * @param j   Store location for the page table index.
+ * @param k   Store location for the page table entry index.
+ */
+PRIVATE inline void locatepg
+(const struct region *reg, unsigned pg, unsigned *i, unsigned *j, unsigned *k)
+{
+	*i = pg >> (MREGION_SHIFT - PAGE_SHIFT);
+	*j = (pg >> (PGTAB_SHIFT - PAGE_SHIFT)) % REGION_PGTABS;
+	*k = pg % (PAGE_SIZE/PTE_SIZE);
+	
+	if (reg->flags & REGION_DOWNWARDS)
+	{
+		*i = MREGIONS - *i - 1;
+		*j = REGION_PGTABS - *j - 1;
+		*k = PAGE_SIZE/PTE_SIZE - *k - 1;
+	}
+}
+
+/**
+ * @brief Returns an address within an attached memory region.
+ * 
+ * @param preg Process region where the memory region is attached.
+ * @param off  Offset from the start of the memory region, in the
+ *             direction that it grows.
+ * 
+ * @returns The requested address.
+ */
+PRIVATE inline addr_t regaddr(const struct pregion *preg, size_t off)
+{
+	if (preg->reg->flags & REGION_DOWNWARDS)
+		return (preg->start - off);
+	
+	return (preg->start + off);
+}
+
 /**
  * @brief Expands a memory region.
  * 
@@ -92,9 +173,8 @@ PRIVATE inline void freemreg(struct miniregion *mreg)
 PRIVATE int expand(struct process *proc, struct region *reg, size_t size)
 {	
 	unsigned i, j, k;     /* Loop indexes.                  */
-	unsigned npages;      /* Number of pages in the region. */
+	unsigned npages;      /* Number of pages to be added.   */
 	struct pregion *preg; /* Working process region.        */
-	size_t newmaxsize;    /* New maximum size of the region.*/
 	struct pte *pgtab;    /* Working page table entry.      */
 	
 	size = ALIGN(size, PAGE_SIZE);
@@ -106,143 +186,57 @@ PRIVATE int expand(struct process *proc, struct region *reg, size_t size)
 	
 	npages = size >> PAGE_SHIFT;
 	
-	/* Expand downwards. */
-	if (reg->flags & REGION_DOWNWARDS)
-	{		
-		/* Allocate first mini region and page table. */
-		if (reg->size == 0)
-		{
-			reg->mtab[MREGIONS - 1] = allocmreg();
-			if (reg->mtab[MREGIONS - 1] == NULL)
-				return (-1);
-
-			pgtab = getkpg(1);
-			if (pgtab == NULL)
- 				return (-1);
-
-			reg->mtab[MREGIONS - 1]->pgtab[REGION_PGTABS - 1] = pgtab;
-		}
-		
-		i = MREGIONS - (reg->size >> MREGION_SHIFT) - 1;
-		j = (REGION_PGTABS * (MREGIONS - i)) - (reg->size >> PGTAB_SHIFT) - 1;
-		k = PAGE_SIZE/PTE_SIZE - 
-				(((PAGE_MASK^PGTAB_MASK) & reg->size) >> PAGE_SHIFT);
-
-		/* Verifies that will not overlap. */
-		newmaxsize = reg->size + size;
-		if (size != 0 && proc != NULL && 
-			findreg(proc, preg->start - newmaxsize) != NULL)
+	/* Allocate first mini region and page table. */
+	locatepg(reg, 0, &i, &j, &k);
+	if (reg->mtab[i] == NULL)
+	{
+		reg->mtab[i] = allocmreg();
+		if (reg->mtab[i] == NULL)
 			return (-1);
 
-		/* Mark pages as demand zero. */
-		while (npages > 0)
-		{
-			/* Create new page table and/or mini region. */
-			if (k == 0)
-			{
-				j--;
-				k = PAGE_SIZE/PTE_SIZE;
-
-				/* Create mini region. */
-				if (j == 0)
-				{
-					i--;
-					j = REGION_PGTABS - 1;
+		pgtab = getkpg(1);
+		if (pgtab == NULL)
+			return (-1);
 
-					reg->mtab[i] = allocmreg();
-					if (reg->mtab[i] == NULL)
-						return (-1);
-				}
-				
-				/* Create page table. */
-				pgtab = getkpg(1);
-				if (pgtab == NULL)
-					return (-1);
-
-				reg->mtab[i]->pgtab[j] = pgtab;
-
-				/* Map page table. */
-				if (proc != NULL)
-					mappgtab(proc, preg->start - reg->size, pgtab);
-					
-				continue;	
-			}
-		
-			k--;
-			npages--;
-			reg->size += PAGE_SIZE;
-			
-			markpg(&reg->mtab[i]->pgtab[j][k], PAGE_ZERO);
-		}
+		reg->mtab[i]->pgtab[j] = pgtab;
 	}
-
-	/* Expand upwards. */
-	else
+	
+	/* Verifies that will not overlap. */
+	if (size != 0 && proc != NULL &&
+		findreg(proc, regaddr(preg, reg->size + size)) != NULL)
+		return (-1);
+	
+	/* Mark pages as demand zero. */
+	while (npages > 0)
 	{
-		/* Allocate first mini region and page table. */
-		if (reg->size == 0)
+		locatepg(reg, reg->size >> PAGE_SHIFT, &i, &j, &k);
+		
+		/* Create mini region. */
+		if (reg->mtab[i] == NULL)
 		{
-			reg->mtab[0] = allocmreg();
-			if (reg->mtab[0] == NULL)
+			reg->mtab[i] = allocmreg();
+			if (reg->mtab[i] == NULL)
 				return (-1);
-
+		}
+		
+		/* Create page table. */
+		if (reg->mtab[i]->pgtab[j] == NULL)
+		{
 			pgtab = getkpg(1);
 			if (pgtab == NULL)
 				return (-1);
 
-			reg->mtab[0]->pgtab[0] = pgtab;
-		}
-		
-		i = reg->size >> MREGION_SHIFT;
-		j = (reg->size >> PGTAB_SHIFT) - (REGION_PGTABS*i);
-		k = ((PAGE_MASK^PGTAB_MASK) & reg->size) >> PAGE_SHIFT;
-
-		/* Verifies that will not overlap. */
-		newmaxsize = reg->size + size;
-		if (size != 0 && proc != NULL && 
-			findreg(proc, preg->start + newmaxsize) != NULL)
-			return (-1);
-
-		/* Mark pages as demand zero. */
-		while (npages > 0)
-		{
-			/* Reset. */
-			if (k == PAGE_SIZE/PTE_SIZE)
-			{
-				j++;
-				k = 0;
-			
-				/* Create mini region. */
-				if (j == REGION_PGTABS)
-				{
-					i++;
-					j = 0;
+			reg->mtab[i]->pgtab[j] = pgtab;
 
-					reg->mtab[i] = allocmreg();
-					if (reg->mtab[i] == NULL)
-						return (-1);
-				}
-				
-				/* Create page table. */
-				pgtab = getkpg(1);
-				if (pgtab == NULL)
-					return (-1);
-
-				reg->mtab[i]->pgtab[j] = pgtab;
-
-				/* Map page table. */
-				if (proc != NULL)
-					mappgtab(proc, preg->start + reg->size, pgtab);
-					
-				continue;	
-			}
-			
-			markpg(&reg->mtab[i]->pgtab[j][k], PAGE_ZERO);
-			
-			k++;
-			npages--;
-			reg->size += PAGE_SIZE;
+			/* Map page table. */
+			if (proc != NULL)
+				mappgtab(proc, regaddr(preg, reg->size), pgtab);
 		}
+		
+		markpg(&reg->mtab[i]->pgtab[j][k], PAGE_ZERO);
+		
+		npages--;
+		reg->size += PAGE_SIZE;
 	}
 	
 	return (0);
@@ -251,6 +245,11 @@ PRIVATE int expand(struct process *proc, struct region *reg, size_t size)
 /**
  * @brief Contracts a memory region.
  * 
+ * @details Pages are freed from the end of the memory region. Page
+ *          tables and mini regions are freed as soon as they become
+ *          empty, except for the first ones, which live as long as
+ *          the memory region does.
+ * 
  * @param proc Process who owns the memory region.
  * @param reg  Memory region that shall be contracted.
  * @param size Size in bytes to be removed from the memory region.
@@ -260,7 +259,8 @@ PRIVATE int expand(struct process *proc, struct region *reg, size_t size)
 PRIVATE int contract(struct process *proc, struct region *reg, size_t size)
 {
 	unsigned i, j, k;     /* Loop indexes.                  */
-	unsigned npages;      /* Number of pages in the region. */
+	unsigned pg;          /* Working page.                  */
+	unsigned npages;      /* Number of pages to be removed. */
 	struct pregion *preg; /* Working process region.        */
 	
 	size = ALIGN(size, PAGE_SIZE);
@@ -270,97 +270,37 @@ PRIVATE int contract(struct process *proc, struct region *reg, size_t size)
 		return (-1);
 
 	preg = reg->preg;
-	npages = reg->size >> PAGE_SHIFT;
+	npages = size >> PAGE_SHIFT;
 	
-	/* Contract downwards. */
-	if (reg->flags & REGION_DOWNWARDS)
-	{		
-		i = MREGIONS - (reg->size >> MREGION_SHIFT) - 1;
-		j = (REGION_PGTABS * (MREGIONS - i)) - (reg->size >> PGTAB_SHIFT) - 1;
-		k = PAGE_SIZE/PTE_SIZE - 
-				(((PAGE_MASK^PGTAB_MASK) & reg->size) >> PAGE_SHIFT);
+	/* Pages are about to be freed one by one. */
+	if (proc != NULL)
+		splitreg(proc, reg);
+	
+	while (npages > 0)
+	{
+		npages--;
+		reg->size -= PAGE_SIZE;
 		
-		/* Mark pages as demand zero. */
-		while (npages > 0)
-		{
-			/* Remove page table and/or mini region. */
-			if (k == PAGE_SIZE/PTE_SIZE)
-			{
-				k = 0;
-
-				/* Unmap page table. */
-				if (proc != NULL)
-					umappgtab(proc, preg->start - reg->size);
-					
-				putkpg(reg->mtab[i]->pgtab[j]);
-				reg->mtab[i]->pgtab[j] = NULL;
-
-				j++;
-
-				/* Remove mini region. */
-				if (j == REGION_PGTABS)
-				{
-					freemreg(reg->mtab[i]);
-					reg->mtab[i] = NULL;
-
-					i++;
-					j = 0;
-				}
-				
-				continue;
-			}
-			
-			freeupg(&reg->mtab[i]->pgtab[j][k]);
-			
-			k++;
-			npages--;
-			reg->size -= PAGE_SIZE;
+		pg = reg->size >> PAGE_SHIFT;
+		locatepg(reg, pg, &i, &j, &k);
 		
-		}
-	}
-
-	/* Contract upwards. */
-	else
-	{
-		i = reg->size >> MREGION_SHIFT;
-		j = (reg->size >> PGTAB_SHIFT) - (REGION_PGTABS*i);
-		k = ((PAGE_MASK^PGTAB_MASK) & reg->size) >> PAGE_SHIFT;
+		freeupg(&reg->mtab[i]->pgtab[j][k]);
 		
-		/* Mark pages as demand zero. */
-		while (npages > 0)
+		/* Page table is still in use. */
+		if ((pg == 0) || (pg % (PAGE_SIZE/PTE_SIZE)))
+			continue;
+		
+		/* Remove page table. */
+		if (proc != NULL)
+			umappgtab(proc, regaddr(preg, reg->size));
+		putkpg(reg->mtab[i]->pgtab[j]);
+		reg->mtab[i]->pgtab[j] = NULL;
+		
+		/* Remove mini region. */
+		if ((pg % (REGION_PGTABS*PAGE_SIZE/PTE_SIZE)) == 0)
 		{
-			/* Reset. */
-			if (k == 0)
-			{
-				k = PAGE_SIZE/PTE_SIZE;
-
-				/* Unmap page table. */
-				if (proc != NULL)
-					umappgtab(proc, preg->start - reg->size);
-					
-				putkpg(reg->mtab[i]->pgtab[j]);
-				reg->mtab[i]->pgtab[j] = NULL;
-				
-				/* Remove mini region. */
-				if (j == 0)
-				{
-					freemreg(reg->mtab[i]);
-					reg->mtab[i] = NULL;
-
-					i--;
-					j = REGION_PGTABS - 1;
-				}
-
-				j--;
-				
-				continue;
-			}
-			
-			k--;
-			npages--;
-			reg->size -= PAGE_SIZE;
-			
-			freeupg(&reg->mtab[i]->pgtab[j][k]);
+			freemreg(reg->mtab[i]);
+			reg->mtab[i] = NULL;
 		}
 	}
 	
@@ -700,6 +640,8 @@ PUBLIC void detachreg(struct process *proc, struct pregion *preg)
 	
 	preg->reg = NULL;
 	proc->size -= reg->size;
+	if (proc->lastreg == preg)
+		proc->lastreg = NULL;
 	
 	unlockreg(reg);	
 	
@@ -729,6 +671,14 @@ PUBLIC struct region *dupreg(struct region *reg)
 	if ((new_reg = allocreg(reg->mode, reg->size, reg->flags)) == NULL)
 		return (NULL);
 	
+	/*
+	 * Pages are about to be shared copy-on-write, which large
+	 * pages do not support. Regions are always duplicated on
+	 * behalf of the process they are attached to.
+	 */
+	if (reg->count > 0)
+		splitreg(curr_proc, reg);
+	
 	/* Link underlying page tables. */
 	for (i = 0; i < MREGIONS; i++)
 	{
@@ -805,6 +755,9 @@ PUBLIC int growreg(struct process *proc, struct pregion *preg, ssize_t size)
 /**
  * @brief Finds a memory region.
  * 
+ * @details The last region that was found is looked up first, since
+ *          consecutive queries tend to hit the same region.
+ * 
  * @param proc Process where the memory region shall be searched.
  * @param addr Address to be queried.
  * 
@@ -813,40 +766,55 @@ PUBLIC int growreg(struct process *proc, struct pregion *preg, ssize_t size)
  */
 PUBLIC struct pregion *findreg(struct process *proc, addr_t addr)
 {        
-	struct region *reg;   /* Working memory region.  */
 	struct pregion *preg; /* Working process region. */
 	
+	/* Cache hit. */
+	preg = proc->lastreg;
+	if ((preg != NULL) && (preg->reg != NULL) && (withinreg(preg, addr)))
+		return (preg);
+	
 	/* Find associated region. */
 	for (preg = &proc->pregs[0]; preg < &proc->pregs[NR_PREGIONS]; preg++)
 	{
 		/* Skip invalid regions. */
-		if (preg == NULL || (reg = preg->reg) == NULL)
+		if (preg->reg == NULL)
 			continue;
 		
-		/* Region grows downwards. */
-		if (reg->flags & REGION_DOWNWARDS)
-		{
-			if (addr <= preg->start)
-			{
-				if (addr >= preg->start - reg->size)
-					return (preg);
-			}
-		}
-		
-		/* Region grows upwards. */
-		else
-		{
-			if (addr >= preg->start)
-			{
-				if (addr < preg->start + reg->size)
-					return (preg);
-			}
-		}
+		if (withinreg(preg, addr))
+			return (proc->lastreg = preg);
 	}
 
 	return (NULL);
 }
 
+/**
+ * @brief Asserts if pages of a file are mapped in place.
+ * 
+ * @details Such pages are the very blocks of a memory-backed device, so
+ *          they must not change while the file is mapped.
+ * 
+ * @param inode Inode of the file.
+ * 
+ * @returns Non-zero if some memory region maps pages of the file in place,
+ *          and zero otherwise.
+ */
+PUBLIC int ismapped(const struct inode *inode)
+{
+	struct region *reg;
+	
+	for (reg = &regtab[0]; reg < &regtab[NR_REGIONS]; reg++)
+	{
+		/* Skip free region. */
+		if (reg->flags & REGION_FREE)
+			continue;
+		
+		if ((reg->flags & REGION_DAX) && (reg->file.inode == inode))
+			return (1);
+	}
+	
+	return (0);
+}
+
 /**
  * @brief Loads a portion of a file into a memory region.
  * 
@@ -983,6 +951,35 @@ PUBLIC struct region *xalloc(struct inode *inode, off_t off, size_t size)
 	return (reg);
 }
 
+/**
+ * @brief Allocates a memory region backed by a kernel page.
+ *
+ * @details The kernel page lies outside user memory, so it is never
+ * handed over to the page frame allocator, not even when the region
+ * is freed. The caller owns it. The page is mapped read-only, unless
+ * @p mode grants write permission.
+ *
+ * @param kpg   Kernel page.
+ * @param mode  Access permissions.
+ * @param flags Memory region flags.
+ *
+ * @returns Upon success, a pointer to the (locked) memory region is
+ * returned. Upon failure, a NULL pointer is returned instead.
+ */
+PUBLIC struct region *kpgreg(void *kpg, mode_t mode, int flags)
+{
+	struct region *reg;
+
+	reg = allocreg(mode, PAGE_SIZE, flags);
+	if (reg == NULL)
+		return (NULL);
+
+	mapkpg(&reg->mtab[0]->pgtab[0][0], kpg,
+		(mode & (S_IWUSR | S_IWGRP | S_IWOTH)) ? 1 : 0);
+
+	return (reg);
+}
+
 /**
  * @brief Initializes memory regions and mini regions.
  */
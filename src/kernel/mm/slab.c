@@ -0,0 +1,628 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file mm/slab.c
+ *
+ * @brief Object caches.
+ *
+ * @details Objects of the same type are carved out of slabs, which are
+ * kernel pages that start with a slab header and a free list of object
+ * indexes. Objects are constructed once, when their slab is created, and
+ * they must be given back to the cache in their constructed state. Like
+ * the kernel page pool, object caches are protected by the kernel lock.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/debug.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <stdint.h>
+
+/**
+ * @brief End of slab free list.
+ */
+#define SLAB_NONE 0xffff
+
+/**
+ * @brief Rounds @p x up to a multiple of @p a, which must be a power of two.
+ */
+#define ALIGN(x, a) (((x) + ((a) - 1)) & ~((a) - 1))
+
+/**
+ * @brief Slab.
+ */
+struct slab
+{
+	struct kcache *cache; /**< Owner cache.                   */
+	struct slab *prev;    /**< Previous slab in the list.     */
+	struct slab *next;    /**< Next slab in the list.         */
+	char *objs;           /**< First object.                  */
+	unsigned inuse;       /**< Number of objects in use.      */
+	unsigned free;        /**< First free object.             */
+	uint16_t bufctl[];    /**< Next free object, per object.  */
+};
+
+/**
+ * @brief Object cache.
+ */
+struct kcache
+{
+	const char *name;      /**< Cache name.                        */
+	size_t size;           /**< Object size (padded).              */
+	size_t align;          /**< Object alignment.                  */
+	unsigned perslab;      /**< Objects per slab.                  */
+	size_t offset;         /**< Offset of first object in a slab.  */
+	void (*ctor)(void *);  /**< Object constructor.                */
+	struct slab *partial;  /**< Slabs with free and used objects.  */
+	struct slab *full;     /**< Slabs with no free objects.        */
+	struct slab *empty;    /**< Slab with no used objects.         */
+	unsigned nslabs;       /**< Number of slabs.                   */
+	unsigned nobjs;        /**< Number of objects in use.          */
+	struct kcache *next;   /**< Next cache.                        */
+};
+
+/**
+ * @brief Cache of object caches.
+ */
+PRIVATE struct kcache kcache_cache;
+
+/**
+ * @brief Object caches.
+ */
+PRIVATE struct kcache *kcaches = NULL;
+
+/**
+ * @brief Object sizes served by kmalloc().
+ */
+PRIVATE const size_t kmalloc_sizes[] = { 16, 32, 64, 128, 256, 512, 1024 };
+
+/**
+ * @brief Number of object caches of kmalloc().
+ */
+#define KMALLOC_NCACHES \
+	((int)(sizeof(kmalloc_sizes)/sizeof(kmalloc_sizes[0])))
+
+/**
+ * @brief Object caches of kmalloc().
+ */
+PRIVATE struct kcache *kmalloc_caches[KMALLOC_NCACHES];
+
+/*============================================================================*
+ *                                  slabs                                     *
+ *============================================================================*/
+
+/**
+ * @brief Inserts a slab in a list.
+ *
+ * @param list Target list.
+ * @param slab Target slab.
+ */
+PRIVATE void slab_link(struct slab **list, struct slab *slab)
+{
+	slab->prev = NULL;
+	slab->next = *list;
+	if (*list != NULL)
+		(*list)->prev = slab;
+	*list = slab;
+}
+
+/**
+ * @brief Removes a slab from a list.
+ *
+ * @param list Target list.
+ * @param slab Target slab.
+ */
+PRIVATE void slab_unlink(struct slab **list, struct slab *slab)
+{
+	if (slab->prev != NULL)
+		slab->prev->next = slab->next;
+	else
+		*list = slab->next;
+	if (slab->next != NULL)
+		slab->next->prev = slab->prev;
+}
+
+/**
+ * @brief Creates a slab.
+ *
+ * @param cache Target cache.
+ *
+ * @returns Upon success, a pointer to the new slab is returned. Upon
+ * failure, a NULL pointer is returned instead.
+ */
+PRIVATE struct slab *slab_create(struct kcache *cache)
+{
+	struct slab *slab;
+
+	if ((slab = getkpg(0)) == NULL)
+		return (NULL);
+
+	slab->cache = cache;
+	slab->objs = (char *)slab + cache->offset;
+	slab->inuse = 0;
+	slab->free = 0;
+
+	/* Build free list and construct objects. */
+	for (unsigned i = 0; i < cache->perslab; i++)
+	{
+		slab->bufctl[i] = (i + 1 < cache->perslab) ? i + 1 : SLAB_NONE;
+		if (cache->ctor != NULL)
+			cache->ctor(slab->objs + i*cache->size);
+	}
+
+	cache->nslabs++;
+
+	return (slab);
+}
+
+/**
+ * @brief Destroys a slab.
+ *
+ * @param slab Target slab.
+ */
+PRIVATE void slab_destroy(struct slab *slab)
+{
+	slab->cache->nslabs--;
+	putkpg(slab);
+}
+
+/*============================================================================*
+ *                              object caches                                 *
+ *============================================================================*/
+
+/**
+ * @brief Sets up an object cache.
+ *
+ * @param cache Target cache.
+ * @param name  Cache name.
+ * @param size  Object size.
+ * @param flags Cache flags.
+ * @param ctor  Object constructor.
+ *
+ * @returns Zero upon success, and non-zero otherwise.
+ */
+PRIVATE int kcache_setup
+(struct kcache *cache, const char *name, size_t size, int flags, void (*ctor)(void *))
+{
+	size_t align;
+	unsigned n;
+
+	/* Objects are word aligned, at least. */
+	align = sizeof(void *);
+	if (flags & KCACHE_HWALIGN)
+		align = CACHE_LINE_SIZE;
+
+	/* Natural alignment for small power of two objects. */
+	else
+	{
+		while ((align < CACHE_LINE_SIZE) && (size%(align << 1) == 0))
+			align <<= 1;
+	}
+
+	size = ALIGN(size, align);
+
+	/* Find out how many objects fit in a slab. */
+	n = (PAGE_SIZE - sizeof(struct slab))/(size + sizeof(uint16_t));
+	while ((n > 0) && (ALIGN(sizeof(struct slab) + n*sizeof(uint16_t), align)
+		+ n*size > PAGE_SIZE))
+		n--;
+
+	/* Too big. */
+	if ((n == 0) || (n >= SLAB_NONE))
+		return (-1);
+
+	cache->name = name;
+	cache->size = size;
+	cache->align = align;
+	cache->perslab = n;
+	cache->offset = ALIGN(sizeof(struct slab) + n*sizeof(uint16_t), align);
+	cache->ctor = ctor;
+	cache->partial = NULL;
+	cache->full = NULL;
+	cache->empty = NULL;
+	cache->nslabs = 0;
+	cache->nobjs = 0;
+	cache->next = kcaches;
+	kcaches = cache;
+
+	return (0);
+}
+
+/**
+ * @brief Creates an object cache.
+ *
+ * @param name  Cache name.
+ * @param size  Object size.
+ * @param flags Cache flags.
+ * @param ctor  Object constructor, or NULL if none.
+ *
+ * @returns Upon success, a pointer to the new cache is returned. Upon
+ * failure, a NULL pointer is returned instead.
+ */
+PUBLIC struct kcache *kcache_create
+(const char *name, size_t size, int flags, void (*ctor)(void *))
+{
+	struct kcache *cache;
+
+	if ((cache = kcache_alloc(&kcache_cache)) == NULL)
+		return (NULL);
+
+	if (kcache_setup(cache, name, size, flags, ctor))
+	{
+		kcache_free(&kcache_cache, cache);
+		return (NULL);
+	}
+
+	return (cache);
+}
+
+/**
+ * @brief Destroys an object cache.
+ *
+ * @param cache Target cache. All of its objects must have been released.
+ */
+PUBLIC void kcache_destroy(struct kcache *cache)
+{
+	struct kcache **p;
+
+	if (cache->nobjs != 0)
+		kpanic("mm: destroying busy %s cache", cache->name);
+
+	if (cache->empty != NULL)
+		slab_destroy(cache->empty);
+
+	for (p = &kcaches; *p != cache; p = &(*p)->next)
+		noop();
+	*p = cache->next;
+
+	kcache_free(&kcache_cache, cache);
+}
+
+/**
+ * @brief Allocates an object.
+ *
+ * @param cache Target cache.
+ *
+ * @returns Upon success, a pointer to a constructed object is returned.
+ * Upon failure, a NULL pointer is returned instead.
+ */
+PUBLIC void *kcache_alloc(struct kcache *cache)
+{
+	void *obj;
+	struct slab *slab;
+
+	/* Get a slab with free objects. */
+	if ((slab = cache->partial) == NULL)
+	{
+		if ((slab = cache->empty) != NULL)
+			cache->empty = NULL;
+		else if ((slab = slab_create(cache)) == NULL)
+		{
+			kprintf("mm: %s cache overflow", cache->name);
+			return (NULL);
+		}
+		slab_link(&cache->partial, slab);
+	}
+
+	obj = slab->objs + slab->free*cache->size;
+	slab->free = slab->bufctl[slab->free];
+	slab->inuse++;
+	cache->nobjs++;
+
+	/* Slab is now full. */
+	if (slab->free == SLAB_NONE)
+	{
+		slab_unlink(&cache->partial, slab);
+		slab_link(&cache->full, slab);
+	}
+
+	return (obj);
+}
+
+/**
+ * @brief Releases an object.
+ *
+ * @param cache Target cache.
+ * @param obj   Target object.
+ */
+PUBLIC void kcache_free(struct kcache *cache, void *obj)
+{
+	unsigned i;
+	struct slab *slab;
+
+	slab = (struct slab *)(ADDR(obj) & PAGE_MASK);
+
+	/* Bad object. */
+	if (slab->cache != cache)
+		kpanic("mm: freeing object to wrong cache");
+	i = ((char *)obj - slab->objs)/cache->size;
+	if (((char *)obj - slab->objs)%cache->size)
+		kpanic("mm: freeing bad object");
+
+	/* Slab was full. */
+	if (slab->free == SLAB_NONE)
+	{
+		slab_unlink(&cache->full, slab);
+		slab_link(&cache->partial, slab);
+	}
+
+	slab->bufctl[i] = slab->free;
+	slab->free = i;
+	slab->inuse--;
+	cache->nobjs--;
+
+	/* Slab is now empty, keep at most one around. */
+	if (slab->inuse == 0)
+	{
+		slab_unlink(&cache->partial, slab);
+		if (cache->empty != NULL)
+			slab_destroy(cache->empty);
+		cache->empty = slab;
+	}
+}
+
+/**
+ * @brief Releases the free slabs of all object caches.
+ */
+PUBLIC void kcache_reap(void)
+{
+	for (struct kcache *cache = kcaches; cache != NULL; cache = cache->next)
+	{
+		if (cache->empty != NULL)
+		{
+			slab_destroy(cache->empty);
+			cache->empty = NULL;
+		}
+	}
+}
+
+/*============================================================================*
+ *                                 kmalloc                                    *
+ *============================================================================*/
+
+/**
+ * @brief Allocates kernel memory.
+ *
+ * @details Small requests are served by general purpose object caches,
+ * larger ones take a whole kernel page.
+ *
+ * @param size Number of bytes to allocate.
+ *
+ * @returns Upon success, a pointer to the allocated memory is returned.
+ * Upon failure, a NULL pointer is returned instead.
+ */
+PUBLIC void *kmalloc(size_t size)
+{
+	/* Invalid size. */
+	if ((size == 0) || (size > PAGE_SIZE))
+		return (NULL);
+
+	for (int i = 0; i < KMALLOC_NCACHES; i++)
+	{
+		if (size <= kmalloc_sizes[i])
+			return (kcache_alloc(kmalloc_caches[i]));
+	}
+
+	return (getkpg(0));
+}
+
+/**
+ * @brief Releases kernel memory.
+ *
+ * @details Objects are never page aligned, since slabs start with a
+ * header, so page aligned memory comes straight from the page pool.
+ *
+ * @param ptr Memory to be released.
+ */
+PUBLIC void kfree(void *ptr)
+{
+	struct slab *slab;
+
+	if (ptr == NULL)
+		return;
+
+	/* Whole page. */
+	if ((ADDR(ptr) & ~PAGE_MASK) == 0)
+	{
+		putkpg(ptr);
+		return;
+	}
+
+	slab = (struct slab *)(ADDR(ptr) & PAGE_MASK);
+	kcache_free(slab->cache, ptr);
+}
+
+/*============================================================================*
+ *                                 testing                                    *
+ *============================================================================*/
+
+/**
+ * @brief Number of objects allocated by the object cache test.
+ */
+#define TEST_SLAB_NOBJS 256
+
+/**
+ * @brief Test object.
+ */
+struct test_obj
+{
+	unsigned magic; /**< Set by the constructor. */
+	char data[60];  /**< Payload.                */
+};
+
+/**
+ * @brief Test object constructor.
+ */
+PRIVATE void test_obj_ctor(void *obj)
+{
+	((struct test_obj *)obj)->magic = 0xc0ffee;
+}
+
+/**
+ * @brief Object cache test.
+ *
+ * @returns Zero upon success, and non-zero otherwise.
+ */
+PRIVATE int test_kcache(void)
+{
+	struct kcache *cache;
+	struct test_obj *objs[TEST_SLAB_NOBJS];
+	int ret = -1;
+
+	for (int i = 0; i < TEST_SLAB_NOBJS; i++)
+		objs[i] = NULL;
+
+	cache = kcache_create("test", sizeof(struct test_obj), KCACHE_HWALIGN,
+		test_obj_ctor);
+	if (cache == NULL)
+		return (-1);
+
+	for (int i = 0; i < TEST_SLAB_NOBJS; i++)
+	{
+		if ((objs[i] = kcache_alloc(cache)) == NULL)
+			goto out;
+
+		/* Not constructed, or not aligned. */
+		if ((objs[i]->magic != 0xc0ffee) ||
+			(ADDR(objs[i]) & (CACHE_LINE_SIZE - 1)))
+			goto out;
+
+		objs[i]->data[0] = i;
+	}
+
+	/* Overlapping objects. */
+	for (int i = 0; i < TEST_SLAB_NOBJS; i++)
+	{
+		if (objs[i]->data[0] != (char)i)
+			goto out;
+	}
+
+	ret = 0;
+
+out:
+	for (int i = 0; i < TEST_SLAB_NOBJS; i++)
+	{
+		if (objs[i] == NULL)
+			break;
+		kcache_free(cache, objs[i]);
+	}
+
+	/* Only one free slab should be kept. */
+	if ((cache->nobjs != 0) || (cache->nslabs != 1))
+		ret = -1;
+
+	kcache_destroy(cache);
+
+	return (ret);
+}
+
+/**
+ * @brief kmalloc() test.
+ *
+ * @returns Zero upon success, and non-zero otherwise.
+ */
+PRIVATE int test_kmalloc(void)
+{
+	char *ptrs[PAGE_SHIFT + 1];
+
+	if (kmalloc(0) != NULL || kmalloc(PAGE_SIZE + 1) != NULL)
+		return (-1);
+
+	/* Allocate all powers of two, up to a page. */
+	for (int i = 0; i <= PAGE_SHIFT; i++)
+	{
+		size_t size = 1 << i;
+
+		if ((ptrs[i] = kmalloc(size)) == NULL)
+		{
+			while (i-- > 0)
+				kfree(ptrs[i]);
+			return (-1);
+		}
+
+		kmemset(ptrs[i], i, size);
+	}
+
+	/* Check. */
+	for (int i = 0; i <= PAGE_SHIFT; i++)
+	{
+		for (size_t j = 0; j < (size_t)(1 << i); j++)
+		{
+			if (ptrs[i][j] != i)
+				return (-1);
+		}
+	}
+
+	for (int i = 0; i <= PAGE_SHIFT; i++)
+		kfree(ptrs[i]);
+
+	return (0);
+}
+
+/**
+ * @brief Object cache and kmalloc() tests.
+ */
+PUBLIC void test_slab(void)
+{
+	if (test_kcache())
+	{
+		tst_failed();
+		return;
+	}
+
+	if (test_kmalloc())
+	{
+		tst_failed();
+		return;
+	}
+
+	tst_passed();
+}
+
+/*============================================================================*
+ *                              initialization                                *
+ *============================================================================*/
+
+/**
+ * @brief Names of the object caches of kmalloc().
+ */
+PRIVATE const char *kmalloc_names[KMALLOC_NCACHES] = {
+	"kmalloc-16",  "kmalloc-32",  "kmalloc-64",   "kmalloc-128",
+	"kmalloc-256", "kmalloc-512", "kmalloc-1024"
+};
+
+/**
+ * @brief Initializes object caches.
+ */
+PUBLIC void kcache_init(void)
+{
+	if (kcache_setup(&kcache_cache, "kcache", sizeof(struct kcache), 0, NULL))
+		kpanic("mm: cannot create cache of caches");
+
+	for (int i = 0; i < KMALLOC_NCACHES; i++)
+	{
+		kmalloc_caches[i] = kcache_create(kmalloc_names[i], kmalloc_sizes[i],
+			0, NULL);
+		if (kmalloc_caches[i] == NULL)
+			kpanic("mm: cannot create %s cache", kmalloc_names[i]);
+	}
+
+	dbg_register(test_slab, "test_slab");
+}
@@ -96,6 +96,9 @@ PUBLIC void die(int status)
 		}
 	}
 	
+	/* Tear down asynchronous I/O ring. */
+	ioring_detach();
+	
 	/* Detach process memory regions. */
 	for (unsigned i = 0; i < NR_PREGIONS; i++)
 		detachreg(curr_proc, &curr_proc->pregs[i]);
@@ -106,6 +109,7 @@ PUBLIC void die(int status)
 	
 	curr_proc->state = PROC_ZOMBIE;
 	curr_proc->alarm = 0;
+	curr_proc->timeout = 0;
 
 	/* Resets the counter if any. */
 	if (curr_proc->pmcs.enable_counters != 0)
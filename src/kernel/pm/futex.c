@@ -0,0 +1,131 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/hal.h>
+#include <nanvix/pm.h>
+#include <errno.h>
+
+/**
+ * @brief Number of futex wait queues.
+ */
+#define FUTEX_HASH_SIZE 64
+
+/**
+ * @brief Hashes a futex key.
+ */
+#define FUTEX_HASH(obj, off) \
+	((((addr_t)(obj) >> 4) ^ ((off) >> 2))%FUTEX_HASH_SIZE)
+
+/**
+ * @brief Futex waiter.
+ *
+ * @details Waiters live on the kernel stack of the sleeping process.
+ */
+struct futex_waiter
+{
+	const void *obj;            /**< Object that holds the word.  */
+	addr_t off;                 /**< Offset of the word.          */
+	struct process *chain;      /**< Sleeping process.            */
+	struct futex_waiter *next;  /**< Next waiter in the queue.    */
+};
+
+/**
+ * @brief Futex wait queues.
+ */
+PRIVATE struct futex_waiter *futex_queues[FUTEX_HASH_SIZE] = { NULL, };
+
+/**
+ * @brief Puts the current process to sleep on a futex.
+ *
+ * @details A futex is identified by an object, which is either a shared
+ * memory region or a process, and by the offset of a word in it. The
+ * caller is expected to have checked the value of the word, with the
+ * kernel lock held, so that a wakeup cannot get in between.
+ *
+ * @param obj Object that holds the word.
+ * @param off Offset of the word.
+ *
+ * @returns Zero if the process was awaken by futex_wakeup(), and
+ * -EINTR if it was interrupted by a signal.
+ */
+PUBLIC int futex_sleep(const void *obj, addr_t off)
+{
+	struct futex_waiter w;
+	struct futex_waiter **q;
+
+	w.obj = obj;
+	w.off = off;
+	w.chain = NULL;
+
+	q = &futex_queues[FUTEX_HASH(obj, off)];
+	w.next = *q;
+	*q = &w;
+
+	sleep(&w.chain, PRIO_USER);
+
+	/* Still queued, so we were interrupted. */
+	for (; *q != NULL; q = &(*q)->next)
+	{
+		if (*q == &w)
+		{
+			*q = w.next;
+			return (-EINTR);
+		}
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Wakes up processes sleeping on a futex.
+ *
+ * @param obj Object that holds the word.
+ * @param off Offset of the word.
+ * @param n   Maximum number of processes to wake up.
+ *
+ * @returns The number of processes that were awaken.
+ */
+PUBLIC int futex_wakeup(const void *obj, addr_t off, int n)
+{
+	int nwoken;
+	struct futex_waiter *w;
+	struct futex_waiter **q;
+
+	nwoken = 0;
+	q = &futex_queues[FUTEX_HASH(obj, off)];
+
+	while ((nwoken < n) && (*q != NULL))
+	{
+		w = *q;
+
+		/* Someone else. */
+		if ((w->obj != obj) || (w->off != off))
+		{
+			q = &w->next;
+			continue;
+		}
+
+		*q = w->next;
+		wakeup(&w->chain);
+		nwoken++;
+	}
+
+	return (nwoken);
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/hal.h>
+#include <nanvix/klib.h>
+#include <nanvix/spinlock.h>
+
+/**
+ * @brief Restores the interrupt state of the local processor.
+ *
+ * @param flags Interrupt state to restore.
+ */
+PRIVATE inline void irq_restore(unsigned flags)
+{
+	if (flags)
+		enable_interrupts();
+}
+
+/*============================================================================*
+ *                                 spinlock                                   *
+ *============================================================================*/
+
+/**
+ * @brief Initializes a spinlock.
+ *
+ * @param lock Target spinlock.
+ */
+PUBLIC void spinlock_init(struct spinlock *lock)
+{
+	lock->locked = 0;
+	lock->flags = 0;
+}
+
+/**
+ * @brief Acquires a spinlock.
+ *
+ * @details Disables interrupts on the local processor and busy waits
+ * until the spinlock pointed to by @p lock is released. Spinlocks
+ * must be released in the opposite order that they were acquired.
+ *
+ * @param lock Target spinlock.
+ */
+PUBLIC void spinlock_lock(struct spinlock *lock)
+{
+	unsigned flags;
+
+	flags = irq_save();
+
+	while (test_and_set(&lock->locked))
+	{
+		/* Spin on a read to keep the cache line shared. */
+		while (lock->locked)
+			noop();
+	}
+
+	lock->flags = flags;
+}
+
+/**
+ * @brief Attempts to acquire a spinlock.
+ *
+ * @param lock Target spinlock.
+ *
+ * @returns Non-zero if the lock was acquired, and zero otherwise.
+ */
+PUBLIC int spinlock_trylock(struct spinlock *lock)
+{
+	unsigned flags;
+
+	flags = irq_save();
+
+	/* Busy. */
+	if (test_and_set(&lock->locked))
+	{
+		irq_restore(flags);
+		return (0);
+	}
+
+	lock->flags = flags;
+
+	return (1);
+}
+
+/**
+ * @brief Releases a spinlock.
+ *
+ * @param lock Target spinlock.
+ */
+PUBLIC void spinlock_unlock(struct spinlock *lock)
+{
+	unsigned flags;
+
+	flags = lock->flags;
+
+	__asm__ __volatile__ ("" ::: "memory");
+	lock->locked = 0;
+
+	irq_restore(flags);
+}
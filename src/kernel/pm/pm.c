@@ -49,11 +49,27 @@ PUBLIC char idle_kstack[KSTACK_SIZE];
  */
 PUBLIC struct process proctab[PROC_MAX];
 
+/**
+ * @brief Processors.
+ */
+PUBLIC struct cpu cpus[CPU_MAX] = {
+	{ &cpus[0], IDLE, NULL, 0, 0, 1, IDLE, idle_kstack, { SPINLOCK_INITIALIZER, NULL, 0 }, 0, 0 }
+};
+
+/**
+ * @brief Number of online processors.
+ */
+PUBLIC unsigned ncpus = 1;
+
+#ifndef i386
+
 /**
  * @brief Current running process. 
  */
 PUBLIC struct process *curr_proc = IDLE;
 
+#endif
+
 /**
  * @brief Last running process. 
  */
@@ -133,8 +149,12 @@ PUBLIC void pm_init(void)
 	IDLE->priority = PRIO_USER;
 	IDLE->nice = NZERO;
 	IDLE->alarm = 0;
+	IDLE->timeout = 0;
 	IDLE->next = NULL;
 	IDLE->chain = NULL;
+	IDLE->rqnext = NULL;
+	IDLE->cpu = 0;
+	IDLE->affinity = CPU_ALL;
 	
 	nprocs++;
 
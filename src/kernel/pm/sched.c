@@ -18,6 +18,7 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <dev/trace.h>
 #include <nanvix/clock.h>
 #include <nanvix/const.h>
 #include <nanvix/hal.h>
@@ -55,15 +56,212 @@
 	(PRIORITY(p2) < PRIORITY(p1) ||                           \
 	 (PRIORITY(p2) == PRIORITY(p1) && (p2)->counter > (p1)->counter))
 
+/**
+ * @brief Asserts if a process may run on a processor.
+ *
+ * @param p   Target process.
+ * @param cpu Target processor.
+ */
+#define CAN_RUN(p, cpu) \
+	((p)->affinity & (1 << (cpu)->id))
+
+/**
+ * @brief Earliest alarm or sleep timeout, in clock ticks, or zero if
+ * there is none.
+ *
+ * @details Deadlines that are cancelled are not withdrawn from here,
+ * so this may be earlier than any armed deadline, but never later.
+ */
+PRIVATE unsigned next_deadline = 0;
+
+/**
+ * @brief Selects the processor where a process should be queued.
+ *
+ * @details The processor where the process last ran is preferred,
+ * so that it gets back to a warm cache. If the process is not allowed
+ * to run there, the least loaded allowed processor is chosen instead.
+ *
+ * @param proc Target process.
+ *
+ * @returns The selected processor.
+ */
+PRIVATE struct cpu *rq_select(struct process *proc)
+{
+	struct cpu *cpu;
+	struct cpu *best;
+
+	cpu = &cpus[proc->cpu];
+	if ((proc->cpu < ncpus) && CAN_RUN(proc, cpu))
+		return (cpu);
+
+	best = &cpus[0];
+	for (unsigned i = 0; i < ncpus; i++)
+	{
+		cpu = &cpus[i];
+
+		if (!CAN_RUN(proc, cpu))
+			continue;
+
+		if ((!CAN_RUN(proc, best)) || (cpu->rq.nready < best->rq.nready))
+			best = cpu;
+	}
+
+	return (best);
+}
+
+/**
+ * @brief Removes a process from a ready queue.
+ *
+ * @param rq   Target ready queue.
+ * @param prev Process that precedes @p proc in the queue, or NULL if
+ *             @p proc is the head of the queue.
+ * @param proc Process to remove.
+ *
+ * @note The ready queue must be locked.
+ */
+PRIVATE void rq_remove
+(struct runqueue *rq, struct process *prev, struct process *proc)
+{
+	if (prev == NULL)
+		rq->head = proc->rqnext;
+	else
+		prev->rqnext = proc->rqnext;
+
+	proc->rqnext = NULL;
+	rq->nready--;
+}
+
+/**
+ * @brief Picks the next process to run from the local ready queue.
+ *
+ * @details The chosen process is the one with the highest priority,
+ * and the one that has been waiting for the longest time, among those
+ * in the ready queue of the calling processor and its idle process.
+ * Processes that are not chosen have their waiting time incremented.
+ *
+ * @param cpu Calling processor.
+ *
+ * @returns The process to run next.
+ */
+PRIVATE struct process *rq_pick(struct cpu *cpu)
+{
+	struct process *p;           /* Working process.              */
+	struct process *prev;        /* Previous process in queue.    */
+	struct process *next;        /* Next process to run.          */
+	struct process *nextprev;    /* Process before next in queue. */
+	struct runqueue *rq = &cpu->rq;
+
+	spinlock_lock(&rq->lock);
+
+	next = cpu->idle;
+	nextprev = NULL;
+	for (prev = NULL, p = rq->head; p != NULL; prev = p, p = p->rqnext)
+	{
+		/* Higher priority process found. */
+		if (HIGHER_PRIORITY(next, p))
+		{
+			next->counter++;
+			next = p;
+			nextprev = prev;
+		}
+
+		/*
+		 * Increment waiting
+		 * time of process.
+		 */
+		else
+			p->counter++;
+	}
+
+	if (next != cpu->idle)
+		rq_remove(rq, nextprev, next);
+
+	spinlock_unlock(&rq->lock);
+
+	return (next);
+}
+
+/**
+ * @brief Steals a process from the busiest ready queue.
+ *
+ * @param cpu Calling processor.
+ *
+ * @returns A process that may run on the calling processor, or NULL if
+ * there is none.
+ */
+PRIVATE struct process *rq_steal(struct cpu *cpu)
+{
+	struct cpu *victim;      /* Busiest processor.         */
+	struct process *p;       /* Working process.           */
+	struct process *prev;    /* Previous process in queue. */
+
+	/* Find busiest processor. */
+	victim = NULL;
+	for (unsigned i = 0; i < ncpus; i++)
+	{
+		if (&cpus[i] == cpu)
+			continue;
+
+		if (cpus[i].rq.nready == 0)
+			continue;
+
+		if ((victim == NULL) || (cpus[i].rq.nready > victim->rq.nready))
+			victim = &cpus[i];
+	}
+
+	/* Nothing to steal. */
+	if (victim == NULL)
+		return (NULL);
+
+	spinlock_lock(&victim->rq.lock);
+
+	for (prev = NULL, p = victim->rq.head; p != NULL; prev = p, p = p->rqnext)
+	{
+		if (CAN_RUN(p, cpu))
+		{
+			rq_remove(&victim->rq, prev, p);
+			break;
+		}
+	}
+
+	spinlock_unlock(&victim->rq.lock);
+
+	return (p);
+}
+
 /**
  * @brief Schedules a process to execution.
  * 
+ * @details The process is put in the ready queue of the processor where
+ * it last ran, and that processor is kicked if it is idle.
+ * 
  * @param proc Process to be scheduled.
  */
 PUBLIC void sched(struct process *proc)
 {
-	proc->state = PROC_READY;
+	struct cpu *cpu;
+
 	proc->counter = 0;
+
+	/* Already queued. */
+	if (proc->state == PROC_READY)
+		return;
+
+	proc->state = PROC_READY;
+
+	/* Idle processes are never queued. */
+	if (proc == cpus[proc->cpu].idle)
+		return;
+
+	cpu = rq_select(proc);
+
+	spinlock_lock(&cpu->rq.lock);
+	proc->rqnext = cpu->rq.head;
+	cpu->rq.head = proc;
+	cpu->rq.nready++;
+	spinlock_unlock(&cpu->rq.lock);
+
+	cpu_kick(cpu);
 }
 
 /**
@@ -90,11 +288,127 @@ PUBLIC void resume(struct process *proc)
 		sched(proc);
 }
 
+/**
+ * @brief Accounts a deadline in the next clock event.
+ *
+ * @param deadline Deadline, in clock ticks, or zero if there is none.
+ * @param nticks   Clock ticks until the next clock event.
+ *
+ * @returns Non-zero if the deadline is due, and zero otherwise.
+ */
+PRIVATE int sched_deadline(unsigned deadline, unsigned *nticks)
+{
+	if (!deadline)
+		return (0);
+
+	if (deadline < ticks)
+		return (1);
+
+	if ((*nticks == 0) || (deadline - ticks + 1 < *nticks))
+		*nticks = deadline - ticks + 1;
+
+	return (0);
+}
+
+/**
+ * @brief Arms an alarm or sleep timeout.
+ *
+ * @param deadline Deadline, in clock ticks, or zero if there is none.
+ */
+PUBLIC void sched_timer(unsigned deadline)
+{
+	if ((deadline) && ((!next_deadline) || (deadline < next_deadline)))
+		next_deadline = deadline;
+}
+
+/**
+ * @brief Fires alarms and sleep timeouts that have expired.
+ *
+ * @details Process deadlines are only walked when the earliest one is
+ * due, and the earliest deadline that is still armed is found again
+ * on the way.
+ */
+PRIVATE void sched_expire(void)
+{
+	struct process *p; /* Working process. */
+
+	/* Nothing is due. */
+	if ((!next_deadline) || (next_deadline >= ticks))
+		return;
+
+	next_deadline = 0;
+
+	for (p = FIRST_PROC; p <= LAST_PROC; p++)
+	{
+		/* Skip invalid processes. */
+		if (!IS_VALID(p))
+			continue;
+
+		/* Alarm has expired. */
+		if ((p->alarm) && (p->alarm < ticks))
+			p->alarm = 0, sndsig(p, SIGALRM);
+		else
+			sched_timer(p->alarm);
+
+		/* Sleep timeout has expired. */
+		if ((p->timeout) && (p->timeout < ticks))
+		{
+			p->timeout = 0;
+			if (p->state == PROC_WAITING)
+				unsleep(p);
+		}
+		else
+			sched_timer(p->timeout);
+	}
+}
+
+/**
+ * @brief Asserts if the calling processor may stop its clock.
+ *
+ * @details A processor may stop its clock while it has nothing to run.
+ * The bootstrap processor keeps time, so it may only do so while all
+ * processors are idle, and it has to wake up for the next alarm or
+ * sleep timeout.
+ *
+ * @param nticks Where to store the number of clock ticks until the
+ *               next alarm or sleep timeout goes off, or zero if there
+ *               is none.
+ *
+ * @returns Non-zero if the clock may be stopped, and zero otherwise.
+ */
+PUBLIC int sched_idle(unsigned *nticks)
+{
+	struct cpu *cpu; /* Running processor. */
+
+	*nticks = 0;
+
+	cpu = cpu_self();
+	if (cpu->rq.nready > 0)
+		return (0);
+
+	/* Other processors keep time for no one. */
+	if (cpu != &cpus[0])
+		return (1);
+
+	for (unsigned i = 1; i < ncpus; i++)
+	{
+		if ((cpus[i].rq.nready > 0) || (cpus[i].curr != cpus[i].idle))
+			return (0);
+	}
+
+	/* Next alarm or sleep timeout is due. */
+	if (sched_deadline(next_deadline, nticks))
+		return (0);
+
+	return (1);
+}
+
 /**
  * @brief Yields the processor.
  */
 PUBLIC void yield(void)
 {
+	struct cpu *cpu;      /* Running processor.   */
 	struct process *p;    /* Working process.     */
 	struct process *next; /* Next process to run. */
 
@@ -121,45 +435,23 @@ PUBLIC void yield(void)
 	/* Remember this process. */
 	last_proc = curr_proc;
 
-	/* Check alarm. */
-	for (p = FIRST_PROC; p <= LAST_PROC; p++)
-	{
-		/* Skip invalid processes. */
-		if (!IS_VALID(p))
-			continue;
-		
-		/* Alarm has expired. */
-		if ((p->alarm) && (p->alarm < ticks))
-			p->alarm = 0, sndsig(p, SIGALRM);
-	}
+	/* Check alarms and sleep timeouts. */
+	sched_expire();
 
 	/* Choose a process to run next. */
-	next = IDLE;
-	for (p = FIRST_PROC; p <= LAST_PROC; p++)
+	cpu = cpu_self();
+	next = rq_pick(cpu);
+	if ((cpu->rq.nready == 0) && (next == cpu->idle))
 	{
-		/* Skip non-ready process. */
-		if (p->state != PROC_READY)
-			continue;
-		
-		/* Higher priority process found. */
-		if (HIGHER_PRIORITY(next, p))
-		{
-			next->counter++;
+		if ((p = rq_steal(cpu)) != NULL)
 			next = p;
-		}
- 
-		/*
-		 * Increment waiting
-		 * time of process.
-		 */
-		else
-			p->counter++;
 	}
 	
 	/* Switch to next process. */
 	next->priority = PRIO_USER;
 	next->state = PROC_RUNNING;
 	next->counter = PROC_QUANTUM;
+	next->cpu = cpu->id;
 
 	/* Start performance counters. */
 	if (next->pmcs.enable_counters != 0)
@@ -193,6 +485,9 @@ PUBLIC void yield(void)
 		fpu_save(curr_proc);
 		fpu_restore(next);
 	
+		TRACE(TRACE_SWITCH, curr_proc->pid, next->pid, curr_proc->state);
+		cpu->nswitches++;
+
 		/* Swith context. */
 		switch_to(next);
 	}
@@ -121,18 +121,7 @@ PUBLIC void sndsig(struct process *proc, int sig)
 	
 	/* Wake up process. */
 	if (proc->state == PROC_WAITING)
-	{
-		if (proc == *proc->chain)
-			*proc->chain = proc->next;
-		else
-		{
-			struct process *p;
-			for (p = *proc->chain; p->next != proc; p = p->next)
-				noop() ;
-			p->next = proc->next;
-		}
-		sched(proc);
-	}
+		unsleep(proc);
 }
 
 /**
@@ -77,13 +77,70 @@ PUBLIC void sleep(struct process **chain, int priority)
 	yield();
 }
 
+/**
+ * @brief Puts the current process to sleep, releasing a spinlock.
+ *
+ * @details Puts the current process to sleep in the chain of processes
+ *          pointed to by @p chain, just like sleep() does, but releases
+ *          the spinlock pointed to by @p lock in the meantime. Interrupts
+ *          are kept disabled until the processor is handed over, so a
+ *          wakeup that is issued by an interrupt handler is never lost.
+ *          The spinlock is held again when this function returns.
+ *
+ * @param chain    Sleeping chain where the process should be put.
+ * @param priority Priority that the process shall assume after waking up.
+ * @param lock     Spinlock that protects the sleeping condition.
+ */
+PUBLIC void sleep_locked(struct process **chain, int priority, struct spinlock *lock)
+{
+	unsigned flags;
+
+	/* Release lock, but leave interrupts disabled. */
+	flags = lock->flags;
+	lock->flags = 0;
+	spinlock_unlock(lock);
+
+	sleep(chain, priority);
+
+	spinlock_lock(lock);
+	lock->flags = flags;
+}
+
+/**
+ * @brief Wakes up a single sleeping process.
+ *
+ * @details Removes the process pointed to by @p proc from the chain
+ *          where it is sleeping and schedules it for execution.
+ *
+ * @param proc Process to be awaken.
+ *
+ * @note @p proc must be sleeping.
+ */
+PUBLIC void unsleep(struct process *proc)
+{
+	struct process *p;
+
+	if (proc == *proc->chain)
+		*proc->chain = proc->next;
+	else
+	{
+		for (p = *proc->chain; p->next != proc; p = p->next)
+			noop();
+		p->next = proc->next;
+	}
+
+	sched(proc);
+}
+
 /**
  * @brief Wakes up all processes that are sleeping in a chain.
  * 
  * @param chain Chain of sleeping processes to be awaken.
  */
 PUBLIC void wakeup(struct process **chain)
-{	
+{
+	struct process *p;
+	
 	/*
 	 * Wakeup idle process. Note that here we don't
 	 * schedule the idle process for execution, once
@@ -96,10 +153,15 @@ PUBLIC void wakeup(struct process **chain)
 		return;
 	}
 	
-	/* Wakeup sleeping processes. */
+	/*
+	 * Wakeup sleeping processes. Each one goes back
+	 * to the ready queue of the processor where it
+	 * last ran, to find a warm cache there.
+	 */
 	while (*chain != NULL)
 	{
-		sched(*chain);
-		*chain = (*chain)->next;
+		p = *chain;
+		*chain = p->next;
+		sched(p);
 	}
 }
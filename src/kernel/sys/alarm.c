@@ -32,7 +32,10 @@ PUBLIC unsigned sys_alarm(unsigned seconds)
 	
 	/* Schedule alarm. */
 	if (seconds > 0)
+	{
 		curr_proc->alarm = ticks + seconds*CLOCK_FREQ;
+		sched_timer(curr_proc->alarm);
+	}
 		
 	/* Cancel alarm. */
 	else
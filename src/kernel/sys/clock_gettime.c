@@ -0,0 +1,66 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/mm.h>
+#include <sys/timepage.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <time.h>
+
+/**
+ * @brief Gets the time of a clock.
+ *
+ * @details Processes normally read the time page instead, this is
+ * the slow path.
+ *
+ * @param clock_id Clock, either CLOCK_MONOTONIC or CLOCK_REALTIME.
+ * @param tp       Where to store the time.
+ *
+ * @returns 0 upon successful completion, a negative error code
+ * otherwise.
+ */
+PUBLIC int sys_clock_gettime(clockid_t clock_id, struct timespec *tp)
+{
+	struct timespec ts;
+
+	/* Invalid buffer. */
+	if (!chkmem(tp, sizeof(struct timespec), MAY_WRITE))
+		return (-EFAULT);
+
+	timepage_read(timepage, &ts, NULL);
+
+	switch (clock_id)
+	{
+		case CLOCK_MONOTONIC:
+			break;
+
+		case CLOCK_REALTIME:
+			ts.tv_sec += startup_time;
+			break;
+
+		default:
+			return (-EINVAL);
+	}
+
+	*tp = ts;
+
+	return (0);
+}
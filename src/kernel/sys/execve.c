@@ -18,6 +18,7 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <nanvix/clock.h>
 #include <nanvix/const.h>
 #include <nanvix/fs.h>
 #include <nanvix/hal.h>
@@ -130,7 +131,6 @@ PRIVATE addr_t load_elf32(struct inode *inode)
 	addr_t entry;           /* Program entry point.           */
 	struct elf32_fhdr *elf; /* ELF file header.               */
 	struct elf32_phdr *seg; /* ELF Program header.            */
-	block_t blk;            /* Working block number.          */
 	buffer_t header;        /* File headers block buffer.     */
 	struct region *reg;     /* Working memory region.         */
 	struct pregion *preg;   /* Working process memory region. */
@@ -140,17 +140,17 @@ PRIVATE addr_t load_elf32(struct inode *inode)
 	int ph_re;              /* Amount of Exec. Prog. Headers. */
 	int ph_rw;              /* Amount of RW Program Headers.  */
 	
-	blk = block_map(inode, 0, 0);
+	/* Read ELF file header. */
+	header = (inode->i_op->file_bread != NULL) ?
+		inode->i_op->file_bread(inode, 0) : NULL;
 	
-	/* Empty file. */
-	if (blk == BLOCK_NULL)
+	/* Empty file, or file not in a disk file system. */
+	if (header == NULL)
 	{
 		curr_proc->errno = -ENOEXEC;
 		return (0);
 	}
 	
-	/* Read ELF file header. */
-	header = bread(inode->dev, blk);
 	elf = buffer_data(header);
 
 	/* Section header infos. */
@@ -526,6 +526,9 @@ PUBLIC int sys_execve(const char *filename, const char **argv, const char **envp
 		}
 	}
 
+	/* Tear down asynchronous I/O ring. */
+	ioring_detach();
+
 	/* Detach process memory regions. */
 	for (i = 0; i < NR_PREGIONS; i++)
 		detachreg(curr_proc, &curr_proc->pregs[i]);
@@ -548,6 +551,10 @@ PUBLIC int sys_execve(const char *filename, const char **argv, const char **envp
 		goto die1;
 	unlockreg(reg);
 
+	/* Attach time page. */
+	if (timepage_attach())
+		goto die0;
+
 	/* Assign binary name to the process name. */
 	kstrncpy(curr_proc->name, get_binary_name(pathname), NAME_MAX);
 	
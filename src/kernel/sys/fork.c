@@ -80,6 +80,10 @@ found:
 		/* Process region not in use. */
 		if (preg == NULL || preg->reg == NULL)
 			continue;	
+		
+		/* Process region not inherited. */
+		if (preg->reg->flags & REGION_PRIVATE)
+			continue;
 			
 		lockreg(preg->reg);
 		reg = dupreg(preg->reg);
@@ -114,6 +118,7 @@ found:
 		proc->handlers[i] = curr_proc->handlers[i];
 	proc->irqlvl = curr_proc->irqlvl;
 	proc->pmcs.enable_counters = 0;
+	proc->lastreg = NULL;
 	proc->size = curr_proc->size;
 	proc->pwd = curr_proc->pwd;
 	proc->pwd->count++;
@@ -146,11 +151,18 @@ found:
 	proc->ktime = 0;
 	proc->cutime = 0;
 	proc->cktime = 0;
+	proc->minflt = 0;
+	proc->majflt = 0;
 	proc->priority = curr_proc->priority;
 	proc->nice = curr_proc->nice;
 	proc->alarm = 0;
+	proc->timeout = 0;
 	proc->next = NULL;
 	proc->chain = NULL;
+	proc->rqnext = NULL;
+	proc->cpu = curr_proc->cpu;
+	proc->affinity = curr_proc->affinity;
+	proc->ioring = NULL;
 	sched(proc);
 
 	curr_proc->nchildren++;
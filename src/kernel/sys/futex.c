@@ -0,0 +1,78 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <sys/futex.h>
+#include <errno.h>
+
+/*
+ * Waits on/wakes up processes waiting on a user word.
+ */
+PUBLIC int sys_futex(int *uaddr, int op, int val)
+{
+	int word;             /* Current value.   */
+	const void *obj;      /* Futex object.    */
+	addr_t off;           /* Futex offset.    */
+	struct pregion *preg; /* Process region.  */
+
+	/* Bad address. */
+	if (ADDR(uaddr) & (sizeof(int) - 1))
+		return (-EINVAL);
+	if ((preg = findreg(curr_proc, ADDR(uaddr))) == NULL)
+		return (-EFAULT);
+	if (copy_from_user(&word, uaddr, sizeof(int)))
+		return (-EFAULT);
+
+	/*
+	 * Words in shared regions are identified by their offset in
+	 * the region, since the region may be attached elsewhere in
+	 * other processes. Other words are private to the process.
+	 */
+	if (preg->reg->flags & REGION_SHARED)
+	{
+		obj = preg->reg;
+		off = ADDR(uaddr) - preg->start;
+	}
+	else
+	{
+		obj = curr_proc;
+		off = ADDR(uaddr);
+	}
+
+	switch (op)
+	{
+		case FUTEX_WAIT:
+			if (word != val)
+				return (-EAGAIN);
+			return (futex_sleep(obj, off));
+
+		case FUTEX_WAKE:
+			if (val <= 0)
+				return (-EINVAL);
+			return (futex_wakeup(obj, off, val));
+
+		default:
+			break;
+	}
+
+	return (-EINVAL);
+}
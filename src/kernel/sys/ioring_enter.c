@@ -0,0 +1,47 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/pm.h>
+#include <nanvix/syscall.h>
+#include <sys/ioring.h>
+#include <errno.h>
+
+/*
+ * Submits operations to and waits for completions on an asynchronous
+ * I/O ring.
+ */
+PUBLIC int sys_ioring_enter(unsigned to_submit, unsigned min_complete)
+{
+	unsigned n;
+	
+	/* No ring. */
+	if (curr_proc->ioring == NULL)
+		return (-ENXIO);
+	
+	/* Would never complete. */
+	if (min_complete > IORING_NR_CQES)
+		return (-EINVAL);
+	
+	n = ioring_submit(to_submit);
+	ioring_wait(min_complete);
+	
+	return (n);
+}
@@ -20,6 +20,7 @@
 #include <nanvix/const.h>
 #include <nanvix/dev.h>
 #include <nanvix/fs.h>
+#include <nanvix/region.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
@@ -171,7 +172,16 @@ PUBLIC struct inode *do_open(const char *path, int oflag, mode_t mode)
 	{
 		/* Truncate file. */
 		if (oflag & O_TRUNC)
+		{
+			/* Blocks are mapped in place. */
+			if (ismapped(i))
+			{
+				curr_proc->errno = -EBUSY;
+				goto error;
+			}
+			
 			inode_truncate(i);
+		}
 	}
 	
 	/* Directory. */
@@ -236,7 +246,7 @@ PUBLIC int sys_open(const char *path, int oflag, mode_t mode)
 	if ((i = do_open(name, oflag, mode)) == NULL)
 	{
 		putname(name);
-		f->count = 0;
+		putfile(f);
 		return (curr_proc->errno);
 	}
 	
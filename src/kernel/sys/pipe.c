@@ -38,20 +38,32 @@ PUBLIC int sys_pipe(int fildes[2])
 	/* Get empty file descriptors. */
 	if ((fd[0] = getfildes()) < 0)
 		return (-EMFILE);
-	if ((fd[1] = getfildes()) < 0)
+	for (fd[1] = fd[0] + 1; fd[1] < OPEN_MAX; fd[1]++)
+	{
+		if (curr_proc->ofiles[fd[1]] == NULL)
+			break;
+	}
+	if (fd[1] >= OPEN_MAX)
 		return (-EMFILE);
 	
 	/* Get empty files. */
 	if ((f[0] = getfile()) == NULL)
 		return (-ENFILE);
 	if ((f[1] = getfile()) == NULL)
+	{
+		putfile(f[0]);
 		return (-ENFILE);
+	}
 	
 	inode = inode_pipe();
 	
 	/* Failed to get pipe inode. */
 	if (inode == NULL)
+	{
+		putfile(f[1]);
+		putfile(f[0]);
 		return (-EAGAIN);
+	}
 	
 	/* Initialize files. */
 	f[0]->oflag = O_RDONLY;
@@ -0,0 +1,225 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/dev.h>
+#include <nanvix/fs.h>
+#include <nanvix/hal.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+
+/**
+ * @brief Sleeping chain of polling processes.
+ */
+PRIVATE struct process *selwait = NULL;
+
+/**
+ * @brief Selection generation.
+ *
+ * @details Bumped on every selwakeup(), so that a process that has
+ * scanned its files notices events that got in before it sleeps.
+ */
+PRIVATE volatile unsigned selgen = 0;
+
+/**
+ * @brief Records that the current process polls an object.
+ *
+ * @details If another process is already sleeping on the object, both
+ * are remembered as a collision, and all polling processes are awaken
+ * when the object becomes ready.
+ *
+ * @param sip Selection record of the object.
+ */
+PUBLIC void selrecord(struct selinfo *sip)
+{
+	struct process *p = sip->proc;
+
+	/* Already recorded. */
+	if (p == curr_proc)
+		return;
+
+	if ((p != NULL) && (p->state == PROC_WAITING) && (p->chain == &selwait))
+		sip->collision = 1;
+	else
+		sip->proc = curr_proc;
+}
+
+/**
+ * @brief Wakes up processes that poll an object.
+ *
+ * @param sip Selection record of the object.
+ */
+PUBLIC void selwakeup(struct selinfo *sip)
+{
+	struct process *p = sip->proc;
+
+	selgen++;
+
+	/* Many processes polling. */
+	if (sip->collision)
+	{
+		sip->collision = 0;
+		wakeup(&selwait);
+	}
+
+	if (p == NULL)
+		return;
+
+	sip->proc = NULL;
+
+	if ((p->state == PROC_WAITING) && (p->chain == &selwait))
+		unsleep(p);
+}
+
+/**
+ * @brief Polls a file descriptor.
+ *
+ * @param fd     File descriptor.
+ * @param events Events of interest.
+ *
+ * @returns The events that are ready.
+ */
+PRIVATE int fd_poll(int fd, int events)
+{
+	struct file *f;  /* File.  */
+	struct inode *i; /* Inode. */
+
+	/* Invalid file descriptor. */
+	if ((fd >= OPEN_MAX) || ((f = curr_proc->ofiles[fd]) == NULL))
+		return (POLLNVAL);
+
+	/* Only what the file is opened for. */
+	events &= POLLIN | POLLOUT;
+	if (ACCMODE(f->oflag) == O_RDONLY)
+		events &= ~POLLOUT;
+	else if (ACCMODE(f->oflag) == O_WRONLY)
+		events &= ~POLLIN;
+
+	i = f->inode;
+
+	/* Pipe file. */
+	if (S_ISFIFO(i->mode))
+		return (pipe_poll(i, events));
+
+	/* Character special file. */
+	if (S_ISCHR(i->mode))
+		return (cdev_poll(i->blocks[0], events));
+
+	/*
+	 * Regular files, directories and block
+	 * special files are always ready.
+	 */
+	return (events);
+}
+
+/**
+ * @brief Converts a timeout to clock ticks.
+ *
+ * @param timeout Timeout, in milliseconds.
+ *
+ * @returns The timeout in clock ticks, rounded up.
+ */
+PRIVATE unsigned poll_ticks(int timeout)
+{
+	return ((timeout/1000)*CLOCK_FREQ + ((timeout%1000)*CLOCK_FREQ + 999)/1000);
+}
+
+/**
+ * @brief Waits for events on file descriptors.
+ *
+ * @details Scans the file descriptors, and sleeps until an object that
+ * was found not ready wakes it up, the timeout expires or a signal is
+ * caught. Negative file descriptors are ignored.
+ *
+ * @param fds     File descriptors to poll.
+ * @param nfds    Number of file descriptors.
+ * @param timeout Timeout, in milliseconds, or a negative number to wait
+ *                indefinitely.
+ *
+ * @returns The number of file descriptors that are ready upon successful
+ * completion, a negative error code otherwise.
+ */
+PUBLIC int sys_poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+	int n;        /* Ready file descriptors. */
+	unsigned gen; /* Selection generation.   */
+
+	/* Too many file descriptors. */
+	if (nfds > OPEN_MAX)
+		return (-EINVAL);
+
+	/* Invalid buffer. */
+	if ((nfds > 0) && (!chkmem(fds, nfds*sizeof(struct pollfd), MAY_WRITE)))
+		return (-EFAULT);
+
+	if (timeout > 0)
+	{
+		curr_proc->timeout = ticks + poll_ticks(timeout);
+		sched_timer(curr_proc->timeout);
+	}
+
+	while (1)
+	{
+		gen = selgen;
+
+		n = 0;
+		for (nfds_t i = 0; i < nfds; i++)
+		{
+			fds[i].revents = (fds[i].fd < 0) ? 0 :
+				fd_poll(fds[i].fd, fds[i].events);
+
+			if (fds[i].revents)
+				n++;
+		}
+
+		/* Done. */
+		if ((n > 0) || (timeout == 0))
+			break;
+
+		/* Timed out. */
+		if ((timeout > 0) && ((!curr_proc->timeout) || (curr_proc->timeout < ticks)))
+			break;
+
+		/*
+		 * Interrupt handlers may wake us up in the
+		 * meantime, so check for that before sleeping.
+		 */
+		disable_interrupts();
+		if (gen == selgen)
+			sleep(&selwait, PRIO_TTY);
+		enable_interrupts();
+
+		/* Awaken by signal. */
+		if (issig() != SIGNULL)
+		{
+			n = -EINTR;
+			break;
+		}
+	}
+
+	curr_proc->timeout = 0;
+
+	return (n);
+}
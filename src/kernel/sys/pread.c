@@ -0,0 +1,72 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <errno.h>
+
+/*
+ * Reads from a file at a given offset.
+ */
+PUBLIC ssize_t sys_pread(int fd, void *buf, size_t n, off_t off)
+{
+	struct file *f;   /* File.                */
+	struct iovec iov; /* I/O vector.          */
+	ssize_t count;    /* Bytes actually read. */
+	
+	/* Invalid file descriptor. */
+	if ((fd < 0) || (fd >= OPEN_MAX) || ((f = curr_proc->ofiles[fd]) == NULL))
+		return (-EBADF);
+	
+	/* File not opened for reading. */
+	if (ACCMODE(f->oflag) == O_WRONLY)
+		return (-EBADF);
+	
+	/* File not seekable. */
+	if (S_ISCHR(f->inode->mode) || S_ISFIFO(f->inode->mode))
+		return (-ESPIPE);
+	
+	/* Invalid offset. */
+	if (off < 0)
+		return (-EINVAL);
+	
+	/* Invalid buffer. */
+	if (!chkuser(buf, n))
+		return (-EFAULT);
+	
+	/* Nothing to do. */
+	if (n == 0)
+		return (0);
+	
+	iov.iov_base = buf;
+	iov.iov_len = n;
+	
+	/* Failed to read. */
+	if ((count = do_read(f, &iov, 1, off)) < 0)
+		return (count);
+	
+	inode_touch(f->inode);
+	
+	return (count);
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <errno.h>
+
+/*
+ * Writes to a file at a given offset.
+ */
+PUBLIC ssize_t sys_pwrite(int fd, const void *buf, size_t n, off_t off)
+{
+	struct file *f;   /* File.                   */
+	struct iovec iov; /* I/O vector.             */
+	
+	/* Invalid file descriptor. */
+	if ((fd < 0) || (fd >= OPEN_MAX) || ((f = curr_proc->ofiles[fd]) == NULL))
+		return (-EBADF);
+	
+	/* File not opened for writing. */
+	if (ACCMODE(f->oflag) == O_RDONLY)
+		return (-EBADF);
+	
+	/* File not seekable. */
+	if (S_ISCHR(f->inode->mode) || S_ISFIFO(f->inode->mode))
+		return (-ESPIPE);
+	
+	/* Invalid offset. */
+	if (off < 0)
+		return (-EINVAL);
+	
+	/* Invalid buffer. */
+	if (!chkuser(buf, n))
+		return (-EFAULT);
+	
+	/* Nothing to do. */
+	if (n == 0)
+		return (0);
+	
+	iov.iov_base = (void *)buf;
+	iov.iov_len = n;
+	
+	return (do_write(f, &iov, 1, off));
+}
@@ -27,15 +27,79 @@
 #include <fcntl.h>
 #include <errno.h>
 
+
+/*
+ * Reads from a file into a vector of buffers.
+ */
+PUBLIC ssize_t do_read(struct file *f, const struct iovec *iov, int iovcnt, off_t off)
+{
+	dev_t dev;         /* Device number.        */
+	struct inode *i;   /* Inode.                */
+	ssize_t count;     /* Bytes read in a step. */
+	ssize_t total = 0; /* Total bytes read.     */
+	
+	i = f->inode;
+	
+	/* Regular file. */
+	if (S_ISREG(i->mode))
+	{
+		count = file_readv(i, iov, iovcnt, off);
+		return ((count < 0) ? curr_proc->errno : count);
+	}
+	
+	dev = i->blocks[0];
+	
+	for (int j = 0; j < iovcnt; j++)
+	{
+		if (iov[j].iov_len == 0)
+			continue;
+		
+		/* Character special file. */
+		if (S_ISCHR(i->mode))
+			count = cdev_read(dev, iov[j].iov_base, iov[j].iov_len);
+		
+		/* Block special file. */
+		else if (S_ISBLK(i->mode))
+			count = bdev_read(dev, iov[j].iov_base, iov[j].iov_len, off + total);
+		
+		/* Pipe file. */
+		else if (S_ISFIFO(i->mode))
+			count = pipe_read(i, iov[j].iov_base, iov[j].iov_len);
+		
+		/* Regular directory. */
+		else if (S_ISDIR(i->mode))
+			count = dir_read(i, iov[j].iov_base, iov[j].iov_len, off + total);
+		
+		/* Unknown file type. */
+		else
+			return (-EINVAL);
+		
+		/* Failed to read. */
+		if (count < 0)
+			return ((total > 0) ? total : curr_proc->errno);
+		
+		total += count;
+		
+		/* Short read. */
+		if ((size_t)count < iov[j].iov_len)
+			break;
+		
+		/* Do not block on streams once some data came in. */
+		if ((count > 0) && (S_ISCHR(i->mode) || S_ISFIFO(i->mode)))
+			break;
+	}
+	
+	return (total);
+}
+
 /*
  * Reads from a file.
  */
 PUBLIC ssize_t sys_read(int fd, void *buf, size_t n)
 {
-	dev_t dev;       /* Device number.       */
-	struct file *f;  /* File.                */
-	struct inode *i; /* Inode.               */
-	ssize_t count;   /* Bytes actually read. */
+	struct file *f;    /* File.                */
+	struct iovec iov;  /* I/O vector.          */
+	ssize_t count;     /* Bytes actually read. */
 	
 	/* Invalid file descriptor. */
 	if ((fd < 0) || (fd >= OPEN_MAX) || ((f = curr_proc->ofiles[fd]) == NULL))
@@ -48,8 +112,8 @@ PUBLIC ssize_t sys_read(int fd, void *buf, size_t n)
 #if (EDUCATIONAL_KERNEL == 0)
 	
 	/* Invalid buffer. */	
-	if (!chkmem(buf, n, MAY_WRITE))
-		return (-EINVAL);
+	if (!chkuser(buf, n))
+		return (-EFAULT);
 
 #endif
 
@@ -57,47 +121,18 @@ PUBLIC ssize_t sys_read(int fd, void *buf, size_t n)
 	if (n == 0)
 		return (0);
 	
-	 i = f->inode;
+	iov.iov_base = buf;
+	iov.iov_len = n;
 	
-	/* Character special file. */
-	if (S_ISCHR(i->mode))
-	{		
-		dev = i->blocks[0];
-		count = cdev_read(dev, buf, n);
+	/* Failed to read. */
+	if ((count = do_read(f, &iov, 1, f->pos)) < 0)
 		return (count);
-	}
-	
-	/* Block special file. */
-	else if (S_ISBLK(i->mode))
-	{
-		dev = i->blocks[0];
-		count = bdev_read(dev, buf, n, f->pos);
-	}
 	
-	/* Pipe file. */
-	else if (S_ISFIFO(i->mode))
-	{
-		kprintf("read from pipe");
-		count = pipe_read(i, buf, n);
-	}
-	
-	/* Regular file. */
-	else if (S_ISREG(i->mode))
-		count = file_read(i, buf, n, f->pos);
-
-	/* Regular directory. */
-	else if (S_ISDIR(i->mode))
-		count = dir_read(i,buf,n,f->pos);
-	
-	/* Unknown file type. */
-	else
-		return (-EINVAL);
+	/* Character special files have no position. */
+	if (S_ISCHR(f->inode->mode))
+		return (count);
 	
-	/* Failed to read. */
-	if (count < 0)
-		return (curr_proc->errno);
-
-	inode_touch(i);
+	inode_touch(f->inode);
 	f->pos += count;
 
 	return (count);
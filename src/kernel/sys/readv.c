@@ -0,0 +1,60 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/pm.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <errno.h>
+
+/*
+ * Reads from a file into a vector of buffers.
+ */
+PUBLIC ssize_t sys_readv(int fd, const struct iovec *iov, int iovcnt)
+{
+	struct file *f; /* File.                */
+	ssize_t count;  /* Bytes actually read. */
+	
+	/* Invalid file descriptor. */
+	if ((fd < 0) || (fd >= OPEN_MAX) || ((f = curr_proc->ofiles[fd]) == NULL))
+		return (-EBADF);
+	
+	/* File not opened for reading. */
+	if (ACCMODE(f->oflag) == O_WRONLY)
+		return (-EBADF);
+	
+	/* Invalid vector. */
+	if ((count = chkiov(iov, iovcnt)) <= 0)
+		return (count);
+	
+	/* Failed to read. */
+	if ((count = do_read(f, iov, iovcnt, f->pos)) < 0)
+		return (count);
+	
+	/* Character special files have no position. */
+	if (S_ISCHR(f->inode->mode))
+		return (count);
+	
+	inode_touch(f->inode);
+	f->pos += count;
+	
+	return (count);
+}
@@ -1,8 +1,185 @@
 #include <sys/sem.h>
+#include <sys/stat.h>
 #include <nanvix/klib.h>
 #include <nanvix/mm.h>
+#include <nanvix/region.h>
 #include <limits.h>
 #include <nanvix/fs.h>
+#include <errno.h>
+
+/* Semaphore values, as seen by the kernel */
+PUBLIC struct usem *semvals = NULL;
+
+/* Shared memory region where semaphore values live */
+PRIVATE struct region *semreg = NULL;
+
+/**
+ *	@brief Atomically compares and swaps a semaphore word
+ *
+ *	@returns The previous value of the word
+ */
+PRIVATE inline int sem_cmpxchg(volatile int *p, int old, int new)
+{
+#ifdef i386
+	__asm__ __volatile__ (
+		"lock; cmpxchgl %2, %1"
+		: "+a" (old), "+m" (*p)
+		: "r" (new)
+		: "memory"
+	);
+
+	return (old);
+#else
+	int prev = *p;
+
+	if (prev == old)
+		*p = new;
+
+	return (prev);
+#endif
+}
+
+/**
+ *	@brief Atomically adds to a semaphore word
+ */
+PRIVATE inline void sem_add(volatile int *p, int v)
+{
+	int old;
+
+	do
+		old = *p;
+	while (sem_cmpxchg(p, old, old + v) != old);
+}
+
+/**
+ *	@brief Checks if semaphore values are mapped in the current process
+ *
+ *	@returns Non-zero if so, zero otherwise
+ */
+int sem_attached(void)
+{
+	struct pregion *preg;
+
+	preg = findreg(curr_proc, SEM_ADDR);
+
+	return ((preg != NULL) && (semreg != NULL) && (preg->reg == semreg));
+}
+
+/**
+ *	@brief Maps semaphore values in the current process
+ *
+ *	@details Semaphore values live in a kernel page, which is
+ *			 shared with user space through a sticky region.
+ *			 Processes may then operate semaphores without
+ *			 entering the kernel, unless they have to sleep.
+ *			 Only processes that pass the permission checks
+ *			 of sem_open() get the page mapped.
+ *
+ *	@returns 0 upon successful completion,
+ *			 a negative error code otherwise
+ */
+int sem_attach(void)
+{
+	struct pregion *preg;
+
+	/* First semaphore ever. */
+	if (semreg == NULL)
+	{
+		if ((semvals = getkpg(1)) == NULL)
+			return (-ENOMEM);
+
+		semreg = kpgreg(semvals,
+			S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH,
+			REGION_SHARED | REGION_STICKY);
+
+		if (semreg == NULL)
+		{
+			putkpg(semvals);
+			semvals = NULL;
+			return (-ENOMEM);
+		}
+
+		unlockreg(semreg);
+	}
+
+	/* Already attached. */
+	if (sem_attached())
+		return (0);
+
+	/* Look for a free process region. */
+	for (preg = DATA(curr_proc); preg < &curr_proc->pregs[NR_PREGIONS]; preg++)
+	{
+		if (preg->reg == NULL)
+			goto found;
+	}
+
+	return (-ENOMEM);
+
+found:
+
+	lockreg(semreg);
+
+	if (attachreg(curr_proc, preg, SEM_ADDR, semreg))
+	{
+		unlockreg(semreg);
+		return (-ENOMEM);
+	}
+
+	unlockreg(semreg);
+
+	return (0);
+}
+
+/**
+ *	@brief Consumes a resource, sleeping if needed
+ *
+ *	@details Sleeps on the same futex as user space does.
+ *
+ *	@returns 0 upon successful completion,
+ *			 -EINTR if awaken by a signal
+ */
+int sem_down(int idx)
+{
+	int v, ret;
+	struct usem *s = &semvals[idx];
+
+	while (1)
+	{
+		v = s->value;
+
+		/* Consume a resource. */
+		if (v > 0)
+		{
+			if (sem_cmpxchg(&s->value, v, v - 1) == v)
+				break;
+			continue;
+		}
+
+		/* Sleep until someone posts. */
+		sem_add(&s->waiters, 1);
+		ret = (s->value == v) ? futex_sleep(semreg, idx*sizeof(struct usem)) : 0;
+		sem_add(&s->waiters, -1);
+
+		if (ret < 0)
+			return (ret);
+	}
+
+	return (0);
+}
+
+/**
+ *	@brief Releases a resource
+ */
+void sem_up(int idx)
+{
+	struct usem *s = &semvals[idx];
+
+	sem_add(&s->value, 1);
+
+	/* Contended. */
+	if (s->waiters > 0)
+		futex_wakeup(semreg, idx*sizeof(struct usem), 1);
+}
 
 /**
  *	@brief Make a semaphore slot available for
@@ -17,9 +194,6 @@ void freesem(struct ksem *sem)
 
 	for (int i = 0; i<PROC_MAX; i++)
 		sem->currprocs[i] = -1;
-
-	for (int i = 0; i<PROC_MAX; i++)
-		sem->semwaiters[i] = NULL;
 }
 
 /**
@@ -12,7 +12,8 @@
 int add_table(int value, const char* semname, int idx, struct inode* seminode)
 {
 	sem_path(semname, semtable[idx].name);
-	semtable[idx].value = value;
+	semvals[idx].value = value;
+	semvals[idx].waiters = 0;
 	semtable[idx].currprocs[0] = curr_proc->pid;
 	semtable[idx].num = seminode->num;
 	semtable[idx].dev = seminode->dev;
@@ -74,6 +75,10 @@ PUBLIC int sys_semopen(const char* name, int oflag, mode_t mode, int value)
 			if (semid < 0) 
 				return (-ENFILE);
 
+			/* Map semaphore values. */
+			if ((i = sem_attach()) < 0)
+				return (i);
+
 			/* Creates the inode */
 			if (!(inode = inode_semaphore(name, mode)))
 			{
@@ -107,6 +112,14 @@ PUBLIC int sys_semopen(const char* name, int oflag, mode_t mode, int value)
 			return (-EACCES);
 		}
 
+		/* Map semaphore values. */
+		if ((i = sem_attach()) < 0)
+		{
+			inode_put(inode);
+			inode_unlock(inode);
+			return (i);
+		}
+
 		for (i = 0; i < PROC_MAX; i++)
 		{
 			/* 	
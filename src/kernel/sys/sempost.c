@@ -13,35 +13,18 @@
  */
 PUBLIC int sys_sempost(int idx)
 {
-	struct inode *seminode;
-	int i;
-
 	if (!SEM_IS_VALID(idx))
 		return (-EINVAL);
 
-	for (i = 0; i < PROC_MAX; i++)
-	{
-		/* Removing the proc pid in the semaphore procs table */
-		if (semtable[idx].currprocs[i] == curr_proc->pid)
-			break;
-	}
-
-	/* Semaphore not opened by the process */
-	if (i == PROC_MAX)
-		return (-1);
-
-	seminode = inode_get(semtable[idx].dev, semtable[idx].num);
-
-	if (seminode == NULL)
+	/* Semaphore not in use */
+	if ((semtable[idx].num == 0) || (semvals == NULL))
 		return (-EINVAL);
 
-	semtable[idx].value++;
-	
-	if (semtable[idx].value == 1)
-		wakeup(semtable[idx].semwaiters);
+	/* No semaphore opened by the process */
+	if (!sem_attached())
+		return (-EINVAL);
 
-	inode_put(seminode);
-	inode_unlock(seminode);
+	sem_up(idx);
 
 	return (0);
 }
@@ -16,43 +16,16 @@
  */
 PUBLIC int sys_semwait(int idx)
 {
-	struct inode *seminode;
-	int i;
-	
 	if (!SEM_IS_VALID(idx))
 		return (-EINVAL);
 
-	for (i = 0; i < PROC_MAX; i++)
-	{
-		if (semtable[idx].currprocs[i] == curr_proc->pid)
-			break;
-	}
-
-	/* Semaphore not opened by the process */
-	if (i == PROC_MAX)
+	/* Semaphore not in use */
+	if ((semtable[idx].num == 0) || (semvals == NULL))
 		return (-EINVAL);
 
-	seminode = inode_get(semtable[idx].dev, semtable[idx].num);
-
-	if (seminode == NULL)
+	/* No semaphore opened by the process */
+	if (!sem_attached())
 		return (-EINVAL);
 
-	inode_unlock(seminode);
-
-	while (semtable[idx].value <= 0)
-	{
-		sleep(semtable[idx].semwaiters,curr_proc->priority);
-		
-		/* Awaken by a signal. */
-		if (issig())
-		{
-			inode_put(seminode);
-			return (-EINTR);
-		}
-	}
-
-	semtable[idx].value--;
-	inode_put(seminode);
-
-	return (0);
-}
\ No newline at end of file
+	return (sem_down(idx));
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <errno.h>
+
+/*
+ * Computes how much of a file block may be sent at once.
+ */
+PRIVATE size_t sendfile_chunk(struct inode *i, off_t off, size_t n)
+{
+	size_t chunk; /* Data chunk size. */
+	
+	chunk = BLOCK_SIZE - (off % BLOCK_SIZE);
+	
+	if (chunk > n)
+		chunk = n;
+	if ((off_t)chunk > i->size - off)
+		chunk = i->size - off;
+	
+	return (chunk);
+}
+
+/*
+ * Gathers file blocks into a bounce page. Files that are not kept in
+ * block buffers are read straight into the page.
+ */
+PRIVATE size_t sendfile_gather(struct inode *i, off_t off, char *page, size_t n)
+{
+	ssize_t count;      /* Bytes read.           */
+	size_t len;         /* Bytes gathered.       */
+	size_t chunk;       /* Data chunk size.      */
+	struct buffer *buf; /* Working block buffer. */
+	
+	if (i->i_op->file_bread == NULL)
+	{
+		count = file_read(i, page, n, off);
+		return ((count > 0) ? (size_t)count : 0);
+	}
+	
+	for (len = 0; (len < n) && (off < i->size); len += chunk, off += chunk)
+	{
+		/* End of file reached. */
+		if ((buf = file_bread(i, off)) == NULL)
+			break;
+		
+		chunk = sendfile_chunk(i, off, n - len);
+		kmemcpy(page + len, (char *)buffer_data(buf) + (off % BLOCK_SIZE), chunk);
+		brelse(buf);
+	}
+	
+	return (len);
+}
+
+/*
+ * Copies data from a regular file to another file.
+ */
+PUBLIC ssize_t sys_sendfile(int out_fd, int in_fd, off_t *offset, size_t count)
+{
+	struct file *in;    /* Input file.           */
+	struct file *out;   /* Output file.          */
+	struct inode *i;    /* Input inode.          */
+	struct buffer *buf; /* Working block buffer. */
+	struct iovec iov;   /* I/O vector.           */
+	char *page = NULL;  /* Bounce page.          */
+	off_t off;          /* Input offset.         */
+	ssize_t n;          /* Bytes written.        */
+	ssize_t total = 0;  /* Bytes copied.         */
+	
+	/* Invalid input file descriptor. */
+	if ((in_fd < 0) || (in_fd >= OPEN_MAX) || ((in = curr_proc->ofiles[in_fd]) == NULL))
+		return (-EBADF);
+	
+	/* Invalid output file descriptor. */
+	if ((out_fd < 0) || (out_fd >= OPEN_MAX) || ((out = curr_proc->ofiles[out_fd]) == NULL))
+		return (-EBADF);
+	
+	/* Files not opened for reading/writing. */
+	if ((ACCMODE(in->oflag) == O_WRONLY) || (ACCMODE(out->oflag) == O_RDONLY))
+		return (-EBADF);
+	
+	i = in->inode;
+	
+	/* Only regular files can be sent, and not onto themselves. */
+	if ((!S_ISREG(i->mode)) || (out->inode == i))
+		return (-EINVAL);
+	
+	/* File size is unknown, so let the caller read it. */
+	if (!file_sized(i))
+		return (-EINVAL);
+	
+	/* Get input offset. */
+	if (offset != NULL)
+	{
+		if (!chkuser(offset, sizeof(off_t)))
+			return (-EFAULT);
+		if (copy_from_user(&off, offset, sizeof(off_t)))
+			return (-EFAULT);
+		if (off < 0)
+			return (-EINVAL);
+	}
+	else
+		off = in->pos;
+	
+	/*
+	 * Writing to pipes and terminals may sleep for long,
+	 * so do not hold cache blocks meanwhile.
+	 */
+	if (S_ISCHR(out->inode->mode) || S_ISFIFO(out->inode->mode) ||
+		(i->i_op->file_bread == NULL))
+	{
+		if ((page = getkpg(0)) == NULL)
+			return (-ENOMEM);
+	}
+	
+	/* Append mode. */
+	if (out->oflag & O_APPEND)
+		out->pos = out->inode->size;
+	
+	while ((count > 0) && (off < i->size))
+	{
+		buf = NULL;
+		
+		/* Go through the bounce page. */
+		if (page != NULL)
+		{
+			iov.iov_base = page;
+			iov.iov_len = sendfile_gather(i, off, page,
+				(count < PAGE_SIZE) ? count : PAGE_SIZE);
+		}
+		
+		/* Write straight from the block buffer. */
+		else
+		{
+			/* End of file reached. */
+			if ((buf = file_bread(i, off)) == NULL)
+				break;
+			
+			iov.iov_base = (char *)buffer_data(buf) + (off % BLOCK_SIZE);
+			iov.iov_len = sendfile_chunk(i, off, count);
+		}
+		
+		/* End of file reached. */
+		if (iov.iov_len == 0)
+			break;
+		
+		n = do_write(out, &iov, 1, out->pos);
+		
+		if (buf != NULL)
+			brelse(buf);
+		
+		/* Failed to write. */
+		if (n < 0)
+		{
+			if (total == 0)
+				total = n;
+			break;
+		}
+		
+		total += n;
+		off += n;
+		count -= n;
+		
+		/* Character special files have no position. */
+		if (!S_ISCHR(out->inode->mode))
+			out->pos += n;
+		
+		/* Short write. */
+		if ((size_t)n < iov.iov_len)
+			break;
+	}
+	
+	if (page != NULL)
+		putkpg(page);
+	
+	/* Update input offset. */
+	if (offset != NULL)
+	{
+		if (copy_to_user(offset, &off, sizeof(off_t)))
+			total = -EFAULT;
+	}
+	else
+		in->pos = off;
+	
+	inode_touch(i);
+	
+	return (total);
+}
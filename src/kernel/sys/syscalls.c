@@ -85,5 +85,16 @@ PUBLIC void (*syscalls_table[NR_SYSCALLS])(void)  = {
 	(void (*)(void))&sys_semwait,
 	(void (*)(void))&sys_sempost,
 	(void (*)(void))&sys_acct,
-	(void (*)(void))&sys_rmdir
+	(void (*)(void))&sys_rmdir,
+	(void (*)(void))&sys_sched_yield,
+	(void (*)(void))&sys_futex,
+	(void (*)(void))&sys_readv,
+	(void (*)(void))&sys_writev,
+	(void (*)(void))&sys_pread,
+	(void (*)(void))&sys_pwrite,
+	(void (*)(void))&sys_sendfile,
+	(void (*)(void))&sys_ioring_setup,
+	(void (*)(void))&sys_ioring_enter,
+	(void (*)(void))&sys_clock_gettime,
+	(void (*)(void))&sys_poll
 };
@@ -26,16 +26,71 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
-#include <nanvix/klib.h>
+
+/*
+ * Writes to a file from a vector of buffers.
+ */
+PUBLIC ssize_t do_write(struct file *f, const struct iovec *iov, int iovcnt, off_t off)
+{
+	dev_t dev;         /* Device number.           */
+	struct inode *i;   /* Inode.                   */
+	ssize_t count;     /* Bytes written in a step. */
+	ssize_t total = 0; /* Total bytes written.     */
+	
+	i = f->inode;
+	
+	/* Regular file. */
+	if (S_ISREG(i->mode))
+	{
+		count = file_writev(i, iov, iovcnt, off);
+		return ((count < 0) ? curr_proc->errno : count);
+	}
+	
+	/* Nothing to write to. */
+	if (!(S_ISCHR(i->mode) || S_ISBLK(i->mode) || S_ISFIFO(i->mode)))
+		return (0);
+	
+	dev = i->blocks[0];
+	
+	for (int j = 0; j < iovcnt; j++)
+	{
+		if (iov[j].iov_len == 0)
+			continue;
+		
+		/* Character special file. */
+		if (S_ISCHR(i->mode))
+			count = cdev_write(dev, iov[j].iov_base, iov[j].iov_len);
+		
+		/* Block special file. */
+		else if (S_ISBLK(i->mode))
+			count = bdev_write(dev, iov[j].iov_base, iov[j].iov_len, off + total);
+		
+		/* Pipe file. */
+		else
+			count = pipe_write(i, iov[j].iov_base, iov[j].iov_len);
+		
+		/* Failed to write. */
+		if (count < 0)
+			return ((total > 0) ? total : curr_proc->errno);
+		
+		total += count;
+		
+		/* Short write. */
+		if ((size_t)count < iov[j].iov_len)
+			break;
+	}
+	
+	return (total);
+}
+
 /*
  * Writes to a file.
  */
 PUBLIC ssize_t sys_write(int fd, const void *buf, size_t n)
 {
-	dev_t dev;         /* Device number.          */
 	struct file *f;    /* File.                   */
-	struct inode *i;   /* Inode.                  */
-	ssize_t count = 0; /* Bytes actually written. */
+	struct iovec iov;  /* I/O vector.             */
+	ssize_t count;     /* Bytes actually written. */
 	
 	/* Invalid file descriptor. */
 	if ((fd < 0) || (fd >= OPEN_MAX) || ((f = curr_proc->ofiles[fd]) == NULL))
@@ -46,48 +101,27 @@ PUBLIC ssize_t sys_write(int fd, const void *buf, size_t n)
 		return (-EBADF);
 	
 	/* Invalid buffer. */
-	if (!chkmem(buf, n, MAY_READ))
-		return (-EINVAL);
+	if (!chkuser(buf, n))
+		return (-EFAULT);
 
 	/* Nothing to do. */
 	if (n == 0)
 		return (0);
-
-	i = f->inode;
 	
 	/* Append mode. */
 	if (f->oflag & O_APPEND)
-		f->pos = i->size;
-	
-	/* Character special file. */
-	if (S_ISCHR(i->mode))
-	{
-		dev = i->blocks[0];
-		count = cdev_write(dev, buf, n);
-		return (count);
-	}
-	
-	/* Block special file. */
-	else if (S_ISBLK(i->mode))
-	{
-		dev = i->blocks[0];
-		count = bdev_write(dev, buf, n, f->pos);
-	}
+		f->pos = f->inode->size;
 	
-	/* Pipe file. */
-	else if (S_ISFIFO(i->mode))
-	{
-		kprintf("write to pipe");
-		count = pipe_write(i, buf, n);
-	}
+	iov.iov_base = (void *)buf;
+	iov.iov_len = n;
 	
-	/* Regular file. */
-	else if (S_ISREG(i->mode))
-		count = file_write(i, buf, n, f->pos);
-
 	/* Failed to write. */
-	if (count < 0)
-		return (curr_proc->errno);
+	if ((count = do_write(f, &iov, 1, f->pos)) < 0)
+		return (count);
+	
+	/* Character special files have no position. */
+	if (S_ISCHR(f->inode->mode))
+		return (count);
 	
 	f->pos += count;
 	
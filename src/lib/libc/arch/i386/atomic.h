@@ -0,0 +1,84 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ATOMIC_H_
+#define ATOMIC_H_
+
+	/**
+	 * @brief Atomically compares and swaps a word.
+	 *
+	 * @param p   Target word.
+	 * @param old Expected value.
+	 * @param new New value.
+	 *
+	 * @returns The previous value of the word.
+	 */
+	static inline int atomic_cas(volatile int *p, int old, int new)
+	{
+		__asm__ volatile (
+			"lock; cmpxchgl %2, %1"
+			: "+a" (old), "+m" (*p)
+			: "r" (new)
+			: "memory"
+		);
+
+		return (old);
+	}
+
+	/**
+	 * @brief Atomically adds to a word.
+	 *
+	 * @param p Target word.
+	 * @param v Value to add.
+	 *
+	 * @returns The previous value of the word.
+	 */
+	static inline int atomic_add(volatile int *p, int v)
+	{
+		__asm__ volatile (
+			"lock; xaddl %0, %1"
+			: "+r" (v), "+m" (*p)
+			:
+			: "memory"
+		);
+
+		return (v);
+	}
+
+	/**
+	 * @brief Atomically exchanges a word.
+	 *
+	 * @param p Target word.
+	 * @param v New value.
+	 *
+	 * @returns The previous value of the word.
+	 */
+	static inline int atomic_xchg(volatile int *p, int v)
+	{
+		__asm__ volatile (
+			"xchgl %0, %1"
+			: "+r" (v), "+m" (*p)
+			:
+			: "memory"
+		);
+
+		return (v);
+	}
+
+#endif /* ATOMIC_H_ */
@@ -0,0 +1,71 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nanvix/syscall.h>
+#include <sys/timepage.h>
+#include <errno.h>
+#include <reent.h>
+#include <time.h>
+
+/*
+ * Gets the time of a clock.
+ *
+ * The monotonic and real time clocks are read from the time page,
+ * without entering the kernel.
+ */
+int clock_gettime(clockid_t clock_id, struct timespec *tp)
+{
+	const volatile struct timepage *page;
+	unsigned boot;
+	int ret;
+	
+	page = (const volatile struct timepage *)TIMEPAGE_ADDR;
+	
+	switch (clock_id)
+	{
+		case CLOCK_MONOTONIC:
+			timepage_read(page, tp, NULL);
+			return (0);
+		
+		case CLOCK_REALTIME:
+			timepage_read(page, tp, &boot);
+			tp->tv_sec += boot;
+			return (0);
+	}
+	
+	/* Let the kernel deal with other clocks. */
+	__asm__ volatile (
+		"int $0x80"
+		: "=a" (ret)
+		: "0" (NR_clock_gettime),
+		  "b" (clock_id),
+		  "c" (tp)
+		: "memory"
+	);
+	
+	/* Error. */
+	if (ret < 0)
+	{
+		errno = -ret;
+		_REENT->_errno = -ret;
+		return (-1);
+	}
+	
+	return (ret);
+}
@@ -17,10 +17,8 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <nanvix/syscall.h>
 #include <sys/time.h>
-#include <errno.h>
-#include <reent.h>
+#include <time.h>
 
 /*
  * @brief Get the time expressed as seconds and microseconds since
@@ -33,30 +31,18 @@
  */
 int gettimeofday(struct timeval *tp, void *tzp)
 {
-	int ret;
+	struct timespec ts;
 
 	/* Timezone obsolete, should be NULL. */
 	if (tzp)
 		return (-1);
 
-	/* Use the time() to get the seconds. */
-	__asm__ volatile (
-		"int $0x80"
-		: "=a" (ret)
-		: "0" (NR_time),
-		  "b" (NULL)
-	);
-
-	/* Error. */
-	if (ret < 0)
-	{
-		errno = -ret;
-		_REENT->_errno = -ret;
+	/* Read from the time page. */
+	if (clock_gettime(CLOCK_REALTIME, &ts) < 0)
 		return (-1);
-	}
 	
-	tp->tv_usec = 0;
-	tp->tv_sec  = ret;
+	tp->tv_usec = ts.tv_nsec/1000;
+	tp->tv_sec  = ts.tv_sec;
 
 	return (0);
 }
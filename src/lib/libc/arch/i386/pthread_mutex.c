@@ -0,0 +1,142 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * libc is built without _POSIX_THREADS, so that stdio does not call
+ * into thread cancellation, but mutex types are only declared with it.
+ */
+#define _POSIX_THREADS 1
+
+#include <sys/futex.h>
+#include <errno.h>
+#include <pthread.h>
+#include "atomic.h"
+
+/*
+ * Mutex states. A statically initialized mutex
+ * is unlocked too, until it is first locked.
+ */
+#define MUTEX_UNLOCKED   0 /* Unlocked.                 */
+#define MUTEX_LOCKED     1 /* Locked, no waiters.       */
+#define MUTEX_CONTENDED  2 /* Locked, maybe waiters.    */
+
+/*
+ * Initializes a mutex.
+ */
+int pthread_mutex_init(pthread_mutex_t *mutex, const pthread_mutexattr_t *attr)
+{
+	((void) attr);
+	
+	if (mutex == NULL)
+		return (EINVAL);
+	
+	*mutex = MUTEX_UNLOCKED;
+	
+	return (0);
+}
+
+/*
+ * Destroys a mutex.
+ */
+int pthread_mutex_destroy(pthread_mutex_t *mutex)
+{
+	if (mutex == NULL)
+		return (EINVAL);
+	
+	/* Still locked. */
+	if ((*mutex != MUTEX_UNLOCKED) && (*mutex != PTHREAD_MUTEX_INITIALIZER))
+		return (EBUSY);
+	
+	return (0);
+}
+
+/*
+ * Attempts to lock a mutex.
+ */
+int pthread_mutex_trylock(pthread_mutex_t *mutex)
+{
+	volatile int *m = (volatile int *)mutex;
+	
+	if (mutex == NULL)
+		return (EINVAL);
+	
+	/* Statically initialized. */
+	if (*mutex == PTHREAD_MUTEX_INITIALIZER)
+		atomic_cas(m, (int)PTHREAD_MUTEX_INITIALIZER, MUTEX_UNLOCKED);
+	
+	if (atomic_cas(m, MUTEX_UNLOCKED, MUTEX_LOCKED) != MUTEX_UNLOCKED)
+		return (EBUSY);
+	
+	return (0);
+}
+
+/*
+ * Locks a mutex.
+ *
+ * The uncontended case takes a single atomic operation. Once there is
+ * contention the mutex is flagged, so that the owner knows it should
+ * enter the kernel to wake up a waiter on unlock.
+ */
+int pthread_mutex_lock(pthread_mutex_t *mutex)
+{
+	int c;
+	volatile int *m = (volatile int *)mutex;
+	
+	if (mutex == NULL)
+		return (EINVAL);
+	
+	/* Statically initialized. */
+	if (*mutex == PTHREAD_MUTEX_INITIALIZER)
+		atomic_cas(m, (int)PTHREAD_MUTEX_INITIALIZER, MUTEX_UNLOCKED);
+	
+	/* Fast path. */
+	if ((c = atomic_cas(m, MUTEX_UNLOCKED, MUTEX_LOCKED)) == MUTEX_UNLOCKED)
+		return (0);
+	
+	/* Slow path. */
+	if (c != MUTEX_CONTENDED)
+		c = atomic_xchg(m, MUTEX_CONTENDED);
+	while (c != MUTEX_UNLOCKED)
+	{
+		futex((int *)m, FUTEX_WAIT, MUTEX_CONTENDED);
+		c = atomic_xchg(m, MUTEX_CONTENDED);
+	}
+	
+	return (0);
+}
+
+/*
+ * Unlocks a mutex.
+ */
+int pthread_mutex_unlock(pthread_mutex_t *mutex)
+{
+	volatile int *m = (volatile int *)mutex;
+	
+	if (mutex == NULL)
+		return (EINVAL);
+	
+	/* Someone may be waiting. */
+	if (atomic_add(m, -1) != MUTEX_LOCKED)
+	{
+		*m = MUTEX_UNLOCKED;
+		futex((int *)m, FUTEX_WAKE, 1);
+	}
+	
+	return (0);
+}
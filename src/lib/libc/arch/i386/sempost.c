@@ -1,6 +1,8 @@
 #include <nanvix/syscall.h>
-#include <stdlib.h>
+#include <sys/futex.h>
+#include <sys/sem.h>
 #include <errno.h>
+#include "atomic.h"
 
 /**
  *	@brief Post action : increments semaphore value
@@ -14,30 +16,24 @@
  */
 int sem_post(sem_t* sem)
 {	
-	int ret, i;
+	struct usem *s;
 
 	if (sem == NULL)
 		return (-1);
 
-	for (i = 0; i < OPEN_MAX; i++)
-		if (usem[i] == sem)
-			break;
+	if ((sem->semid < 0) || (sem->semid >= SEM_OPEN_MAX))
+		return (-1);
 
-	if (i == OPEN_MAX)
+	if (usem[sem->semid] != sem)
 		return (-1);
 
-	__asm__ volatile (
-		"int $0x80"
-		: "=a" (ret)
-		: "0" (NR_sempost),
-		  "b" (sem->semid)
-	);
+	s = SEM_USEM(sem->semid);
 
-	if (ret < 0)
-	{
-		errno = ret;
-		return (-1);
-	}
+	atomic_add(&s->value, 1);
+
+	/* Contended. */
+	if (s->waiters > 0)
+		futex((int *)&s->value, FUTEX_WAKE, 1);
 
 	return (0);
-}
\ No newline at end of file
+}
@@ -1,9 +1,15 @@
 #include <nanvix/syscall.h>
+#include <sys/futex.h>
+#include <sys/sem.h>
 #include <errno.h>
+#include "atomic.h"
 
 /**
  * @brief Wait action : consume a ressource if available
  						sleeps otherwise.
+ *
+ * @details The semaphore value lives in memory that is shared among
+ *          all processes, so the kernel is entered only to sleep.
  *		 
  * @param sem Semaphore's address
  *
@@ -13,30 +19,41 @@
  */
 int sem_wait(sem_t *sem)
 {	
-	int ret, i;
+	int v;
+	struct usem *s;
 
 	if (sem == NULL)
 		return (-1);
 
-	for (i = 0; i < OPEN_MAX; i++)
-		if (usem[i] == sem)
-			break;
+	if ((sem->semid < 0) || (sem->semid >= SEM_OPEN_MAX))
+		return (-1);
 
-	if (i == OPEN_MAX)
+	if (usem[sem->semid] != sem)
 		return (-1);
 
-	__asm__ volatile (
-		"int $0x80"
-		: "=a" (ret)
-		: "0" (NR_semwait),
-		  "b" (sem->semid)
-	);
+	s = SEM_USEM(sem->semid);
 
-	if (ret < 0)
+	while (1)
 	{
-		errno = ret;
-		return (-1);
+		v = s->value;
+
+		/* Consume a resource. */
+		if (v > 0)
+		{
+			if (atomic_cas(&s->value, v, v - 1) == v)
+				break;
+			continue;
+		}
+
+		/* Sleep until someone posts. */
+		atomic_add(&s->waiters, 1);
+		v = futex((int *)&s->value, FUTEX_WAIT, v);
+		atomic_add(&s->waiters, -1);
+
+		/* Awaken by a signal. */
+		if ((v < 0) && (errno == EINTR))
+			return (-1);
 	}
 
 	return (0);
-}
\ No newline at end of file
+}
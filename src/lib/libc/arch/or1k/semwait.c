@@ -41,11 +41,11 @@ int sem_wait(sem_t *sem)
 	if (sem == NULL)
 		return (-1);
 
-	for (i = 0; i < OPEN_MAX; i++)
+	for (i = 0; i < SEM_OPEN_MAX; i++)
 		if (usem[i] == sem)
 			break;
 
-	if (i == OPEN_MAX)
+	if (i == SEM_OPEN_MAX)
 		return (-1);
 
 	register unsigned r3
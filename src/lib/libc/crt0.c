@@ -27,7 +27,7 @@
 extern int main(int argc, char **argv);
 extern void _init(void);
 
-sem_t *usem[OPEN_MAX];
+sem_t *usem[SEM_OPEN_MAX];
 
 /*
  * Entry point of the program.
@@ -37,7 +37,7 @@ void _start(int argc, char **argv, char **envp)
 	int ret;
 	environ = envp;
 
-	for (int i = 0; i < OPEN_MAX; i++)
+	for (int i = 0; i < SEM_OPEN_MAX; i++)
 		usem[i] = NULL;
 
 	/* Call _init. */
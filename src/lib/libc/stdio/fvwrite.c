@@ -22,6 +22,8 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <limits.h>
+#include <unistd.h>
+#include <sys/uio.h>
 #include "local.h"
 #include "fvwrite.h"
 
@@ -37,6 +39,142 @@
       iov++; \
     }
 
+/*
+ * Number of I/O vector elements handed to writev() at once.
+ */
+#define	FVWRITE_NIOV 8
+
+/*
+ * Writes out the stream buffer followed by the first n bytes of uio,
+ * gathering them into as few writev() calls as possible.  This saves
+ * a flush plus one write per region when the data would not stay in
+ * the buffer anyway.  Return zero on success, EOF on error.
+ */
+
+static int
+_DEFUN(__sfvwrite_gather, (ptr, fp, uio, n),
+       struct _reent *ptr _AND
+       register FILE *fp _AND
+       register struct __suio *uio _AND
+       size_t n)
+{
+  struct iovec iov[FVWRITE_NIOV];
+  struct __siov *uiov;
+  size_t pending, left, len;
+  ssize_t w;
+  int cnt;
+
+  while (n > 0 || fp->_p > fp->_bf._base)
+    {
+      cnt = 0;
+      pending = fp->_p - fp->_bf._base;
+      if (pending > 0)
+	{
+	  iov[cnt].iov_base = fp->_bf._base;
+	  iov[cnt++].iov_len = pending;
+	}
+      uiov = uio->uio_iov;
+      for (left = n; left > 0 && cnt < FVWRITE_NIOV; uiov++)
+	{
+	  if ((len = MIN (uiov->iov_len, left)) == 0)
+	    continue;
+	  iov[cnt].iov_base = (_PTR) uiov->iov_base;
+	  iov[cnt++].iov_len = len;
+	  left -= len;
+	}
+
+      if (fp->_flags & __SAPP)
+	_lseek_r (ptr, fp->_file, (_off_t) 0, SEEK_END);
+      fp->_flags &= ~__SOFF;	/* in case O_APPEND mode is set */
+
+      if ((w = writev (fp->_file, iov, cnt)) <= 0)
+	{
+	  ptr->_errno = errno;
+	  return EOF;
+	}
+
+      /* consume the stream buffer first... */
+      if ((size_t) w < pending)
+	{
+	  memmove ((_PTR) fp->_bf._base, (_PTR) (fp->_bf._base + w),
+		   pending - w);
+	  fp->_p -= w;
+	  continue;
+	}
+      fp->_p = fp->_bf._base;
+      w -= pending;
+
+      /* ...and then the caller's regions */
+      n -= w;
+      uio->uio_resid -= w;
+      while (w > 0)
+	{
+	  uiov = uio->uio_iov;
+	  len = MIN (uiov->iov_len, (size_t) w);
+	  uiov->iov_base = (_CONST char *) uiov->iov_base + len;
+	  uiov->iov_len -= len;
+	  w -= len;
+	  if (uiov->iov_len == 0)
+	    {
+	      uio->uio_iov++;
+	      uio->uio_iovcnt--;
+	    }
+	}
+    }
+  fp->_w = fp->_flags & (__SLBF | __SNBF) ? 0 : fp->_bf._size;
+  return 0;
+}
+
+/*
+ * Figures out how many leading bytes of uio should go out right
+ * away, together with the stream buffer, through __sfvwrite_gather().
+ */
+
+static size_t
+_DEFUN(__sfvwrite_gather_size, (fp, uio),
+       register FILE *fp _AND
+       register struct __suio *uio)
+{
+  struct __siov *iov;
+  size_t n, nl;
+  char *p;
+  int i;
+
+  /* only plain file descriptors can be written with writev() */
+  if (fp->_write != __swrite || fp->_file < 0 || (fp->_flags & __SSTR))
+    return 0;
+
+  /* unbuffered: everything */
+  if (fp->_flags & __SNBF)
+    return uio->uio_resid;
+
+  /* fully buffered: everything, if it would not fit in the buffer */
+  if ((fp->_flags & __SLBF) == 0)
+    {
+      if ((size_t) (fp->_p - fp->_bf._base) + uio->uio_resid
+	  >= (size_t) fp->_bf._size)
+	return uio->uio_resid;
+      return 0;
+    }
+
+  /* line buffered: everything up to the last newline */
+  n = nl = 0;
+  for (i = 0, iov = uio->uio_iov; i < uio->uio_iovcnt; i++, iov++)
+    {
+      for (p = (char *) iov->iov_base + iov->iov_len;
+	   p > (char *) iov->iov_base; p--)
+	{
+	  if (p[-1] == '\n')
+	    {
+	      nl = n + (p - (char *) iov->iov_base);
+	      break;
+	    }
+	}
+      n += iov->iov_len;
+    }
+  return nl;
+}
+
 /*
  * Write some memory regions.  Return zero on success, EOF on error.
  *
@@ -87,6 +225,20 @@ _DEFUN(__sfvwrite_r, (ptr, fp, uio),
     }
 #endif
 
+  /*
+   * Nanvix: write out whatever would be flushed right away with a
+   * single writev(), instead of a write() per buffer and region.
+   */
+  if ((len = __sfvwrite_gather_size (fp, uio)) > 0)
+    {
+      if (__sfvwrite_gather (ptr, fp, uio, len))
+	goto err;
+      if (uio->uio_resid == 0)
+	return 0;
+      iov = uio->uio_iov;
+      len = 0;
+    }
+
   if (fp->_flags & __SNBF)
     {
       /*
@@ -0,0 +1,109 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/select.h>
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+
+/*
+ * Waits for file descriptors to become ready.
+ */
+int select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *errorfds, struct timeval *timeout)
+{
+	int n;                       /* Polled file descriptors. */
+	int ret;                     /* Ready file descriptors.  */
+	int ms;                      /* Timeout in milliseconds. */
+	fd_set errors;               /* Error conditions wanted. */
+	struct pollfd fds[OPEN_MAX]; /* Poll set.                */
+	
+	/* Invalid number of file descriptors. */
+	if ((nfds < 0) || (nfds > FD_SETSIZE))
+	{
+		errno = EINVAL;
+		return (-1);
+	}
+	
+	FD_ZERO(&errors);
+	
+	/* Build poll set. */
+	n = 0;
+	for (int fd = 0; fd < nfds; fd++)
+	{
+		int events = 0;
+		
+		if ((readfds != NULL) && (FD_ISSET(fd, readfds)))
+			events |= POLLIN;
+		if ((writefds != NULL) && (FD_ISSET(fd, writefds)))
+			events |= POLLOUT;
+		if ((errorfds != NULL) && (FD_ISSET(fd, errorfds)))
+			FD_SET(fd, &errors);
+		else if (events == 0)
+			continue;
+		
+		/* No process opens that many files. */
+		if (n == OPEN_MAX)
+		{
+			errno = EBADF;
+			return (-1);
+		}
+		
+		fds[n].fd = fd;
+		fds[n].events = events;
+		n++;
+	}
+	
+	/* Wait indefinitely. */
+	ms = -1;
+	if (timeout != NULL)
+		ms = timeout->tv_sec*1000 + (timeout->tv_usec + 999)/1000;
+	
+	if (poll(fds, n, ms) < 0)
+		return (-1);
+	
+	if (readfds != NULL)
+		FD_ZERO(readfds);
+	if (writefds != NULL)
+		FD_ZERO(writefds);
+	if (errorfds != NULL)
+		FD_ZERO(errorfds);
+	
+	/* Report ready file descriptors. */
+	ret = 0;
+	for (int i = 0; i < n; i++)
+	{
+		int revents = fds[i].revents;
+		
+		/* Invalid file descriptor. */
+		if (revents & POLLNVAL)
+		{
+			errno = EBADF;
+			return (-1);
+		}
+		
+		if ((fds[i].events & POLLIN) && (revents & (POLLIN | POLLHUP | POLLERR)))
+			FD_SET(fds[i].fd, readfds), ret++;
+		if ((fds[i].events & POLLOUT) && (revents & (POLLOUT | POLLERR)))
+			FD_SET(fds[i].fd, writefds), ret++;
+		if ((FD_ISSET(fds[i].fd, &errors)) && (revents & POLLERR))
+			FD_SET(fds[i].fd, errorfds), ret++;
+	}
+	
+	return (ret);
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/sendfile.h>
+#include <errno.h>
+#include <unistd.h>
+
+/*
+ * Copies a range of data from a regular file to another file.
+ */
+ssize_t copy_file_range(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned flags)
+{
+	off_t pos;   /* Saved output offset. */
+	ssize_t ret; /* Bytes copied.        */
+	
+	/* No flags are defined. */
+	if (flags != 0)
+	{
+		errno = EINVAL;
+		return (-1);
+	}
+	
+	/* Write at the current output offset. */
+	if (off_out == NULL)
+		return (sendfile(fd_out, fd_in, off_in, len));
+	
+	/*
+	 * sendfile() always writes at the current
+	 * output offset, so move it around.
+	 */
+	if ((pos = lseek(fd_out, 0, SEEK_CUR)) < 0)
+		return (-1);
+	if (lseek(fd_out, *off_out, SEEK_SET) < 0)
+		return (-1);
+	
+	if ((ret = sendfile(fd_out, fd_in, off_in, len)) > 0)
+		*off_out += ret;
+	
+	lseek(fd_out, pos, SEEK_SET);
+	
+	return (ret);
+}
@@ -0,0 +1,689 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Path to this program, used by the exec benchmark.
+ */
+#define BENCH_PATH "/sbin/bench"
+
+/**
+ * @brief Page size.
+ */
+#define BENCH_PAGE_SIZE 4096
+
+/**
+ * @name Benchmark iterations
+ */
+/**@{*/
+#define BENCH_NSYSCALLS 100000          /**< Null system calls.         */
+#define BENCH_NCLOCKS   100000          /**< Clock reads.               */
+#define BENCH_NSWITCHES 10000           /**< Pipe round trips.          */
+#define BENCH_NFORKS    256             /**< fork() + _exit().          */
+#define BENCH_NEXECS    64              /**< fork() + execve() + exit.  */
+#define BENCH_NPAGES    1024            /**< Pages faulted in.          */
+#define BENCH_PIPE_SIZE (8*1024*1024)   /**< Bytes sent through a pipe. */
+#define BENCH_FILE_SIZE (1024*1024)     /**< Bytes written to a file.   */
+#define BENCH_NFILES    256             /**< Files created and removed. */
+#define BENCH_NLOOKUPS  10000           /**< Path name lookups.         */
+/**@}*/
+
+/**
+ * @brief Directory where file system benchmarks run.
+ */
+static const char *bench_dir = "/tmp";
+
+/**
+ * @brief Timer frequency (in Hz).
+ */
+static const uint64_t bench_hz = 1000000000ULL;
+
+/**
+ * @brief I/O buffer.
+ */
+static char bench_buf[BENCH_PAGE_SIZE];
+
+/*============================================================================*
+ *                                  Timer                                     *
+ *============================================================================*/
+
+/**
+ * @brief Reads the timer.
+ *
+ * @returns The monotonic clock, in nanoseconds.
+ */
+static inline uint64_t bench_clock(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((uint64_t)ts.tv_sec*1000000000ULL + ts.tv_nsec);
+}
+
+/**
+ * @brief Converts a timer interval into nanoseconds per operation.
+ *
+ * @param dt Timer interval, in nanoseconds.
+ * @param n  Number of operations.
+ *
+ * @returns Nanoseconds per operation.
+ */
+static unsigned bench_ns(uint64_t dt, unsigned n)
+{
+	return ((unsigned)(dt/n));
+}
+
+/**
+ * @brief Converts a timer interval into bandwidth.
+ *
+ * @param dt    Timer interval.
+ * @param bytes Number of bytes transferred.
+ *
+ * @returns Bandwidth in KB/s.
+ */
+static unsigned bench_kbps(uint64_t dt, uint64_t bytes)
+{
+	if (dt == 0)
+		dt = 1;
+
+	return ((unsigned)((bytes*bench_hz)/(dt*1024)));
+}
+
+/**
+ * @brief Reports a result.
+ *
+ * @details Results are printed one per line as "bench <name> <value>
+ * <unit>", so that they can be extracted from the serial console log.
+ *
+ * @param name  Benchmark name.
+ * @param value Measured value.
+ * @param unit  Unit of @p value.
+ */
+static void bench_report(const char *name, unsigned value, const char *unit)
+{
+	printf("bench %s %u %s\n", name, value, unit);
+}
+
+/**
+ * @brief Reports a failed benchmark.
+ *
+ * @param name Benchmark name.
+ *
+ * @returns Always -1.
+ */
+static int bench_fail(const char *name)
+{
+	printf("bench %s failed\n", name);
+
+	return (-1);
+}
+
+/*============================================================================*
+ *                                Benchmarks                                  *
+ *============================================================================*/
+
+/**
+ * @brief Null system call latency.
+ *
+ * @returns Zero on success, and non-zero otherwise.
+ */
+static int bench_syscall(void)
+{
+	uint64_t t0, t1;
+
+	t0 = bench_clock();
+	for (int i = 0; i < BENCH_NSYSCALLS; i++)
+		getpid();
+	t1 = bench_clock();
+
+	bench_report("syscall", bench_ns(t1 - t0, BENCH_NSYSCALLS), "ns");
+
+	return (0);
+}
+
+/**
+ * @brief Clock read latency.
+ *
+ * @details The clock is read from the time page, without entering the
+ * kernel.
+ *
+ * @returns Zero on success, and non-zero otherwise.
+ */
+static int bench_gettime(void)
+{
+	uint64_t t0, t1;
+	struct timespec ts;
+
+	t0 = bench_clock();
+	for (int i = 0; i < BENCH_NCLOCKS; i++)
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+	t1 = bench_clock();
+
+	bench_report("gettime", bench_ns(t1 - t0, BENCH_NCLOCKS), "ns");
+
+	return (0);
+}
+
+/**
+ * @brief Context switch latency.
+ *
+ * @details A parent and a child process bounce one byte back and forth
+ * through a pair of pipes. Each round trip takes two context switches.
+ *
+ * @returns Zero on success, and non-zero otherwise.
+ */
+static int bench_ctxsw(void)
+{
+	int p2c[2], c2p[2];
+	uint64_t t0, t1;
+	pid_t pid;
+	char c = 0;
+
+	if (pipe(p2c) < 0)
+		return (bench_fail("ctxsw"));
+	if (pipe(c2p) < 0)
+		goto error0;
+
+	if ((pid = fork()) < 0)
+		goto error1;
+
+	/* Child process. */
+	if (pid == 0)
+	{
+		for (int i = 0; i < BENCH_NSWITCHES; i++)
+		{
+			if (read(p2c[0], &c, 1) != 1)
+				_exit(EXIT_FAILURE);
+			if (write(c2p[1], &c, 1) != 1)
+				_exit(EXIT_FAILURE);
+		}
+		_exit(EXIT_SUCCESS);
+	}
+
+	t0 = bench_clock();
+	for (int i = 0; i < BENCH_NSWITCHES; i++)
+	{
+		if (write(p2c[1], &c, 1) != 1)
+			break;
+		if (read(c2p[0], &c, 1) != 1)
+			break;
+	}
+	t1 = bench_clock();
+
+	wait(NULL);
+	close(c2p[0]); close(c2p[1]);
+	close(p2c[0]); close(p2c[1]);
+
+	bench_report("ctxsw", bench_ns(t1 - t0, 2*BENCH_NSWITCHES), "ns");
+
+	return (0);
+
+error1:
+	close(c2p[0]); close(c2p[1]);
+error0:
+	close(p2c[0]); close(p2c[1]);
+	return (bench_fail("ctxsw"));
+}
+
+/**
+ * @brief Process creation and termination cost.
+ *
+ * @returns Zero on success, and non-zero otherwise.
+ */
+static int bench_fork(void)
+{
+	uint64_t t0, t1;
+	int status;
+	pid_t pid;
+
+	/* fork() + _exit() + wait(). */
+	t0 = bench_clock();
+	for (int i = 0; i < BENCH_NFORKS; i++)
+	{
+		if ((pid = fork()) < 0)
+			return (bench_fail("fork"));
+		if (pid == 0)
+			_exit(EXIT_SUCCESS);
+		wait(NULL);
+	}
+	t1 = bench_clock();
+
+	bench_report("fork", bench_ns(t1 - t0, BENCH_NFORKS), "ns");
+
+	/* fork() + execve() + exit() + wait(). */
+	t0 = bench_clock();
+	for (int i = 0; i < BENCH_NEXECS; i++)
+	{
+		if ((pid = fork()) < 0)
+			return (bench_fail("exec"));
+		if (pid == 0)
+		{
+			execl(BENCH_PATH, "bench", "-exit", NULL);
+			_exit(EXIT_FAILURE);
+		}
+		if ((wait(&status) < 0) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+			return (bench_fail("exec"));
+	}
+	t1 = bench_clock();
+
+	bench_report("exec", bench_ns(t1 - t0, BENCH_NEXECS), "ns");
+
+	return (0);
+}
+
+/**
+ * @brief Page fault cost.
+ *
+ * @details Demand-zero faults are taken by touching freshly allocated heap
+ * pages. Copy-on-write faults are taken by a child process that writes
+ * to pages it shares with its parent, and reports the elapsed time back
+ * through a pipe.
+ *
+ * @returns Zero on success, and non-zero otherwise.
+ */
+static int bench_pagefault(void)
+{
+	const size_t size = BENCH_NPAGES*BENCH_PAGE_SIZE;
+	volatile char *buffer;
+	uint64_t t0, t1;
+	int fd[2];
+	pid_t pid;
+
+	if ((buffer = sbrk(size)) == (void *)-1)
+		return (bench_fail("pagefault"));
+
+	/* Demand-zero faults. */
+	t0 = bench_clock();
+	for (size_t i = 0; i < size; i += BENCH_PAGE_SIZE)
+		buffer[i] = 1;
+	t1 = bench_clock();
+
+	bench_report("pagefault_zero", bench_ns(t1 - t0, BENCH_NPAGES), "ns");
+
+	/* Copy-on-write faults. */
+	if (pipe(fd) < 0)
+		goto error0;
+	if ((pid = fork()) < 0)
+		goto error1;
+
+	/* Child process. */
+	if (pid == 0)
+	{
+		t0 = bench_clock();
+		for (size_t i = 0; i < size; i += BENCH_PAGE_SIZE)
+			buffer[i] = 2;
+		t1 = bench_clock();
+		t1 -= t0;
+		write(fd[1], &t1, sizeof(t1));
+		_exit(EXIT_SUCCESS);
+	}
+
+	if (read(fd[0], &t1, sizeof(t1)) != sizeof(t1))
+	{
+		wait(NULL);
+		goto error1;
+	}
+	wait(NULL);
+
+	bench_report("pagefault_cow", bench_ns(t1, BENCH_NPAGES), "ns");
+
+	close(fd[0]); close(fd[1]);
+	sbrk(-size);
+	return (0);
+
+error1:
+	close(fd[0]); close(fd[1]);
+error0:
+	sbrk(-size);
+	return (bench_fail("pagefault"));
+}
+
+/**
+ * @brief Pipe bandwidth.
+ *
+ * @returns Zero on success, and non-zero otherwise.
+ */
+static int bench_pipe(void)
+{
+	uint64_t t0, t1;
+	size_t n;
+	ssize_t ret;
+	int fd[2];
+	pid_t pid;
+
+	if (pipe(fd) < 0)
+		return (bench_fail("pipe"));
+
+	if ((pid = fork()) < 0)
+	{
+		close(fd[0]); close(fd[1]);
+		return (bench_fail("pipe"));
+	}
+
+	/* Child process. */
+	if (pid == 0)
+	{
+		close(fd[0]);
+		for (n = 0; n < BENCH_PIPE_SIZE; n += sizeof(bench_buf))
+		{
+			if (write(fd[1], bench_buf, sizeof(bench_buf)) != sizeof(bench_buf))
+				_exit(EXIT_FAILURE);
+		}
+		_exit(EXIT_SUCCESS);
+	}
+
+	close(fd[1]);
+
+	t0 = bench_clock();
+	for (n = 0; n < BENCH_PIPE_SIZE; n += ret)
+	{
+		if ((ret = read(fd[0], bench_buf, sizeof(bench_buf))) <= 0)
+			break;
+	}
+	t1 = bench_clock();
+
+	close(fd[0]);
+	wait(NULL);
+
+	if (n != BENCH_PIPE_SIZE)
+		return (bench_fail("pipe"));
+
+	bench_report("pipe_bw", bench_kbps(t1 - t0, n), "KB/s");
+
+	return (0);
+}
+
+/**
+ * @brief Builds a path name in the benchmark directory.
+ *
+ * @param buf  Target buffer.
+ * @param size Size of @p buf.
+ * @param name File name.
+ */
+static void bench_path(char *buf, size_t size, const char *name)
+{
+	snprintf(buf, size, "%s/%s", bench_dir, name);
+}
+
+/**
+ * @brief File write and read bandwidth.
+ *
+ * @returns Zero on success, and non-zero otherwise.
+ */
+static int bench_file(void)
+{
+	char path[PATH_MAX];
+	uint64_t t0, t1;
+	size_t n;
+	int fd;
+
+	bench_path(path, sizeof(path), "bench.dat");
+
+	/* Write. */
+	if ((fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+		return (bench_fail("file"));
+	t0 = bench_clock();
+	for (n = 0; n < BENCH_FILE_SIZE; n += sizeof(bench_buf))
+	{
+		if (write(fd, bench_buf, sizeof(bench_buf)) != sizeof(bench_buf))
+			break;
+	}
+	t1 = bench_clock();
+	close(fd);
+
+	if (n != BENCH_FILE_SIZE)
+		goto error;
+
+	bench_report("file_write_bw", bench_kbps(t1 - t0, n), "KB/s");
+
+	/* Read. */
+	if ((fd = open(path, O_RDONLY)) < 0)
+		goto error;
+	t0 = bench_clock();
+	for (n = 0; n < BENCH_FILE_SIZE; n += sizeof(bench_buf))
+	{
+		if (read(fd, bench_buf, sizeof(bench_buf)) != sizeof(bench_buf))
+			break;
+	}
+	t1 = bench_clock();
+	close(fd);
+
+	if (n != BENCH_FILE_SIZE)
+		goto error;
+
+	bench_report("file_read_bw", bench_kbps(t1 - t0, n), "KB/s");
+
+	unlink(path);
+	return (0);
+
+error:
+	unlink(path);
+	return (bench_fail("file"));
+}
+
+/**
+ * @brief File creation and removal rate.
+ *
+ * @returns Zero on success, and non-zero otherwise.
+ */
+static int bench_create(void)
+{
+	char path[PATH_MAX];
+	char name[NAME_MAX];
+	uint64_t t0, t1;
+	int fd;
+
+	/* Create. */
+	t0 = bench_clock();
+	for (int i = 0; i < BENCH_NFILES; i++)
+	{
+		snprintf(name, sizeof(name), "bench%d", i);
+		bench_path(path, sizeof(path), name);
+		if ((fd = open(path, O_WRONLY | O_CREAT, 0644)) < 0)
+			return (bench_fail("create"));
+		close(fd);
+	}
+	t1 = bench_clock();
+
+	bench_report("create", bench_ns(t1 - t0, BENCH_NFILES), "ns");
+
+	/* Remove. */
+	t0 = bench_clock();
+	for (int i = 0; i < BENCH_NFILES; i++)
+	{
+		snprintf(name, sizeof(name), "bench%d", i);
+		bench_path(path, sizeof(path), name);
+		if (unlink(path) < 0)
+			return (bench_fail("unlink"));
+	}
+	t1 = bench_clock();
+
+	bench_report("unlink", bench_ns(t1 - t0, BENCH_NFILES), "ns");
+
+	return (0);
+}
+
+/**
+ * @brief Path name lookup latency.
+ *
+ * @details Stats a file four directories deep in the benchmark directory.
+ *
+ * @returns Zero on success, and non-zero otherwise.
+ */
+static int bench_lookup(void)
+{
+	static const char *dirs[] = { "bench.a", "bench.a/b", "bench.a/b/c", "bench.a/b/c/d" };
+	const int ndirs = sizeof(dirs)/sizeof(dirs[0]);
+	char path[PATH_MAX];
+	struct stat st;
+	uint64_t t0, t1;
+	int ret = 0;
+	int fd;
+
+	/* Build directory tree. */
+	for (int i = 0; i < ndirs; i++)
+	{
+		bench_path(path, sizeof(path), dirs[i]);
+		mkdir(path, 0755);
+	}
+	bench_path(path, sizeof(path), "bench.a/b/c/d/file");
+	if ((fd = open(path, O_WRONLY | O_CREAT, 0644)) < 0)
+	{
+		ret = bench_fail("lookup");
+		goto out;
+	}
+	close(fd);
+
+	t0 = bench_clock();
+	for (int i = 0; i < BENCH_NLOOKUPS; i++)
+	{
+		if (stat(path, &st) < 0)
+			break;
+	}
+	t1 = bench_clock();
+
+	bench_report("lookup", bench_ns(t1 - t0, BENCH_NLOOKUPS), "ns");
+
+	unlink(path);
+
+out:
+	for (int i = ndirs - 1; i >= 0; i--)
+	{
+		bench_path(path, sizeof(path), dirs[i]);
+		rmdir(path);
+	}
+
+	return (ret);
+}
+
+/*============================================================================*
+ *                                   main                                     *
+ *============================================================================*/
+
+/**
+ * @brief Benchmarks.
+ */
+static const struct
+{
+	const char *name;   /**< Name.        */
+	int (*run)(void);   /**< Benchmark.   */
+	const char *brief;  /**< Description. */
+} benchmarks[] = {
+	{ "syscall",   bench_syscall,   "Null system call latency"       },
+	{ "gettime",   bench_gettime,   "Clock read latency"             },
+	{ "ctxsw",     bench_ctxsw,     "Context switch latency"         },
+	{ "fork",      bench_fork,      "fork/exit and fork/exec cost"   },
+	{ "pagefault", bench_pagefault, "Demand-zero and COW fault cost" },
+	{ "pipe",      bench_pipe,      "Pipe bandwidth"                 },
+	{ "file",      bench_file,      "File write and read bandwidth"  },
+	{ "create",    bench_create,    "File create and delete cost"    },
+	{ "lookup",    bench_lookup,    "Path name lookup latency"       },
+	{ NULL,        NULL,            NULL                             },
+};
+
+/**
+ * @brief Prints program usage and exits.
+ */
+static void usage(void)
+{
+	printf("Usage: bench [-d directory] [benchmarks]\n\n");
+	printf("Brief: Measures the cost of operating system primitives.\n\n");
+	printf("Options:\n");
+	printf("  -d directory  Run file system benchmarks in directory (default /tmp)\n\n");
+	printf("Benchmarks (all of them if none is given):\n");
+	for (int i = 0; benchmarks[i].name != NULL; i++)
+		printf("  %-10s %s\n", benchmarks[i].name, benchmarks[i].brief);
+
+	exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Operating system micro-benchmarks.
+ *
+ * @details Results are printed as "bench <name> <value> <unit>" lines,
+ * framed by "bench begin" and "bench end" lines. Latencies are reported
+ * in nanoseconds and bandwidths in KB/s.
+ */
+int main(int argc, char **argv)
+{
+	int nerrors = 0;
+	int nrun = 0;
+	int i = 1;
+
+	/* Exec benchmark. */
+	if ((argc == 2) && !strcmp(argv[1], "-exit"))
+		return (EXIT_SUCCESS);
+
+	if ((argc > 2) && !strcmp(argv[1], "-d"))
+	{
+		bench_dir = argv[2];
+		i = 3;
+	}
+
+	/* Check benchmark names. */
+	for (int j = i; j < argc; j++)
+	{
+		int k;
+
+		for (k = 0; benchmarks[k].name != NULL; k++)
+		{
+			if (!strcmp(argv[j], benchmarks[k].name))
+				break;
+		}
+
+		if (benchmarks[k].name == NULL)
+			usage();
+	}
+
+	printf("bench begin %u Hz\n", (unsigned)bench_hz);
+
+	for (int k = 0; benchmarks[k].name != NULL; k++)
+	{
+		bool selected = (i == argc);
+
+		for (int j = i; j < argc; j++)
+		{
+			if (!strcmp(argv[j], benchmarks[k].name))
+				selected = true;
+		}
+
+		if (!selected)
+			continue;
+
+		nrun++;
+		if (benchmarks[k].run())
+			nerrors++;
+	}
+
+	printf("bench end %d run %d failed\n", nrun, nerrors);
+
+	return ((nerrors == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
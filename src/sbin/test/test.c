@@ -23,6 +23,13 @@
 #include <sys/times.h>
 #include <sys/wait.h>
 #include <sys/sem.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
+#include <sys/ioring.h>
+#include <sys/timepage.h>
+#include <sys/select.h>
+#include <dirent.h>
 #include <stdio.h>
 #include <signal.h>
 #include <stdlib.h>
@@ -31,7 +38,11 @@
 #include <fcntl.h>
 #include <limits.h>
 #include <semaphore.h>
+#include <sched.h>
 #include <errno.h>
+#include <pthread.h>
+#include <poll.h>
+#include <time.h>
 
 /* Test flags. */
 #define VERBOSE	 (1 << 10)
@@ -194,6 +205,65 @@ static int stack_grow_test(void)
 	return (0);
 }
 
+/**
+ * @brief TLB benchmark.
+ *
+ * @details Touches one byte per page of a big heap buffer, over and over
+ * again. With small pages, nearly every access misses in the TLB. With
+ * large pages, the whole buffer is covered by a handful of TLB entries.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int tlb_bench(void)
+{
+	const size_t lpage = 4*1024*1024;  /* Large page size.    */
+	const size_t page = 4096;          /* Page size.          */
+	const size_t size = 4*lpage;       /* Buffer size.        */
+	const int npasses = 64;            /* Number of passes.   */
+	volatile char *buffer;             /* Buffer.             */
+	size_t pad;                        /* Alignment padding.  */
+	unsigned sum;                      /* Checksum.           */
+	struct tms timing;                 /* Timing information. */
+	clock_t t0, t1, t2;                /* Elapsed times.      */
+
+	/* Align break, so that large pages may be used. */
+	pad = (lpage - ((size_t)sbrk(0) & (lpage - 1))) & (lpage - 1);
+	if ((buffer = sbrk(pad + size)) == (void *)-1)
+		return (-1);
+	buffer += pad;
+
+	t0 = times(&timing);
+
+	/* First touch. */
+	for (size_t i = 0; i < size; i += page)
+		buffer[i] = 1;
+
+	t1 = times(&timing);
+
+	/* Page walk. */
+	sum = 0;
+	for (int j = 0; j < npasses; j++)
+	{
+		for (size_t i = 0; i < size; i += page)
+			sum += buffer[i];
+	}
+
+	t2 = times(&timing);
+
+	/* House keeping. */
+	sbrk(-(pad + size));
+
+	/* Print timing statistics. */
+	if (flags & VERBOSE)
+	{
+		printf("  First touch: %d\n", t1 - t0);
+		printf("  Page walk:   %d (%d passes over %d pages)\n",
+			t2 - t1, npasses, size/page);
+	}
+
+	return ((sum == npasses*(size/page)) ? 0 : -1);
+}
+
 /*============================================================================*
  *									io_test									  *
  *============================================================================*/
@@ -242,6 +312,564 @@ static int io_test(void)
 	return (0);
 }
 
+/**
+ * @brief Vectored and positional I/O testing module.
+ * 
+ * @details Gathers data into a file with writev(), patches it with
+ * pwrite(), and checks it back with pread() and readv(). Positional
+ * I/O must leave the file offset untouched. Finally, copies part of
+ * the file with sendfile().
+ * 
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int vio_test(void)
+{
+	int fd;                /* File descriptor. */
+	int fd2 = -1;          /* File descriptor. */
+	off_t off;             /* File offset.     */
+	struct iovec iov[3];   /* I/O vector.      */
+	char a[4], b[8], c[4]; /* Buffers.         */
+	char buf[16];          /* Buffer.          */
+	int ret = -1;          /* Return value.    */
+	
+	fd = open("/home/vio", O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	if (fd < 0)
+		return (-1);
+	
+	/* Gather write. */
+	iov[0].iov_base = "abcd"; iov[0].iov_len = 4;
+	iov[1].iov_base = "efghijkl"; iov[1].iov_len = 8;
+	iov[2].iov_base = "mnop"; iov[2].iov_len = 4;
+	if (writev(fd, iov, 3) != 16)
+		goto out;
+	
+	/* Positional I/O. */
+	if (pwrite(fd, "XY", 2, 0) != 2)
+		goto out;
+	if (pread(fd, buf, 4, 4) != 4)
+		goto out;
+	if (memcmp(buf, "efgh", 4))
+		goto out;
+	if (lseek(fd, 0, SEEK_CUR) != 16)
+		goto out;
+	
+	/* Scatter read. */
+	if (lseek(fd, 0, SEEK_SET) != 0)
+		goto out;
+	iov[0].iov_base = a; iov[0].iov_len = sizeof(a);
+	iov[1].iov_base = b; iov[1].iov_len = sizeof(b);
+	iov[2].iov_base = c; iov[2].iov_len = sizeof(c);
+	if (readv(fd, iov, 3) != 16)
+		goto out;
+	if (memcmp(a, "XYcd", 4) || memcmp(b, "efghijkl", 8) || memcmp(c, "mnop", 4))
+		goto out;
+	
+	/* End of file. */
+	if (readv(fd, iov, 3) != 0)
+		goto out;
+	
+	/* In-kernel copy. */
+	fd2 = open("/home/vio2", O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	if (fd2 < 0)
+		goto out;
+	off = 4;
+	if (sendfile(fd2, fd, &off, 64) != 12)
+		goto out;
+	if ((off != 16) || (lseek(fd, 0, SEEK_CUR) != 16))
+		goto out;
+	if (pread(fd2, buf, 12, 0) != 12)
+		goto out;
+	if (memcmp(buf, "efghijklmnop", 12))
+		goto out;
+	
+	ret = 0;
+
+out:
+	if (fd2 >= 0)
+	{
+		close(fd2);
+		unlink("/home/vio2");
+	}
+	close(fd);
+	unlink("/home/vio");
+	
+	return (ret);
+}
+
+/**
+ * @brief In-memory file system testing module.
+ * 
+ * @details Writes a sparse file to /tmp and checks that the hole reads
+ * back as zeros, copies it out of memory with sendfile(), and checks
+ * that it shows up in, and then goes away from, the directory listing.
+ * 
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int tmpfs_test(void)
+{
+	int fd;                /* File descriptor. */
+	int fd2 = -1;          /* File descriptor. */
+	off_t off;             /* File offset.     */
+	DIR *dirp;             /* Directory.       */
+	struct dirent *dp;     /* Directory entry. */
+	int found;             /* Entry found?     */
+	static char buf[8192]; /* Buffer.          */
+	int ret = -1;          /* Return value.    */
+	
+	fd = open("/tmp/sparse", O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	if (fd < 0)
+		return (-1);
+	
+	/* Leave a hole of two pages. */
+	if (pwrite(fd, "head", 4, 0) != 4)
+		goto out;
+	if (pwrite(fd, "tail", 4, 3*4096) != 4)
+		goto out;
+	if (lseek(fd, 0, SEEK_END) != 3*4096 + 4)
+		goto out;
+	if (pread(fd, buf, sizeof(buf), 4) != sizeof(buf))
+		goto out;
+	for (size_t i = 0; i < sizeof(buf); i++)
+	{
+		if (buf[i] != 0)
+			goto out;
+	}
+	
+	/* Copy out to disk. */
+	fd2 = open("/home/sparse", O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	if (fd2 < 0)
+		goto out;
+	off = 0;
+	if (sendfile(fd2, fd, &off, 4*4096) != 3*4096 + 4)
+		goto out;
+	if (pread(fd2, buf, 4, 3*4096) != 4)
+		goto out;
+	if (memcmp(buf, "tail", 4))
+		goto out;
+	
+	/* Directory listing. */
+	if ((dirp = opendir("/tmp")) == NULL)
+		goto out;
+	found = 0;
+	while ((dp = readdir(dirp)) != NULL)
+	{
+		if (!strcmp(dp->d_name, "sparse"))
+			found++;
+	}
+	closedir(dirp);
+	if (found != 1)
+		goto out;
+	
+	if (unlink("/tmp/sparse"))
+		goto out;
+	if ((dirp = opendir("/tmp")) == NULL)
+		goto out;
+	while ((dp = readdir(dirp)) != NULL)
+	{
+		if (!strcmp(dp->d_name, "sparse"))
+			found++;
+	}
+	closedir(dirp);
+	if (found != 1)
+		goto out;
+	
+	ret = 0;
+
+out:
+	if (fd2 >= 0)
+	{
+		close(fd2);
+		unlink("/home/sparse");
+	}
+	close(fd);
+	unlink("/tmp/sparse");
+	
+	return (ret);
+}
+
+/**
+ * @brief Process file system testing module.
+ * 
+ * @details Checks that the calling process shows up in /proc, that its
+ * status file names it, that system-wide files can be read, but not
+ * sent, and that files cannot be created in /proc.
+ * 
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int proc_test(void)
+{
+	int fd, fd2;        /* File descriptors. */
+	ssize_t n;          /* Bytes read.       */
+	DIR *dirp;          /* Directory.        */
+	struct dirent *dp;  /* Directory entry. */
+	int found;          /* Entry found?      */
+	char pid[16];       /* Process ID.       */
+	char path[64];      /* File name.        */
+	char line[32];      /* Expected line.    */
+	char buf[1024];     /* Buffer.           */
+	
+	sprintf(pid, "%d", getpid());
+	
+	/* Directory listing. */
+	if ((dirp = opendir("/proc")) == NULL)
+		return (-1);
+	found = 0;
+	while ((dp = readdir(dirp)) != NULL)
+	{
+		if (!strcmp(dp->d_name, pid))
+			found++;
+	}
+	closedir(dirp);
+	if (found != 1)
+		return (-1);
+	
+	/* Status file. */
+	sprintf(path, "/proc/%s/status", pid);
+	if ((fd = open(path, O_RDONLY)) < 0)
+		return (-1);
+	n = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (n <= 0)
+		return (-1);
+	buf[n] = '\0';
+	sprintf(line, "\npid %s\n", pid);
+	if (strstr(buf, line) == NULL)
+		return (-1);
+	
+	/* System-wide file. */
+	if ((fd = open("/proc/meminfo", O_RDONLY)) < 0)
+		return (-1);
+	n = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (n <= 0)
+		return (-1);
+	buf[n] = '\0';
+	if (strstr(buf, "user_free ") == NULL)
+		return (-1);
+	
+	/* Unknown size, so sendfile() leaves it to the caller. */
+	if ((fd = open("/proc/meminfo", O_RDONLY)) < 0)
+		return (-1);
+	if ((fd2 = open("/dev/null", O_WRONLY)) < 0)
+	{
+		close(fd);
+		return (-1);
+	}
+	n = sendfile(fd2, fd, NULL, sizeof(buf));
+	close(fd2);
+	close(fd);
+	if ((n != -1) || (errno != EINVAL))
+		return (-1);
+	
+	/* Read-only. */
+	if ((fd = open("/proc/foobar", O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR)) >= 0)
+	{
+		close(fd);
+		return (-1);
+	}
+	
+	return (0);
+}
+
+/**
+ * @brief Asynchronous I/O testing module.
+ * 
+ * @details Writes a file through an I/O ring, reads it back in chunks
+ * with several reads in flight, and then polls the completion queue
+ * until all of them are in.
+ * 
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int aio_test(void)
+{
+	int fd;                  /* File descriptor.  */
+	unsigned n;              /* Operations done.  */
+	struct io_ring *ring;    /* Ring.             */
+	struct io_sqe *sqe;      /* Submission entry. */
+	struct io_cqe *cqe;      /* Completion entry. */
+	static char buf[16384];  /* Buffer.           */
+	static char data[16384]; /* Read back data.   */
+	int ret = -1;            /* Return value.     */
+	
+	if ((ring = ioring_setup()) == NULL)
+		return (-1);
+	
+	fd = open("/home/aio", O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	if (fd < 0)
+		return (-1);
+	
+	for (unsigned i = 0; i < sizeof(buf); i++)
+		buf[i] = i*7;
+	
+	/* Write. */
+	sqe = &ring->sqes[ring->sq_tail & (IORING_NR_SQES - 1)];
+	sqe->opcode = IORING_OP_WRITE;
+	sqe->fd = fd;
+	sqe->buf = buf;
+	sqe->len = sizeof(buf);
+	sqe->off = 0;
+	sqe->user_data = 0xbeef;
+	ring->sq_tail++;
+	if (ioring_enter(1, 1) != 1)
+		goto out;
+	cqe = &ring->cqes[ring->cq_head & (IORING_NR_CQES - 1)];
+	if ((cqe->user_data != 0xbeef) || (cqe->res != sizeof(buf)))
+		goto out;
+	ring->cq_head++;
+	
+	/* Reads, in unaligned chunks. */
+	for (unsigned i = 0; i < 16; i++)
+	{
+		sqe = &ring->sqes[ring->sq_tail & (IORING_NR_SQES - 1)];
+		sqe->opcode = IORING_OP_READ;
+		sqe->fd = fd;
+		sqe->buf = &data[i*1000];
+		sqe->len = (i < 15) ? 1000 : sizeof(data) - 15*1000;
+		sqe->off = i*1000;
+		sqe->user_data = i;
+		ring->sq_tail++;
+	}
+	if (ioring_enter(16, 0) != 16)
+		goto out;
+	
+	/* Poll completions. */
+	for (n = 0; n < 16; /* noop */)
+	{
+		if (ring->cq_head == ring->cq_tail)
+		{
+			sched_yield();
+			continue;
+		}
+		
+		cqe = &ring->cqes[ring->cq_head & (IORING_NR_CQES - 1)];
+		if (cqe->res != (ssize_t)((cqe->user_data < 15) ? 1000 : sizeof(data) - 15*1000))
+			goto out;
+		ring->cq_head++;
+		n++;
+	}
+	
+	if (memcmp(buf, data, sizeof(buf)))
+		goto out;
+	
+	ret = 0;
+
+out:
+	close(fd);
+	unlink("/home/aio");
+	
+	return (ret);
+}
+
+/**
+ * @brief Converts a time to nanoseconds.
+ */
+static long long clock_nsecs(const struct timespec *ts)
+{
+	return (ts->tv_sec*1000000000LL + ts->tv_nsec);
+}
+
+/**
+ * @brief Catches the alarm of the clock test.
+ */
+static void clock_alarm(int sig)
+{
+	((void) sig);
+}
+
+/**
+ * @brief Clock testing module.
+ * 
+ * @details Checks that the monotonic clock never goes backwards, that
+ * it measures a second of wall clock time to within a few clock
+ * ticks, that the real time clock agrees with time(), that an alarm
+ * goes off on time while the system idles with its clock stopped, and
+ * that the time page cannot be written.
+ * 
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int clock_test(void)
+{
+	pid_t pid;             /* Child process.  */
+	int status;            /* Child status.   */
+	time_t t;              /* Wall clock.     */
+	long long ns0, ns1;    /* Monotonic time. */
+	struct timespec ts;    /* Clock reading.  */
+	
+	/* Never goes backwards. */
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ns0 = clock_nsecs(&ts);
+	for (int i = 0; i < 100000; i++)
+	{
+		if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0)
+			return (-1);
+		if ((ts.tv_nsec < 0) || (ts.tv_nsec >= 1000000000))
+			return (-1);
+		if ((ns1 = clock_nsecs(&ts)) < ns0)
+			return (-1);
+		ns0 = ns1;
+	}
+	
+	/* Time between two turns of the wall clock. */
+	t = time(NULL);
+	while (time(NULL) == t)
+		/* noop */ ;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ns0 = clock_nsecs(&ts);
+	t = time(NULL);
+	while (time(NULL) == t)
+		/* noop */ ;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ns1 = clock_nsecs(&ts);
+	if ((ns1 - ns0 < 950000000LL) || (ns1 - ns0 > 1050000000LL))
+		return (-1);
+	
+	/* Real time. */
+	if (clock_gettime(CLOCK_REALTIME, &ts) < 0)
+		return (-1);
+	if ((ts.tv_sec < time(NULL) - 1) || (ts.tv_sec > time(NULL) + 1))
+		return (-1);
+	
+	/* Bad clock. */
+	if ((clock_gettime((clockid_t)-1, &ts) != -1) || (errno != EINVAL))
+		return (-1);
+	
+	/* Alarm, while idle. */
+	signal(SIGALRM, clock_alarm);
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ns0 = clock_nsecs(&ts);
+	alarm(1);
+	pause();
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ns1 = clock_nsecs(&ts);
+	signal(SIGALRM, SIG_DFL);
+	if ((ns1 - ns0 < 950000000LL) || (ns1 - ns0 > 1100000000LL))
+		return (-1);
+	
+	/* Read-only. */
+	if ((pid = fork()) < 0)
+		return (-1);
+	if (pid == 0)
+	{
+		((struct timepage *)TIMEPAGE_ADDR)->base_sec = 0;
+		_exit(EXIT_SUCCESS);
+	}
+	wait(&status);
+	if (!WIFSIGNALED(status))
+		return (-1);
+	
+	return (0);
+}
+
+/**
+ * @brief Poll testing module.
+ * 
+ * @details Checks readiness of both ends of pipes, that poll() times
+ * out on time, that it wakes up when another process writes to one of
+ * many pipes, that it reports hang ups and invalid file descriptors,
+ * and that select() agrees with it.
+ * 
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int poll_test(void)
+{
+	pid_t pid;               /* Child process.     */
+	int ret;                 /* Return value.      */
+	char c;                  /* Working byte.      */
+	int p1[2], p2[2];        /* Pipes.             */
+	long long ns0, ns1;      /* Monotonic time.    */
+	struct timespec ts;      /* Clock reading.     */
+	struct pollfd fds[2];    /* Polled files.      */
+	struct timeval tv;       /* select() timeout.  */
+	fd_set rfds;             /* select() read set. */
+	
+	ret = -1;
+	
+	if (pipe(p1) < 0)
+		return (-1);
+	if (pipe(p2) < 0)
+		goto out1;
+	
+	/* Empty pipe. */
+	fds[0].fd = p1[0];
+	fds[0].events = POLLIN;
+	fds[1].fd = p1[1];
+	fds[1].events = POLLOUT;
+	if (poll(fds, 2, 0) != 1)
+		goto out0;
+	if ((fds[0].revents != 0) || (fds[1].revents != POLLOUT))
+		goto out0;
+	
+	/* Timeout. */
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ns0 = clock_nsecs(&ts);
+	if (poll(fds, 1, 200) != 0)
+		goto out0;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	ns1 = clock_nsecs(&ts);
+	if ((ns1 - ns0 < 190000000LL) || (ns1 - ns0 > 300000000LL))
+		goto out0;
+	
+	/* Another process writes to one of many pipes. */
+	if ((pid = fork()) < 0)
+		goto out0;
+	if (pid == 0)
+	{
+		close(p1[0]);
+		close(p2[0]);
+		c = 'x';
+		write(p2[1], &c, 1);
+		_exit(EXIT_SUCCESS);
+	}
+	close(p1[1]);
+	close(p2[1]);
+	p1[1] = p2[1] = -1;
+	
+	fds[0].fd = p1[0];
+	fds[0].events = POLLIN;
+	fds[1].fd = p2[0];
+	fds[1].events = POLLIN;
+	if (poll(fds, 2, -1) < 1)
+		goto out0;
+	if (!(fds[1].revents & POLLIN))
+		goto out0;
+	
+	/* select() agrees. */
+	FD_ZERO(&rfds);
+	FD_SET(p2[0], &rfds);
+	tv.tv_sec = 0;
+	tv.tv_usec = 0;
+	if ((select(p2[0] + 1, &rfds, NULL, NULL, &tv) != 1) || (!FD_ISSET(p2[0], &rfds)))
+		goto out0;
+	if ((read(p2[0], &c, 1) != 1) || (c != 'x'))
+		goto out0;
+	
+	/* Writers are gone. */
+	wait(NULL);
+	if (poll(fds, 2, -1) != 2)
+		goto out0;
+	if (!(fds[0].revents & POLLHUP) || !(fds[1].revents & POLLHUP))
+		goto out0;
+	
+	/* Invalid file descriptor. */
+	fds[0].fd = OPEN_MAX - 1;
+	fds[1].fd = -1;
+	if ((poll(fds, 2, 0) != 1) || (fds[0].revents != POLLNVAL) || (fds[1].revents != 0))
+		goto out0;
+	
+	ret = 0;
+	
+out0:
+	close(p2[0]);
+	if (p2[1] >= 0)
+		close(p2[1]);
+out1:
+	close(p1[0]);
+	if (p1[1] >= 0)
+		close(p1[1]);
+	
+	return (ret);
+}
+
 /*============================================================================*
  *								  sched_test								  *
  *============================================================================*/
@@ -433,6 +1061,134 @@ static int sched_test4(void)
 	return (0);
 }
 
+/*============================================================================*
+ *							  Scheduler Benchmark							  *
+ *============================================================================*/
+
+/**
+ * @brief Maximum number of worker processes in scheduler benchmarks.
+ */
+#define SCHED_BENCH_NPROCS 8
+
+/**
+ * @brief Number of sched_yield() calls issued by each worker.
+ */
+#define SCHED_BENCH_NYIELDS 4096
+
+/**
+ * @brief Number of fork() calls issued by each worker.
+ */
+#define SCHED_BENCH_NFORKS 64
+
+/**
+ * @brief Yields the processor a number of times.
+ */
+static void work_yield(void)
+{
+	for (int i = 0; i < SCHED_BENCH_NYIELDS; i++)
+		sched_yield();
+}
+
+/**
+ * @brief Forks and waits for short-lived children a number of times.
+ */
+static void work_fork(void)
+{
+	for (int i = 0; i < SCHED_BENCH_NFORKS; i++)
+	{
+		pid_t pid;
+
+		if ((pid = fork()) < 0)
+			_exit(EXIT_FAILURE);
+
+		/* Child process. */
+		else if (pid == 0)
+			_exit(EXIT_SUCCESS);
+
+		wait(NULL);
+	}
+}
+
+/**
+ * @brief Runs a workload on concurrent worker processes.
+ *
+ * @param work   Workload.
+ * @param nprocs Number of worker processes.
+ *
+ * @returns Elapsed time (in clock ticks), or a negative number if
+ * any worker has failed.
+ */
+static clock_t sched_bench_run(void (*work)(void), int nprocs)
+{
+	int status;			/* Exit status of a worker. */
+	int err = 0;		/* Any worker failed?       */
+	struct tms timing;	/* Timing information.      */
+	clock_t t0, t1;		/* Elapsed times.           */
+
+	t0 = times(&timing);
+
+	for (int i = 0; i < nprocs; i++)
+	{
+		pid_t pid;
+
+		if ((pid = fork()) < 0)
+			err = -1;
+
+		/* Child process. */
+		else if (pid == 0)
+		{
+			work();
+			_exit(EXIT_SUCCESS);
+		}
+	}
+
+	/* Wait for workers. */
+	while (wait(&status) >= 0)
+	{
+		if (!WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS))
+			err = -1;
+	}
+
+	t1 = times(&timing);
+
+	return ((err) ? -1 : t1 - t0);
+}
+
+/**
+ * @brief Scheduler benchmark.
+ *
+ * @details Measures fork() and sched_yield() throughput with an
+ * increasing number of concurrent worker processes. Running it on
+ * machines with different processor counts shows how the scheduler
+ * scales.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int sched_bench(void)
+{
+	for (int nprocs = 1; nprocs <= SCHED_BENCH_NPROCS; nprocs <<= 1)
+	{
+		clock_t tyield, tfork;
+
+		if ((tyield = sched_bench_run(work_yield, nprocs)) < 0)
+			return (-1);
+		if ((tfork = sched_bench_run(work_fork, nprocs)) < 0)
+			return (-1);
+
+		/* Print timing statistics. */
+		if (flags & VERBOSE)
+		{
+			printf("  %d procs: %d yields in %d ticks, %d forks in %d ticks\n",
+				nprocs,
+				nprocs*SCHED_BENCH_NYIELDS, tyield,
+				nprocs*SCHED_BENCH_NFORKS, tfork
+			);
+		}
+	}
+
+	return (0);
+}
+
 /*============================================================================*
  *							   Semaphores Test								  *
  *============================================================================*/
@@ -605,6 +1361,98 @@ static int sem_test_open_close(void)
 	return (0); 
 } 
 
+/**
+ * @brief Semaphore and mutex benchmark.
+ *
+ * @details Times uncontended semaphore and mutex operations, which
+ * do not enter the kernel, and a ping-pong between two processes,
+ * which sleeps and wakes up a process on every round.
+ *
+ * @returns Zero if passed on test, and non-zero otherwise.
+ */
+static int sem_bench(void)
+{
+	const int n = 10000;		   /* Number of operations. */
+	const int nrounds = 1000;	   /* Number of rounds.		*/
+	sem_t *ping, *pong;			   /* Semaphores.			*/
+	pthread_mutex_t mutex;		   /* Mutex.				*/
+	struct tms timing;			   /* Timing information.	*/
+	clock_t t0, t1, t2, t3;		   /* Elapsed times.		*/
+	pid_t pid;					   /* Child process.		*/
+
+	ping = sem_open("/home/mysem/ping", O_CREAT, 0644, 0);
+	pong = sem_open("/home/mysem/pong", O_CREAT, 0644, 0);
+	if ((ping == NULL) || (pong == NULL))
+		return (-1);
+
+	pthread_mutex_init(&mutex, NULL);
+
+	t0 = times(&timing);
+
+	/* Uncontended semaphore. */
+	for (int i = 0; i < n; i++)
+	{
+		sem_post(ping);
+		sem_wait(ping);
+	}
+
+	t1 = times(&timing);
+
+	/* Uncontended mutex. */
+	for (int i = 0; i < n; i++)
+	{
+		if (pthread_mutex_lock(&mutex))
+			return (-1);
+		pthread_mutex_unlock(&mutex);
+	}
+
+	t2 = times(&timing);
+
+	/* Mutex is not recursive. */
+	pthread_mutex_lock(&mutex);
+	if (pthread_mutex_trylock(&mutex) != EBUSY)
+		return (-1);
+	pthread_mutex_unlock(&mutex);
+	if (pthread_mutex_destroy(&mutex))
+		return (-1);
+
+	/* Ping-pong. */
+	if ((pid = fork()) < 0)
+		return (-1);
+	if (pid == 0)
+	{
+		for (int i = 0; i < nrounds; i++)
+		{
+			sem_wait(ping);
+			sem_post(pong);
+		}
+		_exit(EXIT_SUCCESS);
+	}
+	for (int i = 0; i < nrounds; i++)
+	{
+		sem_post(ping);
+		sem_wait(pong);
+	}
+	wait(NULL);
+
+	t3 = times(&timing);
+
+	sem_close(pong);
+	sem_close(ping);
+	sem_unlink("/home/mysem/pong");
+	sem_unlink("/home/mysem/ping");
+
+	/* Print timing statistics. */
+	if (flags & VERBOSE)
+	{
+		printf("  Semaphore: %d\n", t1 - t0);
+		printf("  Mutex:     %d\n", t2 - t1);
+		printf("  Ping-pong: %d\n", t3 - t2);
+	}
+
+	return (0);
+}
+
 /*============================================================================*
  *								  FPU test									  *
  *============================================================================*/
@@ -820,6 +1668,35 @@ static int test_mem0(void)
 	return (0);
 }
 
+/*
+ * @brief Passes bad buffers to read() and write().
+ */
+static int test_mem1(void)
+{
+	int fd[2];   /* Pipe.        */
+	char c;      /* Data read.   */
+	int ret = 0; /* Test result. */
+	
+	if (pipe(fd) < 0)
+		return (-1);
+	
+	if ((write(fd[1], NULL, 1) != -1) || (errno != EFAULT))
+		ret = -1;
+	if (write(fd[1], "x", 1) != 1)
+		ret = -1;
+	if ((read(fd[0], NULL, 1) != -1) || (errno != EFAULT))
+		ret = -1;
+	
+	/* Data is still there. */
+	if ((read(fd[0], &c, 1) != 1) || (c != 'x'))
+		ret = -1;
+	
+	close(fd[0]);
+	close(fd[1]);
+	
+	return (ret);
+}
+
 /*============================================================================*
  *									 main									  *
  *============================================================================*/
@@ -837,10 +1714,18 @@ static void usage(void)
 	printf("  fpu	  Floating Point Unit Test\n");
 	printf("  simd    Streaming SIMD Extensions Test\n");
 	printf("  io	  I/O Test\n");
+	printf("  vio	  Vectored and Positional I/O Test\n");
+	printf("  aio	  Asynchronous I/O Test\n");
+	printf("  clock	  Clock Test\n");
+	printf("  poll	  Poll Test\n");
+	printf("  tmpfs	  In-Memory File System Test\n");
+	printf("  proc	  Process File System Test\n");
 	printf("  ipc	  Interprocess Communication Test\n");
 	printf("  paging  Paging System Test\n");
+	printf("  tlb	  TLB Benchmark\n");
 	printf("  stack	  Stack growth Test\n");
 	printf("  sched	  Scheduling Test\n");
+	printf("  schedbench Scheduler Benchmark\n");
 	printf("  sem	  Semaphore Tests\n");
 	printf("  mem	  Memory Violation Tests\n");
 
@@ -866,6 +1751,54 @@ int main(int argc, char **argv)
 				   (!io_test()) ? "PASSED" : "FAILED");
 		}
 		
+		/* Vectored and positional I/O test. */
+		else if (!strcmp(argv[i], "vio"))
+		{
+			printf("Vectored I/O Test\n");
+			printf("  Result:			  [%s]\n", 
+				   (!vio_test()) ? "PASSED" : "FAILED");
+		}
+		
+		/* Asynchronous I/O test. */
+		else if (!strcmp(argv[i], "aio"))
+		{
+			printf("Asynchronous I/O Test\n");
+			printf("  Result:			  [%s]\n", 
+				   (!aio_test()) ? "PASSED" : "FAILED");
+		}
+		
+		/* Clock test. */
+		else if (!strcmp(argv[i], "clock"))
+		{
+			printf("Clock Test\n");
+			printf("  Result:			  [%s]\n", 
+				   (!clock_test()) ? "PASSED" : "FAILED");
+		}
+		
+		/* Poll test. */
+		else if (!strcmp(argv[i], "poll"))
+		{
+			printf("Poll Test\n");
+			printf("  Result:			  [%s]\n", 
+				   (!poll_test()) ? "PASSED" : "FAILED");
+		}
+		
+		/* In-memory file system test. */
+		else if (!strcmp(argv[i], "tmpfs"))
+		{
+			printf("In-Memory File System Test\n");
+			printf("  Result:			  [%s]\n", 
+				   (!tmpfs_test()) ? "PASSED" : "FAILED");
+		}
+		
+		/* Process file system test. */
+		else if (!strcmp(argv[i], "proc"))
+		{
+			printf("Process File System Test\n");
+			printf("  Result:			  [%s]\n", 
+				   (!proc_test()) ? "PASSED" : "FAILED");
+		}
+		
 		/* Paging system test. */
 		else if (!strcmp(argv[i], "paging"))
 		{
@@ -874,6 +1807,14 @@ int main(int argc, char **argv)
 				   (!demand_zero_test()) ? "PASSED" : "FAILED");
 		}
 
+		/* TLB benchmark. */
+		else if (!strcmp(argv[i], "tlb"))
+		{
+			printf("TLB Benchmark\n");
+			printf("  Result:			  [%s]\n",
+				   (!tlb_bench()) ? "PASSED" : "FAILED");
+		}
+
 		/* Stack growth test. */
 		else if (!strcmp(argv[i], "stack"))
 		{
@@ -896,6 +1837,14 @@ int main(int argc, char **argv)
 					!sched_test4()) ? "PASSED" : "FAILED");
 		}
 
+		/* Scheduler benchmark. */
+		else if (!strcmp(argv[i], "schedbench"))
+		{
+			printf("Scheduler Benchmark\n");
+			printf("  Result [%s]\n",
+				   (!sched_bench()) ? "PASSED" : "FAILED");
+		}
+
 		/* FPU test. */
 		else if (!strcmp(argv[i], "fpu"))
 		{
@@ -920,12 +1869,16 @@ int main(int argc, char **argv)
 				   (!sem_test_open_close()) ? "PASSED" : "FAILED");
 			printf("  producer consumer [%s]\n",
 				   (!sem_producer_consumer_test()) ? "PASSED" : "FAILED");
+			printf("  benchmark         [%s]\n",
+				   (!sem_bench()) ? "PASSED" : "FAILED");
 		}
 
 		/* Memory tests. */
 		else if (!strcmp(argv[i], "mem"))
 		{
 			printf("Memory Violation Tests\n");
+			printf("  bad buffer		[%s]\n",
+				   (!test_mem1()) ? "PASSED" : "FAILED");
 			printf("  null pointer		[%s]\n",
 				   (!test_mem0()) ? "PASSED" : "FAILED");
 		}
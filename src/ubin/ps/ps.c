@@ -17,13 +17,126 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <sys/types.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
+/* Maximum number of fields in a status file. */
+#define NR_FIELDS 32
+
+/*
+ * Status of a process.
+ */
+static struct
+{
+	int nfields;             /* Number of fields. */
+	char *keys[NR_FIELDS];   /* Field names.      */
+	char *values[NR_FIELDS]; /* Field values.     */
+	char buf[1024];          /* Raw status file.  */
+} status;
+
+/*
+ * Reads the status file of a process.
+ */
+static int status_read(const char *pid)
+{
+	int fd;         /* File descriptor. */
+	ssize_t n;      /* Bytes read.      */
+	char path[64];  /* Status file.     */
+	char *line;     /* Working line.    */
+	char *next;     /* Next line.       */
+	
+	sprintf(path, "/proc/%s/status", pid);
+	
+	/* Process is gone. */
+	if ((fd = open(path, O_RDONLY)) < 0)
+		return (-1);
+	
+	n = read(fd, status.buf, sizeof(status.buf) - 1);
+	close(fd);
+	if (n < 0)
+		return (-1);
+	status.buf[n] = '\0';
+	
+	/* Split into "key value" lines. */
+	status.nfields = 0;
+	for (line = status.buf; *line != '\0'; line = next)
+	{
+		char *sep;
+		
+		if ((next = strchr(line, '\n')) != NULL)
+			*next++ = '\0';
+		else
+			next = line + strlen(line);
+		
+		if ((sep = strchr(line, ' ')) == NULL)
+			continue;
+		*sep = '\0';
+		
+		if (status.nfields == NR_FIELDS)
+			break;
+		status.keys[status.nfields] = line;
+		status.values[status.nfields] = sep + 1;
+		status.nfields++;
+	}
+	
+	return (0);
+}
+
+/*
+ * Gets a field of the last status file read.
+ */
+static const char *status_field(const char *key)
+{
+	for (int i = 0; i < status.nfields; i++)
+	{
+		if (!strcmp(status.keys[i], key))
+			return (status.values[i]);
+	}
+	
+	return ("?");
+}
+
 /*
  * Gets and prints process information
  */
 int main()
 {
-	ps();
-	return 0;
+	DIR *dirp;         /* /proc directory. */
+	struct dirent *dp; /* Working entry.   */
+	
+	/* No procfs, so let the kernel print it. */
+	if ((dirp = opendir("/proc")) == NULL)
+	{
+		ps();
+		return (0);
+	}
+	
+	printf("%5s %5s %5s %-8s %6s %6s %6s %6s %s\n",
+		"PID", "PPID", "UID", "STATE", "UTIME", "KTIME", "MINFLT", "MAJFLT", "NAME");
+	
+	while ((dp = readdir(dirp)) != NULL)
+	{
+		/* Not a process. */
+		if ((dp->d_name[0] < '0') || (dp->d_name[0] > '9'))
+			continue;
+		
+		/* Process is gone. */
+		if (status_read(dp->d_name))
+			continue;
+		
+		printf("%5s %5s %5s %-8s %6s %6s %6s %6s %s\n",
+			status_field("pid"), status_field("ppid"), status_field("uid"),
+			status_field("state"), status_field("utime"),
+			status_field("ktime"), status_field("minflt"),
+			status_field("majflt"), status_field("name"));
+	}
+	
+	closedir(dirp);
+	
+	return (0);
 }
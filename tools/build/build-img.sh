@@ -63,7 +63,7 @@ function eject {
 }
 
 # Generate passwords file
-#   $1 Disk image name.
+#   $1 Manifest file.
 #
 function passwords
 {
@@ -74,109 +74,60 @@ function passwords
 
 	chmod 600 $file
 	
-	$QEMU_VIRT bin/cp.minix $1 $file /etc/$file $ROOTUID $ROOTGID
-	
-	# House keeping.
-	rm -f $file
+	echo "cp $file /etc/$file $ROOTUID $ROOTGID" >> $1
 }
 
 #
-# Formats a disk.
-#   $1 Disk image name.
-#   $2 Number of inodes.
-#   $3 File system size (in blocks).
+# Adds the base directories and device files to a manifest.
+#   $1 Manifest file.
 #
 function format {
-	$QEMU_VIRT bin/mkfs.minix $1 $2 $3 $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /etc $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /sbin $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /bin $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /home $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /home/rep1 $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /home/rep2 $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /dev $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mkdir.minix $1 /home/mysem/ $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mknod.minix $1 /dev/null 666 c 0 0 $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mknod.minix $1 /dev/tty 666 c 0 1 $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mknod.minix $1 /dev/klog 666 c 0 2 $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mknod.minix $1 /dev/ramdisk 666 b 0 0 $ROOTUID $ROOTGID
-	$QEMU_VIRT bin/mknod.minix $1 /dev/ramdisk1 666 b 1 0 $ROOTUID $ROOTGID
-}
-
-#
-# Copy a given folder (and its files) to a root directory disk image.
-#   $1 Disk image name.
-#   $2 Target Folder
-#
-function copy_folder
-{
-	disk="$1"
-	folder="$2"
-
-	# Seems like mkdir.minix do not works well with leading '/'
-	# lets check and remove if any
-	if [ "${folder: -1}" = "/" ];
-	then
-		folder=${folder%?}
-	fi
-
-	complete_path=$(readlink -f "$folder")
-	basefolder=$(basename "$folder")
-	prefix=$(dirname "$complete_path")
-
-	# Make directories first
-	find "$complete_path" -type d -print0 | while read -d $'\0' cfolder
-	do
-		newpath=${cfolder#"$prefix"}
-		if [ "${newpath:0:1}" != "/" ];
-		then
-			newpath="/$newpath"
-		fi
-
-		echo "Creating $newpath folder..."
-		$QEMU_VIRT bin/mkdir.minix "$disk" "$newpath" "$ROOTUID" "$ROOTGID"
-	done
-	echo ""
-
-	# Copy files
-	find "$complete_path" -type f -print0 | while read -d $'\0' cfolder
-	do
-		newpath=${cfolder#"$prefix"}
-		if [ "${newpath:0:1}" != "/" ];
-		then
-			newpath="/$newpath"
-		fi
-
-		echo "Copying $cfolder file into $newpath..."
-		$QEMU_VIRT bin/cp.minix "$disk" "$cfolder" "$newpath" "$ROOTUID" "$ROOTGID"
-	done
-	echo ""
+	cat >> $1 <<EOF
+mkdir /etc $ROOTUID $ROOTGID
+mkdir /sbin $ROOTUID $ROOTGID
+mkdir /bin $ROOTUID $ROOTGID
+mkdir /home $ROOTUID $ROOTGID
+mkdir /home/rep1 $ROOTUID $ROOTGID
+mkdir /home/rep2 $ROOTUID $ROOTGID
+mkdir /dev $ROOTUID $ROOTGID
+mkdir /tmp $ROOTUID $ROOTGID
+mkdir /proc $ROOTUID $ROOTGID
+mkdir /home/mysem/ $ROOTUID $ROOTGID
+mknod /dev/null 666 c 0 0 $ROOTUID $ROOTGID
+mknod /dev/tty 666 c 0 1 $ROOTUID $ROOTGID
+mknod /dev/klog 666 c 0 2 $ROOTUID $ROOTGID
+mknod /dev/trace 600 c 0 3 $ROOTUID $ROOTGID
+mknod /dev/tmpfs 666 c 0 4 $ROOTUID $ROOTGID
+mknod /dev/proc 444 c 0 5 $ROOTUID $ROOTGID
+mknod /dev/ramdisk 666 b 0 0 $ROOTUID $ROOTGID
+mknod /dev/ramdisk1 666 b 1 0 $ROOTUID $ROOTGID
+EOF
 }
 
 #
-# Copy files to a disk image.
-#   $1 Target disk image.
+# Adds files to a manifest.
+#   $1 Manifest file.
 #
 function copy_files
 {
 	chmod 666 tools/img/inittab
 	chmod 600 tools/img/inittab
 	
-	$QEMU_VIRT bin/cp.minix $1 tools/img/inittab /etc/inittab $ROOTUID $ROOTGID
+	echo "cp tools/img/inittab /etc/inittab $ROOTUID $ROOTGID" >> $1
 	
 	passwords $1
 	
 	for file in bin/sbin/*; do
 		filename=`basename $file`
 		if [[ "$filename" != *.sym ]]; then
-			$QEMU_VIRT bin/cp.minix $1 $file /sbin/$filename $ROOTUID $ROOTGID
+			echo "cp $file /sbin/$filename $ROOTUID $ROOTGID" >> $1
 		fi;
 	done
 	
 	for file in bin/ubin/*; do
 		filename=`basename $file`
 		if [[ "$filename" != *.sym ]]; then
-			$QEMU_VIRT bin/cp.minix $1 $file /bin/$filename $ROOTUID $ROOTGID
+			echo "cp $file /bin/$filename $ROOTUID $ROOTGID" >> $1
 		fi;
 	done
 
@@ -195,11 +146,31 @@ function copy_files
 		# Iterate over each folder and copy them into the disk image
 		for targ_folder in $(ls -d $folder/binaries/*)
 		do
-			copy_folder initrd.img $targ_folder
+			echo "tree $targ_folder /$(basename $targ_folder) $ROOTUID $ROOTGID" >> $1
 		done
 	done
 }
 
+#
+# Builds a disk image in a single pass.
+#   $1 Disk image name.
+#   $2 Number of inodes.
+#   $3 File system size (in blocks).
+#
+function build
+{
+	manifest="$1.manifest"
+
+	rm -f $manifest
+	format $manifest
+	copy_files $manifest
+
+	$QEMU_VIRT bin/mkimg.minix $1 $2 $3 $ROOTUID $ROOTGID $manifest
+	
+	# House keeping.
+	rm -f $manifest passwords
+}
+
 #
 # Strip a binary from it's debug symbols and
 # add a GNU debug link to the original binary
@@ -256,14 +227,12 @@ else
 	if [ "$BUILD_HD_IMAGE" -eq 1 ];
 	then
 		dd if=/dev/zero of=hdd.img bs=1024 count=65536
-		format hdd.img 1024 32768
-		copy_files hdd.img
+		build hdd.img 1024 32768
 	fi
 
 	# Build initrd image.
 	dd if=/dev/zero of=initrd.img bs=1024 count=65536
-	format initrd.img 1024 64535
-	copy_files initrd.img
+	build initrd.img 1024 64535
 	initrdsize=`stat -c %s initrd.img`
 	maxsize=`grep "INITRD_SIZE" include/nanvix/config.h | grep -Po "(0x[0-9]+|[0-9]+)"`
 	maxsize=`printf "%d\n" $maxsize`
@@ -0,0 +1,684 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file hal.c
+ *
+ * @brief Host abstraction layer.
+ *
+ * @details Stands in for the parts of the kernel that the file system
+ * and memory subsystems lean on, so that these run as a plain Linux
+ * process: a file-backed block device, a single fake process that is
+ * always running, spinlocks that must never be contended, and a pool
+ * of kernel pages. Page tables are kept for bookkeeping only, since
+ * user pages are never touched on the host.
+ */
+
+#include <dev/trace.h>
+#include <nanvix/clock.h>
+#include <nanvix/const.h>
+#include <nanvix/debug.h>
+#include <nanvix/dev.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/smp.h>
+#include <nanvix/spinlock.h>
+#include <sys/stat.h>
+#include <stdarg.h>
+#include <stdint.h>
+
+#include "fs/minix3/minix3.h"
+#include "fs/procfs/procfs.h"
+#include "fs/tmpfs/tmpfs.h"
+#include "mm/mm.h"
+#include "hal.h"
+#include "host.h"
+
+/**
+ * @brief Number of kernel pages in the pool.
+ */
+#define HAL_NR_KPAGES 1024
+
+/*============================================================================*
+ *                                 processor                                  *
+ *============================================================================*/
+
+/**
+ * @brief Processor.
+ */
+PRIVATE struct cpu hal_cpu;
+
+/**
+ * @brief Process on whose behalf the kernel runs.
+ */
+PUBLIC struct process hal_proc;
+
+/**
+ * @brief Are SSE2 instructions available?
+ */
+PUBLIC int fpu_sse2 = 0;
+
+/**
+ * @brief Clock ticks since system initialization.
+ */
+PUBLIC unsigned ticks = 0;
+
+/**
+ * @brief Time at system startup.
+ */
+PUBLIC unsigned startup_time = 0;
+
+/**
+ * @brief Is tracing enabled?
+ */
+PUBLIC volatile int trace_enabled = 0;
+
+/**
+ * @brief Number of held spinlocks.
+ */
+PUBLIC unsigned hal_nlocks = 0;
+
+/**
+ * @brief Records a trace event.
+ */
+PUBLIC void trace_event(unsigned event, uint32_t a0, uint32_t a1, uint32_t a2)
+{
+	UNUSED(event);
+	UNUSED(a0);
+	UNUSED(a1);
+	UNUSED(a2);
+}
+
+/**
+ * @brief Acquires a spinlock.
+ *
+ * @details There is a single flow of execution, so a spinlock
+ * that is already held will never be released.
+ */
+PUBLIC void spinlock_lock(struct spinlock *lock)
+{
+	if (lock->locked)
+		kpanic("hal: spinlock deadlock");
+
+	lock->locked = 1;
+	hal_nlocks++;
+}
+
+/**
+ * @brief Releases a spinlock.
+ */
+PUBLIC void spinlock_unlock(struct spinlock *lock)
+{
+	if (!lock->locked)
+		kpanic("hal: releasing a free spinlock");
+
+	lock->locked = 0;
+	hal_nlocks--;
+}
+
+/**
+ * @brief Puts the running process to sleep.
+ *
+ * @details Nobody else is there to wake it up.
+ */
+PUBLIC void sleep(struct process **chain, int priority)
+{
+	UNUSED(chain);
+	UNUSED(priority);
+
+	kpanic("hal: sleeping with a single process");
+}
+
+/**
+ * @brief Puts the running process to sleep, releasing a spinlock.
+ */
+PUBLIC void sleep_locked(struct process **chain, int priority, struct spinlock *lock)
+{
+	UNUSED(lock);
+
+	sleep(chain, priority);
+}
+
+/**
+ * @brief Wakes up processes that are sleeping in a chain.
+ */
+PUBLIC void wakeup(struct process **chain)
+{
+	*chain = NULL;
+}
+
+/*============================================================================*
+ *                                kernel library                              *
+ *============================================================================*/
+
+/**
+ * @brief Number of tests that have passed.
+ */
+PUBLIC unsigned hal_passed = 0;
+
+/**
+ * @brief Number of tests that have failed.
+ */
+PUBLIC unsigned hal_failed = 0;
+
+/**
+ * @brief Writes to the kernel log.
+ */
+PUBLIC ssize_t klog_write(unsigned minor, const char *buf, size_t n)
+{
+	UNUSED(minor);
+	UNUSED(buf);
+
+	return (n);
+}
+
+/**
+ * @brief Reads from the kernel log.
+ */
+PUBLIC ssize_t klog_read(unsigned minor, char *buf, size_t n)
+{
+	UNUSED(minor);
+	UNUSED(buf);
+	UNUSED(n);
+
+	return (0);
+}
+
+/**
+ * @brief Writes to a character device.
+ *
+ * @details The kernel output device is the standard output of the host.
+ */
+PUBLIC ssize_t cdev_write(dev_t dev, const void *buf, size_t n)
+{
+	UNUSED(dev);
+
+	return (host_write(1, buf, n));
+}
+
+/**
+ * @brief Panics the kernel.
+ */
+PUBLIC void kpanic(const char *fmt, ...)
+{
+	int i;
+	va_list args;
+	char buffer[KBUFFER_SIZE + 1];
+
+	va_start(args, fmt);
+	i = kvsprintf(buffer, fmt, args);
+	buffer[i++] = '\n';
+	va_end(args);
+
+	host_write(2, "PANIC: ", 7);
+	host_write(2, buffer, i);
+	host_exit(2);
+}
+
+/**
+ * @brief Registers a passed test.
+ */
+PUBLIC void tst_passed(void)
+{
+	hal_passed++;
+}
+
+/**
+ * @brief Registers a failed test.
+ */
+PUBLIC void tst_failed(void)
+{
+	hal_failed++;
+}
+
+/*============================================================================*
+ *                                block device                                *
+ *============================================================================*/
+
+/**
+ * @brief Host file that backs the root device.
+ */
+PRIVATE int hal_disk = -1;
+
+/**
+ * @brief Number of blocks read from the device.
+ */
+PUBLIC unsigned hal_nreads = 0;
+
+/**
+ * @brief Number of blocks written to the device.
+ */
+PUBLIC unsigned hal_nwrites = 0;
+
+/**
+ * @brief Asserts if a device is the root device.
+ */
+PRIVATE void hal_chkdev(dev_t dev)
+{
+	if (dev != ROOT_DEV)
+		kpanic("hal: invalid device %x", dev);
+}
+
+/**
+ * @brief Writes to the root device.
+ */
+PUBLIC ssize_t bdev_write(dev_t dev, const char *buf, size_t n, off_t off)
+{
+	hal_chkdev(dev);
+
+	return (host_pwrite(hal_disk, buf, n, off));
+}
+
+/**
+ * @brief Reads a block from the root device.
+ *
+ * @details Blocks past the end of the disk file read as zeros.
+ */
+PUBLIC void bdev_readblk(struct buffer *buf)
+{
+	ssize_t n;
+
+	hal_chkdev(buffer_dev(buf));
+
+	n = host_pread(hal_disk, buffer_data(buf), BLOCK_SIZE,
+		(uint64_t)buffer_num(buf) << BLOCK_SIZE_LOG2);
+	if (n < 0)
+		kpanic("hal: failed to read block %d", buffer_num(buf));
+	kmemset((char *)buffer_data(buf) + n, 0, BLOCK_SIZE - n);
+
+	hal_nreads++;
+
+	/* Asynchronous reads are done, too. */
+	if (buffer_is_async(buf))
+		bdone(buf);
+}
+
+/**
+ * @brief Writes a block to the root device.
+ */
+PUBLIC void bdev_writeblk(struct buffer *buf)
+{
+	hal_chkdev(buffer_dev(buf));
+
+	if (host_pwrite(hal_disk, buffer_data(buf), BLOCK_SIZE,
+		(uint64_t)buffer_num(buf) << BLOCK_SIZE_LOG2) != BLOCK_SIZE)
+		kpanic("hal: failed to write block %d", buffer_num(buf));
+
+	hal_nwrites++;
+
+	buffer_dirty(buf, 0);
+	brelse(buf);
+}
+
+/**
+ * @brief Maps a block of the root device.
+ *
+ * @details The root device is not memory-backed.
+ */
+PUBLIC void *bdev_mapblk(dev_t dev, block_t num)
+{
+	UNUSED(dev);
+	UNUSED(num);
+
+	return (NULL);
+}
+
+/*============================================================================*
+ *                                 file system                                *
+ *============================================================================*/
+
+/**
+ * @brief Minix v3 file systems are not built.
+ */
+PUBLIC void init_minix3(void)
+{
+}
+
+/**
+ * @brief The tmpfs file system is not built.
+ */
+PUBLIC void init_tmpfs(void)
+{
+}
+
+/**
+ * @brief The /proc file system is not built.
+ */
+PUBLIC void init_procfs(void)
+{
+}
+
+/**
+ * @brief Creates a file.
+ *
+ * @details Only named semaphores create files this way, and these
+ * are not built.
+ */
+PUBLIC struct inode *do_creat(struct inode *d, const char *name, mode_t mode, int oflag)
+{
+	UNUSED(d);
+	UNUSED(name);
+	UNUSED(mode);
+	UNUSED(oflag);
+
+	return (NULL);
+}
+
+/**
+ * @brief Returns access permissions of a process.
+ */
+PUBLIC mode_t permission(mode_t mode, uid_t uid, gid_t gid, struct process *proc, mode_t mask, int oreal)
+{
+	mode &= mask;
+
+	/* Super user or owner user. */
+	if ((IS_SUPERUSER(proc)) ||
+		((proc->uid == uid) || ((!oreal && proc->euid == uid))))
+		mode &= S_IRWXU | S_IRWXG | S_IRWXO;
+
+	/* Owner's group user. */
+	else if ((proc->gid == gid) || ((!oreal && proc->egid == gid)))
+		mode &= S_IRWXG | S_IRWXO;
+
+	/* Other user. */
+	else
+		mode &= S_IRWXO;
+
+	return (mode);
+}
+
+/*============================================================================*
+ *                                   memory                                   *
+ *============================================================================*/
+
+/**
+ * @brief Kernel page pool.
+ */
+PRIVATE char hal_kpages[HAL_NR_KPAGES][PAGE_SIZE]
+	__attribute__((aligned(PAGE_SIZE)));
+
+/**
+ * @brief Kernel page pool map.
+ */
+PRIVATE uint32_t hal_kpgmap[HAL_NR_KPAGES/32];
+
+/**
+ * @brief Number of kernel pages in use.
+ */
+PUBLIC unsigned hal_nkpages = 0;
+
+/**
+ * @brief Number of page tables that are mapped.
+ */
+PUBLIC unsigned hal_npgtabs = 0;
+
+/**
+ * @brief Block buffers.
+ */
+PRIVATE char hal_buffers[NR_BUFFERS*BLOCK_SIZE]
+	__attribute__((aligned(PAGE_SIZE)));
+
+/**
+ * @brief Block buffers virtual address.
+ */
+PUBLIC unsigned const BUFFERS_VIRT = (unsigned)hal_buffers;
+
+/**
+ * @brief Returns the pool index of a kernel page.
+ */
+PRIVATE unsigned hal_kpgidx(const void *kpg)
+{
+	unsigned i;
+
+	i = ((const char *)kpg - &hal_kpages[0][0]) >> PAGE_SHIFT;
+
+	/* Bad kernel page. */
+	if ((i >= HAL_NR_KPAGES) || (hal_kpages[i] != kpg))
+		kpanic("hal: bad kernel page %x", kpg);
+
+	return (i);
+}
+
+/**
+ * @brief Allocates a kernel page.
+ */
+PUBLIC void *getkpg(int clean)
+{
+	bit_t i;
+
+	i = bitmap_first_free(hal_kpgmap, sizeof(hal_kpgmap));
+	if (i == BITMAP_FULL)
+	{
+		kprintf("hal: kernel page pool overflow");
+		return (NULL);
+	}
+
+	bitmap_set(hal_kpgmap, i);
+	hal_nkpages++;
+
+	if (clean)
+		kmemset(hal_kpages[i], 0, PAGE_SIZE);
+
+	return (hal_kpages[i]);
+}
+
+/**
+ * @brief Releases a kernel page.
+ */
+PUBLIC void putkpg(void *kpg)
+{
+	unsigned i;
+
+	i = hal_kpgidx(kpg);
+
+	/* Double free. */
+	if (!(hal_kpgmap[IDX(i)] & (1 << OFF(i))))
+		kpanic("hal: double free on kernel page %x", kpg);
+
+	bitmap_clear(hal_kpgmap, i);
+	hal_nkpages--;
+}
+
+/**
+ * @brief Maps a page table into the page directory of a process.
+ */
+PUBLIC void mappgtab(struct process *proc, addr_t addr, void *pgtab)
+{
+	struct pde *pde;
+
+	pde = &proc->pgdir[PGTAB(addr)];
+
+	/* Bad page table. */
+	if (pde_is_present(pde))
+		kpanic("hal: busy page directory entry");
+
+	kmemset(pde, 0, sizeof(struct pde));
+	pde_present_set(pde, 1);
+	pde->frame = hal_kpgidx(pgtab);
+
+	hal_npgtabs++;
+}
+
+/**
+ * @brief Unmaps a page table from the page directory of a process.
+ */
+PUBLIC void umappgtab(struct process *proc, addr_t addr)
+{
+	struct pde *pde;
+
+	pde = &proc->pgdir[PGTAB(addr)];
+
+	/* Bad page table. */
+	if (!pde_is_present(pde))
+		kpanic("hal: invalid page directory entry");
+
+	kmemset(pde, 0, sizeof(struct pde));
+
+	hal_npgtabs--;
+}
+
+/**
+ * @brief Splits a large page.
+ *
+ * @details Large pages are never mapped on the host.
+ */
+PUBLIC void splitpg(struct process *proc, addr_t addr, void *pgtab)
+{
+	UNUSED(proc);
+	UNUSED(addr);
+	UNUSED(pgtab);
+}
+
+/**
+ * @brief Maps a kernel page into a page table entry.
+ */
+PUBLIC void mapkpg(struct pte *pg, void *kpg, int writable)
+{
+	kmemset(pg, 0, sizeof(struct pte));
+	pte_present_set(pg, 1);
+	pte_write_set(pg, writable);
+	pte_user_set(pg, 1);
+	pg->frame = hal_kpgidx(kpg);
+}
+
+/**
+ * @brief Marks a page for demand fill or demand zero.
+ */
+PUBLIC void markpg(struct pte *pg, int mark)
+{
+	/* Bad page. */
+	if (pte_is_present(pg))
+		kpanic("hal: demand fill on a present page");
+
+	pte_fill_set(pg, mark == PAGE_FILL);
+	pte_zero_set(pg, mark == PAGE_ZERO);
+}
+
+/**
+ * @brief Frees a user page.
+ *
+ * @details User pages are never faulted in on the host, so present
+ * pages are kernel pages that were mapped with mapkpg().
+ */
+PUBLIC void freeupg(struct pte *pg)
+{
+	/* Bad page. */
+	if (!pte_is_present(pg) && !pte_is_fill(pg) && !pte_is_zero(pg))
+	{
+		if (*(unsigned *)pg != 0)
+			kpanic("hal: freeing invalid user page");
+	}
+
+	kmemset(pg, 0, sizeof(struct pte));
+}
+
+/**
+ * @brief Copies data from a caller buffer.
+ *
+ * @details There is no user space on the host, so every buffer is a
+ * kernel buffer.
+ */
+PUBLIC int copy_from_user(void *to, const void *from, size_t n)
+{
+	kmemcpy(to, from, n);
+
+	return (0);
+}
+
+/**
+ * @brief Copies data to a caller buffer.
+ */
+PUBLIC int copy_to_user(void *to, const void *from, size_t n)
+{
+	kmemcpy(to, from, n);
+
+	return (0);
+}
+
+/**
+ * @brief Links two user pages.
+ */
+PUBLIC void linkupg(struct pte *upg1, struct pte *upg2)
+{
+	/* Set copy on write. */
+	if (pte_is_present(upg1) && pte_is_write(upg1))
+	{
+		pte_write_set(upg1, 0);
+		pte_cow_set(upg1, 1);
+	}
+
+	kmemcpy(upg2, upg1, sizeof(struct pte));
+}
+
+/*============================================================================*
+ *                               initialization                               *
+ *============================================================================*/
+
+/**
+ * @brief Initializes the host abstraction layer.
+ *
+ * @param disk Host file that backs the root device.
+ *
+ * @returns Zero upon success, and non-zero otherwise.
+ */
+PUBLIC int hal_init(const char *disk)
+{
+	unsigned eax, ebx, ecx, edx;
+
+	/* Processor. */
+	hal_cpu.self = &hal_cpu;
+	hal_cpu.curr = &hal_proc;
+	if (host_setgs(&hal_cpu, sizeof(struct cpu)))
+		return (-1);
+
+	eax = 1;
+	__asm__ __volatile__ (
+		"cpuid"
+		: "+a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+	);
+	fpu_sse2 = (edx & (1 << 26)) ? 1 : 0;
+
+	/* Process. */
+	hal_proc.state = PROC_RUNNING;
+	hal_proc.pid = 1;
+	hal_proc.uid = hal_proc.euid = hal_proc.suid = SUPERUSER;
+	hal_proc.gid = hal_proc.egid = hal_proc.sgid = SUPERGROUP;
+	hal_proc.umask = 022;
+	if ((hal_proc.pgdir = getkpg(1)) == NULL)
+		return (-1);
+	for (unsigned i = 0; i < NR_PREGIONS; i++)
+		hal_proc.pregs[i].reg = NULL;
+
+	/* Root device. */
+	if ((hal_disk = host_open(disk, HOST_O_RDWR, 0)) < 0)
+		return (-1);
+
+	return (0);
+}
+
+/**
+ * @brief Shuts down the host abstraction layer.
+ */
+PUBLIC void hal_shutdown(void)
+{
+	host_close(hal_disk);
+	hal_disk = -1;
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HAL_H_
+#define HAL_H_
+
+	#include <nanvix/const.h>
+	#include <nanvix/pm.h>
+
+	/* Forward definitions. */
+	EXTERN struct process hal_proc;
+	EXTERN unsigned hal_nlocks;
+	EXTERN unsigned hal_passed;
+	EXTERN unsigned hal_failed;
+	EXTERN unsigned hal_nreads;
+	EXTERN unsigned hal_nwrites;
+	EXTERN unsigned hal_nkpages;
+	EXTERN unsigned hal_npgtabs;
+	EXTERN int hal_init(const char *);
+	EXTERN void hal_shutdown(void);
+
+#endif /* HAL_H_ */
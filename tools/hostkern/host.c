@@ -0,0 +1,200 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "host.h"
+
+/**
+ * @name Linux i386 System Call Numbers
+ */
+/**@{*/
+#define NR_exit_group        252 /**< exit_group()      */
+#define NR_write               4 /**< write()           */
+#define NR_open                5 /**< open()            */
+#define NR_close               6 /**< close()           */
+#define NR_pread64           180 /**< pread64()         */
+#define NR_pwrite64          181 /**< pwrite64()        */
+#define NR_set_thread_area   243 /**< set_thread_area() */
+#define NR_clock_gettime     265 /**< clock_gettime()   */
+/**@}*/
+
+/**
+ * @brief Monotonic clock.
+ */
+#define CLOCK_MONOTONIC 1
+
+/**
+ * @brief Segment descriptor, as taken by set_thread_area().
+ */
+struct user_desc
+{
+	unsigned entry_number;         /**< GDT entry.            */
+	unsigned base_addr;            /**< Segment base.         */
+	unsigned limit;                /**< Segment limit.        */
+	unsigned seg_32bit       : 1;  /**< 32-bit segment?       */
+	unsigned contents        : 2;  /**< Segment type.         */
+	unsigned read_exec_only  : 1;  /**< Read only?            */
+	unsigned limit_in_pages  : 1;  /**< Limit in pages?       */
+	unsigned seg_not_present : 1;  /**< Not present?          */
+	unsigned useable         : 1;  /**< Available to user?    */
+};
+
+/**
+ * @brief Issues a Linux system call.
+ */
+static inline int host_syscall
+(int nr, unsigned a1, unsigned a2, unsigned a3, unsigned a4, unsigned a5)
+{
+	int ret;
+
+	__asm__ __volatile__ (
+		"int $0x80"
+		: "=a" (ret)
+		: "0" (nr), "b" (a1), "c" (a2), "d" (a3), "S" (a4), "D" (a5)
+		: "memory"
+	);
+
+	return (ret);
+}
+
+/**
+ * @brief Opens a host file.
+ */
+int host_open(const char *path, int flags, mode_t mode)
+{
+	return (host_syscall(NR_open, (unsigned)path, flags, mode, 0, 0));
+}
+
+/**
+ * @brief Closes a host file.
+ */
+int host_close(int fd)
+{
+	return (host_syscall(NR_close, fd, 0, 0, 0, 0));
+}
+
+/**
+ * @brief Writes to a host file.
+ */
+ssize_t host_write(int fd, const void *buf, size_t n)
+{
+	return (host_syscall(NR_write, fd, (unsigned)buf, n, 0, 0));
+}
+
+/**
+ * @brief Reads from a host file, at a given offset.
+ */
+ssize_t host_pread(int fd, void *buf, size_t n, uint64_t off)
+{
+	return (host_syscall(NR_pread64, fd, (unsigned)buf, n,
+		(unsigned)off, (unsigned)(off >> 32)));
+}
+
+/**
+ * @brief Writes to a host file, at a given offset.
+ */
+ssize_t host_pwrite(int fd, const void *buf, size_t n, uint64_t off)
+{
+	return (host_syscall(NR_pwrite64, fd, (unsigned)buf, n,
+		(unsigned)off, (unsigned)(off >> 32)));
+}
+
+/**
+ * @brief Reads the monotonic clock of the host.
+ *
+ * @returns The current time, in nanoseconds.
+ */
+uint64_t host_nsecs(void)
+{
+	struct { int32_t sec; int32_t nsec; } ts;
+
+	host_syscall(NR_clock_gettime, CLOCK_MONOTONIC, (unsigned)&ts, 0, 0, 0);
+
+	return ((uint64_t)ts.sec*1000000000ULL + ts.nsec);
+}
+
+/**
+ * @brief Points the %gs segment to a memory area.
+ *
+ * @details The kernel reaches its per-processor structure through
+ * %gs, so the HAL loads a thread-local segment that covers it.
+ *
+ * @returns Zero upon success, and a negative error code otherwise.
+ */
+int host_setgs(void *base, size_t size)
+{
+	int ret;
+	unsigned sel;
+	struct user_desc desc;
+
+	desc.entry_number = (unsigned)-1;
+	desc.base_addr = (unsigned)base;
+	desc.limit = size - 1;
+	desc.seg_32bit = 1;
+	desc.contents = 0;
+	desc.read_exec_only = 0;
+	desc.limit_in_pages = 0;
+	desc.seg_not_present = 0;
+	desc.useable = 1;
+
+	if ((ret = host_syscall(NR_set_thread_area, (unsigned)&desc, 0, 0, 0, 0)))
+		return (ret);
+
+	sel = (desc.entry_number << 3) | 3;
+	__asm__ __volatile__ ("movw %w0, %%gs" : : "r" (sel));
+
+	return (0);
+}
+
+/**
+ * @brief Terminates the program.
+ */
+void host_exit(int status)
+{
+	for (;;)
+		host_syscall(NR_exit_group, status, 0, 0, 0, 0);
+}
+
+/**
+ * @brief Program entry point.
+ *
+ * @details There is no C library underneath, so the stack that the
+ * host hands over is parsed here.
+ */
+__asm__ (
+	".globl _start\n"
+	"_start:\n"
+	"	xorl %ebp, %ebp\n"
+	"	movl %esp, %eax\n"
+	"	andl $-16, %esp\n"
+	"	subl $12, %esp\n"
+	"	pushl %eax\n"
+	"	call host_start\n"
+	"	hlt\n"
+);
+
+/**
+ * @brief Calls the main routine with the arguments of the program.
+ */
+void host_start(unsigned *sp)
+{
+	host_exit(hostkern_main((int)sp[0], (char **)&sp[1]));
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HOST_H_
+#define HOST_H_
+
+	#include <stdint.h>
+	#include <sys/types.h>
+
+	/**
+	 * @name Host File Flags
+	 *
+	 * @details Flags of the Linux open() system call, which differ
+	 * from the ones of Nanvix.
+	 */
+	/**@{*/
+	#define HOST_O_RDONLY 00000 /**< Read only.          */
+	#define HOST_O_RDWR   00002 /**< Read and write.     */
+	#define HOST_O_CREAT  00100 /**< Create file.        */
+	#define HOST_O_TRUNC  01000 /**< Truncate file.      */
+	/**@}*/
+
+	/* Forward definitions. */
+	extern int host_open(const char *, int, mode_t);
+	extern int host_close(int);
+	extern ssize_t host_write(int, const void *, size_t);
+	extern ssize_t host_pread(int, void *, size_t, uint64_t);
+	extern ssize_t host_pwrite(int, const void *, size_t, uint64_t);
+	extern uint64_t host_nsecs(void);
+	extern int host_setgs(void *, size_t);
+	extern void host_exit(int);
+
+	/* Forward definitions. */
+	extern int hostkern_main(int, char **);
+
+#endif /* HOST_H_ */
@@ -0,0 +1,844 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file hostkern.c
+ *
+ * @brief Host-native benchmarks and stress tests.
+ *
+ * @details Runs the block buffer cache, the Minix file system, the
+ * bitmap library and the memory region manager of the kernel as a
+ * Linux process, on top of the host abstraction layer. Benchmarks
+ * run fixed workloads, and stress tests draw random operations from
+ * a seeded generator and check the outcome against a model, so that
+ * a given seed always replays the very same run.
+ */
+
+#include <nanvix/const.h>
+#include <nanvix/config.h>
+#include <nanvix/fs.h>
+#include <nanvix/klib.h>
+#include <nanvix/mm.h>
+#include <nanvix/pm.h>
+#include <nanvix/region.h>
+#include <sys/stat.h>
+#include <stdint.h>
+
+#include "fs/fs.h"
+#include "hal.h"
+#include "host.h"
+
+/**
+ * @name Benchmark iterations
+ */
+/**@{*/
+#define HK_NHITS      100000        /**< Block buffer cache hits.   */
+#define HK_NMISSES    (8*NR_BUFFERS) /**< Block buffer cache misses. */
+#define HK_BITMAP_SIZE 4096         /**< Bitmap size (in bytes).    */
+#define HK_FILE_SIZE  (256*1024)    /**< Bytes written to a file.   */
+#define HK_NFILES     256           /**< Files created and removed. */
+#define HK_NLOOKUPS   10000         /**< Path name lookups.         */
+#define HK_NREGIONS   1000          /**< Memory regions attached.   */
+/**@}*/
+
+/**
+ * @name Stress test parameters
+ */
+/**@{*/
+#define HK_STRESS_NFILES   8           /**< Files.                      */
+#define HK_STRESS_FILE_MAX (128*1024)  /**< Maximum file size.          */
+#define HK_STRESS_IO_MAX   (8*1024)    /**< Maximum bytes per I/O.      */
+#define HK_STRESS_NSLOTS   4           /**< Memory region slots.        */
+#define HK_STRESS_NPAGES   1536        /**< Maximum pages per region.   */
+/**@}*/
+
+/**
+ * @brief File used by benchmarks.
+ */
+#define HK_BENCH_FILE "/hostkern.bench"
+
+/**
+ * @brief Seed of the random number generator.
+ */
+PRIVATE uint32_t hk_seed = 1;
+
+/**
+ * @brief Number of operations run by each stress test.
+ */
+PRIVATE unsigned hk_nops = 10000;
+
+/**
+ * @brief Stress test file contents.
+ */
+PRIVATE char hk_files[HK_STRESS_NFILES][HK_STRESS_FILE_MAX];
+
+/**
+ * @brief Stress test file sizes.
+ */
+PRIVATE size_t hk_sizes[HK_STRESS_NFILES];
+
+/**
+ * @brief Do stress test files exist?
+ */
+PRIVATE int hk_exists[HK_STRESS_NFILES];
+
+/**
+ * @brief I/O buffer.
+ */
+PRIVATE char hk_buf[HK_STRESS_IO_MAX];
+
+/*============================================================================*
+ *                                  helpers                                   *
+ *============================================================================*/
+
+/**
+ * @brief Draws a pseudo-random number.
+ */
+PRIVATE uint32_t hk_rand(void)
+{
+	hk_seed ^= hk_seed << 13;
+	hk_seed ^= hk_seed >> 17;
+	hk_seed ^= hk_seed << 5;
+
+	return (hk_seed);
+}
+
+/**
+ * @brief Converts a string to an unsigned integer.
+ *
+ * @returns The number, or zero if the string is not a number.
+ */
+PRIVATE unsigned hk_atou(const char *str)
+{
+	unsigned n = 0;
+
+	for (; *str != '\0'; str++)
+	{
+		if ((*str < '0') || (*str > '9'))
+			return (0);
+		n = n*10 + (*str - '0');
+	}
+
+	return (n);
+}
+
+/**
+ * @brief Reports a benchmark.
+ *
+ * @param name Benchmark name.
+ * @param t0   Start time (in nanoseconds).
+ * @param nops Number of operations.
+ */
+PRIVATE void hk_report(const char *name, uint64_t t0, unsigned nops)
+{
+	uint64_t ns;
+
+	ns = host_nsecs() - t0;
+
+	/* There is no 64-bit division. */
+	while ((ns >> 32) && (nops > 1))
+	{
+		ns >>= 1;
+		nops >>= 1;
+	}
+
+	kprintf("bench %s %d ns", name, (unsigned)ns/nops);
+}
+
+/**
+ * @brief Reports a test failure.
+ */
+#define hk_fail(test, why)                                    \
+	do {                                                      \
+		kprintf("test %s failed: %s (op %d)", test, why, op); \
+		return (-1);                                          \
+	} while (0)
+
+/**
+ * @brief Builds the path name of a stress test file.
+ */
+PRIVATE const char *hk_path(unsigned n)
+{
+	PRIVATE char path[] = "/hostkern.0";
+
+	path[sizeof(path) - 2] = '0' + n;
+
+	return (path);
+}
+
+/**
+ * @brief Opens a file.
+ *
+ * @param path   Path name of the file.
+ * @param create Create the file if it does not exist?
+ *
+ * @returns Upon success, a pointer to the unlocked inode of the file
+ * is returned. Upon failure, a NULL pointer is returned instead.
+ */
+PRIVATE struct inode *hk_open(const char *path, int create)
+{
+	ino_t num;
+	const char *name;
+	struct inode *dip, *ip;
+
+	if ((dip = inode_dname(path, &name)) == NULL)
+		return (NULL);
+
+	/* Open file. */
+	if ((num = dir_search(dip, name)) != INODE_NULL)
+	{
+		inode_put(dip);
+		if ((ip = inode_get(ROOT_DEV, num)) == NULL)
+			return (NULL);
+		inode_unlock(ip);
+		return (ip);
+	}
+
+	/* Create file. */
+	if (!create)
+	{
+		inode_put(dip);
+		return (NULL);
+	}
+	if ((ip = inode_alloc(dip->sb)) == NULL)
+	{
+		inode_put(dip);
+		return (NULL);
+	}
+	ip->mode = (S_IRUSR | S_IWUSR) | S_IFREG;
+	if (dir_add(dip, ip, name))
+	{
+		inode_put(ip);
+		inode_put(dip);
+		return (NULL);
+	}
+	inode_put(dip);
+	inode_unlock(ip);
+
+	return (ip);
+}
+
+/**
+ * @brief Closes a file opened with hk_open().
+ */
+PRIVATE void hk_close(struct inode *ip)
+{
+	inode_lock(ip);
+	inode_put(ip);
+}
+
+/**
+ * @brief Truncates a file.
+ */
+PRIVATE void hk_truncate(struct inode *ip)
+{
+	inode_lock(ip);
+	inode_truncate(ip);
+	inode_unlock(ip);
+}
+
+/**
+ * @brief Removes a file.
+ *
+ * @returns Zero upon success, and non-zero otherwise.
+ */
+PRIVATE int hk_unlink(const char *path)
+{
+	int ret;
+	const char *name;
+	struct inode *dip;
+
+	if ((dip = inode_dname(path, &name)) == NULL)
+		return (-1);
+
+	ret = dir_remove(dip, name);
+	inode_put(dip);
+
+	return (ret);
+}
+
+/**
+ * @brief Mounts the root file system.
+ *
+ * @returns Zero upon success, and non-zero otherwise.
+ */
+PRIVATE int hk_mount(void)
+{
+	struct superblock *sb;
+	struct inode *root;
+
+	binit();
+	inode_init();
+	superblock_init();
+
+	if ((sb = superblock_read(ROOT_DEV)) == NULL)
+		return (-1);
+	mountRoot(sb->fs);
+	superblock_unlock(sb);
+
+	if ((root = inode_get(ROOT_DEV, 1)) == NULL)
+		return (-1);
+	hal_proc.pwd = root;
+	hal_proc.root = root;
+	root->count += 2;
+	inode_unlock(root);
+
+	return (0);
+}
+
+/**
+ * @brief Flushes the file system.
+ */
+PRIVATE void hk_sync(void)
+{
+	inode_sync();
+	superblock_sync();
+	bsync();
+}
+
+/*============================================================================*
+ *                                benchmarks                                  *
+ *============================================================================*/
+
+/**
+ * @brief Benchmarks bitmap searches.
+ */
+PRIVATE void bench_bitmap(void)
+{
+	uint64_t t0;
+	bit_t bit;
+	PRIVATE uint32_t bitmap[HK_BITMAP_SIZE/sizeof(uint32_t)];
+
+	kmemset(bitmap, 0, sizeof(bitmap));
+
+	t0 = host_nsecs();
+	while ((bit = bitmap_first_free(bitmap, sizeof(bitmap))) != BITMAP_FULL)
+		bitmap_set(bitmap, bit);
+	hk_report("bitmap_first_free", t0, HK_BITMAP_SIZE*8);
+}
+
+/**
+ * @brief Benchmarks the block buffer cache.
+ */
+PRIVATE void bench_buffer(void)
+{
+	uint64_t t0;
+	unsigned nreads;
+	struct buffer *buf;
+
+	/* Cache hits. */
+	brelse(bread(ROOT_DEV, 1));
+	t0 = host_nsecs();
+	for (int i = 0; i < HK_NHITS; i++)
+		brelse(bread(ROOT_DEV, 1));
+	hk_report("bread_hit", t0, HK_NHITS);
+
+	/* Cache misses. */
+	nreads = hal_nreads;
+	t0 = host_nsecs();
+	for (int i = 0; i < HK_NMISSES; i++)
+	{
+		buf = bread(ROOT_DEV, 2 + (i % (2*NR_BUFFERS)));
+		brelse(buf);
+	}
+	hk_report("bread_miss", t0, HK_NMISSES);
+	kprintf("bench bread_miss_reads %d blocks", hal_nreads - nreads);
+}
+
+/**
+ * @brief Benchmarks the Minix file system.
+ *
+ * @returns Zero upon success, and non-zero otherwise.
+ */
+PRIVATE int bench_fs(void)
+{
+	uint64_t t0;
+	struct inode *ip, *ip2;
+
+	if ((ip = hk_open(HK_BENCH_FILE, 1)) == NULL)
+		return (-1);
+
+	/* Sequential writes. */
+	kmemset(hk_buf, 0xa5, BLOCK_SIZE);
+	t0 = host_nsecs();
+	for (off_t off = 0; off < HK_FILE_SIZE; off += BLOCK_SIZE)
+	{
+		if (file_write(ip, hk_buf, BLOCK_SIZE, off) != BLOCK_SIZE)
+			goto error;
+	}
+	hk_report("file_write", t0, HK_FILE_SIZE/BLOCK_SIZE);
+
+	/* Sequential reads. */
+	t0 = host_nsecs();
+	for (off_t off = 0; off < HK_FILE_SIZE; off += BLOCK_SIZE)
+	{
+		if (file_read(ip, hk_buf, BLOCK_SIZE, off) != BLOCK_SIZE)
+			goto error;
+	}
+	hk_report("file_read", t0, HK_FILE_SIZE/BLOCK_SIZE);
+
+	/* Path name lookups. */
+	t0 = host_nsecs();
+	for (int i = 0; i < HK_NLOOKUPS; i++)
+	{
+		if ((ip2 = inode_name(HK_BENCH_FILE)) == NULL)
+			goto error;
+		inode_put(ip2);
+	}
+	hk_report("inode_name", t0, HK_NLOOKUPS);
+
+	hk_truncate(ip);
+	hk_close(ip);
+	if (hk_unlink(HK_BENCH_FILE))
+		return (-1);
+
+	/* File creation and removal. */
+	t0 = host_nsecs();
+	for (int i = 0; i < HK_NFILES; i++)
+	{
+		if ((ip = hk_open(HK_BENCH_FILE, 1)) == NULL)
+			return (-1);
+		hk_close(ip);
+		if (hk_unlink(HK_BENCH_FILE))
+			return (-1);
+	}
+	hk_report("creat_unlink", t0, HK_NFILES);
+
+	return (0);
+
+error:
+	hk_close(ip);
+	return (-1);
+}
+
+/**
+ * @brief Benchmarks the memory region manager.
+ *
+ * @returns Zero upon success, and non-zero otherwise.
+ */
+PRIVATE int bench_region(void)
+{
+	uint64_t t0;
+	struct region *reg;
+	struct pregion *preg;
+
+	preg = &hal_proc.pregs[0];
+
+	t0 = host_nsecs();
+	for (int i = 0; i < HK_NREGIONS; i++)
+	{
+		reg = allocreg(S_IRUSR | S_IWUSR, PAGE_SIZE, REGION_UPWARDS);
+		if (reg == NULL)
+			return (-1);
+		if (attachreg(&hal_proc, preg, UBASE_VIRT, reg))
+		{
+			freereg(reg);
+			return (-1);
+		}
+		unlockreg(reg);
+
+		lockreg(reg);
+		if (growreg(&hal_proc, preg, 16*PAGE_SIZE))
+		{
+			unlockreg(reg);
+			detachreg(&hal_proc, preg);
+			return (-1);
+		}
+		unlockreg(reg);
+
+		detachreg(&hal_proc, preg);
+	}
+	hk_report("region", t0, HK_NREGIONS);
+
+	return (0);
+}
+
+/*============================================================================*
+ *                               stress tests                                 *
+ *============================================================================*/
+
+/**
+ * @brief Checks that a stress test file matches the model.
+ *
+ * @returns Zero if the file matches, and non-zero otherwise.
+ */
+PRIVATE int stress_fs_check(struct inode *ip, unsigned n, off_t off, size_t len)
+{
+	if ((size_t)ip->size != hk_sizes[n])
+		return (-1);
+
+	if (file_read(ip, hk_buf, len, off) != (ssize_t)len)
+		return (-1);
+
+	for (size_t i = 0; i < len; i++)
+	{
+		if (hk_buf[i] != hk_files[n][off + i])
+			return (-1);
+	}
+
+	return (0);
+}
+
+/**
+ * @brief Stress tests the Minix file system.
+ *
+ * @details Writes, reads, truncates and removes a small set of files,
+ * and checks every read against an in-memory model of the files.
+ * Files are only ever extended by writes that start at or before
+ * their end.
+ *
+ * @returns Zero upon success, and non-zero otherwise.
+ */
+PRIVATE int stress_fs(void)
+{
+	unsigned op;
+	struct inode *ip;
+
+	for (op = 0; op < hk_nops; op++)
+	{
+		unsigned n;
+		off_t off;
+		size_t len;
+		uint32_t action;
+
+		n = hk_rand() % HK_STRESS_NFILES;
+		action = hk_rand() % 16;
+
+		/* Remove file. */
+		if (action == 0)
+		{
+			if ((hk_unlink(hk_path(n)) == 0) != hk_exists[n])
+				hk_fail("stress_fs", "dir_remove");
+			hk_exists[n] = 0;
+			hk_sizes[n] = 0;
+			continue;
+		}
+
+		/* Flush file system. */
+		if (action == 1)
+		{
+			hk_sync();
+			continue;
+		}
+
+		if ((ip = hk_open(hk_path(n), 1)) == NULL)
+			hk_fail("stress_fs", "open");
+		hk_exists[n] = 1;
+
+		/* Truncate file. */
+		if (action == 2)
+		{
+			hk_truncate(ip);
+			hk_sizes[n] = 0;
+			if (ip->size != 0)
+			{
+				hk_close(ip);
+				hk_fail("stress_fs", "inode_truncate");
+			}
+		}
+
+		/* Write to file. */
+		else if (action < 10)
+		{
+			off = hk_rand() % (hk_sizes[n] + 1);
+			len = 1 + hk_rand() % HK_STRESS_IO_MAX;
+			if (off + len > HK_STRESS_FILE_MAX)
+				len = HK_STRESS_FILE_MAX - off;
+
+			for (size_t i = 0; i < len; i++)
+				hk_buf[i] = hk_rand();
+			if (file_write(ip, hk_buf, len, off) != (ssize_t)len)
+			{
+				hk_close(ip);
+				hk_fail("stress_fs", "file_write");
+			}
+
+			kmemcpy(&hk_files[n][off], hk_buf, len);
+			if (off + len > hk_sizes[n])
+				hk_sizes[n] = off + len;
+		}
+
+		/* Read from file. */
+		else if (hk_sizes[n] > 0)
+		{
+			off = hk_rand() % hk_sizes[n];
+			len = 1 + hk_rand() % HK_STRESS_IO_MAX;
+			if (off + len > hk_sizes[n])
+				len = hk_sizes[n] - off;
+
+			if (stress_fs_check(ip, n, off, len))
+			{
+				hk_close(ip);
+				hk_fail("stress_fs", "file_read");
+			}
+		}
+
+		hk_close(ip);
+
+		if (hal_nlocks != 0)
+			hk_fail("stress_fs", "spinlock held");
+	}
+
+	/* Read everything back from the disk. */
+	hk_sync();
+	for (op = 0; op < HK_STRESS_NFILES; op++)
+	{
+		if ((ip = hk_open(hk_path(op), 0)) == NULL)
+		{
+			if (hk_exists[op])
+				hk_fail("stress_fs", "lost file");
+			continue;
+		}
+		if (!hk_exists[op])
+		{
+			hk_close(ip);
+			hk_fail("stress_fs", "removed file");
+		}
+		for (off_t off = 0; off < (off_t)hk_sizes[op]; off += HK_STRESS_IO_MAX)
+		{
+			size_t len = hk_sizes[op] - off;
+			if (len > HK_STRESS_IO_MAX)
+				len = HK_STRESS_IO_MAX;
+			if (stress_fs_check(ip, op, off, len))
+			{
+				hk_close(ip);
+				hk_fail("stress_fs", "file contents");
+			}
+		}
+		hk_close(ip);
+	}
+
+	kprintf("test stress_fs passed");
+
+	return (0);
+}
+
+/**
+ * @brief Returns the address where a stress test slot is attached.
+ *
+ * @details Even slots grow upwards from the start of a 256 MB window,
+ * and odd slots grow downwards from its end.
+ */
+PRIVATE addr_t stress_mm_addr(unsigned slot)
+{
+	addr_t base;
+
+	base = 0x10000000*(slot + 1);
+
+	return ((slot & 1) ? base + 0x0fffffff : base);
+}
+
+/**
+ * @brief Stress tests the memory region manager.
+ *
+ * @details Attaches, grows, shrinks, duplicates and detaches memory
+ * regions at random, and checks the process size, the page tables
+ * that are mapped and the kernel pages that are in use.
+ *
+ * @returns Zero upon success, and non-zero otherwise.
+ */
+PRIVATE int stress_mm(void)
+{
+	unsigned op;
+	unsigned nkpages;
+	struct region *reg;
+	struct pregion *preg;
+
+	nkpages = hal_nkpages;
+
+	for (op = 0; op < hk_nops; op++)
+	{
+		unsigned slot;
+		ssize_t size;
+		uint32_t action;
+
+		slot = hk_rand() % HK_STRESS_NSLOTS;
+		action = hk_rand() % 8;
+		preg = &hal_proc.pregs[slot];
+
+		/* Attach region. */
+		if ((reg = preg->reg) == NULL)
+		{
+			size = (hk_rand() % HK_STRESS_NPAGES)*PAGE_SIZE;
+			reg = allocreg(S_IRUSR | S_IWUSR, size,
+				(slot & 1) ? REGION_DOWNWARDS : REGION_UPWARDS);
+			if (reg == NULL)
+				hk_fail("stress_mm", "allocreg");
+			if (attachreg(&hal_proc, preg, stress_mm_addr(slot), reg))
+				hk_fail("stress_mm", "attachreg");
+			unlockreg(reg);
+		}
+
+		/* Detach region. */
+		else if (action == 0)
+			detachreg(&hal_proc, preg);
+
+		/* Duplicate region. */
+		else if (action == 1)
+		{
+			struct region *new_reg;
+
+			lockreg(reg);
+			new_reg = dupreg(reg);
+			unlockreg(reg);
+			if (new_reg == NULL)
+				hk_fail("stress_mm", "dupreg");
+			if (new_reg->size != reg->size)
+				hk_fail("stress_mm", "dupreg size");
+			unlockreg(new_reg);
+			freereg(new_reg);
+		}
+
+		/* Grow or shrink region. */
+		else
+		{
+			size = (hk_rand() % HK_STRESS_NPAGES)*PAGE_SIZE;
+			if (action & 1)
+				size = -((size > (ssize_t)reg->size) ? (ssize_t)reg->size : size);
+			else if (reg->size + size > HK_STRESS_NPAGES*PAGE_SIZE)
+				size = 0;
+
+			lockreg(reg);
+			if (growreg(&hal_proc, preg, size))
+			{
+				unlockreg(reg);
+				hk_fail("stress_mm", "growreg");
+			}
+			unlockreg(reg);
+		}
+
+		/* Check process size. */
+		size = 0;
+		for (unsigned i = 0; i < HK_STRESS_NSLOTS; i++)
+		{
+			if (hal_proc.pregs[i].reg != NULL)
+				size += hal_proc.pregs[i].reg->size;
+		}
+		if ((size_t)size != hal_proc.size)
+			hk_fail("stress_mm", "process size");
+		if (hal_nlocks != 0)
+			hk_fail("stress_mm", "spinlock held");
+	}
+
+	/* Nothing may leak. */
+	for (unsigned i = 0; i < HK_STRESS_NSLOTS; i++)
+		detachreg(&hal_proc, &hal_proc.pregs[i]);
+	if (hal_proc.size != 0)
+		hk_fail("stress_mm", "process size");
+	if (hal_npgtabs != 0)
+		hk_fail("stress_mm", "page table leak");
+	if (hal_nkpages != nkpages)
+		hk_fail("stress_mm", "kernel page leak");
+
+	kprintf("test stress_mm passed");
+
+	return (0);
+}
+
+/*============================================================================*
+ *                                   main                                     *
+ *============================================================================*/
+
+/**
+ * @brief Prints program usage and exits.
+ */
+PRIVATE void usage(void)
+{
+	kprintf("usage: hostkern [-s seed] [-n ops] <disk>");
+	host_exit(1);
+}
+
+/**
+ * @brief Host-native benchmarks and stress tests.
+ */
+PUBLIC int hostkern_main(int argc, char **argv)
+{
+	int passed = 0;
+	int failed = 0;
+	const char *disk = NULL;
+
+	/* Parse command line arguments. */
+	for (int i = 1; i < argc; i++)
+	{
+		if ((!kstrcmp(argv[i], "-s")) && (i + 1 < argc))
+		{
+			if ((hk_seed = hk_atou(argv[++i])) == 0)
+				usage();
+		}
+		else if ((!kstrcmp(argv[i], "-n")) && (i + 1 < argc))
+			hk_nops = hk_atou(argv[++i]);
+		else if (disk == NULL)
+			disk = argv[i];
+		else
+			usage();
+	}
+	if (disk == NULL)
+		usage();
+
+	if (hal_init(disk))
+	{
+		kprintf("hostkern: cannot open %s", disk);
+		return (1);
+	}
+	if (hk_mount())
+	{
+		kprintf("hostkern: cannot mount %s", disk);
+		return (1);
+	}
+	initreg();
+
+	kprintf("hostkern: seed %d, %d operations", hk_seed, hk_nops);
+
+	/* Kernel tests. */
+	test_mm();
+
+	/* Benchmarks. */
+	bench_bitmap();
+	bench_buffer();
+	if (bench_fs())
+	{
+		kprintf("bench fs failed");
+		failed++;
+	}
+	if (bench_region())
+	{
+		kprintf("bench region failed");
+		failed++;
+	}
+
+	/* Stress tests. */
+	if (stress_fs())
+		failed++;
+	else
+		passed++;
+	if (stress_mm())
+		failed++;
+	else
+		passed++;
+
+	hk_sync();
+	hal_shutdown();
+
+	kprintf("hostkern: %d block reads, %d block writes, %d/%d buffer hits",
+		hal_nreads, hal_nwrites, buffer_hits, buffer_hits + buffer_misses);
+	kprintf("hostkern: %d passed, %d failed",
+		hal_passed + passed, hal_failed + failed);
+
+	return ((hal_failed + failed) ? 1 : 0);
+}
@@ -54,6 +54,15 @@
 	#define bitmap_clear(bitmap, pos) \
 		(((uint32_t *)(bitmap))[IDX(pos)] &= ~(0x1 << OFF(pos)))
 	
+	/**
+	 * @brief Tests a bit in a bitmap.
+	 * 
+	 * @param bitmap Bitmap where the bit should be tested.
+	 * @param pos    Position of the bit that shall be tested.
+	 */
+	#define bitmap_test(bitmap, pos) \
+		((((uint32_t *)(bitmap))[IDX(pos)] >> OFF(pos)) & 0x1)
+	
 	/**
 	 * @name Bitmap Functions
 	 */
@@ -0,0 +1,53 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "minix.h"
+#include "util.h"
+
+/**
+ * @brief Prints program usage and exits.
+ */
+static void usage(void)
+{
+	printf("usage: defrag.minix <input file>\n");
+	exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Defragments a Minix file system.
+ */
+int main(int argc, char **argv)
+{
+	unsigned nextents; /* Contiguous runs of zones before. */
+	
+	/* Wrong usage. */
+	if (argc != 2)
+		usage();
+	
+	minix_mount(argv[1]);
+	nextents = minix_defrag();
+	minix_umount();
+	
+	printf("defrag.minix: %s: %u extents before defragmentation\n", argv[1], nextents);
+	
+	return (EXIT_SUCCESS);
+}
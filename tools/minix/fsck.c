@@ -0,0 +1,69 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "minix.h"
+#include "util.h"
+
+/**
+ * @brief Prints program usage and exits.
+ */
+static void usage(void)
+{
+	printf("usage: fsck.minix [-n] <input file>\n");
+	exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Checks and repairs a Minix file system.
+ * 
+ * @details The -n flag only reports inconsistencies, without repairing
+ *          them. Exits with a non-zero status if some inconsistency was
+ *          found.
+ */
+int main(int argc, char **argv)
+{
+	bool repair;       /* Repair inconsistencies? */
+	unsigned nerrors;  /* Inconsistencies found.  */
+	
+	/* Check only. */
+	repair = !((argc > 1) && (!strcmp(argv[1], "-n")));
+	if (!repair)
+	{
+		argc--;
+		argv++;
+	}
+	
+	/* Wrong usage. */
+	if (argc != 2)
+		usage();
+	
+	minix_mount(argv[1]);
+	nerrors = minix_fsck(repair);
+	minix_umount();
+	
+	printf("fsck.minix: %s: %u inconsistencies %s\n", argv[1], nerrors,
+		(repair) ? "repaired" : "found");
+	
+	return ((nerrors == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -40,12 +40,12 @@ static void usage(void)
  */
 int main(int argc, char **argv)
 {
-	int fd;                            /* File ID of source file.  */
-	char filename[MINIX_NAME_MAX + 1]; /* Name of the file.        */
-	char *buf;                         /* Buffer used for copying. */
-	uint16_t num;                      /* Working inode number.    */
-	struct d_inode *ip;                /* Working inode pointer.   */
-	size_t len;                        /* Bytes read.              */
+	int fd;                             /* File ID of source file.  */
+	char filename[MINIX3_NAME_MAX + 1]; /* Name of the file.        */
+	char *buf;                          /* Buffer used for copying. */
+	uint16_t num;                       /* Working inode number.    */
+	struct minix_inode *ip;             /* Working inode pointer.   */
+	size_t len;                         /* Bytes read.              */
 	
 	/* Wrong usage. */
 	if (argc != 3)
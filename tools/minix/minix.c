@@ -17,8 +17,10 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <fcntl.h>
+#include <stdarg.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -34,13 +36,115 @@
 /**
  * @brief Mounted superblock.
  */
-static struct d_superblock super;
+static union
+{
+	struct d_superblock v1;    /**< Minix v1 superblock. */
+	struct d_superblock_v3 v3; /**< Minix v3 superblock. */
+} super;
+
+/**
+ * @brief Geometry of the mounted Minix file system.
+ * 
+ * @details Minix v1 and v3 file systems share the same layout, but they
+ *          differ in the size of blocks, zone numbers, inodes and directory
+ *          entries.
+ */
+static struct
+{
+	bool v3;                   /**< Minix v3 file system?       */
+	size_t bsize;              /**< Block size (in bytes).      */
+	size_t zsize;              /**< Zone number size.           */
+	size_t isize;              /**< Disk inode size.            */
+	size_t dsize;              /**< Directory entry size.       */
+	size_t name_max;           /**< Maximum file name length.   */
+	unsigned nlevels;          /**< Indirection levels.         */
+	uint32_t ninodes;          /**< Number of inodes.           */
+	uint32_t nblocks;          /**< Number of blocks.           */
+	uint32_t imap_nblocks;     /**< Number of inode map blocks. */
+	uint32_t bmap_nblocks;     /**< Number of block map blocks. */
+	uint32_t first_data_block; /**< First data block.           */
+	uint32_t max_size;         /**< Maximum file size.          */
+} fs;
 
 /**
  * @brief Identifier of the file where the mounted Minix file system resides.
  */
 static int fd = -1;
 
+/**
+ * @brief In-memory image of the mounted Minix file system.
+ * 
+ * @details The whole disk file is mapped into memory when the file system
+ *          is mounted, so that inodes, directory entries and data blocks
+ *          are accessed with plain memory copies. Only pages that are
+ *          actually touched are read in, and dirty pages are written back
+ *          to the disk file once, when the file system is unmounted.
+ */
+static struct
+{
+	char *data;  /**< Mapped disk file.             */
+	size_t size; /**< Size of mapping (in bytes).   */
+} image = { NULL, 0 };
+
+/**
+ * @brief Maps the first @p size bytes of the disk file into memory.
+ * 
+ * @param size Size of the mapping (in bytes).
+ */
+static void minix_image_map(size_t size)
+{
+	void *p;
+	
+	p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (p == MAP_FAILED)
+		error("cannot mmap()");
+	
+	image.data = p;
+	image.size = size;
+}
+
+/**
+ * @brief Unmaps the disk file, flushing dirty pages to it.
+ */
+static void minix_image_unmap(void)
+{
+	if (munmap(image.data, image.size) == -1)
+		error("cannot munmap()");
+	
+	image.data = NULL;
+	image.size = 0;
+}
+
+/**
+ * @brief Reads from the mounted Minix file system.
+ * 
+ * @param off Offset in the disk file.
+ * @param buf Target buffer.
+ * @param n   Number of bytes to read.
+ */
+static void minix_pread(off_t off, void *buf, size_t n)
+{
+	if ((off < 0) || ((size_t)off > image.size) || (n > image.size - off))
+		error("read past end of disk file");
+	
+	memcpy(buf, image.data + off, n);
+}
+
+/**
+ * @brief Writes to the mounted Minix file system.
+ * 
+ * @param off Offset in the disk file.
+ * @param buf Source buffer.
+ * @param n   Number of bytes to write.
+ */
+static void minix_pwrite(off_t off, const void *buf, size_t n)
+{
+	if ((off < 0) || ((size_t)off > image.size) || (n > image.size - off))
+		error("write past end of disk file");
+	
+	memcpy(image.data + off, buf, n);
+}
+
 /**
  * @brief Inode map.
  */
@@ -59,28 +163,69 @@ static struct
 	uint32_t *bitmap; /**< Bitmap.                   */
 } zmap;
 
+/**
+ * @brief Sets up the geometry of a Minix file system.
+ * 
+ * @param v3 Minix v3 file system?
+ */
+static void minix_geometry(bool v3)
+{
+	fs.v3 = v3;
+	fs.bsize = (v3) ? BLOCK_SIZE_V3 : BLOCK_SIZE;
+	fs.zsize = (v3) ? sizeof(uint32_t) : sizeof(uint16_t);
+	fs.isize = (v3) ? sizeof(struct d_inode_v3) : sizeof(struct d_inode);
+	fs.dsize = (v3) ? sizeof(struct d_dirent_v3) : sizeof(struct d_dirent);
+	fs.name_max = (v3) ? MINIX3_NAME_MAX : MINIX_NAME_MAX;
+	fs.nlevels = (v3) ? 3 : 2;
+}
+
 /**
  * @brief Reads the superblock of a Minix file system.
  */
 static void minix_super_read(void)
 {	
 	/* Read superblock. */
-	slseek(fd, 1*BLOCK_SIZE, SEEK_SET);
-	sread(fd, &super, sizeof(struct d_superblock));
-	if (super.s_magic != SUPER_MAGIC)
+	minix_pread(1*BLOCK_SIZE, &super, sizeof(super));
+	
+	/* Minix v1 file system. */
+	if (super.v1.s_magic == SUPER_MAGIC)
+	{
+		minix_geometry(false);
+		fs.ninodes = super.v1.s_ninodes;
+		fs.nblocks = super.v1.s_nblocks;
+		fs.imap_nblocks = super.v1.s_imap_nblocks;
+		fs.bmap_nblocks = super.v1.s_bmap_nblocks;
+		fs.first_data_block = super.v1.s_first_data_block;
+		fs.max_size = super.v1.s_max_size;
+	}
+	
+	/* Minix v3 file system. */
+	else if (super.v3.s_magic == SUPER_MAGIC_V3)
+	{
+		if (super.v3.s_block_size != BLOCK_SIZE_V3)
+			error("bad block size");
+		
+		minix_geometry(true);
+		fs.ninodes = super.v3.s_ninodes;
+		fs.nblocks = super.v3.s_nblocks;
+		fs.imap_nblocks = super.v3.s_imap_nblocks;
+		fs.bmap_nblocks = super.v3.s_bmap_nblocks;
+		fs.first_data_block = super.v3.s_first_data_block;
+		fs.max_size = super.v3.s_max_size;
+	}
+	
+	else
 		error("bad magic number");
 	
 	/* Read inode map. */
-	slseek(fd, 2*BLOCK_SIZE, SEEK_SET);
-	imap.size = super.s_imap_nblocks*BLOCK_SIZE;
+	imap.size = fs.imap_nblocks*fs.bsize;
 	imap.bitmap = smalloc(imap.size);
-	sread(fd, imap.bitmap, imap.size);
+	minix_pread(2*fs.bsize, imap.bitmap, imap.size);
 	
 	/* Read block map. */
-	slseek(fd, (2 + super.s_imap_nblocks)*BLOCK_SIZE, SEEK_SET);
-	zmap.size = super.s_bmap_nblocks*BLOCK_SIZE;
+	zmap.size = fs.bmap_nblocks*fs.bsize;
 	zmap.bitmap = smalloc(zmap.size);
-	sread(fd, zmap.bitmap, zmap.size);
+	minix_pread((2 + fs.imap_nblocks)*fs.bsize, zmap.bitmap, zmap.size);
 }
 
 /**
@@ -89,16 +234,16 @@ static void minix_super_read(void)
 static void minix_super_write(void)
 {
 	/* Write superblock. */
-	slseek(fd, 1*BLOCK_SIZE, SEEK_SET);
-	swrite(fd, &super, sizeof(struct d_superblock));
+	if (fs.v3)
+		minix_pwrite(1*BLOCK_SIZE, &super.v3, sizeof(struct d_superblock_v3));
+	else
+		minix_pwrite(1*BLOCK_SIZE, &super.v1, sizeof(struct d_superblock));
 	
 	/* Write inode map. */
-	slseek(fd, 2*BLOCK_SIZE, SEEK_SET);
-	swrite(fd, imap.bitmap, imap.size);
+	minix_pwrite(2*fs.bsize, imap.bitmap, imap.size);
 	
 	/* Write zone map. */
-	slseek(fd, (2 + super.s_imap_nblocks)*BLOCK_SIZE, SEEK_SET);
-	swrite(fd, zmap.bitmap, zmap.size);
+	minix_pwrite((2 + fs.imap_nblocks)*fs.bsize, zmap.bitmap, zmap.size);
 	
 	/* House keeping. */
 	free(imap.bitmap);
@@ -112,7 +257,15 @@ static void minix_super_write(void)
  */
 void minix_mount(const char *filename)
 {
+	off_t size;
+	
 	fd = sopen(filename, O_RDWR);
+	
+	/* Map disk file. */
+	if ((size = lseek(fd, 0, SEEK_END)) < 2*BLOCK_SIZE)
+		error("disk file too small");
+	minix_image_map(size);
+	
 	minix_super_read();
 }
 
@@ -124,9 +277,28 @@ void minix_mount(const char *filename)
 void minix_umount(void)
 {
 	minix_super_write();
+	minix_image_unmap();
 	sclose(fd);
 }
 
+/**
+ * @brief Computes the offset of a disk inode.
+ * 
+ * @param num Number of the inode.
+ * 
+ * @returns The offset of the inode @p num in the file system.
+ * 
+ * @note The Minix file system must be mounted.
+ */
+static off_t minix_inode_offset(uint16_t num)
+{
+	/* Bad inode number. */
+	if ((num == INODE_NULL) || (num > fs.ninodes))
+		error("bad inode number");
+	
+	return ((2 + fs.imap_nblocks + fs.bmap_nblocks)*fs.bsize + (num - 1)*fs.isize);
+}
+
 /**
  * @brief Reads an inode from the currently mounted Minix file system.
  * 
@@ -136,31 +308,44 @@ void minix_umount(void)
  * 
  * @note The Minix file system must be mounted.
  */
-struct d_inode *minix_inode_read(uint16_t num)
+struct minix_inode *minix_inode_read(uint16_t num)
 {
-	unsigned idx, off;         /* Inode number offset/index. */
-	off_t offset;              /* Offset in the file system. */
-	struct d_inode *ip;        /* Inode.                     */
-	unsigned inodes_per_block; /* Inodes per block.          */
+	struct minix_inode *ip;   /* Inode.            */
+	struct d_inode d_i;       /* Minix v1 inode.   */
+	struct d_inode_v3 d_i3;   /* Minix v3 inode.   */
+	off_t off;                /* Inode offset.     */
 	
-	num--;
+	ip = smalloc(sizeof(struct minix_inode));
+	off = minix_inode_offset(num);
 	
-	/* Bad inode number. */
-	if (num >= super.s_imap_nblocks*BLOCK_SIZE*8)
-		error("bad inode number");
-	
-	ip = smalloc(sizeof(struct d_inode));
-	
-	/* Compute file offset. */
-	inodes_per_block = BLOCK_SIZE/sizeof(struct d_inode);
-	idx = num/inodes_per_block; 
-	off = num%inodes_per_block;
-	offset = (2 + super.s_imap_nblocks + super.s_bmap_nblocks + idx)*BLOCK_SIZE;
-	offset += off*sizeof(struct d_inode);
+	/* Read Minix v3 inode. */
+	if (fs.v3)
+	{
+		minix_pread(off, &d_i3, sizeof(struct d_inode_v3));
+		ip->i_mode = d_i3.i_mode;
+		ip->i_uid = d_i3.i_uid;
+		ip->i_gid = d_i3.i_gid;
+		ip->i_nlinks = d_i3.i_nlinks;
+		ip->i_size = d_i3.i_size;
+		ip->i_time = d_i3.i_mtime;
+		for (unsigned i = 0; i < NR_ZONES_V3; i++)
+			ip->i_zones[i] = d_i3.i_zones[i];
+	}
 	
-	/* Read inode. */
-	slseek(fd, offset, SEEK_SET);
-	sread(fd, ip, sizeof(struct d_inode));
+	/* Read Minix v1 inode. */
+	else
+	{
+		minix_pread(off, &d_i, sizeof(struct d_inode));
+		ip->i_mode = d_i.i_mode;
+		ip->i_uid = d_i.i_uid;
+		ip->i_gid = d_i.i_gid;
+		ip->i_nlinks = d_i.i_nlinks;
+		ip->i_size = d_i.i_size;
+		ip->i_time = d_i.i_time;
+		for (unsigned i = 0; i < NR_ZONES; i++)
+			ip->i_zones[i] = d_i.i_zones[i];
+		ip->i_zones[ZONE_TRIPLE] = BLOCK_NULL;
+	}
 	
 	return (ip);
 }
@@ -173,28 +358,43 @@ struct d_inode *minix_inode_read(uint16_t num)
  * 
  * @note The Minix file system must be mounted.
  */
-void minix_inode_write(uint16_t num, struct d_inode *ip)
+void minix_inode_write(uint16_t num, struct minix_inode *ip)
 {
-	unsigned idx, off;         /* Inode number offset/index. */
-	off_t offset;              /* Offset in the file system. */
-	unsigned inodes_per_block; /* Inodes per block.          */
+	struct d_inode d_i;     /* Minix v1 inode. */
+	struct d_inode_v3 d_i3; /* Minix v3 inode. */
+	off_t off;              /* Inode offset.   */
 	
-	num--;
+	off = minix_inode_offset(num);
 	
-	/* Bad inode number. */
-	if (num >= super.s_imap_nblocks*BLOCK_SIZE*8)
-		error("bad inode number");
-	
-	/* Compute file offset. */
-	inodes_per_block = BLOCK_SIZE/sizeof(struct d_inode);
-	idx = num/inodes_per_block; 
-	off = num%inodes_per_block;
-	offset = (2 + super.s_imap_nblocks + super.s_bmap_nblocks + idx)*BLOCK_SIZE;
-	offset += off*sizeof(struct d_inode);
+	/* Write Minix v3 inode. */
+	if (fs.v3)
+	{
+		d_i3.i_mode = ip->i_mode;
+		d_i3.i_nlinks = ip->i_nlinks;
+		d_i3.i_uid = ip->i_uid;
+		d_i3.i_gid = ip->i_gid;
+		d_i3.i_size = ip->i_size;
+		d_i3.i_atime = ip->i_time;
+		d_i3.i_mtime = ip->i_time;
+		d_i3.i_ctime = ip->i_time;
+		for (unsigned i = 0; i < NR_ZONES_V3; i++)
+			d_i3.i_zones[i] = ip->i_zones[i];
+		minix_pwrite(off, &d_i3, sizeof(struct d_inode_v3));
+	}
 	
-	/* Write inode. */
-	slseek(fd, offset, SEEK_SET);
-	swrite(fd, ip, sizeof(struct d_inode));
+	/* Write Minix v1 inode. */
+	else
+	{
+		d_i.i_mode = ip->i_mode;
+		d_i.i_uid = ip->i_uid;
+		d_i.i_size = ip->i_size;
+		d_i.i_time = ip->i_time;
+		d_i.i_gid = ip->i_gid;
+		d_i.i_nlinks = ip->i_nlinks;
+		for (unsigned i = 0; i < NR_ZONES; i++)
+			d_i.i_zones[i] = ip->i_zones[i];
+		minix_pwrite(off, &d_i, sizeof(struct d_inode));
+	}
 	
 	free(ip);
 }
@@ -212,11 +412,11 @@ static block_t minix_block_alloc(void)
 	
 	/* Allocate block. */
 	bit = bitmap_first_free(zmap.bitmap, zmap.size);
-	if (bit == BITMAP_FULL)
+	if ((bit == BITMAP_FULL) || (fs.first_data_block + bit >= fs.nblocks))
 		error("block map overflow");
 	bitmap_set(zmap.bitmap, bit);
 	
-	return (super.s_first_data_block + bit);
+	return (fs.first_data_block + bit);
 }
 
 /**
@@ -232,13 +432,13 @@ static block_t minix_block_alloc(void)
  */
 static uint16_t minix_inode_alloc(uint16_t mode, uint16_t uid, uint16_t gid)
 {
-	uint16_t num;       /* Inode number.                */
-	uint32_t bit;       /* Bit number if the inode map. */
-	struct d_inode *ip; /* New inode.                   */
+	uint16_t num;           /* Inode number.                */
+	uint32_t bit;           /* Bit number if the inode map. */
+	struct minix_inode *ip; /* New inode.                   */
 
 	/* Allocate inode. */
 	bit = bitmap_first_free(imap.bitmap, imap.size);
-	if (bit == BITMAP_FULL)
+	if ((bit == BITMAP_FULL) || (bit >= fs.ninodes))
 		error("inode map overflow");
 	bitmap_set(imap.bitmap, bit);
 	num = bit + 1;
@@ -251,7 +451,7 @@ static uint16_t minix_inode_alloc(uint16_t mode, uint16_t uid, uint16_t gid)
 	ip->i_time = 0;
 	ip->i_gid = gid;
 	ip->i_nlinks = 1;
-	for (unsigned i = 0; i < NR_ZONES; i++)
+	for (unsigned i = 0; i < NR_ZONES_V3; i++)
 		ip->i_zones[i] = BLOCK_NULL;
 	minix_inode_write(num, ip);
 
@@ -261,33 +461,35 @@ static uint16_t minix_inode_alloc(uint16_t mode, uint16_t uid, uint16_t gid)
 /**
  * @brief Create an indirect block.
  *
- * @details Creates a indirect block and saves in @param dest.
+ * @details Gets the zone number at index @p idx of the indirect block @p blk,
+ *          and creates it if requested.
  *
- * @param dest Destination buffer, It is the corresponding disk block to be changed.
- * @param offset Offset to be calculated the block.
- * @param off File byte offset.
- * @param creat If 1, creates an block, otherwise, just return this value.
+ * @param blk    Indirect block.
+ * @param idx    Index of the zone number in the indirect block.
+ * @param create If 1, creates an block, otherwise, just return this value.
  *
  * @returns If successful, the block number created / obtained, otherwise BLOCK_NULL is 
  *          returned.
  */
-static block_t create_indirect_block
-(block_t *dest, off_t offset, off_t off, int create)
+static block_t create_indirect_block(block_t blk, block_t idx, bool create)
 {
-	block_t phys; /* Physical block number. */
+	off_t off;    /* Offset of the zone number. */
+	block_t phys; /* Physical block number.     */
+	
+	/* Zone numbers are stored in little endian. */
+	phys = BLOCK_NULL;
+	off = blk*fs.bsize + idx*fs.zsize;
+	minix_pread(off, &phys, fs.zsize);
 
-	if (dest[offset] == BLOCK_NULL && create)
+	if (phys == BLOCK_NULL && create)
 	{
 		/* Allocate an block. */
 		phys = minix_block_alloc();
-		dest[offset] = phys;
 		
-		slseek(fd, off , SEEK_SET);
-		swrite(fd, dest, BLOCK_SIZE);
-		return (phys);
+		minix_pwrite(off, &phys, fs.zsize);
 	}
-	else
-		return (dest[offset]);
+	
+	return (phys);
 }
 
 /**
@@ -302,7 +504,7 @@ static block_t create_indirect_block
  * @returns If successful, the block number created/obtained, otherwise BLOCK_NULL
  *          is returned.
  */
-static block_t create_direct_block(struct d_inode *ip, off_t offset, bool create)
+static block_t create_direct_block(struct minix_inode *ip, off_t offset, bool create)
 {
 	block_t phys; /* Physical block number. */
 
@@ -320,6 +522,9 @@ static block_t create_direct_block(struct d_inode *ip, off_t offset, bool create
 /**
  * @brief Maps a file byte offset in a block number.
  * 
+ * @details Indirect zones are walked one level at a time, so single, double
+ *          and triple indirect zones share the same code.
+ * 
  * @param ip     File to use
  * @param off    File byte offset.
  * @param create Create offset?
@@ -329,19 +534,20 @@ static block_t create_direct_block(struct d_inode *ip, off_t offset, bool create
  * @note @p ip must point to a valid inode.
  * @note The Minix file system must be mounted.
  */
-static block_t minix_block_map(struct d_inode *ip, off_t off, bool create)
+static block_t minix_block_map(struct minix_inode *ip, off_t off, bool create)
 {
-	block_t phys;                            /* Phys. blk. #.      */
-	size_t logic;                            /* Logic. blk. #.     */
-	block_t buf[BLOCK_SIZE/sizeof(block_t)]; /* Working buffer.    */
-	unsigned tmp;                            /* Logic. blk. #. tmp */
+	block_t phys;  /* Phys. blk. #.            */
+	block_t logic; /* Logic. blk. #.           */
+	block_t span;  /* Blocks per entry.        */
+	block_t nr;    /* Zone numbers per block.  */
+	unsigned lvl;  /* Indirection level.       */
 
-	logic = off/BLOCK_SIZE;
-	
 	/* File offset too big. */
-	if ((uint32_t)off >= super.s_max_size)
+	if ((uint32_t)off >= fs.max_size)
 		error("file too big");
 	
+	logic = off/fs.bsize;
+	
 	/* 
 	 * Create blocks that are
 	 * in a valid offset.
@@ -351,75 +557,62 @@ static block_t minix_block_map(struct d_inode *ip, off_t off, bool create)
 	
 	/* Direct block. */
 	if (logic < NR_ZONES_DIRECT)
-	{
-		/* Create direct block. */
-		if ( (phys = create_direct_block(ip,logic,create)) != BLOCK_NULL)
-			return (phys);
-		else
-			return (BLOCK_NULL);
-	}
+		return (create_direct_block(ip, logic, create));
 	
 	logic -= NR_ZONES_DIRECT;
 	
-	/* Single indirect block. */
-	if (logic < NR_SINGLE)
+	/* Find indirection level. */
+	nr = fs.bsize/fs.zsize;
+	span = nr;
+	for (lvl = 1; logic >= span; lvl++)
 	{
-		if ( (phys = create_direct_block(ip,ZONE_SINGLE,create)) != BLOCK_NULL)
-		{
-			off = phys*BLOCK_SIZE;
-			slseek(fd, off, SEEK_SET);
-			sread(fd, buf, BLOCK_SIZE);
-
-			if ( (phys = create_indirect_block(buf,logic,off,create)) != BLOCK_NULL)
-				return (phys);
-			else
-				return (BLOCK_NULL);
-		}
-		else
-			return (BLOCK_NULL);
+		if (lvl == fs.nlevels)
+			error("file too big");
+		
+		logic -= span;
+		span *= nr;
 	}
-
-	logic = off - REMAINING_OFFSET;
-
-	/* Double indirect block. */
-	tmp = logic / BLOCK_SIZE;
-	if (tmp < NR_DOUBLE)
+	
+	/* Walk down indirect blocks. */
+	phys = create_direct_block(ip, ZONE_SINGLE + lvl - 1, create);
+	while ((phys != BLOCK_NULL) && (lvl-- > 0))
 	{
-		size_t logicSingle = logic / (NR_SINGLE * BLOCK_SIZE);
-		size_t logicDouble = (logic / BLOCK_SIZE) & (NR_SINGLE - 1);
-
-		/* Create single, double and/or direct block. */
-		if ( (phys = create_direct_block(ip,ZONE_DOUBLE,create)) != BLOCK_NULL)
-		{
-			off = phys*BLOCK_SIZE;
-
-			slseek(fd, off, SEEK_SET);
-			sread(fd, buf, BLOCK_SIZE);
-
-			if ( (phys = create_indirect_block(buf,logicSingle,off,create)) 
-				!= BLOCK_NULL)
-			{
-				off = phys*BLOCK_SIZE;
-				slseek(fd, off, SEEK_SET);
-				sread(fd, buf, BLOCK_SIZE);
-
-				if ( (phys = create_indirect_block(buf,logicDouble,off,create)) 
-					!= BLOCK_NULL)
-					return (phys);
-				else
-					return (BLOCK_NULL);
-			}
-			else
-				return (BLOCK_NULL);
-		}
-		else
-			return (BLOCK_NULL);
+		span /= nr;
+		phys = create_indirect_block(phys, logic/span, create);
+		logic %= span;
 	}
 	
-	/* Triple indirect zone. */
-	error("triple indirect zone");
+	return (phys);
+}
+
+/**
+ * @brief Reads a directory entry.
+ * 
+ * @param off  File system offset of the directory entry.
+ * @param name Place to save the name of the entry, if not NULL.
+ * 
+ * @returns The inode number of the directory entry.
+ * 
+ * @note The Minix file system must be mounted.
+ */
+static uint16_t minix_dirent_read(off_t off, char *name)
+{
+	struct d_dirent d;     /* Minix v1 directory entry. */
+	struct d_dirent_v3 d3; /* Minix v3 directory entry. */
+	
+	/* Minix v3 directory entry. */
+	if (fs.v3)
+	{
+		minix_pread(off, &d3, sizeof(struct d_dirent_v3));
+		if (name != NULL)
+			memcpy(name, d3.d_name, MINIX3_NAME_MAX);
+		return (d3.d_ino);
+	}
 	
-	return (BLOCK_NULL);
+	minix_pread(off, &d, sizeof(struct d_dirent));
+	if (name != NULL)
+		memcpy(name, d.d_name, MINIX_NAME_MAX);
+	return (d.d_ino);
 }
 
 /**
@@ -436,70 +629,50 @@ static block_t minix_block_map(struct d_inode *ip, off_t off, bool create)
  * @note @p filename must point to a valid file name.
  * @note The Minix file system must be mounted.
  */
-static off_t dirent_search(struct d_inode *ip, const char *filename,bool create)
+static off_t dirent_search(struct minix_inode *ip, const char *filename,bool create)
 {
-	int i;             /* Working entry.               */
-	off_t base, off;   /* Working file offsets.        */
-	int entry;         /* Free entry.                  */
-	block_t blk;       /* Working block.               */
-	int nentries;      /* Number of directory entries. */
-	struct d_dirent d; /* Working directory entry.     */
+	off_t off;                   /* Working file offset.         */
+	int entry;                   /* Free entry.                  */
+	block_t blk;                 /* Working block.               */
+	int nentries;                /* Number of directory entries. */
+	int per_block;               /* Entries per block.           */
+	char name[MINIX3_NAME_MAX];  /* Working entry name.          */
 	
-	nentries = ip->i_size/sizeof(struct d_dirent);
+	nentries = ip->i_size/fs.dsize;
+	per_block = fs.bsize/fs.dsize;
 	
 	/* Search for directory entry. */
-	i = 0;
 	entry = -1;
-	blk = ip->i_zones[0];
-	base = -1;
-	while (i < nentries)
+	for (int i = 0; i < nentries; i++)
 	{
+		blk = minix_block_map(ip, i*fs.dsize, false);
+		
 		/* Skip invalid block. */
 		if (blk == BLOCK_NULL)
 		{
-			i += BLOCK_SIZE/sizeof(struct d_dirent);
-			blk = minix_block_map(ip, i*sizeof(struct d_dirent), false);
+			i += per_block - 1 - (i%per_block);
 			continue;
 		}
 		
-		/* Compute file offset. */
-		if (base < 0)
-		{
-			off = 0;
-			base = blk*BLOCK_SIZE;
-			slseek(fd, base, SEEK_SET);
-		}
+		off = blk*fs.bsize + (i%per_block)*fs.dsize;
 		
-		/* Get next block. */
-		else if (off >= BLOCK_SIZE)
+		/* Remember entry index. */
+		if (minix_dirent_read(off, name) == INODE_NULL)
 		{
-			base = -1;
-			blk = minix_block_map(ip, i*sizeof(struct d_dirent), false);
+			if (entry < 0)
+				entry = i;
 			continue;
 		}
 		
-		sread(fd, &d, sizeof(struct d_dirent));
-		
-		/* Valid entry. */
-		if (d.d_ino != INODE_NULL)
+		/* Found. */
+		if (!strncmp(name, filename, fs.name_max))
 		{
-			/* Found. */
-			if (!strncmp(d.d_name, filename, MINIX_NAME_MAX))
-			{
-				/* Duplicate entry. */
-				if (create)
-					error("duplicate entry");
-				
-				return (base + off);
-			}
+			/* Duplicate entry. */
+			if (create)
+				error("duplicate entry");
+			
+			return (off);
 		}
-		
-		/* Remember entry index. */
-		else
-			entry = i;
-		
-		i++;
-		off += sizeof(struct d_dirent);
 	}
 	
 	/* No entry found. */
@@ -510,18 +683,14 @@ static off_t dirent_search(struct d_inode *ip, const char *filename,bool create)
 	if (entry < 0)
 	{
 		entry = nentries;
-		blk = minix_block_map(ip, entry*sizeof(struct d_dirent), true);
-		ip->i_size += sizeof(struct d_dirent);
+		blk = minix_block_map(ip, entry*fs.dsize, true);
+		ip->i_size += fs.dsize;
 	}
 	
 	else
-		blk = minix_block_map(ip, entry*sizeof(struct d_dirent), false);
+		blk = minix_block_map(ip, entry*fs.dsize, false);
 	
-	/* Compute file offset. */
-	off = (entry%(BLOCK_SIZE/sizeof(struct d_dirent)))*sizeof(struct d_dirent);
-	base = blk*BLOCK_SIZE;
-	
-	return (base + off);
+	return (blk*fs.bsize + (entry%per_block)*fs.dsize);
 }
 
 /**
@@ -537,24 +706,24 @@ static off_t dirent_search(struct d_inode *ip, const char *filename,bool create)
  * @note @p filename must point to a valid file name.
  * @note The Minix file system must be mounted.
  */
-uint16_t dir_search(struct d_inode *dip, const char *filename)
+uint16_t dir_search(struct minix_inode *dip, const char *filename)
 {
-	off_t off;         /* File offset where the entry is. */
-	struct d_dirent d; /* Working directory entry.        */
+	off_t off; /* File offset where the entry is. */
 	
 	/* Not a directory. */
 	if (!S_ISDIR(dip->i_mode))
 		error("not a directory");
+	
+	/* Name does not fit in a directory entry. */
+	if (strlen(filename) > fs.name_max)
+		return (INODE_NULL);
 		
 	/* Search directory entry. */
 	off = dirent_search(dip, filename, false);
 	if (off == -1)
 		return (INODE_NULL);
 	
-	slseek(fd, off, SEEK_SET);
-	sread(fd, &d, sizeof(struct d_dirent));
-	
-	return (d.d_ino);
+	return (minix_dirent_read(off, NULL));
 }
 
 /**
@@ -569,25 +738,32 @@ uint16_t dir_search(struct d_inode *dip, const char *filename)
  * @note The Minix file system must be mounted.
  */
 static void minix_dirent_add
-(struct d_inode *dip, const char *filename, uint16_t num)
+(struct minix_inode *dip, const char *filename, uint16_t num)
 {
-	off_t off;         /* File offset of the entry. */
-	struct d_dirent d; /* Directory entry.          */
+	off_t off;             /* File offset of the entry. */
+	struct d_dirent d;     /* Minix v1 directory entry. */
+	struct d_dirent_v3 d3; /* Minix v3 directory entry. */
+	
+	/* Name does not fit in a directory entry. */
+	if (strlen(filename) > fs.name_max)
+		error("file name too long");
 	
 	/* Get free entry. */
 	off = dirent_search(dip, filename, true);
 	
-	/* Read directory entry. */
-	slseek(fd, off, SEEK_SET);
-	sread(fd, &d, sizeof(struct d_dirent));
-	
-	/* Set attributes. */
-	d.d_ino = num;
-	strncpy(d.d_name, filename, MINIX_NAME_MAX);
-	
 	/* Write directory entry. */
-	slseek(fd, off, SEEK_SET);
-	swrite(fd, &d, sizeof(struct d_dirent));
+	if (fs.v3)
+	{
+		d3.d_ino = num;
+		strncpy(d3.d_name, filename, MINIX3_NAME_MAX);
+		minix_pwrite(off, &d3, sizeof(struct d_dirent_v3));
+	}
+	else
+	{
+		d.d_ino = num;
+		strncpy(d.d_name, filename, MINIX_NAME_MAX);
+		minix_pwrite(off, &d, sizeof(struct d_dirent));
+	}
 	
 	dip->i_nlinks++;
 	dip->i_time = 0;
@@ -606,7 +782,7 @@ static void minix_dirent_add
  */
 uint16_t minix_inode_dname(const char *pathname, char *filename)
 {
-	struct d_inode *ip;   /* Working inode.         */
+	struct minix_inode *ip;   /* Working inode.         */
 	uint16_t num1, num2;  /* Working inode numbers. */
 	
 	/* Traverse file system tree. */
@@ -652,11 +828,11 @@ out:
  * @note The Minix file system must be mounted.
  */
 uint16_t minix_mkdir
-(struct d_inode *dip, uint16_t dnum, const char *filename, uint16_t uid, uint16_t gid)
+(struct minix_inode *dip, uint16_t dnum, const char *filename, uint16_t uid, uint16_t gid)
 {
 	uint16_t mode;
 	uint16_t num;
-	struct d_inode *ip;
+	struct minix_inode *ip;
 	
 	/* Not a directory. */
 	if (!S_ISDIR(dip->i_mode))
@@ -679,6 +855,58 @@ uint16_t minix_mkdir
 	return (num);
 }
 
+/**
+ * @brief Creates a directory and all missing parent directories.
+ * 
+ * @param pathname Path name of the directory.
+ * @param uid  User ID.
+ * @param gid  User group ID.
+ * 
+ * @returns The inode number of the directory.
+ * 
+ * @note @p pathname must point to a valid path name.
+ * @note The Minix file system must be mounted.
+ */
+uint16_t minix_mkdirs(const char *pathname, uint16_t uid, uint16_t gid)
+{
+	uint16_t num1, num2;                /* Working inode numbers. */
+	struct minix_inode *ip;             /* Working inode.         */
+	char filename[MINIX3_NAME_MAX + 1]; /* Working file name.     */
+	
+	/* Traverse file system tree. */
+	ip = minix_inode_read(num1 = INODE_ROOT);
+	do
+	{
+		pathname = break_path(pathname, filename);	
+		num2 = dir_search(ip, filename);
+		
+		/* Create directory. */
+		if (num2 == INODE_NULL)
+			num2 = minix_mkdir(ip, num1, filename, uid, gid);
+		
+		minix_inode_write(num1, ip);
+		ip = minix_inode_read(num1 = num2);
+	} while (*pathname != '\0');
+
+	minix_inode_write(num1, ip);
+	
+	return (num1);
+}
+
+/**
+ * @brief Returns device number.
+ * 
+ * @param type  Device type ('c' or 'b').
+ * @param major Major number.
+ * @param minor Minor number.
+ * 
+ * @returns The device number.
+ */
+uint16_t minix_devnum(char type, unsigned major, unsigned minor)
+{
+	return (((major & 0xf) << 8)|((minor & 0xf) << 4) | (type == 'c' ? 0 : 1));
+}
+
 /**
  * @brief Creates a special file.
  * 
@@ -694,10 +922,10 @@ uint16_t minix_mkdir
  * @note The Minix file system must be mounted.
  */
 void minix_mknod
-(struct d_inode *dip, const char *filename, uint16_t mode, uint16_t dev, uint16_t uid, uint16_t gid)
+(struct minix_inode *dip, const char *filename, uint16_t mode, uint16_t dev, uint16_t uid, uint16_t gid)
 {
 	uint16_t num;       /* Inode number of special file. */
-	struct d_inode *ip; /* Special file.                 */
+	struct minix_inode *ip; /* Special file.                 */
 	
 	/* Not a directory. */
 	if (!S_ISDIR(dip->i_mode))
@@ -734,8 +962,8 @@ uint16_t minix_create
 {
 	uint16_t num;                      /* Inode number of file. */
 	uint16_t dnum;                     /* Inode number of directory. */
-	struct d_inode *dip;               /* Directory.            */
-	char filename[MINIX_NAME_MAX + 1]; /* Name of the file.     */
+	struct minix_inode *dip;               /* Directory.            */
+	char filename[MINIX3_NAME_MAX + 1]; /* Name of the file.    */
 	
 	mode = (mode & ~S_IFMT) | S_IFREG;
 	
@@ -763,7 +991,7 @@ size_t minix_read(uint16_t num, void *buf, size_t n)
 {
 	char *p;            /* Reading pointer.     */
 	off_t off;          /* Current file offset. */
-	struct d_inode *ip; /* File.                */
+	struct minix_inode *ip; /* File.                */
 
 	p = buf;
 	ip = minix_inode_read(num);
@@ -774,15 +1002,14 @@ size_t minix_read(uint16_t num, void *buf, size_t n)
 	{
 		size_t blkoff;
 		size_t chunk;
-		uint16_t blk;
+		block_t blk;
 
 		blk = minix_block_map(ip, off, false);
-		blkoff = off % BLOCK_SIZE;
-		chunk = ((n - i) < (BLOCK_SIZE - blkoff)) ? n - i : BLOCK_SIZE - blkoff;
+		blkoff = off % fs.bsize;
+		chunk = ((n - i) < (fs.bsize - blkoff)) ? n - i : fs.bsize - blkoff;
 
 		/* Read data from file. */
-		slseek(fd, blk*BLOCK_SIZE + blkoff, SEEK_SET);
-		sread(fd, p, chunk);
+		minix_pread((off_t)blk*fs.bsize + blkoff, p, chunk);
 
 		off += chunk;
 		p += chunk;
@@ -807,7 +1034,7 @@ void minix_write(uint16_t num, const void *buf, size_t n)
 {
 	const char *p;      /* Writing pointer.     */
 	off_t off;          /* Current file offset. */
-	struct d_inode *ip; /* File.                */
+	struct minix_inode *ip; /* File.                */
 
 	p = buf;
 
@@ -820,15 +1047,14 @@ void minix_write(uint16_t num, const void *buf, size_t n)
 	{
 		size_t blkoff;
 		size_t chunk;
-		uint16_t blk;
+		block_t blk;
 
 		blk = minix_block_map(ip, off, true);
-		blkoff = off % BLOCK_SIZE;
-		chunk = ((n - i) < (BLOCK_SIZE - blkoff)) ? n - i : BLOCK_SIZE - blkoff;
+		blkoff = off % fs.bsize;
+		chunk = ((n - i) < (fs.bsize - blkoff)) ? n - i : fs.bsize - blkoff;
 
 		/* Write data to file. */
-		slseek(fd, blk*BLOCK_SIZE + blkoff, SEEK_SET);
-		swrite(fd, p, chunk);
+		minix_pwrite((off_t)blk*fs.bsize + blkoff, p, chunk);
 
 		ip->i_size += chunk;
 		off += chunk;
@@ -839,70 +1065,111 @@ void minix_write(uint16_t num, const void *buf, size_t n)
 	minix_inode_write(num, ip);
 }
 
+/**
+ * @brief Sets the bits of a bitmap that lie past its last valid bit.
+ * 
+ * @param bitmap Bitmap.
+ * @param size   Size of the bitmap (in bytes).
+ * @param nbits  Number of valid bits in the bitmap.
+ */
+static void minix_bitmap_trim(uint32_t *bitmap, size_t size, uint32_t nbits)
+{
+	for (uint32_t bit = nbits; bit < size*8; bit++)
+		bitmap_set(bitmap, bit);
+}
+
 /**
  * @brief Creates a Minix file system.
  * 
  * @param diskfile File where the minix file system shall be created.
+ * @param v3       Create a Minix v3 file system?
  * @param ninodes  Number of inodes.
  * @param nblocks  Number of blocks.
  * @param uid  User ID.
  * @param gid  User group ID.
  * 
  * @note @p diskfile must refer to a valid file.
- * @note @p ninodes must be valid.
- * @note @p nblocks must be valid.
  */
 void minix_mkfs
-(const char *diskfile, uint16_t ninodes, uint16_t nblocks, uint16_t uid, uint16_t gid)
+(const char *diskfile, bool v3, uint32_t ninodes, uint32_t nblocks, uint16_t uid, uint16_t gid)
 {
-	size_t size;            /* Size of file system.            */
-	char buf[BLOCK_SIZE];   /* Writing buffer.                 */
-	uint16_t imap_nblocks;  /* Number of inodes map blocks.    */
-	uint16_t bmap_nblocks;  /* Number of block map blocks.     */
-	uint16_t inode_nblocks; /* Number of inode blocks.         */
-	struct d_inode *root;   /* Root directory.                 */
-	mode_t mode;            /* Access permissions to root dir. */
-	uint16_t num;           /* Inode number of root directory. */
+	off_t size;                 /* File system size (in bytes).    */
+	uint32_t inode_nblocks;     /* Number of inode blocks.         */
+	struct minix_inode *root;   /* Root directory.                 */
+	mode_t mode;                /* Access permissions to root dir. */
+	uint16_t num;               /* Inode number of root directory. */
 	
-	fd = sopen(diskfile, O_RDWR | O_CREAT);
+	minix_geometry(v3);
+	
+	/* Inode numbers are 16-bit wide. */
+	if ((ninodes == 0) || (ninodes > UINT16_MAX))
+		error("bad number of inodes");
 	
-	#define ROUND(x) (((x) == 0) ? 1 : (x))
+	/* Minix v1 zone numbers are 16-bit wide. */
+	if ((!v3) && (nblocks > UINT16_MAX))
+		error("bad number of blocks");
 	
 	/* Compute dimensions of file sytem. */
-	imap_nblocks = ROUND(ninodes/(8*BLOCK_SIZE));
-	bmap_nblocks = ROUND(nblocks/(8*BLOCK_SIZE));
-	inode_nblocks = ROUND( (ninodes*sizeof(struct d_inode))/BLOCK_SIZE);
-	
-	/* Compute size of file system. */
-	size  = 1;             /* boot block   */
-	size += 1;             /* superblock   */
-	size += imap_nblocks;  /* inode map    */
-	size += bmap_nblocks;  /* block map    */
-	size += inode_nblocks; /* inode blocks */
-	size = nblocks - size;       /* data blocks  */
-	size <<= BLOCK_SIZE_LOG2;
+	fs.ninodes = ninodes;
+	fs.nblocks = nblocks;
+	fs.imap_nblocks = (ninodes + 8*fs.bsize - 1)/(8*fs.bsize);
+	fs.bmap_nblocks = (nblocks + 8*fs.bsize - 1)/(8*fs.bsize);
+	inode_nblocks = (ninodes*fs.isize + fs.bsize - 1)/fs.bsize;
+	fs.first_data_block = 2 + fs.imap_nblocks + fs.bmap_nblocks + inode_nblocks;
+	fs.max_size = (v3) ? 0x7fffffff : 67641344;
+	
+	/* Too small. */
+	if (fs.first_data_block >= nblocks)
+		error("too few blocks");
+	
+	fd = sopen(diskfile, O_RDWR | O_CREAT);
+	
+	/* Grow disk file, if needed. */
+	size = (off_t)nblocks*fs.bsize;
+	if (lseek(fd, 0, SEEK_END) < size)
+	{
+		slseek(fd, size - 1, SEEK_SET);
+		swrite(fd, "", 1);
+	}
 	
 	/* Fill file system with zeros. */
-	memset(buf, 0, BLOCK_SIZE);
-	for (size_t i = 0; i < size; i += BLOCK_SIZE)
-		swrite(fd, buf, BLOCK_SIZE);
+	minix_image_map(size);
+	memset(image.data, 0, size);
 	
 	/* Write superblock. */
-	super.s_ninodes = ninodes;
-	super.s_nblocks = nblocks;
-	super.s_imap_nblocks = imap_nblocks;
-	super.s_bmap_nblocks = bmap_nblocks;
-	super.s_first_data_block = 2 + imap_nblocks + bmap_nblocks + inode_nblocks;
-	super.s_max_size = 67641344;
-	super.s_magic = SUPER_MAGIC;
+	memset(&super, 0, sizeof(super));
+	if (v3)
+	{
+		super.v3.s_ninodes = ninodes;
+		super.v3.s_nblocks = nblocks;
+		super.v3.s_imap_nblocks = fs.imap_nblocks;
+		super.v3.s_bmap_nblocks = fs.bmap_nblocks;
+		super.v3.s_first_data_block = fs.first_data_block;
+		super.v3.s_log_zone_size = 0;
+		super.v3.s_max_size = fs.max_size;
+		super.v3.s_magic = SUPER_MAGIC_V3;
+		super.v3.s_block_size = BLOCK_SIZE_V3;
+	}
+	else
+	{
+		super.v1.s_ninodes = ninodes;
+		super.v1.s_nblocks = nblocks;
+		super.v1.s_imap_nblocks = fs.imap_nblocks;
+		super.v1.s_bmap_nblocks = fs.bmap_nblocks;
+		super.v1.s_first_data_block = fs.first_data_block;
+		super.v1.s_max_size = fs.max_size;
+		super.v1.s_magic = SUPER_MAGIC;
+	}
 	
 	/* Create inode map. */
-	imap.size = imap_nblocks*BLOCK_SIZE;
-	imap.bitmap = scalloc(imap_nblocks, BLOCK_SIZE);
+	imap.size = fs.imap_nblocks*fs.bsize;
+	imap.bitmap = scalloc(fs.imap_nblocks, fs.bsize);
+	minix_bitmap_trim(imap.bitmap, imap.size, ninodes);
 	
 	/* Create block map. */
-	zmap.size = bmap_nblocks*BLOCK_SIZE;
-	zmap.bitmap = scalloc(bmap_nblocks, BLOCK_SIZE);
+	zmap.size = fs.bmap_nblocks*fs.bsize;
+	zmap.bitmap = scalloc(fs.bmap_nblocks, fs.bsize);
+	minix_bitmap_trim(zmap.bitmap, zmap.size, nblocks - fs.first_data_block);
 	
 	/* Access permission to root directory. */
 	mode  = S_IFDIR;
@@ -918,3 +1185,531 @@ void minix_mkfs
 	
 	minix_umount();
 }
+
+/*============================================================================*
+ *                          File System Checker                               *
+ *============================================================================*/
+
+/**
+ * @name Inode states for the file system checker
+ */
+/**@{*/
+#define FSCK_USED    (1 << 0) /**< Inode is in use.                */
+#define FSCK_DIR     (1 << 1) /**< Inode is a directory.           */
+#define FSCK_DEV     (1 << 2) /**< Inode is a special file.        */
+#define FSCK_REACHED (1 << 3) /**< Inode is reachable from root.   */
+/**@}*/
+
+/**
+ * @brief File system checker.
+ */
+static struct
+{
+	bool repair;            /**< Repair inconsistencies?          */
+	unsigned nerrors;       /**< Inconsistencies found.           */
+	uint8_t *state;         /**< Inode states.                    */
+	uint16_t *refs;         /**< Directory entries to each inode. */
+	uint16_t *stack;        /**< Directories to be scanned.       */
+	uint32_t nstack;        /**< Directories in the stack.        */
+	uint32_t *imap;         /**< Rebuilt inode map.               */
+	uint32_t *zmap;         /**< Rebuilt zone map.                */
+	uint16_t num;           /**< Working inode number.            */
+	struct minix_inode *ip; /**< Working inode.                   */
+} fsck;
+
+/**
+ * @brief Asserts whether a zone number is in the data area.
+ * 
+ * @param blk Zone number.
+ * 
+ * @returns True if @p blk is a valid data zone, and false otherwise.
+ */
+static inline bool minix_zone_valid(block_t blk)
+{
+	return ((blk >= fs.first_data_block) && (blk < fs.nblocks));
+}
+
+/**
+ * @brief Gets a zone number from an indirect block.
+ * 
+ * @param blk Indirect block.
+ * @param idx Index of the zone number in the indirect block.
+ * 
+ * @returns The requested zone number.
+ */
+static block_t minix_zone_get(block_t blk, block_t idx)
+{
+	block_t z; /* Zone number. */
+	
+	/* Zone numbers are stored in little endian. */
+	z = BLOCK_NULL;
+	minix_pread((off_t)blk*fs.bsize + idx*fs.zsize, &z, fs.zsize);
+	
+	return (z);
+}
+
+/**
+ * @brief Sets a zone number in an indirect block.
+ * 
+ * @param blk Indirect block.
+ * @param idx Index of the zone number in the indirect block.
+ * @param z   Zone number.
+ */
+static void minix_zone_put(block_t blk, block_t idx, block_t z)
+{
+	minix_pwrite((off_t)blk*fs.bsize + idx*fs.zsize, &z, fs.zsize);
+}
+
+/**
+ * @brief Reports an inconsistency.
+ * 
+ * @param fmt Format string.
+ */
+static void minix_fsck_report(const char *fmt, ...)
+{
+	va_list args;
+	
+	va_start(args, fmt);
+	vprintf(fmt, args);
+	va_end(args);
+	printf("%s\n", (fsck.repair) ? " (fixed)" : "");
+	
+	fsck.nerrors++;
+}
+
+/**
+ * @brief Checks the entries of a directory block.
+ * 
+ * @param blk   Directory block.
+ * @param logic Logical number of @p blk in the working directory.
+ */
+static void minix_fsck_dirblk(block_t blk, block_t logic)
+{
+	uint32_t nentries;                  /* Entries in the directory. */
+	uint32_t per_block;                 /* Entries per block.        */
+	uint32_t ino;                       /* Working entry.            */
+	uint32_t null = INODE_NULL;         /* Cleared entry.            */
+	off_t off;                          /* Offset of the entry.      */
+	char name[MINIX3_NAME_MAX + 1];     /* Name of the entry.        */
+	
+	nentries = fsck.ip->i_size/fs.dsize;
+	per_block = fs.bsize/fs.dsize;
+	
+	for (uint32_t j = 0; j < per_block; j++)
+	{
+		if (logic*per_block + j >= nentries)
+			break;
+		
+		off = (off_t)blk*fs.bsize + j*fs.dsize;
+		if ((ino = minix_dirent_read(off, name)) == INODE_NULL)
+			continue;
+		name[fs.name_max] = '\0';
+		
+		/* Dangling entry. */
+		if ((ino > fs.ninodes) || !(fsck.state[ino] & FSCK_USED))
+		{
+			minix_fsck_report("directory %u: entry \"%s\" refers to free inode %u",
+				fsck.num, name, ino);
+			if (fsck.repair)
+				minix_pwrite(off, &null, (fs.v3) ? sizeof(uint32_t) : sizeof(uint16_t));
+			continue;
+		}
+		
+		fsck.refs[ino]++;
+		
+		/* Scan subdirectory later. */
+		if (!(fsck.state[ino] & FSCK_REACHED))
+		{
+			fsck.state[ino] |= FSCK_REACHED;
+			if (fsck.state[ino] & FSCK_DIR)
+				fsck.stack[fsck.nstack++] = ino;
+		}
+	}
+}
+
+/**
+ * @brief Walks a zone tree of the working inode.
+ * 
+ * @details While scanning directories (@p claim false), invalid zones are
+ *          silently skipped and data blocks are handed to
+ *          minix_fsck_dirblk(). While claiming zones (@p claim true), zones
+ *          that are out of range or that were already claimed by another
+ *          file are reported and, when repairing, cleared.
+ * 
+ * @param blk   Zone number.
+ * @param lvl   Indirection level of @p blk.
+ * @param logic Logical number of the first data block under @p blk.
+ * @param claim Claim zones?
+ * 
+ * @returns The zone number that should replace @p blk.
+ */
+static block_t minix_fsck_zone(block_t blk, unsigned lvl, block_t *logic, bool claim)
+{
+	block_t nr;   /* Zone numbers per block. */
+	block_t span; /* Blocks under this zone. */
+	block_t z;    /* Working zone number.    */
+	
+	nr = fs.bsize/fs.zsize;
+	span = 1;
+	for (unsigned i = 0; i < lvl; i++)
+		span *= nr;
+	
+	/* Hole. */
+	if (blk == BLOCK_NULL)
+		goto skip;
+	
+	/* Out of range. */
+	if (!minix_zone_valid(blk))
+	{
+		if (claim)
+		{
+			minix_fsck_report("inode %u: bad zone %u", fsck.num, blk);
+			goto bad;
+		}
+		goto skip;
+	}
+	
+	if (claim)
+	{
+		/* Cross-linked. */
+		if (bitmap_test(fsck.zmap, blk - fs.first_data_block))
+		{
+			minix_fsck_report("inode %u: duplicate zone %u", fsck.num, blk);
+			goto bad;
+		}
+		
+		bitmap_set(fsck.zmap, blk - fs.first_data_block);
+	}
+	
+	/* Data block. */
+	if (lvl == 0)
+	{
+		if (!claim)
+			minix_fsck_dirblk(blk, *logic);
+		(*logic)++;
+		return (blk);
+	}
+	
+	/* Indirect block. */
+	for (block_t idx = 0; idx < nr; idx++)
+	{
+		z = minix_zone_get(blk, idx);
+		if (minix_fsck_zone(z, lvl - 1, logic, claim) != z)
+			minix_zone_put(blk, idx, BLOCK_NULL);
+	}
+	
+	return (blk);
+
+bad:
+	*logic += span;
+	return ((fsck.repair) ? BLOCK_NULL : blk);
+
+skip:
+	*logic += span;
+	return (blk);
+}
+
+/**
+ * @brief Walks all zone trees of the working inode.
+ * 
+ * @param claim Claim zones?
+ * 
+ * @returns True if some zone number of the inode was cleared.
+ */
+static bool minix_fsck_zones(bool claim)
+{
+	bool dirty;    /* Inode changed?         */
+	block_t logic; /* Working logical block. */
+	block_t z;     /* Working zone number.   */
+	
+	dirty = false;
+	logic = 0;
+	
+	for (unsigned i = 0; i < NR_ZONES_DIRECT + fs.nlevels; i++)
+	{
+		z = fsck.ip->i_zones[i];
+		if (minix_fsck_zone(z, (i < NR_ZONES_DIRECT) ? 0 : i - NR_ZONES_DIRECT + 1,
+			&logic, claim) != z)
+		{
+			fsck.ip->i_zones[i] = BLOCK_NULL;
+			dirty = true;
+		}
+	}
+	
+	return (dirty);
+}
+
+/**
+ * @brief Compares a rebuilt bitmap to the on-disk one.
+ * 
+ * @param what    Name of the bitmap.
+ * @param bitmap  On-disk bitmap.
+ * @param rebuilt Rebuilt bitmap.
+ * @param size    Size of the bitmaps (in bytes).
+ */
+static void minix_fsck_bitmap
+(const char *what, uint32_t *bitmap, const uint32_t *rebuilt, size_t size)
+{
+	unsigned nwrong; /* Wrong bits. */
+	
+	nwrong = 0;
+	for (size_t i = 0; i < size/sizeof(uint32_t); i++)
+	{
+		for (uint32_t diff = bitmap[i] ^ rebuilt[i]; diff != 0; diff &= diff - 1)
+			nwrong++;
+	}
+	
+	if (nwrong == 0)
+		return;
+	
+	minix_fsck_report("%s map: %u wrong bits", what, nwrong);
+	if (fsck.repair)
+		memcpy(bitmap, rebuilt, size);
+}
+
+/**
+ * @brief Checks the currently mounted Minix file system.
+ * 
+ * @details The inode table is scanned once to learn which inodes are in use,
+ *          the directory tree is then walked from the root to count the
+ *          links to each inode and drop entries that refer to free inodes.
+ *          Finally, every inode in use is visited in a single linear pass,
+ *          in which unreachable inodes are released, link counts of
+ *          non-directory files are fixed, bad and cross-linked zones are
+ *          cleared, and the inode and zone maps are rebuilt.
+ * 
+ * @param repair Repair inconsistencies?
+ * 
+ * @returns The number of inconsistencies found.
+ * 
+ * @note The Minix file system must be mounted.
+ */
+unsigned minix_fsck(bool repair)
+{
+	bool dirty; /* Working inode changed? */
+	
+	fsck.repair = repair;
+	fsck.nerrors = 0;
+	fsck.state = scalloc(fs.ninodes + 1, sizeof(uint8_t));
+	fsck.refs = scalloc(fs.ninodes + 1, sizeof(uint16_t));
+	fsck.stack = scalloc(fs.ninodes + 1, sizeof(uint16_t));
+	fsck.nstack = 0;
+	fsck.imap = scalloc(1, imap.size);
+	fsck.zmap = scalloc(1, zmap.size);
+	
+	/* Find inodes in use. */
+	for (uint32_t num = 1; num <= fs.ninodes; num++)
+	{
+		fsck.ip = minix_inode_read(num);
+		if (fsck.ip->i_nlinks != 0)
+		{
+			fsck.state[num] |= FSCK_USED;
+			if (S_ISDIR(fsck.ip->i_mode))
+				fsck.state[num] |= FSCK_DIR;
+			else if (S_ISCHR(fsck.ip->i_mode) || S_ISBLK(fsck.ip->i_mode))
+				fsck.state[num] |= FSCK_DEV;
+		}
+		free(fsck.ip);
+	}
+	
+	if ((fsck.state[INODE_ROOT] & (FSCK_USED | FSCK_DIR)) != (FSCK_USED | FSCK_DIR))
+		error("root directory is damaged");
+	
+	/* Walk directory tree. */
+	fsck.state[INODE_ROOT] |= FSCK_REACHED;
+	fsck.stack[fsck.nstack++] = INODE_ROOT;
+	while (fsck.nstack > 0)
+	{
+		block_t logic = 0;
+		
+		fsck.num = fsck.stack[--fsck.nstack];
+		fsck.ip = minix_inode_read(fsck.num);
+		for (unsigned i = 0; i < NR_ZONES_DIRECT + fs.nlevels; i++)
+		{
+			minix_fsck_zone(fsck.ip->i_zones[i],
+				(i < NR_ZONES_DIRECT) ? 0 : i - NR_ZONES_DIRECT + 1, &logic, false);
+		}
+		free(fsck.ip);
+	}
+	
+	/* Check inodes. */
+	for (uint32_t num = 1; num <= fs.ninodes; num++)
+	{
+		if (!(fsck.state[num] & FSCK_USED))
+			continue;
+		
+		fsck.num = num;
+		fsck.ip = minix_inode_read(num);
+		dirty = false;
+		
+		/* Lost file. */
+		if (!(fsck.state[num] & FSCK_REACHED))
+		{
+			minix_fsck_report("inode %u: not referenced by any directory", num);
+			if (repair)
+			{
+				memset(fsck.ip, 0, sizeof(struct minix_inode));
+				minix_inode_write(num, fsck.ip);
+				continue;
+			}
+		}
+		
+		bitmap_set(fsck.imap, num - 1);
+		
+		/* Special files store a device number in the first zone. */
+		if (!(fsck.state[num] & FSCK_DEV))
+			dirty = minix_fsck_zones(true);
+		
+		/*
+		 * Directory link counts are maintained differently by
+		 * the kernel and by these tools, so only check other files.
+		 */
+		if (!(fsck.state[num] & FSCK_DIR) && (fsck.state[num] & FSCK_REACHED) &&
+			(fsck.ip->i_nlinks != fsck.refs[num]))
+		{
+			minix_fsck_report("inode %u: link count is %u, should be %u",
+				num, fsck.ip->i_nlinks, fsck.refs[num]);
+			fsck.ip->i_nlinks = fsck.refs[num];
+			dirty = true;
+		}
+		
+		if (repair && dirty)
+			minix_inode_write(num, fsck.ip);
+		else
+			free(fsck.ip);
+	}
+	
+	/* Check bitmaps. */
+	minix_bitmap_trim(fsck.imap, imap.size, fs.ninodes);
+	minix_bitmap_trim(fsck.zmap, zmap.size, fs.nblocks - fs.first_data_block);
+	minix_fsck_bitmap("inode", imap.bitmap, fsck.imap, imap.size);
+	minix_fsck_bitmap("zone", zmap.bitmap, fsck.zmap, zmap.size);
+	
+	/* House keeping. */
+	free(fsck.zmap);
+	free(fsck.imap);
+	free(fsck.stack);
+	free(fsck.refs);
+	free(fsck.state);
+	
+	return (fsck.nerrors);
+}
+
+/*============================================================================*
+ *                              Defragmenter                                  *
+ *============================================================================*/
+
+/**
+ * @brief Defragmenter.
+ */
+static struct
+{
+	char *area;        /**< Relocated data area.            */
+	block_t next;      /**< Next free zone in @p area.      */
+	block_t prev;      /**< Last zone visited.              */
+	unsigned nextents; /**< Contiguous runs of zones found. */
+} defrag;
+
+/**
+ * @brief Relocates a zone tree.
+ * 
+ * @details Zones are laid out in the order in which they are read, that is,
+ *          each indirect block comes right before the zones it refers to.
+ * 
+ * @param blk Zone number.
+ * @param lvl Indirection level of @p blk.
+ * 
+ * @returns The new zone number of @p blk.
+ */
+static block_t minix_defrag_zone(block_t blk, unsigned lvl)
+{
+	char *p;     /* Relocated zone.      */
+	block_t new; /* New zone number.     */
+	block_t z;   /* Working zone number. */
+	
+	if (blk == BLOCK_NULL)
+		return (BLOCK_NULL);
+	
+	if (blk != defrag.prev + 1)
+		defrag.nextents++;
+	defrag.prev = blk;
+	
+	new = defrag.next++;
+	p = defrag.area + (size_t)(new - fs.first_data_block)*fs.bsize;
+	minix_pread((off_t)blk*fs.bsize, p, fs.bsize);
+	
+	/* Relocate zones referred by an indirect block. */
+	if (lvl > 0)
+	{
+		for (block_t idx = 0; idx < fs.bsize/fs.zsize; idx++)
+		{
+			z = BLOCK_NULL;
+			memcpy(&z, p + idx*fs.zsize, fs.zsize);
+			z = minix_defrag_zone(z, lvl - 1);
+			memcpy(p + idx*fs.zsize, &z, fs.zsize);
+		}
+	}
+	
+	return (new);
+}
+
+/**
+ * @brief Defragments the currently mounted Minix file system.
+ * 
+ * @details The zones of every file are relocated, in inode order, to a
+ *          contiguous run at the beginning of the data area, and zone numbers
+ *          in inodes and indirect blocks are rewritten accordingly. The file
+ *          system must be consistent, so it is checked beforehand.
+ * 
+ * @returns The number of contiguous runs of zones that files were split into
+ *          before defragmentation.
+ * 
+ * @note The Minix file system must be mounted.
+ */
+unsigned minix_defrag(void)
+{
+	struct minix_inode *ip; /* Working inode.          */
+	uint32_t ndata;         /* Zones in the data area. */
+	
+	if (minix_fsck(false) != 0)
+		error("file system is not consistent, run fsck.minix first");
+	
+	ndata = fs.nblocks - fs.first_data_block;
+	defrag.area = scalloc(ndata, fs.bsize);
+	defrag.next = fs.first_data_block;
+	defrag.prev = BLOCK_NULL;
+	defrag.nextents = 0;
+	
+	/* Relocate zones. */
+	for (uint32_t num = 1; num <= fs.ninodes; num++)
+	{
+		ip = minix_inode_read(num);
+		
+		/* Skip free inodes and special files. */
+		if ((ip->i_nlinks == 0) || S_ISCHR(ip->i_mode) || S_ISBLK(ip->i_mode))
+		{
+			free(ip);
+			continue;
+		}
+		
+		defrag.prev = BLOCK_NULL;
+		for (unsigned i = 0; i < NR_ZONES_DIRECT + fs.nlevels; i++)
+		{
+			ip->i_zones[i] = minix_defrag_zone(ip->i_zones[i],
+				(i < NR_ZONES_DIRECT) ? 0 : i - NR_ZONES_DIRECT + 1);
+		}
+		minix_inode_write(num, ip);
+	}
+	
+	/* Write relocated data area. */
+	minix_pwrite((off_t)fs.first_data_block*fs.bsize, defrag.area, (size_t)ndata*fs.bsize);
+	free(defrag.area);
+	
+	/* Rebuild zone map. */
+	memset(zmap.bitmap, 0, zmap.size);
+	for (block_t blk = fs.first_data_block; blk < defrag.next; blk++)
+		bitmap_set(zmap.bitmap, blk - fs.first_data_block);
+	minix_bitmap_trim(zmap.bitmap, zmap.size, ndata);
+	
+	return (defrag.nextents);
+}
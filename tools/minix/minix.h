@@ -21,20 +21,43 @@
 #define _MINIX_H_
  	
  	#include <sys/types.h>
+ 	#include <stdbool.h>
+ 	#include <stdint.h>
  	#include <minix.h>
 
+	/**
+	 * @brief In-memory inode.
+	 * 
+	 * @details Disk inodes of Minix v1 and v3 file systems are converted
+	 *          to and from this structure.
+	 */
+	struct minix_inode
+	{
+		uint16_t i_mode;              /**< Access permissions.            */
+		uint16_t i_uid;               /**< User id of the file's owner.   */
+		uint16_t i_gid;               /**< Group number of owner user.    */
+		uint16_t i_nlinks;            /**< Number of links to the file.   */
+		uint32_t i_size;              /**< File size (in bytes).          */
+		uint32_t i_time;              /**< Time of last access.           */
+		block_t i_zones[NR_ZONES_V3]; /**< Zone numbers.                  */
+	};
+
 	/* Forward definitions. */
-	extern void minix_inode_write(uint16_t, struct d_inode *);
-	extern uint16_t dir_search(struct d_inode *, const char *);
+	extern void minix_inode_write(uint16_t, struct minix_inode *);
+	extern uint16_t dir_search(struct minix_inode *, const char *);
 	extern void minix_mount(const char *);
 	extern void minix_umount(void);
-	extern struct d_inode *minix_inode_read(uint16_t);
-	extern uint16_t minix_mkdir(struct d_inode *, uint16_t, const char *, uint16_t, uint16_t);
-	extern void minix_mknod(struct d_inode *, const char *, uint16_t, uint16_t, uint16_t, uint16_t);
+	extern struct minix_inode *minix_inode_read(uint16_t);
+	extern uint16_t minix_mkdir(struct minix_inode *, uint16_t, const char *, uint16_t, uint16_t);
+	extern uint16_t minix_mkdirs(const char *, uint16_t, uint16_t);
+	extern uint16_t minix_devnum(char, unsigned, unsigned);
+	extern void minix_mknod(struct minix_inode *, const char *, uint16_t, uint16_t, uint16_t, uint16_t);
 	extern uint16_t minix_inode_dname(const char *, char *);
 	extern uint16_t minix_create(const char *, uint16_t, uint16_t, uint16_t);
 	extern size_t minix_read(uint16_t, void *, size_t);
 	extern void minix_write(uint16_t, const void *, size_t);
-	extern void minix_mkfs(const char *, uint16_t, uint16_t, uint16_t, uint16_t);
+	extern void minix_mkfs(const char *, bool, uint32_t, uint32_t, uint16_t, uint16_t);
+	extern unsigned minix_fsck(bool);
+	extern unsigned minix_defrag(void);
 
 #endif /* _MINIX_H_ */
@@ -41,36 +41,12 @@ static void usage(void)
  */
 int main(int argc, char **argv)
 {
-	const char *dirname;               /* Directory that shall be created. */
-	uint16_t num1, num2;               /* Working inode numbers.           */
-	struct d_inode *ip;                /* Working inode.                   */
-	char filename[MINIX_NAME_MAX + 1]; /* Working file name.               */
-	
 	/* Wrong usage. */
 	if (argc != 5)
 		usage();
 
 	minix_mount(argv[1]);
-	
-	dirname = argv[2];
-	
-	/* Traverse file system tree. */
-	ip = minix_inode_read(num1 = INODE_ROOT);
-	do
-	{
-		dirname = break_path(dirname, filename);	
-		num2 = dir_search(ip, filename);
-		
-		/* Create directory. */
-		if (num2 == INODE_NULL)
-			num2 = minix_mkdir(ip, num1, filename, atoi(argv[3]), atoi(argv[4]));
-		
-		minix_inode_write(num1, ip);
-		ip = minix_inode_read(num1 = num2);
-	} while (*dirname != '\0');
-
-	minix_inode_write(num1, ip);
-
+	minix_mkdirs(argv[2], atoi(argv[3]), atoi(argv[4]));
 	minix_umount();
 	
 	return (EXIT_SUCCESS);
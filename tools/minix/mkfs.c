@@ -17,8 +17,10 @@
  * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "minix.h"
 
@@ -27,18 +29,30 @@
  */
 static void usage(void)
 {
-	printf("usage: mkfs.minix <input file> <ninodes> <nblocks> <uid> <gid>\n");
+	printf("usage: mkfs.minix [-3] <input file> <ninodes> <nblocks> <uid> <gid>\n");
 	exit(EXIT_SUCCESS);
 }
 
 /**
  * @brief Creates a Minix file system.
+ * 
+ * @details The -3 flag selects the Minix v3 format, in which case
+ *          @p nblocks counts 4 KB blocks instead of 1 KB ones.
  */
 int main(int argc, char **argv)
 {
 	unsigned ninodes;     /* # inodes in the file system.      */
 	unsigned nblocks; 	  /* # data blocks in the file system. */
 	const char *diskfile; /* Disk file name.                   */
+	bool v3;              /* Create a Minix v3 file system?    */
+	
+	/* Minix v3 file system. */
+	v3 = ((argc > 1) && (!strcmp(argv[1], "-3")));
+	if (v3)
+	{
+		argc--;
+		argv++;
+	}
 	
 	/* Missing arguments. */
 	if (argc < 6)
@@ -49,7 +63,7 @@ int main(int argc, char **argv)
 	sscanf(argv[2], "%u", &ninodes);
 	sscanf(argv[3], "%u", &nblocks);
 	
-	minix_mkfs(diskfile, ninodes, nblocks, atoi(argv[4]), atoi(argv[5]));
+	minix_mkfs(diskfile, v3, ninodes, nblocks, atoi(argv[4]), atoi(argv[5]));
 	
 	return (EXIT_SUCCESS);
 }
@@ -0,0 +1,268 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "minix.h"
+#include "util.h"
+
+/**
+ * @brief Maximum length of a path name (including the null character).
+ */
+#define PATHNAME_MAX 1024
+
+/**
+ * @brief Maximum length of a manifest line (including the null character).
+ */
+#define MANIFEST_LINE_MAX (4*PATHNAME_MAX)
+
+/**
+ * @brief Prints program usage and exits.
+ */
+static void usage(void)
+{
+	printf("usage: mkimg.minix [-3] <input file> <ninodes> <nblocks> <uid> <gid> <manifest>\n");
+	printf("\n");
+	printf("manifest entries, one per line:\n");
+	printf("  mkdir <directory> <uid> <gid>\n");
+	printf("  mknod <file name> <mode> <type> <minor> <major> <uid> <gid>\n");
+	printf("  cp <source file> <dest file> <uid> <gid>\n");
+	printf("  tree <source directory> <dest directory> <uid> <gid>\n");
+	exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Copies a file to the mounted Minix file system.
+ * 
+ * @param src  Source file.
+ * @param dest Destination file.
+ * @param uid  User ID.
+ * @param gid  User group ID.
+ */
+static void mkimg_cp(const char *src, const char *dest, uint16_t uid, uint16_t gid)
+{
+	int fd;            /* File ID of source file. */
+	struct stat stbuf; /* Buffer for stat().      */
+	char *buf;         /* Buffer used for copying. */
+	uint16_t num;      /* Working inode number.   */
+	
+	if (stat(src, &stbuf) != 0)
+		error("cannot stat()");
+	
+	num = minix_create(dest, stbuf.st_mode, uid, gid);
+	
+	/* Empty file. */
+	if (stbuf.st_size == 0)
+		return;
+	
+	buf = smalloc(stbuf.st_size);
+	fd = sopen(src, O_RDONLY);
+	sread(fd, buf, stbuf.st_size);
+	sclose(fd);
+	minix_write(num, buf, stbuf.st_size);
+	free(buf);
+}
+
+/**
+ * @brief Copies a directory tree to the mounted Minix file system.
+ * 
+ * @param src  Source directory.
+ * @param dest Destination directory.
+ * @param uid  User ID.
+ * @param gid  User group ID.
+ */
+static void mkimg_tree(const char *src, const char *dest, uint16_t uid, uint16_t gid)
+{
+	DIR *dirp;                  /* Source directory.  */
+	struct dirent *dp;          /* Working entry.     */
+	struct stat stbuf;          /* Buffer for stat(). */
+	char spath[PATHNAME_MAX];   /* Source path.       */
+	char dpath[PATHNAME_MAX];   /* Destination path.  */
+	
+	minix_mkdirs(dest, uid, gid);
+	
+	if ((dirp = opendir(src)) == NULL)
+		error("cannot opendir()");
+	
+	while ((dp = readdir(dirp)) != NULL)
+	{
+		if (!strcmp(dp->d_name, ".") || !strcmp(dp->d_name, ".."))
+			continue;
+		
+		if (snprintf(spath, sizeof(spath), "%s/%s", src, dp->d_name) >= PATHNAME_MAX)
+			error("path name too long");
+		if (snprintf(dpath, sizeof(dpath), "%s/%s", dest, dp->d_name) >= PATHNAME_MAX)
+			error("path name too long");
+		
+		if (stat(spath, &stbuf) != 0)
+			error("cannot stat()");
+		
+		if (S_ISDIR(stbuf.st_mode))
+			mkimg_tree(spath, dpath, uid, gid);
+		else if (S_ISREG(stbuf.st_mode))
+			mkimg_cp(spath, dpath, uid, gid);
+	}
+	
+	closedir(dirp);
+}
+
+/**
+ * @brief Creates a special file in the mounted Minix file system.
+ * 
+ * @param pathname Name of the special file.
+ * @param mode     Access mode of the special file.
+ * @param dev      Device number.
+ * @param uid      User ID.
+ * @param gid      User group ID.
+ */
+static void mkimg_mknod
+(const char *pathname, unsigned mode, uint16_t dev, uint16_t uid, uint16_t gid)
+{
+	uint16_t num;                       /* Working inode number. */
+	struct minix_inode *dip;            /* Working inode.        */
+	char filename[MINIX3_NAME_MAX + 1]; /* Working file name.    */
+	
+	num = minix_inode_dname(pathname, filename);
+	dip = minix_inode_read(num);
+	minix_mknod(dip, filename, mode, dev, uid, gid);
+	minix_inode_write(num, dip);
+}
+
+/**
+ * @brief Applies a manifest entry to the mounted Minix file system.
+ * 
+ * @param line Manifest line.
+ * 
+ * @returns True if the entry is well formed, and false otherwise.
+ */
+static bool mkimg_entry(const char *line)
+{
+	char cmd[8];                      /* Entry type.          */
+	char arg1[PATHNAME_MAX];          /* First path name.     */
+	char arg2[PATHNAME_MAX];          /* Second path name.    */
+	unsigned uid, gid;                /* Owner.               */
+	unsigned mode, minor, major;      /* Special file.        */
+	char type;                        /* Special file type.   */
+	int n;                            /* Characters consumed. */
+	
+	/* Blank line or comment. */
+	if (sscanf(line, " %7s%n", cmd, &n) != 1 || cmd[0] == '#')
+		return (true);
+	line += n;
+	
+	if (!strcmp(cmd, "mkdir"))
+	{
+		if (sscanf(line, "%1023s %u %u", arg1, &uid, &gid) != 3)
+			return (false);
+		minix_mkdirs(arg1, uid, gid);
+	}
+	
+	else if (!strcmp(cmd, "mknod"))
+	{
+		if (sscanf(line, "%1023s %o %c %u %u %u %u",
+			arg1, &mode, &type, &minor, &major, &uid, &gid) != 7)
+			return (false);
+		mkimg_mknod(arg1, mode, minix_devnum(type, major, minor), uid, gid);
+	}
+	
+	else if (!strcmp(cmd, "cp"))
+	{
+		if (sscanf(line, "%1023s %1023s %u %u", arg1, arg2, &uid, &gid) != 4)
+			return (false);
+		mkimg_cp(arg1, arg2, uid, gid);
+	}
+	
+	else if (!strcmp(cmd, "tree"))
+	{
+		if (sscanf(line, "%1023s %1023s %u %u", arg1, arg2, &uid, &gid) != 4)
+			return (false);
+		mkimg_tree(arg1, arg2, uid, gid);
+	}
+	
+	else
+		return (false);
+	
+	return (true);
+}
+
+/**
+ * @brief Builds a Minix file system image from a manifest.
+ * 
+ * @details Creates the file system and then applies every entry of the
+ *          manifest to it, all in a single mount. This is equivalent to
+ *          running mkfs.minix followed by one mkdir.minix, mknod.minix or
+ *          cp.minix per entry, but the disk file is mapped into memory and
+ *          the bitmaps and superblock are only written back once.
+ */
+int main(int argc, char **argv)
+{
+	FILE *manifest;               /* Manifest file.                    */
+	char line[MANIFEST_LINE_MAX]; /* Working line.                     */
+	unsigned lineno;              /* Working line number.              */
+	unsigned ninodes;             /* # inodes in the file system.      */
+	unsigned nblocks;             /* # data blocks in the file system. */
+	const char *diskfile;         /* Disk file name.                   */
+	bool v3;                      /* Create a Minix v3 file system?    */
+	
+	/* Minix v3 file system. */
+	v3 = ((argc > 1) && (!strcmp(argv[1], "-3")));
+	if (v3)
+	{
+		argc--;
+		argv++;
+	}
+	
+	/* Wrong usage. */
+	if (argc != 7)
+		usage();
+	
+	/* Extract arguments. */
+	diskfile = argv[1];
+	sscanf(argv[2], "%u", &ninodes);
+	sscanf(argv[3], "%u", &nblocks);
+	
+	if ((manifest = fopen(argv[6], "r")) == NULL)
+		error("cannot open manifest");
+	
+	minix_mkfs(diskfile, v3, ninodes, nblocks, atoi(argv[4]), atoi(argv[5]));
+	minix_mount(diskfile);
+	
+	for (lineno = 1; fgets(line, sizeof(line), manifest) != NULL; lineno++)
+	{
+		if (!mkimg_entry(line))
+		{
+			fprintf(stderr, "%s:%u: bad manifest entry\n", argv[6], lineno);
+			exit(EXIT_FAILURE);
+		}
+	}
+	
+	minix_umount();
+	fclose(manifest);
+	
+	return (EXIT_SUCCESS);
+}
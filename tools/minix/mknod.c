@@ -36,32 +36,18 @@ static void usage(void)
 	exit(EXIT_SUCCESS);
 }
 
-/**
- * @brief Returns device number.
- * 
- * @param type  Device type.
- * @param major Major number.
- * @param minor Minor number.
- * 
- * @returns The device number.
- */
-static inline uint16_t devnum(char type, unsigned major, unsigned minor)
-{
-	return (((major & 0xf) << 8)|((minor & 0xf) << 4) | (type == 'c' ? 0 : 1));
-}
-
 /**
  * @brief Creates a special file in a Minix file system.
  */
 int main(int argc, char **argv)
 {
-	const char *pathname;              /* Directory where create file.     */
-	uint16_t num;                      /* Working inode number.            */
-	struct d_inode *dip;               /* Working inode.                   */
-	char filename[MINIX_NAME_MAX + 1]; /* Working file name.               */
-	unsigned mode;                     /* Access mode of the special file. */
-	unsigned major, minor;             /* Major and minor numbers.         */
-	char type;                         /* Character type.                  */
+	const char *pathname;               /* Directory where create file.     */
+	uint16_t num;                       /* Working inode number.            */
+	struct minix_inode *dip;            /* Working inode.                   */
+	char filename[MINIX3_NAME_MAX + 1]; /* Working file name.               */
+	unsigned mode;                      /* Access mode of the special file. */
+	unsigned major, minor;              /* Major and minor numbers.         */
+	char type;                          /* Character type.                  */
 	
 	/* Wrong usage. */
 	if (argc != 9)
@@ -76,7 +62,7 @@ int main(int argc, char **argv)
 	minix_mount(argv[1]);	
 	num = minix_inode_dname(pathname, filename);
 	dip = minix_inode_read(num);
-	minix_mknod(dip, filename, mode, devnum(type, major, minor), atoi(argv[7]), atoi(argv[8]));
+	minix_mknod(dip, filename, mode, minix_devnum(type, major, minor), atoi(argv[7]), atoi(argv[8]));
 	minix_inode_write(num, dip);
 	minix_umount();
 	
@@ -171,7 +171,7 @@ const char *break_path(const char *pathname, char *filename)
 	/* Get file name. */
 	while ((*p1 != '\0') && (*p1 != '/'))
 	{
-		if ((p2 - filename) > MINIX_NAME_MAX)
+		if ((p2 - filename) >= MINIX3_NAME_MAX)
 			error("file name too long");
 		*p2++ = *p1++;
 	}
@@ -21,33 +21,35 @@
 # NOTES:
 #   - This script should work in any Linux distribution.
 #   - You should run this script with superuser privileges.
+#   - Set NCPUS to run an SMP machine, e.g. NCPUS=4.
 #
 
 export CURDIR=`pwd`
+export NCPUS=${NCPUS:-1}
 
 if [ "$TARGET" = "i386" ]; then
 	if [ "$1" = "--dbg" ]; then
 		qemu-system-i386 -s -S                                   \
 			-drive file=nanvix.iso,format=raw,if=ide,media=cdrom \
-			-m 256M                                              \
+			-m 256M -smp $NCPUS                                  \
 			-mem-prealloc &
 		ddd --debugger "$CURDIR/tools/dev/toolchain/i386/bin/i386-elf-gdb"
 	elif [ "$1" = "--perf" ]; then
 		qemu-system-i386                                         \
 			-drive file=nanvix.iso,format=raw,if=ide,media=cdrom \
-			-m 256M                                              \
+			-m 256M -smp $NCPUS                                  \
 			-mem-prealloc -cpu host --enable-kvm
 	elif [ "$1" = "--serial" ]; then
 		qemu-system-i386                                         \
 			-nographic                                           \
 			-display none                                        \
 			-drive file=nanvix.iso,format=raw,if=ide,media=cdrom \
-			-m 256M                                              \
+			-m 256M -smp $NCPUS                                  \
 			-mem-prealloc
 	else
 		qemu-system-i386                                         \
 			-drive file=nanvix.iso,format=raw,if=ide,media=cdrom \
-			-m 256M                                              \
+			-m 256M -smp $NCPUS                                  \
 			-mem-prealloc
 	fi
 else
@@ -0,0 +1,238 @@
+/*
+ * Copyright(C) 2011-2018 Pedro H. Penna <pedrohenriquepenna@gmail.com>
+ *
+ * This file is part of Nanvix.
+ *
+ * Nanvix is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Nanvix is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Nanvix. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sys/trace.h"
+
+/**
+ * @brief Number of slots in the pending system call table.
+ */
+#define NR_PENDING 1024
+
+/**
+ * @brief Number of system calls that are accounted.
+ */
+#define NR_SYSCALLS_MAX 128
+
+/**
+ * @brief Event names.
+ */
+static const char *events[TRACE_NR_EVENTS] = {
+	"user",
+	"syscall",
+	"sysret",
+	"switch",
+	"pgfault",
+	"bmiss",
+	"ata"
+};
+
+/**
+ * @brief System call that has not returned yet.
+ */
+static struct
+{
+	int32_t pid;   /**< Process ID.      */
+	uint64_t time; /**< Entry time stamp. */
+} pending[NR_PENDING];
+
+/**
+ * @brief System call statistics.
+ */
+static struct
+{
+	unsigned count; /**< Number of calls.  */
+	uint64_t total; /**< Total latency.    */
+	uint64_t max;   /**< Maximum latency.  */
+} stats[NR_SYSCALLS_MAX];
+
+/**
+ * @brief Prints program usage and exits.
+ */
+static void usage(void)
+{
+	printf("usage: tracedump <trace file>\n");
+	exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Compares two trace records by time stamp.
+ */
+static int record_cmp(const void *p1, const void *p2)
+{
+	const struct trace_record *r1 = p1;
+	const struct trace_record *r2 = p2;
+
+	if (r1->time != r2->time)
+		return ((r1->time < r2->time) ? -1 : 1);
+	if (r1->cpu != r2->cpu)
+		return (r1->cpu - r2->cpu);
+
+	return ((r1->seq < r2->seq) ? -1 : (r1->seq > r2->seq));
+}
+
+/**
+ * @brief Prints a trace record.
+ *
+ * @param rec   Target record.
+ * @param start Time stamp of the first record.
+ */
+static void record_print(const struct trace_record *rec, uint64_t start)
+{
+	unsigned slot = (unsigned)rec->pid % NR_PENDING;
+
+	printf("%12" PRIu64 " cpu%-2u %5" PRId32 " %-8s ",
+		rec->time - start,
+		rec->cpu,
+		rec->pid,
+		(rec->event < TRACE_NR_EVENTS) ? events[rec->event] : "?");
+
+	switch (rec->event)
+	{
+		case TRACE_SYSCALL_ENTER:
+			printf("nr=%" PRIu32 " arg0=%#" PRIx32 " arg1=%#" PRIx32 "\n",
+				rec->args[0], rec->args[1], rec->args[2]);
+			pending[slot].pid = rec->pid;
+			pending[slot].time = rec->time;
+			break;
+
+		case TRACE_SYSCALL_EXIT:
+			printf("nr=%" PRIu32 " ret=%" PRId32,
+				rec->args[0], (int32_t)rec->args[1]);
+
+			/* Account latency. */
+			if ((pending[slot].pid == rec->pid) && (pending[slot].time != 0))
+			{
+				uint64_t latency = rec->time - pending[slot].time;
+
+				printf(" latency=%" PRIu64, latency);
+				pending[slot].time = 0;
+
+				if (rec->args[0] < NR_SYSCALLS_MAX)
+				{
+					stats[rec->args[0]].count++;
+					stats[rec->args[0]].total += latency;
+					if (latency > stats[rec->args[0]].max)
+						stats[rec->args[0]].max = latency;
+				}
+			}
+			printf("\n");
+			break;
+
+		case TRACE_SWITCH:
+			printf("prev=%" PRId32 " next=%" PRId32 " state=%" PRIu32 "\n",
+				(int32_t)rec->args[0], (int32_t)rec->args[1], rec->args[2]);
+			break;
+
+		case TRACE_PAGE_FAULT:
+			printf("addr=%#" PRIx32 " %s\n",
+				rec->args[0], rec->args[1] ? "protection" : "validity");
+			break;
+
+		case TRACE_BREAD_MISS:
+			printf("dev=%#" PRIx32 " block=%" PRIu32 "\n",
+				rec->args[0], rec->args[1]);
+			break;
+
+		case TRACE_ATA_DONE:
+			printf("dev=%" PRIu32 " %s block=%" PRIu32 "\n",
+				rec->args[0], rec->args[1] ? "write" : "read", rec->args[2]);
+			break;
+
+		default:
+			printf("%#" PRIx32 " %#" PRIx32 " %#" PRIx32 "\n",
+				rec->args[0], rec->args[1], rec->args[2]);
+			break;
+	}
+}
+
+/**
+ * @brief Decodes a kernel trace.
+ *
+ * @details Reads the records that were dumped from /dev/trace, sorts them
+ * by time stamp, prints them and then prints system call latencies. Time
+ * stamps are printed relative to the first record, in the unit that the
+ * kernel uses (CPU cycles on i386, clock ticks elsewhere).
+ */
+int main(int argc, char **argv)
+{
+	FILE *fp;                    /* Trace file.        */
+	size_t n;                    /* Number of records. */
+	size_t size;                 /* Size of records.   */
+	struct trace_record *recs;   /* Trace records.     */
+
+	/* Wrong usage. */
+	if (argc != 2)
+		usage();
+
+	if ((fp = fopen(argv[1], "rb")) == NULL)
+	{
+		perror(argv[1]);
+		return (EXIT_FAILURE);
+	}
+
+	/* Read all records. */
+	n = 0;
+	size = 1024;
+	if ((recs = malloc(size*sizeof(struct trace_record))) == NULL)
+		goto error;
+	while (fread(&recs[n], sizeof(struct trace_record), 1, fp) == 1)
+	{
+		if (++n == size)
+		{
+			struct trace_record *tmp;
+
+			size *= 2;
+			if ((tmp = realloc(recs, size*sizeof(struct trace_record))) == NULL)
+				goto error;
+			recs = tmp;
+		}
+	}
+	fclose(fp);
+
+	qsort(recs, n, sizeof(struct trace_record), record_cmp);
+
+	for (size_t i = 0; i < n; i++)
+		record_print(&recs[i], recs[0].time);
+
+	/* Print latencies. */
+	printf("\n%4s %8s %12s %12s\n", "nr", "count", "avg", "max");
+	for (unsigned i = 0; i < NR_SYSCALLS_MAX; i++)
+	{
+		if (stats[i].count == 0)
+			continue;
+
+		printf("%4u %8u %12" PRIu64 " %12" PRIu64 "\n",
+			i, stats[i].count, stats[i].total/stats[i].count, stats[i].max);
+	}
+
+	free(recs);
+
+	return (EXIT_SUCCESS);
+
+error:
+	fprintf(stderr, "tracedump: out of memory\n");
+	fclose(fp);
+	return (EXIT_FAILURE);
+}